@@ -64,8 +64,71 @@ namespace Gsage
         dump(node);
         return node;
       };
+
+      /**
+       * Read all bound properties, marks component dirty
+       * @param dict DataProxy to read
+       */
+      virtual bool read(const DataProxy& dict);
+
+      /**
+       * Read a particular property, marks component dirty
+       * @param dict To read property from
+       * @param id Property id
+       */
+      virtual bool read(const DataProxy& dict, const std::string& id);
+
+      /**
+       * Read resolved properties, marks component dirty.
+       * Calls read of the DataProxy, unless the component reads resolved properties
+       *
+       * @param properties Resolved properties
+       * @param dict DataProxy the properties were resolved from
+       */
+      virtual bool read(const ResolvedProperties& properties, const DataProxy& dict);
+
+      /**
+       * Mark component state as changed, so that it is dumped by the next save.
+       * Owner entity is marked dirty as well
+       *
+       * @param value false resets the flag, it is done by the save
+       */
+      void setDirty(bool value = true);
+
+      /**
+       * Check if component state was changed since the last save.
+       * Components that do not track their changes are always dirty
+       */
+      bool isDirty() const { return mDirty || !mTracksChanges; }
+
+      /**
+       * Check if component calls setDirty on each state change
+       */
+      bool tracksChanges() const { return mTracksChanges; }
+
+      /**
+       * Check if the component reads resolved properties directly into the bindings
+       */
+      bool readsResolvedProperties() const { return mReadsResolvedProperties; }
     protected:
+      /**
+       * Enable change tracking. Component should call setDirty on each state change then,
+       * otherwise saves will miss the change.
+       * Should be called in the constructor, before the component is added to the entity
+       */
+      void setTracksChanges(bool value) { mTracksChanges = value; }
+
+      /**
+       * Read resolved properties without calling read of the DataProxy.
+       * Should be enabled only by components, that do not override read of the DataProxy
+       */
+      void setReadsResolvedProperties(bool value) { mReadsResolvedProperties = value; }
+
       Entity* mOwner;
+    private:
+      bool mDirty;
+      bool mTracksChanges;
+      bool mReadsResolvedProperties;
   };
 }
 
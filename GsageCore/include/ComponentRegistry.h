@@ -0,0 +1,162 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _ComponentRegistry_H_
+#define _ComponentRegistry_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GsageDefinitions.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define MAX_COMPONENT_TYPES 64
+
+namespace Gsage
+{
+  /**
+   * Integer id of the component type
+   */
+  typedef uint32_t ComponentId;
+
+  /**
+   * Set of component types, one bit per component id
+   */
+  typedef uint64_t ComponentMask;
+
+  /**
+   * Assigns integer ids to the component types.
+   *
+   * Component type is identified by the name of the system it belongs to.
+   * Ids are assigned on the first registration and never change, there can be up to MAX_COMPONENT_TYPES types.
+   * Only registration of a new type takes a lock, lookups of the registered types are lock-free
+   */
+  class GSAGE_API ComponentRegistry
+  {
+    public:
+      enum : ComponentId {
+        INVALID_ID = 0xFFFFFFFF
+      };
+
+      /**
+       * Get component type id, registers the type if it's new
+       *
+       * @param name Name of the system component belongs to
+       * @returns INVALID_ID if there are too many component types
+       */
+      static ComponentId getId(const std::string& name);
+
+      /**
+       * Get component type id, cached per component class
+       */
+      template<class C>
+      static ComponentId getId()
+      {
+        static const ComponentId id = getId(C::SYSTEM);
+        return id;
+      }
+
+      /**
+       * Find id of the registered component type, does not register new types
+       *
+       * @param name Name of the system component belongs to
+       * @returns INVALID_ID if not registered
+       */
+      static ComponentId find(const std::string& name);
+
+      /**
+       * Get component type name by id
+       *
+       * @param id Component type id
+       */
+      static const std::string& getName(ComponentId id);
+
+      /**
+       * Get mask bit of the component type
+       *
+       * @param id Component type id
+       */
+      static ComponentMask getBit(ComponentId id)
+      {
+        return id < MAX_COMPONENT_TYPES ? ((ComponentMask)1 << id) : 0;
+      }
+
+      /**
+       * Build mask for the list of component types
+       *
+       * @param names Names of the systems
+       * @param registered Set to false if any of the types is not registered
+       */
+      static ComponentMask getMask(const std::vector<std::string>& names, bool* registered = 0);
+
+      /**
+       * Get mask for component classes
+       */
+      template<class... C>
+      static ComponentMask getMask()
+      {
+        ComponentMask res = 0;
+        ComponentId ids[] = {getId<C>()...};
+        for(ComponentId id : ids)
+        {
+          res |= getBit(id);
+        }
+        return res;
+      }
+
+      /**
+       * Count set bits in the mask
+       */
+      static inline uint32_t count(ComponentMask mask)
+      {
+#if defined(_MSC_VER)
+        return (uint32_t)__popcnt64(mask);
+#else
+        return (uint32_t)__builtin_popcountll(mask);
+#endif
+      }
+
+      /**
+       * Get the lowest component id in the mask, mask should not be empty
+       */
+      static inline ComponentId lowest(ComponentMask mask)
+      {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return (ComponentId)index;
+#else
+        return (ComponentId)__builtin_ctzll(mask);
+#endif
+      }
+  };
+}
+
+#endif
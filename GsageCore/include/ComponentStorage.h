@@ -29,6 +29,10 @@ THE SOFTWARE.
 
 #include "EngineSystem.h"
 #include "ObjectPool.h"
+#include "ScratchAllocator.h"
+#include "ThreadPool.h"
+
+#define DEFAULT_GRAIN_SIZE 256
 
 namespace Gsage
 {
@@ -39,7 +43,13 @@ namespace Gsage
       public:
         typedef T type;
 
-        ComponentStorage(const unsigned int& poolSize = COMPONENT_POOL_SIZE) : mComponents(poolSize) { };
+        ComponentStorage(const unsigned int& poolSize = COMPONENT_POOL_SIZE)
+          : mComponents(poolSize)
+          , mParallelUpdate(false)
+          , mGrainSize(DEFAULT_GRAIN_SIZE)
+          , mScratch(1)
+        {
+        };
 
         virtual ~ComponentStorage() {};
 
@@ -60,8 +70,7 @@ namespace Gsage
          */
         EntityComponent* createComponent(const DataProxy& data, Entity* owner)
         {
-          T* c = allocateComponent();
-          c->setOwner(owner);
+          T* c = allocateComponent(owner);
           if(!prepareComponent(c) || !c->read(data) || !fillComponentData(c, data))
           {
             removeComponent(c);
@@ -71,6 +80,35 @@ namespace Gsage
           return c;
         }
 
+        /**
+         * Create component in the storage, using resolved properties
+         * @param data DataProxy to get values from
+         * @param owner Entity, that owns the instance
+         * @param properties Properties resolved from the data, resolved on the first call
+         */
+        EntityComponent* createComponent(const DataProxy& data, Entity* owner, ResolvedProperties& properties)
+        {
+          T* c = allocateComponent(owner);
+          if(!prepareComponent(c))
+          {
+            removeComponent(c);
+            return NULL;
+          }
+
+          if(c->readsResolvedProperties() && properties.table != c->getPropertyTable())
+            c->resolve(data, properties);
+
+          // derived component can hide the overload by its own read
+          EntityComponent* component = c;
+          if(!component->read(properties, data) || !fillComponentData(c, data))
+          {
+            removeComponent(c);
+            return NULL; // failed to read data from node
+          }
+
+          return c;
+        }
+
         /**
          * Fill component data from data node
          * @param component Component to fill
@@ -116,23 +154,96 @@ namespace Gsage
          */
         virtual void update(const double& time)
         {
-          typename ObjectPool<T>::PointerVector components = mComponents.getElements();
-          const int len = components.size();
+          // component list can be changed during the update, so work on the snapshot
+          // snapshot buffer is reused between frames to avoid allocating it each update
+          const typename ObjectPool<T>::PointerVector& components = mComponents.getElements();
+          mUpdateQueue.assign(components.begin(), components.end());
+          const size_t len = mUpdateQueue.size();
           if(len == 0)
             return;
 
           if(mConfigDirty)
             configUpdated();
 
-          for(int i = 0; i < len; ++i)
+          ThreadPool* pool = mParallelUpdate && len > mGrainSize ? getThreadPool() : 0;
+          if(pool)
+          {
+            if(mScratch.size() < pool->getMaxParticipants())
+              mScratch.resize(pool->getMaxParticipants());
+
+            pool->parallelFor(len, mGrainSize, [this, &time] (size_t begin, size_t end, size_t participant) {
+              ScratchAllocator& scratch = mScratch[participant];
+              scratch.reset();
+              updateChunk(mUpdateQueue.data() + begin, end - begin, time, scratch);
+            });
+            return;
+          }
+
+          mScratch[0].reset();
+          updateChunk(mUpdateQueue.data(), len, time, mScratch[0]);
+        }
+
+        /**
+         * Update a chunk of components.
+         * Override it if components update needs temporary memory, scratch allocator is reset before each chunk
+         *
+         * @param components Pointer to the first component in the chunk
+         * @param count Component count
+         * @param time Elapsed time
+         * @param scratch Chunk scratch allocator
+         */
+        virtual void updateChunk(T** components, size_t count, const double& time, ScratchAllocator& scratch)
+        {
+          for(size_t i = 0; i < count; ++i)
           {
             updateComponent(components[i], components[i]->getOwner(), time);
           }
         }
+
         /**
          * Update a single component
          */
         virtual void updateComponent(T* component, Entity* entity, const double& time) = 0;
+
+        /**
+         * Configure the system, reads "grainSize" of the parallel update
+         * @param config DataProxy system configuration.
+         */
+        virtual bool configure(const DataProxy& config)
+        {
+          if(!EngineSystem::configure(config))
+            return false;
+
+          int grainSize = mConfig.get("grainSize", (int)mGrainSize);
+          if(grainSize > 0)
+            mGrainSize = grainSize;
+          return true;
+        }
+
+        /**
+         * Enable parallel update of components.
+         * Components are split into chunks, which are updated on the engine job pool.
+         * Enable it only if updateComponent is thread safe: it may modify only the updated component,
+         * and must not create or remove components
+         *
+         * @param value Enable parallel update
+         * @param grainSize Max count of components in a single chunk
+         */
+        void setParallelUpdate(bool value, size_t grainSize = DEFAULT_GRAIN_SIZE)
+        {
+          mParallelUpdate = value;
+          mGrainSize = grainSize > 0 ? grainSize : 1;
+        }
+
+        /**
+         * Check if parallel update is enabled
+         */
+        bool isParallelUpdate() const { return mParallelUpdate; }
+
+        /**
+         * Get max count of components in a single parallel update chunk
+         */
+        size_t getGrainSize() const { return mGrainSize; }
         /**
          * Get component count
          */
@@ -141,10 +252,21 @@ namespace Gsage
         typedef ObjectPool<T> Components;
         Components mComponents;
 
-        T* allocateComponent()
+        /**
+         * Allocate component in the pool
+         * @param owner Entity, that owns the instance
+         */
+        virtual T* allocateComponent(Entity* owner)
         {
-          return mComponents.create();
+          T* c = mComponents.create();
+          c->setOwner(owner);
+          return c;
         }
+        bool mParallelUpdate;
+        size_t mGrainSize;
+      private:
+        typename ObjectPool<T>::PointerVector mUpdateQueue;
+        std::vector<ScratchAllocator> mScratch;
     };
 }
 
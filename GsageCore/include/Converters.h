@@ -27,7 +27,9 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 
+#include <cstddef>
 #include <string>
+#include <type_traits>
 
 #define TYPE_CASTER(name, t, f) \
 struct name {\
@@ -75,6 +77,51 @@ namespace Gsage {
     typedef NoopCaster<F, T> type;
   };
 
+  /**
+   * Fixed size array of numbers.
+   *
+   * Types, that have caster to the NumericArray, are stored as arrays of numbers
+   * instead of formatted strings: vectors, quaternions, colours.
+   */
+  struct NumericArray
+  {
+    enum { MAX_SIZE = 16 };
+
+    NumericArray() : size(0) {}
+
+    /**
+     * Append value to the array
+     *
+     * @param value number to append
+     * @returns false if array is full
+     */
+    bool push(double value)
+    {
+      if(size >= MAX_SIZE) {
+        return false;
+      }
+      values[size++] = value;
+      return true;
+    }
+
+    double operator[](size_t index) const
+    {
+      return values[index];
+    }
+
+    double values[MAX_SIZE];
+    size_t size;
+  };
+
+  /**
+   * Check if type has a caster to the NumericArray
+   */
+  template<typename T>
+  struct HasNumericCaster
+  {
+    static const bool value = !std::is_same<typename TranslatorBetween<NumericArray, T>::type, NoopCaster<NumericArray, T> >::value;
+  };
+
   TYPE_CASTER(DoubleCaster, double, std::string)
   TYPE_CASTER(IntCaster, int, std::string)
   TYPE_CASTER(UIntCaster, unsigned int, std::string)
@@ -39,6 +39,7 @@ THE SOFTWARE.
 #include "serialization/DataWrapper.h"
 #include "serialization/SolTableWrapper.h"
 #include "serialization/JsonValueWrapper.h"
+#include "serialization/MsgpackWrapper.h"
 
 namespace Gsage
 {
@@ -118,6 +119,15 @@ namespace Gsage {
     typedef JsonValueWrapper type;
   };
 
+  /**
+   * Specialization for converting type id to MsgpackWrapper type.
+   */
+  template<>
+  struct TypeToWrapper<DataWrapper::MSGPACK_OBJECT>
+  {
+    typedef MsgpackWrapper type;
+  };
+
   /**
    * Specialization for converting wrapped type to SolTableWrapper type.
    */
@@ -157,6 +167,62 @@ namespace Gsage {
        */
       typedef std::shared_ptr<DataWrapper> DataWrapperPtr;
 
+      /**
+       * Compiled dotted key.
+       *
+       * The key is split into parts only once, then interned: all paths
+       * created from the same key share the same parts storage, so copying
+       * a path is as cheap as copying a pointer.
+       *
+       * Use it for keys that are known in advance and accessed often,
+       * interned paths are never released.
+       *
+       * @code{.cpp}
+       * static const DataProxy::Path position("root.position");
+       * auto value = dp.get<std::string>(position);
+       * @endcode
+       */
+      class Path
+      {
+        public:
+          explicit Path(const std::string& key);
+          explicit Path(const char* key);
+
+          /**
+           * Get original dotted key
+           */
+          const std::string& str() const;
+
+          /**
+           * Get all key parts except the last one
+           */
+          const std::vector<std::string>& getParents() const;
+
+          /**
+           * Get last key part
+           */
+          const std::string& getKey() const;
+
+          bool operator==(const Path& other) const
+          {
+            return mParts == other.mParts;
+          }
+
+          bool operator!=(const Path& other) const
+          {
+            return mParts != other.mParts;
+          }
+
+          struct Parts
+          {
+            std::string key;
+            std::vector<std::string> parents;
+            std::string last;
+          };
+        private:
+          const Parts* mParts;
+      };
+
       /**
        * Iterator base for const and non const iterator.
        */
@@ -390,6 +456,39 @@ namespace Gsage {
         return def;
       }
 
+      /**
+       * Get child at compiled path using type caster.
+       *
+       * @param path compiled child path
+       *
+       * @returns pair value, success
+       */
+      template<class T>
+      std::pair<T, bool> get(const Path& path) const
+      {
+        T res;
+        return std::make_pair(res, read(path, res));
+      }
+
+      /**
+       * Get child at compiled path using type caster, fallback to def, if failed.
+       *
+       * @param path compiled child path
+       * @param def fallback value
+       *
+       * @returns value or default
+       */
+      template<class T>
+      T get(const Path& path, const T& def) const
+      {
+        auto pair = get<T>(path);
+        if(pair.second)
+        {
+          return pair.first;
+        }
+        return def;
+      }
+
       /**
        * Put value to key.
        * Thread unsafe
@@ -401,6 +500,11 @@ namespace Gsage {
       template<typename T>
       void put(const std::string& key, const T& value)
       {
+        if(key.find('.') == std::string::npos) {
+          putImpl(mDataWrapper, key, value);
+          return;
+        }
+
         std::vector<std::string> parts = split(key, '.');
         std::string lastPart = parts[parts.size() - 1];
         parts.pop_back();
@@ -408,6 +512,20 @@ namespace Gsage {
         putImpl(wrapper, lastPart, value);
       }
 
+      /**
+       * Put value to compiled path.
+       * Thread unsafe
+       *
+       * @param path to put to
+       * @param value to put
+       */
+      template<typename T>
+      void put(const Path& path, const T& value)
+      {
+        const std::vector<std::string>& parents = path.getParents();
+        putImpl(parents.empty() ? mDataWrapper : traverseWrite(parents), path.getKey(), value);
+      }
+
       /**
        * Put to array index
        *
@@ -459,6 +577,9 @@ namespace Gsage {
           case DataWrapper::JSON_OBJECT:
             getWrapper<DataWrapper::JSON_OBJECT>()->set(value);
             break;
+          case DataWrapper::MSGPACK_OBJECT:
+            getWrapper<DataWrapper::MSGPACK_OBJECT>()->set(value);
+            break;
           default:
             LOG(WARNING) << "Can't set " << mDataWrapper->getType();
         }
@@ -474,6 +595,10 @@ namespace Gsage {
       template<typename T>
       bool read(const std::string& key, T& dest) const
       {
+        if(key.find('.') == std::string::npos) {
+          return readObjectKey(mDataWrapper, key, dest);
+        }
+
         std::vector<std::string> parts = split(key, '.');
         std::string lastPart = parts[parts.size()-1];
         parts.pop_back();
@@ -486,15 +611,21 @@ namespace Gsage {
           wrapper = mDataWrapper;
         }
 
-        if(wrapper->getStoredType() != DataWrapper::Object) {
-          return false;
-        }
-
-        if(!wrapper) {
-          return false;
-        }
+        return readObjectKey(wrapper, lastPart, dest);
+      }
 
-        return readImpl(wrapper, lastPart, dest);
+      /**
+       * Read value at compiled path to the reference
+       *
+       * @param path to read
+       * @param dest destination
+       * @returns true if succeed
+       */
+      template<typename T>
+      bool read(const Path& path, T& dest) const
+      {
+        const std::vector<std::string>& parents = path.getParents();
+        return readObjectKey(parents.empty() ? mDataWrapper : traverseSearch(parents), path.getKey(), dest);
       }
 
       /**
@@ -526,6 +657,8 @@ namespace Gsage {
             return getWrapper<DataWrapper::LUA_TABLE>()->read(dest);
           case DataWrapper::JSON_OBJECT:
             return getWrapper<DataWrapper::JSON_OBJECT>()->read(dest);
+          case DataWrapper::MSGPACK_OBJECT:
+            return getWrapper<DataWrapper::MSGPACK_OBJECT>()->read(dest);
           default:
             LOG(WARNING) << "Can't read type: " << mDataWrapper->getType();
         }
@@ -602,6 +735,9 @@ namespace Gsage {
           case DataWrapper::JSON_OBJECT:
             getWrapper<DataWrapper::JSON_OBJECT>(wrapper)->put(key, value);
             break;
+          case DataWrapper::MSGPACK_OBJECT:
+            getWrapper<DataWrapper::MSGPACK_OBJECT>(wrapper)->put(key, value);
+            break;
           default:
             LOG(WARNING) << "Can't put " << key << " to the wrapper of type: " << mDataWrapper->getType();
         }
@@ -615,6 +751,8 @@ namespace Gsage {
             return getWrapper<DataWrapper::LUA_TABLE>(wrapper)->read(key, dest);
           case DataWrapper::JSON_OBJECT:
             return getWrapper<DataWrapper::JSON_OBJECT>(wrapper)->read(key, dest);
+          case DataWrapper::MSGPACK_OBJECT:
+            return getWrapper<DataWrapper::MSGPACK_OBJECT>(wrapper)->read(key, dest);
           default:
             LOG(WARNING) << "Can't read " << key << " of the wrapper of type: " << mDataWrapper->getType();
         }
@@ -686,6 +824,16 @@ namespace Gsage {
        */
       bool fromString(const std::string& s);
 
+      /**
+       * Fill wrapped object by parsing raw buffer.
+       * Not all types are supported.
+       *
+       * @param data buffer to parse
+       * @param size buffer size
+       * @returns true if success
+       */
+      bool fromBuffer(const char* data, size_t size);
+
       template<class K>
       DataProxy getOrCreateChild(const K& key)
       {
@@ -703,8 +851,25 @@ namespace Gsage {
        * @copydoc Dictionary::get(key, value)
        */
       std::string get(const std::string& key, const char* def) const;
+
+      /**
+       * Special handling for const char* get.
+       *
+       * @copydoc Dictionary::get(path, value)
+       */
+      std::string get(const Path& path, const char* def) const;
     protected:
 
+      template<typename T>
+      bool readObjectKey(DataWrapperPtr wrapper, const std::string& key, T& dest) const
+      {
+        if(!wrapper || wrapper->getStoredType() != DataWrapper::Object) {
+          return false;
+        }
+
+        return readImpl(wrapper, key, dest);
+      }
+
       template<class K>
       void mergeChild(const K& key, const DataProxy& value)
       {
@@ -763,6 +928,16 @@ namespace Gsage {
    */
   bool loads(DataProxy& dest, const std::string& value, DataWrapper::WrappedType type);
 
+  /**
+   * Parse raw buffer into DataProxy of the specified type
+   *
+   * @param dest DataProxy to load into
+   * @param data buffer to parse
+   * @param size buffer size
+   * @param type wrapped type to create
+   */
+  bool loads(DataProxy& dest, const char* data, size_t size, DataWrapper::WrappedType type);
+
   /**
    * Get DataProxy which is union of two proxies
    *
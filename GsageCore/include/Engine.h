@@ -31,12 +31,18 @@ THE SOFTWARE.
 #define KEY_FLAGS "flags"
 
 #include "EventDispatcher.h"
+#include "EventQueue.h"
+#include "EventInbox.h"
+#include "EntityView.h"
 #include "GsageDefinitions.h"
 #include "Entity.h"
 #include "EngineSystem.h"
+#include "SystemScheduler.h"
 
 #include "ObjectPool.h"
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include "DataProxy.h"
 
@@ -53,6 +59,33 @@ namespace Gsage
     public:
       typedef std::map<std::string, EngineSystem*> EngineSystems;
       typedef ObjectPool<Entity> Entities;
+
+      /**
+       * Entity data with component type ids and property slots, resolved by the first createEntity call.
+       * Next entities created from the template skip the name lookups.
+       * Data is shared by all entities created from the template, so it should not be modified
+       */
+      struct EntityTemplate
+      {
+        struct Component
+        {
+          ComponentId id;
+          std::string type;
+          DataProxy data;
+          ResolvedProperties properties;
+        };
+
+        EntityTemplate(const DataProxy& data)
+          : data(data)
+          , resolved(false)
+        {
+        }
+
+        DataProxy data;
+        std::vector<Component> components;
+        bool resolved;
+      };
+
       Engine(const unsigned int& poolSize = ENTITY_POOL_SIZE);
       virtual ~Engine();
       /**
@@ -69,10 +102,31 @@ namespace Gsage
        */
       bool configureSystems(const DataProxy& config);
       /**
-       * Updates each system
+       * Updates each system.
+       * Systems are updated serially, or concurrently if parallel scheduling is enabled
        * @param time Delta time
        */
       void update(const double& time);
+      /**
+       * Get systems scheduler
+       */
+      SystemScheduler& getScheduler() { return mScheduler; }
+      /**
+       * Get inbox for the events posted from the background threads
+       */
+      EventInbox& getEventInbox() { return mEventInbox; }
+      /**
+       * Post event from any thread, it will be fired by the engine on the main thread.
+       * Never locks, fails if the inbox is full
+       *
+       * @param event Event to copy
+       * @returns true if posted
+       */
+      template<class E>
+      bool postEvent(const E& event)
+      {
+        return mEventInbox.post(this, event);
+      }
       /**
        * Add system to the engine
        * @param configure system after adding
@@ -154,12 +208,23 @@ namespace Gsage
        * @param data Deserialized data object
        */
       Entity* createEntity(DataProxy& data);
+      /**
+       * Create entity from the template, resolving it on the first call
+       * @param entityTemplate Entity template
+       */
+      Entity* createEntity(EntityTemplate& entityTemplate);
       /**
        * Remove entity by id
        *
        * @param id entity id
        */
       bool removeEntity(const std::string& id);
+      /**
+       * Remove entity by compact id
+       *
+       * @param handle entity handle
+       */
+      bool removeEntity(Entity::Handle handle);
       /**
        * Remove entity by pointer
        *
@@ -191,7 +256,7 @@ namespace Gsage
        * @param entity Entity with all components
        * @param name Component name
        */
-      template<typename C> C* getComponent(Entity& entity) { return static_cast<C*>(entity[C::SYSTEM]); }
+      template<typename C> C* getComponent(Entity& entity) { return entity.getComponent<C>(); }
       /**
        * Get component by entity
        * @param entity Entity with all components
@@ -209,7 +274,7 @@ namespace Gsage
         if(!e)
           return 0;
 
-        return static_cast<C*>((*e)[C::SYSTEM]);
+        return e->getComponent<C>();
       }
       /**
        * Get component by entity
@@ -229,6 +294,40 @@ namespace Gsage
        * @param id Entity id
        */
       Entity* getEntity(const std::string& id);
+      /**
+       * Get entity by compact id, O(1)
+       * @param handle Entity handle
+       * @returns 0 if the entity was removed
+       */
+      Entity* getEntity(Entity::Handle handle);
+      /**
+       * Get view of entities, that have all specified components.
+       * View is cached and kept up to date, when entities are created, updated or removed
+       */
+      template<class... C>
+      EntityView& view()
+      {
+        return view(ComponentRegistry::getMask<C...>());
+      }
+      /**
+       * Get view of entities, that have all components from the mask
+       * @param mask Components mask
+       */
+      EntityView& view(ComponentMask mask);
+      /**
+       * Get view of entities, that have all specified components
+       * @param components Names of the systems
+       */
+      EntityView& view(const std::vector<std::string>& components);
+      /**
+       * Call function for each entity, that has all specified components
+       * @param func Function that accepts Entity* and pointers to the components
+       */
+      template<class... C, class F>
+      void each(F func)
+      {
+        view<C...>().template each<C...>(func);
+      }
 
       /**
        * Get environment
@@ -248,6 +347,27 @@ namespace Gsage
        * @param node DataProxy with configs
        */
       bool createComponent(Entity* entity, const std::string& type, const DataProxy& node);
+      /**
+       * Create component for entity from the resolved template component
+       *
+       * @param entity Pointer to entity object
+       * @param component Template component
+       */
+      bool createComponent(Entity* entity, EntityTemplate::Component& component);
+      /**
+       * Allocate entity in the pool and read its id, class and props
+       *
+       * @param id Entity id
+       * @param data Entity data
+       */
+      Entity* allocateEntity(const std::string& id, const DataProxy& data);
+      /**
+       * Read entity flags
+       *
+       * @param entity Entity to update
+       * @param node DataProxy with new config
+       */
+      void readEntityFlags(Entity* entity, const DataProxy& node);
       /**
        * Update entity with new config
        *
@@ -255,15 +375,28 @@ namespace Gsage
        * @param node DataProxy with new config
        */
       bool readEntityData(Entity* entity, const DataProxy& node);
+      /**
+       * Update entity membership in all views
+       *
+       * @param entity Entity to update
+       */
+      void updateViews(Entity* entity);
 
       bool mInitialized;
 
       EngineSystems mEngineSystems;
+      SystemScheduler mScheduler;
+      EventQueue mEventQueue;
+      EventInbox mEventInbox;
       Entities mEntities;
       unsigned long mEntityCounter;
-      typedef std::map<const std::string, Entity*> EntityMap;
+      // index of the human readable entity ids
+      typedef std::unordered_map<std::string, Entity*> EntityMap;
       EntityMap mEntityMap;
 
+      typedef std::unordered_map<ComponentMask, std::unique_ptr<EntityView> > Views;
+      Views mViews;
+
       typedef std::vector<std::string> SystemNames;
       SystemNames mSetUpOrder;
       SystemNames mManagedByEngine;
@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include "EventDispatcher.h"
 #include "DataProxy.h"
+#include "Entity.h"
 
 namespace Gsage {
   class EngineSystem;
@@ -42,14 +43,18 @@ namespace Gsage {
        * New lua state was created, can be used to reinitialize all bindings
        */
       static const Event::Type LUA_STATE_CHANGE;
+      static const Event::TypeId LUA_STATE_CHANGE_ID;
       /**
        * Engine issued stopping
        */
       static const Event::Type STOPPING;
+      static const Event::TypeId STOPPING_ID;
       /**
        * Engine was shut down
        */
       static const Event::Type SHUTDOWN;
+      static const Event::TypeId SHUTDOWN_ID;
+      EngineEvent(Event::TypeId type);
       EngineEvent(Event::ConstType type);
       virtual ~EngineEvent();
   };
@@ -64,17 +69,22 @@ namespace Gsage {
        * Entity added event
        */
       static const Event::Type CREATE;
+      static const Event::TypeId CREATE_ID;
 
       /**
        * Entity removed event
        */
       static const Event::Type REMOVE;
+      static const Event::TypeId REMOVE_ID;
 
-      EntityEvent(Event::ConstType type, const std::string& entityId);
+      EntityEvent(Event::TypeId type, const std::string& entityId, Entity::Handle entityHandle = Entity::INVALID_HANDLE);
+      EntityEvent(Event::ConstType type, const std::string& entityId, Entity::Handle entityHandle = Entity::INVALID_HANDLE);
 
       virtual ~EntityEvent();
 
       std::string mEntityId;
+
+      Entity::Handle mEntityHandle;
   };
 
   /**
@@ -87,7 +97,9 @@ namespace Gsage {
        * Settings updated
        */
       static const Event::Type UPDATE;
+      static const Event::TypeId UPDATE_ID;
 
+      SettingsEvent(Event::TypeId type, const DataProxy& settings);
       SettingsEvent(Event::ConstType type, const DataProxy& settings);
       virtual ~SettingsEvent();
       DataProxy settings;
@@ -103,11 +115,14 @@ namespace Gsage {
        * System was added
        */
       static const Event::Type SYSTEM_ADDED;
+      static const Event::TypeId SYSTEM_ADDED_ID;
       /**
        * System was removed
        */
       static const Event::Type SYSTEM_REMOVED;
+      static const Event::TypeId SYSTEM_REMOVED_ID;
 
+      SystemChangeEvent(Event::TypeId type, const std::string& systemId, EngineSystem* system = 0);
       SystemChangeEvent(Event::ConstType type, const std::string& systemId, EngineSystem* system = 0);
       virtual ~SystemChangeEvent();
 
@@ -122,15 +137,19 @@ namespace Gsage {
        * Window was created
        */
       static const Event::Type CREATE;
+      static const Event::TypeId CREATE_ID;
       /**
        * Window resized
        */
       static const Event::Type RESIZE;
+      static const Event::TypeId RESIZE_ID;
       /**
        * Window closed
        */
       static const Event::Type CLOSE;
+      static const Event::TypeId CLOSE_ID;
 
+      WindowEvent(Event::TypeId type, size_t handle, unsigned int width = 0, unsigned int height = 0);
       WindowEvent(Event::ConstType type, size_t handle, unsigned int width = 0, unsigned int height = 0);
       virtual ~WindowEvent();
 
@@ -149,14 +168,24 @@ namespace Gsage {
        * Object selected
        */
       static const Event::Type OBJECT_SELECTED;
+      static const Event::TypeId OBJECT_SELECTED_ID;
       /**
        * Object is rolled over
        */
       static const Event::Type ROLL_OVER;
+      static const Event::TypeId ROLL_OVER_ID;
       /**
        * Object is rolled out
        */
       static const Event::Type ROLL_OUT;
+      static const Event::TypeId ROLL_OUT_ID;
+      SelectEvent(Event::TypeId type, const unsigned int& flags, const std::string& entityId)
+        : mFlags(flags)
+        , mEntityId(entityId)
+        , Event(type)
+      {
+      }
+
       SelectEvent(Event::ConstType type, const unsigned int& flags, const std::string& entityId)
         : mFlags(flags)
         , mEntityId(entityId)
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #define _EngineSystem_H_
 
 #include <vector>
+#include <set>
 
 #include "Component.h"
 #include "GsageDefinitions.h"
@@ -39,6 +40,7 @@ namespace Gsage
   class Engine;
   class EntityComponent;
   class GsageFacade;
+  class ThreadPool;
 
   /**
    * Abstract system class.
@@ -77,6 +79,18 @@ namespace Gsage
        * @param data Component data description
        */
       virtual EntityComponent* createComponent(const DataProxy& data, Entity* owner) = 0;
+      /**
+       * Create component from the data object, using properties resolved by the previous creation.
+       * Systems that do not support resolved properties create the component from the data
+       *
+       * @param data Component data description
+       * @param owner Entity, that owns the instance
+       * @param properties Properties resolved from the data, they are resolved again if they do not match the component
+       */
+      virtual EntityComponent* createComponent(const DataProxy& data, Entity* owner, ResolvedProperties& properties)
+      {
+        return createComponent(data, owner);
+      }
       /**
        * Remove component from engine system
        * @param component Pointer to the component for removal
@@ -133,7 +147,65 @@ namespace Gsage
        * @param name system's name as it's registered in the Engine
        */
       void setName(const std::string& name);
+
+      typedef std::set<std::string> ComponentTypes;
+
+      /**
+       * Get component types, that are read by the system update
+       */
+      const ComponentTypes& getReads() const;
+
+      /**
+       * Get component types, that are modified by the system update
+       */
+      const ComponentTypes& getWrites() const;
+
+      /**
+       * System declared component access, so it can be updated concurrently with other systems.
+       * Systems without declarations are exclusive: they are updated on the main thread, one at a time
+       */
+      bool hasDeclaredAccess() const;
+
+      /**
+       * System update can access any component, so it can't overlap with any other system update
+       */
+      bool isExclusive() const;
+
+      /**
+       * System update must be called from the main thread
+       */
+      bool isMainThreadOnly() const;
     protected:
+      /**
+       * Declare component type, which is read by the system update
+       * @param componentType Component type (name of the system, that owns the component)
+       */
+      void declareRead(const std::string& componentType);
+
+      /**
+       * Declare component type, which is modified by the system update
+       * @param componentType Component type (name of the system, that owns the component)
+       */
+      void declareWrite(const std::string& componentType);
+
+      /**
+       * Force system update to run on the main thread, even if it has access declarations
+       * @param value
+       */
+      void setMainThreadOnly(bool value);
+
+      /**
+       * Mark system update as exclusive, even if it has access declarations.
+       * Use it for the systems, which run arbitrary code, like scripts
+       * @param value
+       */
+      void setExclusive(bool value);
+
+      /**
+       * Get job pool shared by the engine
+       * @returns 0 if the system is not added to the engine
+       */
+      ThreadPool* getThreadPool();
 
       /**
        * Update configuration
@@ -149,6 +221,11 @@ namespace Gsage
       bool mEnabled;
       DataProxy mSystemInfo;
       std::string mName;
+
+      ComponentTypes mReads;
+      ComponentTypes mWrites;
+      bool mMainThreadOnly;
+      bool mExclusive;
   };
 }
 
@@ -27,11 +27,13 @@ THE SOFTWARE.
 #ifndef _Entity_H_
 #define _Entity_H_
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 
 #include "Serializable.h"
+#include "ComponentRegistry.h"
 
 namespace Gsage
 {
@@ -41,27 +43,88 @@ namespace Gsage
   class Entity
   {
     public:
+      /**
+       * Compact entity id: slot index in the lower 32 bits and slot generation in the upper bits.
+       * Fits into 53 bits, so it is kept precisely by Lua numbers
+       */
+      typedef uint64_t Handle;
+
+      enum : Handle {
+        INVALID_HANDLE = 0
+      };
+
+      enum : uint32_t {
+        GENERATION_MASK = 0xFFFFF
+      };
+
+      /**
+       * Make entity handle
+       * @param index Slot index
+       * @param generation Slot generation
+       */
+      static Handle makeHandle(uint32_t index, uint32_t generation)
+      {
+        return ((Handle)((generation & GENERATION_MASK) + 1) << 32) | index;
+      }
+
+      /**
+       * Get slot index from the handle
+       */
+      static uint32_t getIndex(Handle handle) { return (uint32_t)(handle & 0xFFFFFFFF); }
+
+      /**
+       * Get masked slot generation from the handle
+       */
+      static uint32_t getGeneration(Handle handle) { return (uint32_t)(handle >> 32) - 1; }
+
       Entity();
       virtual ~Entity();
       /**
-       * Add component handle to the map of components
+       * Add component handle to the component slots
        *
        * @param name Name of the system component belongs to
        * @param c Component
+       * @returns false if component type can't be registered
+       */
+      bool addComponent(const std::string& name, EntityComponent* c);
+      /**
+       * Add component handle to the component slots
+       *
+       * @param id Component type id
+       * @param c Component
        */
-      void addComponent(const std::string& name, EntityComponent* c);
+      bool addComponent(ComponentId id, EntityComponent* c);
       /**
        * Remove component
        *
        * @param name Name of the system component belongs to
        */
       bool removeComponent(const std::string& name);
+      /**
+       * Remove component
+       *
+       * @param id Component type id
+       */
+      bool removeComponent(ComponentId id);
       /**
        * Get component handle by component name
        *
        * @param name Name of the system component belongs to
        */
       EntityComponent* getComponent(const std::string& name);
+      /**
+       * Get component handle by component type id
+       *
+       * @param id Component type id
+       */
+      EntityComponent* getComponent(ComponentId id)
+      {
+        ComponentMask bit = ComponentRegistry::getBit(id);
+        if((mComponentMask & bit) == 0)
+          return 0;
+
+        return mSlots[ComponentRegistry::count(mComponentMask & (bit - 1))];
+      }
       /**
        * Check that entity has all specified components
        *
@@ -69,12 +132,18 @@ namespace Gsage
        */
       bool hasComponents(std::vector<std::string> components)
       {
-        for(auto component : components)
-        {
-          if(!hasComponent(component))
-            return false;
-        }
-        return true;
+        bool registered;
+        ComponentMask mask = ComponentRegistry::getMask(components, &registered);
+        return registered && hasComponents(mask);
+      }
+      /**
+       * Check that entity has all specified components
+       *
+       * @param mask Component types mask
+       */
+      bool hasComponents(ComponentMask mask) const
+      {
+        return (mComponentMask & mask) == mask;
       }
       /**
        * Check that entity has specified component
@@ -83,27 +152,33 @@ namespace Gsage
        */
       bool hasComponent(const std::string& component) const
       {
-        return mComponents.count(component) != 0;
+        return (mComponentMask & ComponentRegistry::getBit(ComponentRegistry::find(component))) != 0;
       }
+      /**
+       * Get mask of all entity components
+       */
+      ComponentMask getComponentMask() const { return mComponentMask; }
       /**
        * Remove entity and all related components from the system
        *
        * @param name Name of the system component belongs to
        */
       EntityComponent* operator[](const std::string& name) { return getComponent(name); };
-
       /**
        * Get component of a specific type
        */
       template<class C>
       C* getComponent() {
-        return static_cast<C*>(getComponent(C::SYSTEM));
+        return static_cast<C*>(getComponent(ComponentRegistry::getId<C>()));
       }
-
       /**
        * Get entity id
        */
       const std::string& getId() { return mId; }
+      /**
+       * Get compact entity id
+       */
+      Handle getHandle() const { return mHandle; }
       /**
        * Adds flag to flag list
        *
@@ -130,7 +205,8 @@ namespace Gsage
       void setClass(const std::string& cls);
 
       /**
-       * Get entity properties
+       * Get entity properties.
+       * Returned reference can be modified, so entity is marked dirty
        */
       DataProxy& getProps();
 
@@ -146,18 +222,33 @@ namespace Gsage
        */
       std::vector<std::string> getComponentNames() const;
 
-      typedef std::map<const std::string, EntityComponent*> Components;
-      typedef Components::const_iterator ComponentsIterator;
+      /**
+       * Mark entity as changed since the last save.
+       * Components that track changes mark the owner entity on each change
+       *
+       * @param value false resets the flag, it is done by the save
+       */
+      void setDirty(bool value = true) { mDirty = value; }
 
-      // TODO: expose iterator only
-      Components mComponents;
+      /**
+       * Check if entity should be dumped by the next save.
+       * Entity with any component, that does not track its changes, is always dirty
+       */
+      bool isDirty() const { return mDirty || mUntrackedComponents != 0; }
     private:
       friend class Engine;
       std::string mId;
+      Handle mHandle;
+      ComponentMask mComponentMask;
+      // components sorted by component type id, one per each bit set in the mask
+      typedef std::vector<EntityComponent*> ComponentSlots;
+      ComponentSlots mSlots;
       typedef std::vector<std::string> Flags;
       Flags mFlags;
       std::string mClass;
       DataProxy mProps;
+      bool mDirty;
+      uint32_t mUntrackedComponents;
   };
 }
 
@@ -0,0 +1,130 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _EntityView_H_
+#define _EntityView_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "Entity.h"
+
+namespace Gsage
+{
+  /**
+   * Cached list of entities, that have all components from the mask.
+   *
+   * Views are created and updated by the Engine, when entities are created, updated or removed.
+   * Do not remove entities while iterating the view: iterate a copy instead
+   */
+  class GSAGE_API EntityView
+  {
+    public:
+      typedef std::vector<Entity*> Entities;
+      typedef Entities::const_iterator const_iterator;
+
+      EntityView(ComponentMask mask);
+      virtual ~EntityView();
+
+      /**
+       * Get mask of the required components
+       */
+      ComponentMask getMask() const { return mMask; }
+
+      /**
+       * Check if entity with components mask belongs to this view
+       *
+       * @param mask Entity components mask
+       */
+      bool matches(ComponentMask mask) const { return (mask & mMask) == mMask; }
+
+      /**
+       * Check if entity is in the view
+       *
+       * @param entity Entity pointer
+       */
+      bool contains(Entity* entity) const { return mIndex.count(entity) != 0; }
+
+      const_iterator begin() const { return mEntities.begin(); }
+      const_iterator end() const { return mEntities.end(); }
+
+      /**
+       * Get count of matched entities
+       */
+      size_t size() const { return mEntities.size(); }
+
+      /**
+       * Check if view is empty
+       */
+      bool empty() const { return mEntities.empty(); }
+
+      /**
+       * Get matched entities
+       */
+      const Entities& getEntities() const { return mEntities; }
+
+      /**
+       * Call function for each entity in the view
+       *
+       * @param func Function that accepts Entity* and pointers to the requested components
+       */
+      template<class... C, class F>
+      void each(F func) const
+      {
+        for(Entity* entity : mEntities)
+        {
+          func(entity, entity->getComponent<C>()...);
+        }
+      }
+
+      /**
+       * Add entity to the view if it matches, remove it if it does not match anymore
+       *
+       * @param entity Entity pointer
+       */
+      void update(Entity* entity);
+
+      /**
+       * Remove entity from the view
+       *
+       * @param entity Entity pointer
+       */
+      void remove(Entity* entity);
+
+      /**
+       * Remove all entities from the view
+       */
+      void clear();
+    private:
+      ComponentMask mMask;
+      Entities mEntities;
+
+      typedef std::unordered_map<Entity*, size_t> Index;
+      Index mIndex;
+  };
+}
+
+#endif
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #define _EventDispatcher_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <vector>
@@ -38,6 +39,7 @@ THE SOFTWARE.
 namespace Gsage {
   class EventDispatcher;
   class EventSignal;
+  class EventQueue;
   class Event;
 
   /**
@@ -68,6 +70,11 @@ namespace Gsage {
 
   /**
    * Lightweight version of boost::signal2
+   *
+   * Callbacks are kept in a single contiguous array sorted by priority,
+   * so calling the signal is a linear walk without any allocations.
+   * Connections added or removed while the signal is being called are applied
+   * after the call is finished.
    */
   class EventSignal
   {
@@ -92,32 +99,88 @@ namespace Gsage {
        *Disconnect one callback identified by priority and id
        */
       void disconnect(int priority, int id);
+
+      /**
+       * Check if signal has no connected callbacks
+       */
+      bool empty() const;
     private:
-      typedef std::map<int, EventCallback> CallbacksList;
+      struct Connection
+      {
+        Connection(int p, int i, EventCallback c) : priority(p), id(i), active(true), callback(c) {}
+
+        int priority;
+        int id;
+        bool active;
+        EventCallback callback;
+      };
+
+      typedef std::vector<Connection> Connections;
+
+      /**
+       * Insert connection keeping priority order, same priority callbacks are called in the order of connection
+       */
+      void insert(Connection&& connection);
 
-      typedef std::map<int, CallbacksList> Connections;
+      /**
+       * Apply connections changes, that were made during the signal call
+       */
+      void flush();
 
       Connections mConnections;
+      Connections mPending;
+
+      int mNextId;
+      int mCallDepth;
+      bool mDirty;
   };
 
   /**
    * Abstract event class
+   *
+   * Event type strings are interned: each distinct type gets a small integer id,
+   * which is used by the EventDispatcher to find the signal.
    */
   class GSAGE_API Event
   {
     public:
       typedef std::string Type;
       typedef const std::string& ConstType;
+      typedef uint32_t TypeId;
 
-      Event(ConstType type) : mType(type) {};
+      Event(ConstType type);
+      /**
+       * Create event by interned type id, does not lock
+       */
+      Event(TypeId id);
       virtual ~Event() {};
 
       /**
        * Get event type
        */
-      ConstType getType() const { return mType; };
+      ConstType getType() const { return *mType; };
+
+      /**
+       * Get interned event type id
+       */
+      TypeId getTypeId() const { return mTypeId; };
+
+      /**
+       * Get interned id of the event type, registers the type if it's new
+       *
+       * @param type Event type
+       */
+      static TypeId intern(ConstType type);
+
+      /**
+       * Get event type string by interned id
+       *
+       * @param id Interned event type id
+       */
+      static ConstType getTypeName(TypeId id);
     private:
-      Type mType;
+      const Type* mType;
+      TypeId mTypeId;
 
   };
 
@@ -125,7 +188,9 @@ namespace Gsage {
   {
     public:
       GSAGE_API static const Event::Type FORCE_UNSUBSCRIBE;
+      GSAGE_API static const Event::TypeId FORCE_UNSUBSCRIBE_ID;
 
+      DispatcherEvent(TypeId type) : Event(type) {}
       DispatcherEvent(ConstType type) : Event(type) {}
       virtual ~DispatcherEvent() {};
   };
@@ -137,9 +202,9 @@ namespace Gsage {
       EventDispatcher();
       virtual ~EventDispatcher();
       /**
-       * All event bindings
+       * All event bindings, indexed by interned event type id
        */
-      typedef std::map<Event::Type, EventSignal*> EventTypes;
+      typedef std::vector<EventSignal*> EventTypes;
 
       /**
        * Dispatch event to all subscribers of the type, defined in the event.
@@ -148,6 +213,39 @@ namespace Gsage {
        */
       void fireEvent(const Event& event);
 
+      /**
+       * Post event to the event queue, it will be dispatched on the next queue flush.
+       * Fires event immediately if the dispatcher has no queue.
+       * Defined in EventQueue.h
+       *
+       * @param event Abstract event, it is copied
+       * @param key Coalescing key: queued events of the same type and key are merged into one
+       */
+      template<class E>
+      void queueEvent(const E& event, uint64_t key = 0xFFFFFFFFFFFFFFFFULL);
+
+      /**
+       * Post event to the event queue, merging it with the already queued one
+       *
+       * @param event Abstract event, it is copied
+       * @param key Coalescing key
+       * @param merge Function (E& queued, const E& event) that merges event into the queued one
+       */
+      template<class E, class Merge>
+      void queueEvent(const E& event, uint64_t key, Merge merge);
+
+      /**
+       * Set event queue used by queueEvent
+       *
+       * @param queue EventQueue, 0 to fire events immediately
+       */
+      void setEventQueue(EventQueue* queue);
+
+      /**
+       * Get event queue used by queueEvent
+       */
+      EventQueue* getEventQueue() { return mEventQueue; }
+
       /**
        * Remove all listeners from this event dispatcher
        */
@@ -155,12 +253,19 @@ namespace Gsage {
     private:
       template<class C>
       friend class EventSubscriber;
+      friend class EventQueue;
       /**
        * Check if dispatcher has listeners for event type
        *
        * @param type Event type
        */
       bool hasListenersForType(Event::ConstType type);
+      /**
+       * Check if dispatcher has listeners for event type
+       *
+       * @param id Interned event type id
+       */
+      bool hasListenersForType(Event::TypeId id);
       /**
        * Adds event subscriber to the event. Should be called by event subscriber class
        *
@@ -170,6 +275,10 @@ namespace Gsage {
        */
       EventConnection addEventListener(Event::ConstType eventType, EventCallback callback, const int priority = 0);
       EventTypes mSignals;
+
+      EventQueue* mEventQueue;
+      // count of events queued for this dispatcher, guarded by the queue mutex
+      int mQueuedEvents;
   };
 }
 
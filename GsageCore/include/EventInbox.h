@@ -0,0 +1,150 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _EventInbox_H_
+#define _EventInbox_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "EventDispatcher.h"
+
+#define EVENT_INBOX_SIZE 1024
+#define EVENT_INBOX_MAX_EVENT_SIZE 128
+
+namespace Gsage {
+
+  /**
+   * Bounded lock free multi producer single consumer event queue.
+   *
+   * Any thread can post events, they are copied into preallocated cells, so the memory
+   * used by the inbox never grows. Posting fails if the inbox is full.
+   * Events are dispatched by the consumer thread, when it calls drain.
+   */
+  class GSAGE_API EventInbox
+  {
+    public:
+      /**
+       * @param capacity Count of cells, rounded up to the power of two
+       */
+      EventInbox(size_t capacity = EVENT_INBOX_SIZE);
+      virtual ~EventInbox();
+
+      /**
+       * Post event copy to the inbox. Can be called from any thread
+       *
+       * @param target Dispatcher that will fire the event, it should outlive the inbox
+       * @param event Event to copy
+       * @returns false if the inbox is full
+       */
+      template<class E>
+      bool post(EventDispatcher* target, const E& event)
+      {
+        static_assert(sizeof(E) <= EVENT_INBOX_MAX_EVENT_SIZE, "Event is too big for the EventInbox cell");
+        static_assert(alignof(E) <= alignof(Storage), "Event alignment is not supported by the EventInbox");
+
+        size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+        Cell* cell;
+        for(;;)
+        {
+          cell = &mCells[position & mMask];
+          size_t sequence = cell->sequence.load(std::memory_order_acquire);
+          intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+          if(diff == 0)
+          {
+            if(mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+              break;
+          }
+          else if(diff < 0)
+          {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+          }
+          else
+          {
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+          }
+        }
+
+        cell->target = target;
+        cell->event = new (&cell->storage) E(event);
+        cell->destroy = &destroyEvent<E>;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+      }
+
+      /**
+       * Dispatch events posted to the inbox. Should be called only by the consumer thread.
+       * Events posted during the drain can be left for the next call
+       *
+       * @returns number of dispatched events
+       */
+      size_t drain();
+
+      /**
+       * Get inbox capacity
+       */
+      size_t getCapacity() const { return mMask + 1; }
+
+      /**
+       * Get count of events dropped because the inbox was full
+       */
+      size_t getDroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+    private:
+      typedef void (*DestroyFunction)(Event*);
+      typedef std::aligned_storage<EVENT_INBOX_MAX_EVENT_SIZE, alignof(std::max_align_t)>::type Storage;
+
+      template<class E>
+      static void destroyEvent(Event* event)
+      {
+        static_cast<E*>(event)->~E();
+      }
+
+      struct Cell
+      {
+        std::atomic<size_t> sequence;
+        EventDispatcher* target;
+        Event* event;
+        DestroyFunction destroy;
+        Storage storage;
+      };
+
+      std::unique_ptr<Cell[]> mCells;
+      size_t mMask;
+      size_t mDequeuePosition;
+      std::atomic<size_t> mDropped;
+      bool mDraining;
+      // producers position is kept on a separate cache line from the consumer data
+      char mPadding[64];
+      std::atomic<size_t> mEnqueuePosition;
+  };
+}
+
+#endif
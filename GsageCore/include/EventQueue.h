@@ -0,0 +1,222 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _EventQueue_H_
+#define _EventQueue_H_
+
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include "EventDispatcher.h"
+#include "ScratchAllocator.h"
+
+namespace Gsage {
+
+  /**
+   * Default coalescing policy: the newer event replaces the queued one
+   */
+  template<class E>
+  struct ReplaceEvent
+  {
+    void operator()(E& queued, const E& event) const
+    {
+      queued = event;
+    }
+  };
+
+  /**
+   * Frame local queue of deferred events.
+   *
+   * Events are copied into the linear allocator and dispatched in the order they were posted
+   * when flush is called. Events posted with the same coalescing key for the same dispatcher
+   * and event type are merged into one, which is moved to the end of the queue.
+   *
+   * Posting is guarded by a mutex, so systems updated on the worker threads can post events too.
+   * Flush should be called from the main thread.
+   */
+  class GSAGE_API EventQueue
+  {
+    public:
+      typedef uint64_t Key;
+
+      enum : Key {
+        /**
+         * Events posted with this key are never coalesced
+         */
+        NO_COALESCE = 0xFFFFFFFFFFFFFFFFULL
+      };
+
+      EventQueue(size_t capacity = 64 * 1024);
+      virtual ~EventQueue();
+
+      /**
+       * Post event copy to the queue
+       *
+       * @param target Dispatcher that will fire the event
+       * @param event Event to copy
+       * @param key Coalescing key, unique per event type
+       * @param merge Function that merges new event into the queued one
+       */
+      template<class E, class Merge = ReplaceEvent<E> >
+      void post(EventDispatcher* target, const E& event, Key key = NO_COALESCE, Merge merge = Merge())
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Batch& batch = mBatches[mCurrent];
+        if(key != NO_COALESCE)
+        {
+          CoalesceKey id = {target, event.getTypeId(), key};
+          CoalesceIndex::iterator iter = batch.index.find(id);
+          if(iter != batch.index.end())
+          {
+            Entry& queued = batch.entries[iter->second];
+            if(queued.event && queued.destroy == &destroyEvent<E>)
+            {
+              E* merged = new (batch.arena.allocate(sizeof(E), alignof(E))) E(static_cast<const E&>(*queued.event));
+              merge(*merged, event);
+              queued.destroy(queued.event);
+              queued.event = 0;
+              target->mQueuedEvents--;
+              iter->second = batch.entries.size();
+              append(batch, target, merged, &destroyEvent<E>);
+              return;
+            }
+          }
+
+          batch.index[id] = batch.entries.size();
+        }
+
+        append(batch, target, new (batch.arena.allocate(sizeof(E), alignof(E))) E(event), &destroyEvent<E>);
+      }
+
+      /**
+       * Dispatch all queued events.
+       * Events posted by the handlers during the flush are dispatched on the next flush
+       *
+       * @returns number of dispatched events
+       */
+      size_t flush();
+
+      /**
+       * Drop all events queued for the dispatcher, it is called when dispatcher is destroyed
+       *
+       * @param target EventDispatcher
+       */
+      void cancel(EventDispatcher* target);
+
+      /**
+       * Drop all queued events
+       */
+      void clear();
+
+      /**
+       * Get count of events waiting for the flush
+       */
+      size_t size();
+    private:
+      typedef void (*DestroyFunction)(Event*);
+
+      template<class E>
+      static void destroyEvent(Event* event)
+      {
+        static_cast<E*>(event)->~E();
+      }
+
+      struct Entry
+      {
+        EventDispatcher* target;
+        Event* event;
+        DestroyFunction destroy;
+      };
+
+      struct CoalesceKey
+      {
+        EventDispatcher* target;
+        Event::TypeId type;
+        Key key;
+
+        bool operator==(const CoalesceKey& other) const
+        {
+          return target == other.target && type == other.type && key == other.key;
+        }
+      };
+
+      struct CoalesceKeyHash
+      {
+        size_t operator()(const CoalesceKey& k) const
+        {
+          size_t h = std::hash<EventDispatcher*>()(k.target);
+          h ^= std::hash<Key>()(k.key) + 0x9e3779b9 + (h << 6) + (h >> 2);
+          h ^= std::hash<Event::TypeId>()(k.type) + 0x9e3779b9 + (h << 6) + (h >> 2);
+          return h;
+        }
+      };
+
+      typedef std::unordered_map<CoalesceKey, size_t, CoalesceKeyHash> CoalesceIndex;
+
+      struct Batch
+      {
+        Batch(size_t capacity) : arena(capacity) {}
+
+        ScratchAllocator arena;
+        std::vector<Entry> entries;
+        CoalesceIndex index;
+      };
+
+      void append(Batch& batch, EventDispatcher* target, Event* event, DestroyFunction destroy);
+
+      void drop(Batch& batch);
+
+      void clear(Batch& batch);
+
+      std::mutex mMutex;
+      std::vector<Batch> mBatches;
+      int mCurrent;
+      Batch* mFlushingBatch;
+  };
+
+  template<class E>
+  void EventDispatcher::queueEvent(const E& event, uint64_t key)
+  {
+    queueEvent(event, key, ReplaceEvent<E>());
+  }
+
+  template<class E, class Merge>
+  void EventDispatcher::queueEvent(const E& event, uint64_t key, Merge merge)
+  {
+    if(!mEventQueue)
+    {
+      fireEvent(event);
+      return;
+    }
+
+    mEventQueue->post(this, event, key, merge);
+  }
+}
+
+#endif
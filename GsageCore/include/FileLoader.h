@@ -28,8 +28,11 @@ THE SOFTWARE.
 */
 
 #include "DataProxy.h"
+#include <memory>
 
 namespace Gsage {
+  class MappedFile;
+
   class FileLoader
   {
     public:
@@ -38,6 +41,33 @@ namespace Gsage {
         Json
       };
 
+      /**
+       * Parsed files cache statistics
+       */
+      struct CacheStats {
+        /**
+         * Loads served from the cache
+         */
+        size_t hits;
+        /**
+         * Loads that had to read and parse the file
+         */
+        size_t misses;
+        /**
+         * Count of cached files
+         */
+        size_t entries;
+        /**
+         * Total size of cached files in bytes
+         */
+        size_t size;
+      };
+
+      /**
+       * Default cache capacity: 32 MB of source files
+       */
+      static const size_t DEFAULT_CACHE_CAPACITY;
+
       FileLoader(Encoding format, const DataProxy& environment);
       virtual ~FileLoader();
 
@@ -88,16 +118,63 @@ namespace Gsage {
        *
        * @param path: path to file
        * @param value: value to dump
+       * @returns false if failed to write the file
        */
-      void dump(const std::string& path, const DataProxy& value) const;
+      bool dump(const std::string& path, const DataProxy& value) const;
+
+      /**
+       * Set max total size of the files kept in the parsed files cache.
+       * Least recently used files are evicted when the cache grows bigger.
+       * Zero capacity disables caching.
+       *
+       * @param bytes: capacity in bytes
+       */
+      void setCacheCapacity(size_t bytes);
+
+      /**
+       * Get parsed files cache capacity
+       */
+      size_t getCacheCapacity() const;
+
+      /**
+       * Drop all parsed files from the cache
+       */
+      void flushCache();
+
+      /**
+       * Drop single file from the cache
+       *
+       * @param path: path to file
+       */
+      void flushCache(const std::string& path);
+
+      /**
+       * Get parsed files cache hit/miss counters
+       */
+      CacheStats getCacheStats() const;
+
+      /**
+       * Get file modification time in nanoseconds.
+       * Precision depends on the platform and the file system: Windows only reports seconds
+       *
+       * @param path: path to file
+       * @param mtime: modification time
+       * @param size: optional pointer to write file size to
+       * @returns false if the file does not exist
+       */
+      static bool getModificationTime(const std::string& path, int64_t& mtime, size_t* size = 0);
 
     private:
-      std::pair<std::string, bool> loadFile(const std::string& path) const;
-      bool parse(const std::string& data, DataProxy& dest) const;
+      struct Cache;
+
+      bool parse(const MappedFile& file, DataProxy& dest) const;
+      bool loadCached(const std::string& path, DataProxy& dest) const;
 
       Encoding mFormat;
       DataProxy mEnvironment;
 
+      std::shared_ptr<Cache> mCache;
+
       static FileLoader* mInstance;
   };
 }
@@ -30,8 +30,11 @@ THE SOFTWARE.
 #include <istream>
 #include <ostream>
 #include <map>
+#include <memory>
 #include "GsageDefinitions.h"
 #include "DataProxy.h"
+#include "EventDispatcher.h"
+#include "UpdateListener.h"
 
 namespace Gsage
 {
@@ -39,10 +42,69 @@ namespace Gsage
   class Entity;
   class EngineSystem;
 
+  /**
+   * Area loading events, fired by the engine
+   */
+  class AreaLoadEvent : public Event
+  {
+    public:
+      /**
+       * Fired each frame while entities are created
+       */
+      static const Type PROGRESS;
+      static const Event::TypeId PROGRESS_ID;
+      /**
+       * Fired when all entities are created
+       */
+      static const Type COMPLETE;
+      static const Event::TypeId COMPLETE_ID;
+      /**
+       * Fired if area data can't be read
+       */
+      static const Type FAILED;
+      static const Event::TypeId FAILED_ID;
+
+      AreaLoadEvent(Event::TypeId type, const std::string& area, size_t loaded = 0, size_t total = 0);
+      AreaLoadEvent(ConstType type, const std::string& area, size_t loaded = 0, size_t total = 0);
+      virtual ~AreaLoadEvent();
+
+      /**
+       * Get loaded area name
+       */
+      const std::string& getArea() const { return mArea; }
+
+      /**
+       * Get count of created entities
+       */
+      size_t getLoaded() const { return mLoaded; }
+
+      /**
+       * Get total count of entities to create
+       */
+      size_t getTotal() const { return mTotal; }
+
+      /**
+       * Get load progress in range [0, 1]
+       */
+      float getProgress() const { return mTotal == 0 ? 1.0f : (float)mLoaded / mTotal; }
+    private:
+      std::string mArea;
+      size_t mLoaded;
+      size_t mTotal;
+  };
+
   /**
    * Class responsible for level loading
+   *
+   * Loading is done in two stages: files are read and parsed by the engine thread pool,
+   * then entities are created on the main thread in update, spending not more than frame budget per frame.
+   * Synchronous load methods run the same pipeline and block until it is finished.
+   *
+   * Saves are incremental: entities that did not change since the previous save are not written again.
+   * Changes are appended to the delta log next to the save file, which is compacted into the save file periodically.
+   * Files are written by the engine thread pool.
    */
-  class GameDataManager
+  class GameDataManager : public UpdateListener
   {
     public:
       GameDataManager(Engine* engine, const DataProxy& config);
@@ -57,9 +119,25 @@ namespace Gsage
        */
       bool loadSave(const std::string& saveFile);
       /**
-       * Dump engine state to save
+       * Dump engine state to save.
+       * Only changed entities are serialized, the file is written in the background
+       *
+       * @param saveFile Save file name
        */
       bool dumpSave(const std::string& saveFile);
+
+      /**
+       * Wait until all queued save writes are finished
+       */
+      void waitForSaves();
+
+      /**
+       * Save game periodically
+       *
+       * @param saveFile Save file name, empty name disables autosave
+       * @param interval Interval in seconds
+       */
+      void setAutosave(const std::string& saveFile, float interval);
       /**
        * Create entity from string
        *
@@ -108,21 +186,143 @@ namespace Gsage
        * Load area, without loading characters
        */
       bool loadArea(const std::string& area);
+
+      /**
+       * Start loading save in the background. Progress is reported by AreaLoadEvent
+       *
+       * @param saveFile Save file name
+       * @returns false if another load is in progress
+       */
+      bool loadSaveAsync(const std::string& saveFile);
+
+      /**
+       * Start loading area in the background, without loading characters.
+       * Progress is reported by AreaLoadEvent
+       *
+       * @param area Area name
+       * @returns false if another load is in progress
+       */
+      bool loadAreaAsync(const std::string& area);
+
+      /**
+       * Check if there is a load in progress
+       */
+      bool isLoading() const { return mLoadTask != 0; }
+
+      /**
+       * Drop current load. Already created entities are kept
+       */
+      void cancelLoad();
+
+      /**
+       * Create entities of the current load, run autosave
+       *
+       * @param time Frame time
+       */
+      void update(const float& time);
+
+      /**
+       * Set time limit for entity creation per frame
+       *
+       * @param value Time in milliseconds
+       */
+      void setFrameBudget(double value) { mFrameBudget = value; }
+
+      /**
+       * Get time limit for entity creation per frame in milliseconds
+       */
+      double getFrameBudget() const { return mFrameBudget; }
     private:
       static const std::string CONFIG_SECTION;
 
+      struct LoadTask;
+      typedef std::shared_ptr<LoadTask> LoadTaskPtr;
+      struct PrefabCache;
+
+      /**
+       * Create load task for the save, area or save template
+       */
+      LoadTaskPtr createLoadTask(int source, const std::string& name);
+
+      /**
+       * Submit load task reading to the thread pool
+       */
+      bool startLoad(LoadTaskPtr task);
+
+      /**
+       * Wait until current load task is read and create all entities
+       */
+      bool finishLoad();
+
+      /**
+       * Create entities of the current load task
+       *
+       * @param budget Time limit in milliseconds, negative value means no limit
+       * @returns false if load failed
+       */
+      bool processLoad(double budget);
+
+      /**
+       * Read and parse all files of the load task, called by the worker thread
+       */
+      static bool readLoadTask(LoadTask& task);
+
+      /**
+       * Read area entities and settings
+       */
+      static bool readArea(LoadTask& task);
+
+      struct SaveState;
+      struct SaveJob;
+
+      /**
+       * Serialize dynamic entity into the save record, reusing nodes of unchanged components
+       */
+      std::string dumpCharacter(Entity* entity, std::map<std::string, DataProxy>& components);
+
+      /**
+       * Queue save file write to the thread pool
+       */
+      void queueSave(SaveJob& job);
+
+      /**
+       * Log errors of the finished save writes
+       */
+      void logSaveErrors();
+
+      /**
+       * Write all queued save jobs, called by the worker thread
+       */
+      static void writeSaves(SaveState& state);
+
+      /**
+       * Rewrite save file or append delta records
+       */
+      static bool writeSave(const SaveJob& job, std::string& error);
+
       DataProxy* mCurrentSaveFile;
 
       Engine* mEngine;
 
+      LoadTaskPtr mLoadTask;
+      double mFrameBudget;
+      // area prefabs with the resolved entity templates
+      std::shared_ptr<PrefabCache> mPrefabs;
+
+      std::shared_ptr<SaveState> mSaveState;
+      // count of delta records after which the save file is rewritten
+      size_t mCompactionThreshold;
+
+      std::string mAutosaveFile;
+      float mAutosaveInterval;
+      float mAutosaveElapsed;
+
       // settings
       std::string mFileExtension;
       std::string mCharactersFolder;
       std::string mLevelsFolder;
       std::string mSavesFolder;
 
-      bool loadCharacters(const std::string& area);
-
       DataProxy& getSaveFile();
       void resetSaveFile();
 
@@ -71,16 +71,19 @@ namespace Gsage
        * Event id dispatched when level is loaded
        */
       static const Event::Type LOAD;
+      static const Event::TypeId LOAD_ID;
 
       /**
        * Event id dispatched when level is unloaded
        */
       static const Event::Type RESET;
+      static const Event::TypeId RESET_ID;
 
       /**
        * Event id dispatched before level unload
        */
       static const Event::Type BEFORE_RESET;
+      static const Event::TypeId BEFORE_RESET_ID;
 
       GsageFacade();
       virtual ~GsageFacade();
@@ -190,6 +193,20 @@ namespace Gsage
        * @param name Area file name
        */
       virtual bool loadArea(const std::string& name);
+      /**
+       * Starts loading game save in the background, entities are created over several frames.
+       * Progress is reported by AreaLoadEvent
+       *
+       * @param name Save file name
+       */
+      virtual bool loadSaveAsync(const std::string& name);
+      /**
+       * Starts loading game area in the background, entities are created over several frames.
+       * Progress is reported by AreaLoadEvent
+       *
+       * @param name Area file name
+       */
+      virtual bool loadAreaAsync(const std::string& name);
       /**
        * Gets engine instance
        */
@@ -303,6 +320,8 @@ namespace Gsage
     protected:
       bool onEngineShutdown(EventDispatcher* sender, const Event& event);
 
+      bool onAreaLoaded(EventDispatcher* sender, const Event& event);
+
       bool mStarted;
       bool mStartupScriptRun;
       std::string mStartupScript;
@@ -34,7 +34,9 @@ namespace Gsage {
   {
     public:
       static const Event::Type KEY_DOWN;
+      static const Event::TypeId KEY_DOWN_ID;
       static const Event::Type KEY_UP;
+      static const Event::TypeId KEY_UP_ID;
 
       enum Modifier {
         LShift = 0x0001,
@@ -207,6 +209,7 @@ namespace Gsage {
         KC_MEDIASELECT,
       };
 
+      KeyboardEvent(Event::TypeId type, const Key& key, const unsigned int text, const unsigned int modifierState);
       KeyboardEvent(const std::string& type, const Key& key, const unsigned int text, const unsigned int modifierState);
       virtual ~KeyboardEvent();
 
@@ -233,7 +236,9 @@ namespace Gsage {
   {
     public:
       static const Event::Type INPUT;
+      static const Event::TypeId INPUT_ID;
 
+      TextInputEvent(Event::TypeId type, const char* text);
       TextInputEvent(const std::string& type, const char* text);
       virtual ~TextInputEvent();
 
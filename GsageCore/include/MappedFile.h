@@ -0,0 +1,119 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _MappedFile_H_
+#define _MappedFile_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Gsage
+{
+  /**
+   * Read only view of the file contents.
+   *
+   * The file is mapped into memory when the platform allows it, otherwise it is read into an internal buffer
+   * with a single read call. Either way data() can be passed to parsers directly, without copying it into a string.
+   *
+   * The data is not null terminated and stays valid until the MappedFile is closed or destroyed.
+   */
+  class MappedFile
+  {
+    public:
+      MappedFile();
+      /**
+       * Open file
+       *
+       * @param path: path to file
+       */
+      MappedFile(const std::string& path);
+      virtual ~MappedFile();
+
+      MappedFile(MappedFile&& other);
+      MappedFile& operator=(MappedFile&& other);
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      /**
+       * Open file, closing the previous one
+       *
+       * @param path: path to file
+       * @returns true if the file was opened
+       */
+      bool open(const std::string& path);
+
+      /**
+       * Release the mapping or the buffer
+       */
+      void close();
+
+      /**
+       * Check if file was opened successfully
+       */
+      bool isOpen() const;
+
+      /**
+       * Check if file contents are memory mapped and not copied into the fallback buffer
+       */
+      bool isMapped() const;
+
+      /**
+       * Get file contents, never null for the opened file
+       */
+      const char* data() const;
+
+      /**
+       * Get file size
+       */
+      size_t size() const;
+
+      /**
+       * Get path of the opened file
+       */
+      const std::string& getPath() const;
+
+      /**
+       * Copy file contents into a string
+       */
+      std::string str() const;
+    private:
+      void swap(MappedFile& other);
+      bool map();
+      bool read();
+
+      std::string mPath;
+      const char* mData;
+      size_t mSize;
+      bool mOpen;
+
+      void* mMapping;
+      std::vector<char> mBuffer;
+  };
+}
+
+#endif
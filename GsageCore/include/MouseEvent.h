@@ -38,11 +38,19 @@ namespace Gsage
   {
     public:
       static const Event::Type MOUSE_DOWN;
+      static const Event::TypeId MOUSE_DOWN_ID;
       static const Event::Type MOUSE_UP;
+      static const Event::TypeId MOUSE_UP_ID;
       static const Event::Type MOUSE_MOVE;
+      static const Event::TypeId MOUSE_MOVE_ID;
 
       enum ButtonType { Left = 0, Right, Middle, Button3, Button4, Button5, Button6, Button7, None };
 
+      MouseEvent(Event::TypeId type,
+                 const float& width,
+                 const float& height,
+                 const ButtonType& button = None,
+                 const std::string& dispatcher = "main");
       MouseEvent(Event::ConstType type,
                  const float& width,
                  const float& height,
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <vector>
 #include <iostream>
 #include <stdexcept>
+#include <stdint.h>
 
 namespace Gsage {
   template<typename T>
@@ -46,14 +47,51 @@ namespace Gsage {
   };
 
   /**
-   * Class that allocates objects in continuous block of memory
+   * Generational handle of the object, allocated in the ObjectPool.
+   * Handle becomes stale when the object is erased, even if the slot is reused later
+   */
+  struct PoolHandle
+  {
+    enum : uint32_t { INVALID_INDEX = 0xFFFFFFFF };
+
+    PoolHandle() : index(INVALID_INDEX), generation(0) {}
+    PoolHandle(uint32_t i, uint32_t g) : index(i), generation(g) {}
+
+    /**
+     * Check that handle points to some slot
+     */
+    bool isValid() const { return index != INVALID_INDEX; }
+
+    bool operator==(const PoolHandle& other) const
+    {
+      return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=(const PoolHandle& other) const
+    {
+      return !(*this == other);
+    }
+
+    uint32_t index;
+    uint32_t generation;
+  };
+
+  /**
+   * Class that allocates objects in continuous blocks of memory.
+   *
+   * Objects never move after allocation, so raw pointers stay valid until erase.
+   * Live objects are also tracked in the dense pointer array (swap-and-pop on removal)
+   * and free slots are chained into the intrusive free list, so create, erase and handle
+   * lookup are O(1).
    */
   template<typename T, typename TMemoryAllocator=DefaultMemoryAllocator<T>>
   class ObjectPool
   {
     public:
+      typedef PoolHandle Handle;
+
       explicit ObjectPool(size_t initialCapacity=32, size_t maxBlockLength=1000000):
-        mFirstDeleted(NULL),
+        mFreeHead(Handle::INVALID_INDEX),
         mCountInNode(0),
         mNodeCapacity(initialCapacity),
         mFirstNode(initialCapacity),
@@ -100,22 +138,28 @@ namespace Gsage {
        */
       T *getAddress()
       {
-        T *result;
-        if (mFirstDeleted)
+        uint32_t index;
+        if (mFreeHead != Handle::INVALID_INDEX)
         {
-          result = (T *)mFirstDeleted;
-          mFirstDeleted = *((T **)mFirstDeleted);
+          index = mFreeHead;
+          mFreeHead = mSlots[index].nextFree;
         }else{
           if (mCountInNode >= mNodeCapacity)
             allocateNewNode();
           char *address = (char *)mNodeMemory;
           address += mCountInNode * itemSize;
           mCountInNode++;
-          result = (T *)address;
+
+          index = (uint32_t)mSlots.size();
+          *((uint32_t *)address) = index;
+          mSlots.push_back(Slot((T *)(address + headerSize)));
         }
 
-        mElements.push_back(result);
-        return result;
+        Slot& slot = mSlots[index];
+        slot.dense = (uint32_t)mElements.size();
+        slot.nextFree = Handle::INVALID_INDEX;
+        mElements.push_back(slot.object);
+        return slot.object;
       }
 
       /**
@@ -128,28 +172,100 @@ namespace Gsage {
         remove(content);
       }
 
+      /**
+       * Remove element by handle and call it's destructor
+       * @param handle Element handle
+       * @returns false if handle is stale
+       */
+      bool erase(const Handle& handle)
+      {
+        T* content = get(handle);
+        if(!content)
+          return false;
+
+        erase(content);
+        return true;
+      }
+
       /**
        * Remove element by pointer
        * @param content Element pointer
        */
       void remove(T *content)
       {
-        *((T **)content) = mFirstDeleted;
-        mFirstDeleted = content;
-        for(unsigned int i = 0; i < mElements.size(); i++)
+        uint32_t index = slotIndex(content);
+        Slot& slot = mSlots[index];
+        if(slot.dense == Handle::INVALID_INDEX)
+          return;
+
+        // swap-and-pop: move the last element into the freed dense position
+        uint32_t last = (uint32_t)mElements.size() - 1;
+        if(slot.dense != last)
         {
-          if(mElements[i] == content)
-          {
-            mElements.erase(mElements.begin() + i);
-            break;
-          }
+          T* moved = mElements[last];
+          mElements[slot.dense] = moved;
+          mSlots[slotIndex(moved)].dense = slot.dense;
         }
+        mElements.pop_back();
+
+        slot.dense = Handle::INVALID_INDEX;
+        slot.generation++;
+        slot.nextFree = mFreeHead;
+        mFreeHead = index;
+      }
+
+      /**
+       * Get handle of the element
+       * @param content Element pointer
+       */
+      Handle getHandle(const T *content) const
+      {
+        uint32_t index = slotIndex(content);
+        return Handle(index, mSlots[index].generation);
+      }
+
+      /**
+       * Get handle of the element stored in the slot
+       * @param index Slot index
+       * @returns invalid handle if the slot is empty
+       */
+      Handle getHandleAt(uint32_t index) const
+      {
+        if(index >= mSlots.size() || mSlots[index].dense == Handle::INVALID_INDEX)
+          return Handle();
+
+        return Handle(index, mSlots[index].generation);
+      }
+
+      /**
+       * Resolve element by handle
+       * @param handle Element handle
+       * @returns NULL if the handle is stale
+       */
+      T* get(const Handle& handle) const
+      {
+        if(!valid(handle))
+          return NULL;
+
+        return mSlots[handle.index].object;
+      }
+
+      /**
+       * Check that handle points to the living element
+       * @param handle Element handle
+       */
+      bool valid(const Handle& handle) const
+      {
+        return handle.index < mSlots.size() &&
+          mSlots[handle.index].generation == handle.generation &&
+          mSlots[handle.index].dense != Handle::INVALID_INDEX;
       }
 
       typedef std::vector<T*> PointerVector;
 
       /**
-       * Get list of all elements as a vector
+       * Get list of all elements as a vector.
+       * Order of elements is not preserved when elements are removed
        */
       PointerVector& getElements()
       {
@@ -157,12 +273,23 @@ namespace Gsage {
       }
 
       /**
-       * Resets data pointer. Clears pointer vector
+       * Resets data pointer. Clears pointer vector.
+       * All previously allocated slots are returned into the free list, handles become stale
        */
       void clear()
       {
-        mFirstDeleted = NULL;
-        mCountInNode = 0;
+        mFreeHead = Handle::INVALID_INDEX;
+        for(uint32_t i = (uint32_t)mSlots.size(); i > 0; --i)
+        {
+          Slot& slot = mSlots[i - 1];
+          if(slot.dense != Handle::INVALID_INDEX)
+          {
+            slot.dense = Handle::INVALID_INDEX;
+            slot.generation++;
+          }
+          slot.nextFree = mFreeHead;
+          mFreeHead = i - 1;
+        }
         mElements.clear();
       }
 
@@ -194,10 +321,25 @@ namespace Gsage {
         }
       };
 
+      struct Slot
+      {
+        Slot(T* o) : object(o), generation(0), dense(Handle::INVALID_INDEX), nextFree(Handle::INVALID_INDEX) {}
+
+        T* object;
+        uint32_t generation;
+        // position in mElements, INVALID_INDEX when the slot is free
+        uint32_t dense;
+        uint32_t nextFree;
+      };
 
       ObjectPool(const ObjectPool<T, TMemoryAllocator> &source);
       void operator = (const ObjectPool<T, TMemoryAllocator> &source);
 
+      uint32_t slotIndex(const T *content) const
+      {
+        return *((const uint32_t *)((const char *)content - headerSize));
+      }
+
       void allocateNewNode()
       {
         size_t size = mCountInNode;
@@ -223,20 +365,29 @@ namespace Gsage {
       }
 
       void *mNodeMemory;
-      T *mFirstDeleted;
+      uint32_t mFreeHead;
       size_t mCountInNode;
       size_t mNodeCapacity;
       Node mFirstNode;
       Node *mLastNode;
       size_t mMaxBlockLength;
       PointerVector mElements;
+      std::vector<Slot> mSlots;
 
+      static const size_t alignment;
+      static const size_t headerSize;
       static const size_t itemSize;
-
   };
 
   template<typename T, class TMemoryAllocator>
-  const size_t ObjectPool<T,TMemoryAllocator>::itemSize = ((sizeof(T) + sizeof(void *)-1) / sizeof(void *)) * sizeof(void *);
+  const size_t ObjectPool<T,TMemoryAllocator>::alignment = alignof(T) > sizeof(void *) ? alignof(T) : sizeof(void *);
+
+  // each item is prefixed with the slot index, so pointer -> slot resolution does not need any lookup
+  template<typename T, class TMemoryAllocator>
+  const size_t ObjectPool<T,TMemoryAllocator>::headerSize = ((sizeof(uint32_t) + alignment - 1) / alignment) * alignment;
+
+  template<typename T, class TMemoryAllocator>
+  const size_t ObjectPool<T,TMemoryAllocator>::itemSize = ((headerSize + sizeof(T) + alignment - 1) / alignment) * alignment;
 }
 
 #endif
@@ -0,0 +1,232 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _PackedComponentStorage_H_
+#define _PackedComponentStorage_H_
+
+#include "ComponentStorage.h"
+
+namespace Gsage
+{
+  /**
+   * Empty hot data, used when the system does not split component fields
+   */
+  struct NoHotData {};
+
+  /**
+   * Component storage that keeps everything needed by the update loop in packed arrays.
+   *
+   * Components themselves stay in the object pool, as entities and property bindings reference them,
+   * but the update walks parallel contiguous arrays: hot data, component pointers and owners.
+   * Frequently updated fields can be moved to THot, the rest of the component stays cold.
+   *
+   * Component to packed index map is keyed by the pool slot, so lookup is O(1) and stable.
+   * Removal is swap-and-pop, components removed during the update are marked dead and
+   * compacted after the loop, so the update never allocates.
+   *
+   * Systems opt in by inheriting this class instead of ComponentStorage.
+   */
+  template<typename T, typename THot = NoHotData>
+  class PackedComponentStorage : public ComponentStorage<T>
+  {
+    public:
+      typedef THot HotData;
+
+      PackedComponentStorage(const unsigned int& poolSize = COMPONENT_POOL_SIZE)
+        : ComponentStorage<T>(poolSize)
+        , mUpdating(false)
+        , mDeadCount(0)
+      {
+        mHotData.reserve(poolSize);
+        mPacked.reserve(poolSize);
+        mOwners.reserve(poolSize);
+      }
+
+      virtual ~PackedComponentStorage() {};
+
+      /**
+       * Removes component from the system
+       * @param component Component pointer
+       */
+      virtual bool removeComponent(T* component)
+      {
+        uint32_t slot = this->mComponents.getHandle(component).index;
+        if(slot < mSlotToIndex.size() && mSlotToIndex[slot] != PoolHandle::INVALID_INDEX)
+        {
+          uint32_t index = mSlotToIndex[slot];
+          mSlotToIndex[slot] = PoolHandle::INVALID_INDEX;
+          if(mUpdating)
+          {
+            mPacked[index] = NULL;
+            mDeadCount++;
+          }
+          else
+          {
+            release(index);
+          }
+        }
+        return ComponentStorage<T>::removeComponent(component);
+      }
+
+      /**
+       * Update each component, walking packed arrays
+       * @param time Elapsed time
+       */
+      virtual void update(const double& time)
+      {
+        // components, created during the update, will be updated on the next frame
+        const size_t len = mPacked.size();
+        if(len == 0)
+          return;
+
+        if(this->mConfigDirty)
+          this->configUpdated();
+
+        mUpdating = true;
+        ThreadPool* pool = this->mParallelUpdate && len > this->mGrainSize ? this->getThreadPool() : 0;
+        if(pool)
+        {
+          pool->parallelFor(len, this->mGrainSize, [this, &time] (size_t begin, size_t end, size_t participant) {
+            updateRange(begin, end, time);
+          });
+        }
+        else
+        {
+          updateRange(0, len, time);
+        }
+        mUpdating = false;
+
+        if(mDeadCount > 0)
+          compact();
+      }
+
+      /**
+       * Update a single component
+       */
+      virtual void updateComponent(T* component, Entity* entity, const double& time)
+      {
+        updateComponent(getHotData(component), component, entity, time);
+      }
+
+      /**
+       * Update a single component using packed hot data
+       * Hot data reference is valid only during the call
+       *
+       * @param data Hot data of the component
+       * @param component Component pointer
+       * @param entity Entity that owns the component
+       * @param time Elapsed time
+       */
+      virtual void updateComponent(THot& data, T* component, Entity* entity, const double& time) = 0;
+
+      /**
+       * Get hot data of the component
+       * @param component Component pointer, must belong to this storage
+       */
+      THot& getHotData(T* component)
+      {
+        return mHotData[mSlotToIndex[this->mComponents.getHandle(component).index]];
+      }
+    protected:
+      /**
+       * Allocate component in the pool and reserve packed entry for it
+       * @param owner Entity, that owns the instance
+       */
+      virtual T* allocateComponent(Entity* owner)
+      {
+        T* c = ComponentStorage<T>::allocateComponent(owner);
+        uint32_t slot = this->mComponents.getHandle(c).index;
+        if(slot >= mSlotToIndex.size())
+          mSlotToIndex.resize(slot + 1, PoolHandle::INVALID_INDEX);
+
+        mSlotToIndex[slot] = (uint32_t)mPacked.size();
+        mHotData.push_back(THot());
+        mPacked.push_back(c);
+        mOwners.push_back(owner);
+        return c;
+      }
+    private:
+      /**
+       * Update packed entries in [begin, end) range
+       */
+      void updateRange(size_t begin, size_t end, const double& time)
+      {
+        for(size_t i = begin; i < end; ++i)
+        {
+          if(mPacked[i] == NULL)
+            continue;
+
+          updateComponent(mHotData[i], mPacked[i], mOwners[i], time);
+        }
+      }
+
+      /**
+       * Remove packed entry, moving the last one in its place
+       */
+      void release(uint32_t index)
+      {
+        uint32_t last = (uint32_t)mPacked.size() - 1;
+        if(index != last)
+        {
+          mHotData[index] = std::move(mHotData[last]);
+          mPacked[index] = mPacked[last];
+          mOwners[index] = mOwners[last];
+          if(mPacked[index] != NULL)
+            mSlotToIndex[this->mComponents.getHandle(mPacked[index]).index] = index;
+        }
+
+        mHotData.pop_back();
+        mPacked.pop_back();
+        mOwners.pop_back();
+      }
+
+      /**
+       * Drop entries of components that were removed during the update
+       */
+      void compact()
+      {
+        uint32_t i = 0;
+        while(i < mPacked.size())
+        {
+          if(mPacked[i] == NULL)
+            release(i);
+          else
+            i++;
+        }
+        mDeadCount = 0;
+      }
+
+      std::vector<THot> mHotData;
+      std::vector<T*> mPacked;
+      std::vector<Entity*> mOwners;
+      std::vector<uint32_t> mSlotToIndex;
+
+      bool mUpdating;
+      size_t mDeadCount;
+  };
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _Prefab_H_
+#define _Prefab_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DataProxy.h"
+#include "Engine.h"
+
+namespace Gsage
+{
+  /**
+   * Precompiled entity or level data.
+   *
+   * Prefab is a small header followed by the msgpack packed data tree.
+   * Prefabs are produced from json files by tools/compile_prefabs.py or by Prefab::compile.
+   * Instantiating a prefab copies the packed data and unpacks it in place: strings and binary values reference
+   * the copied buffer, so there is no text parsing and no per value allocations.
+   * Entities of the prefab are kept as engine entity templates: component type ids and property slots
+   * are resolved when the first entity is created, and each next instantiation reuses them.
+   */
+  class Prefab
+  {
+    public:
+      /**
+       * Prefab file extension
+       */
+      static const std::string EXTENSION;
+
+      /**
+       * Binary format version
+       */
+      enum : uint32_t { VERSION = 1 };
+
+      /**
+       * Header size in bytes: magic, version and payload size
+       */
+      enum : size_t { HEADER_SIZE = 12 };
+
+      Prefab();
+      virtual ~Prefab();
+
+      /**
+       * Compile data tree into prefab
+       *
+       * @param data DataProxy to compile
+       * @param dest String to write prefab to
+       */
+      static bool compile(const DataProxy& data, std::string& dest);
+
+      /**
+       * Check if the buffer starts with prefab header
+       *
+       * @param data Buffer
+       * @param size Buffer size
+       */
+      static bool isPrefab(const char* data, size_t size);
+
+      /**
+       * Read prefab from the buffer, buffer is copied
+       *
+       * @param data Buffer
+       * @param size Buffer size
+       * @returns false if the buffer has wrong header or truncated
+       */
+      bool read(const char* data, size_t size);
+
+      /**
+       * Create data tree from the prefab
+       *
+       * @param dest DataProxy to write to, it gets the new msgpack tree
+       */
+      bool instantiate(DataProxy& dest) const;
+
+      /**
+       * Get templates of the entities, listed in the "entities" array or object of the prefab.
+       * Data is unpacked by the first call and it is kept by the prefab
+       */
+      std::vector<Engine::EntityTemplate>& getEntityTemplates();
+
+      /**
+       * Get data unpacked for the entity templates
+       */
+      const DataProxy& getData() const { return mData; }
+
+      /**
+       * Get packed data
+       */
+      const std::string& getPayload() const { return mPayload; }
+
+      /**
+       * Check if prefab was read successfully
+       */
+      bool empty() const { return mPayload.empty(); }
+    private:
+      std::string mPayload;
+
+      DataProxy mData;
+      std::vector<Engine::EntityTemplate> mEntityTemplates;
+      bool mUnpacked;
+  };
+}
+
+#endif
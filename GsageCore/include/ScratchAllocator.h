@@ -0,0 +1,126 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _ScratchAllocator_H_
+#define _ScratchAllocator_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Gsage
+{
+  /**
+   * Linear allocator for the short living temporary data.
+   *
+   * Memory is released all at once by the reset call, destructors are not called.
+   * If the buffer overflows, additional blocks are allocated, and on reset they are merged
+   * into one bigger buffer, so in steady state the allocator does not touch the heap.
+   */
+  class ScratchAllocator
+  {
+    public:
+      ScratchAllocator(size_t capacity = 64 * 1024)
+        : mCapacity(capacity)
+        , mOffset(0)
+        , mOverflow(0)
+      {
+      }
+
+      ScratchAllocator(ScratchAllocator&& other) = default;
+      ScratchAllocator& operator=(ScratchAllocator&& other) = default;
+
+      /**
+       * Allocate memory block
+       * @param size Block size
+       * @param alignment Block alignment
+       */
+      void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+      {
+        if(!mBuffer)
+          mBuffer = std::unique_ptr<char[]>(new char[mCapacity]);
+
+        size_t offset = align(mOffset, alignment);
+        if(offset + size <= mCapacity)
+        {
+          mOffset = offset + size;
+          return mBuffer.get() + offset;
+        }
+
+        // does not fit: allocate separate block, it will be merged on reset
+        mOverflow += size + alignment;
+        mBlocks.emplace_back(new char[size + alignment]);
+        char* block = mBlocks.back().get();
+        return block + (align((size_t)block, alignment) - (size_t)block);
+      }
+
+      /**
+       * Allocate array of objects, objects are not constructed
+       * @param count Object count
+       */
+      template<typename T>
+      T* allocate(size_t count)
+      {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+      }
+
+      /**
+       * Release all allocated memory
+       */
+      void reset()
+      {
+        if(mOverflow > 0)
+        {
+          mCapacity += mOverflow;
+          mBlocks.clear();
+          mBuffer.reset();
+          mOverflow = 0;
+        }
+        mOffset = 0;
+      }
+
+      /**
+       * Get used byte count
+       */
+      size_t getUsed() const
+      {
+        return mOffset + mOverflow;
+      }
+    private:
+      static size_t align(size_t value, size_t alignment)
+      {
+        return (value + alignment - 1) / alignment * alignment;
+      }
+
+      std::unique_ptr<char[]> mBuffer;
+      std::vector<std::unique_ptr<char[]>> mBlocks;
+      size_t mCapacity;
+      size_t mOffset;
+      size_t mOverflow;
+  };
+}
+
+#endif
@@ -30,6 +30,10 @@ THE SOFTWARE.
 #include "GsageDefinitions.h"
 #include "DataProxy.h"
 #include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
 
 /**
  * Bind member field
@@ -172,6 +176,19 @@ namespace Gsage
     return true;
   }
 
+  template<typename Type>
+  inline bool getValue(const DataProxy& value, Type& dest)
+  {
+    return value.getValue(dest);
+  }
+
+  inline bool getValue(const DataProxy& value, DataProxy& dest)
+  {
+    // resolved values can be shared by several objects, so each one gets a copy
+    dest = DataProxy::create(value.getWrappedType());
+    return value.dump(dest, DataProxy::ForceCopy);
+  }
+
   template<typename Type>
   inline bool put(DataProxy& dict, const std::string& id, const Type& value)
   {
@@ -196,7 +213,34 @@ namespace Gsage
   }
 
   /**
-   * Class that has bindings for quick reading fields from DataProxy and writing it to it
+   * Values of the data node, resolved to the binding indices of a property table.
+   * Reading them does not look up properties by name
+   */
+  struct ResolvedProperties
+  {
+    struct Value
+    {
+      size_t index;
+      DataProxy value;
+      bool found;
+    };
+
+    ResolvedProperties()
+      : table(0)
+    {
+    }
+
+    // property table the indices belong to
+    const void* table;
+    std::vector<Value> values;
+  };
+
+  /**
+   * Class that has bindings for quick reading fields from DataProxy and writing it to it.
+   *
+   * Bindings are not stored per instance: each registration sequence is interned as a chain of
+   * shared property tables, so only the first instance of a class builds them. Every instance
+   * just walks the chain and keeps a pointer to the resulting table.
    */
   template<typename C>
   class Serializable : public Reflection
@@ -204,7 +248,7 @@ namespace Gsage
     public:
       /**
        * Non templated property base
-       * Used to store all props in the vector
+       * Used to store all props in the property table
        */
       class AbstractProperty
       {
@@ -216,17 +260,37 @@ namespace Gsage
           virtual ~AbstractProperty() {};
           /**
            * Read property from DataProxy
+           * @param target Pointer to the bound field or instance
            * @param dict DataProxy
            */
-          virtual bool read(const DataProxy& dict) = 0;
+          virtual bool read(void* target, const DataProxy& dict) const = 0;
+          /**
+           * Read property from the value, that was already found in the DataProxy
+           * @param target Pointer to the bound field or instance
+           * @param value Property value
+           */
+          virtual bool readValue(void* target, const DataProxy& value) const = 0;
           /**
            * Write property to the DataProxy
+           * @param target Pointer to the bound field or instance
            * @param dict DataProxy
            */
-          virtual bool dump(DataProxy& dict) = 0;
+          virtual bool dump(void* target, DataProxy& dict) const = 0;
+          /**
+           * Make a heap copy of the property
+           */
+          virtual AbstractProperty* clone() const = 0;
+          /**
+           * Check if both properties have the same type, name, flags and accessors
+           * @param other Property to compare with
+           */
+          virtual bool equals(const AbstractProperty& other) const
+          {
+            return mName == other.mName && mFlags == other.mFlags;
+          }
 
           std::string mName;
-          bool isFlagSet(const PropertyFlag& flag)
+          bool isFlagSet(const PropertyFlag& flag) const
           {
             return (mFlags & flag) == flag;
           }
@@ -242,40 +306,61 @@ namespace Gsage
       class Property : public AbstractProperty
       {
         public:
-          Property(std::string name, T* propertyPtr, int flags = 0x00)
-            : mPropertyPtr(propertyPtr)
-            , AbstractProperty(name, flags)
+          Property(const std::string& name, int flags = 0x00)
+            : AbstractProperty(name, flags)
           {
           }
           /**
            * Read property value from the node
+           * @param target Pointer to the field
            * @param dict Should contain value with key, that is defined in constructor of object
            */
-          bool read(const DataProxy& dict)
+          bool read(void* target, const DataProxy& dict) const
           {
             if(AbstractProperty::isFlagSet(Readonly) || AbstractProperty::isFlagSet(Optional))
               return true;
 
-            return get(dict, AbstractProperty::mName, *mPropertyPtr);
+            return get(dict, AbstractProperty::mName, *static_cast<T*>(target));
+          }
+
+          /**
+           * Read property value
+           * @param target Pointer to the field
+           * @param value Property value
+           */
+          bool readValue(void* target, const DataProxy& value) const
+          {
+            if(AbstractProperty::isFlagSet(Readonly) || AbstractProperty::isFlagSet(Optional))
+              return true;
+
+            return getValue(value, *static_cast<T*>(target));
           }
 
           /**
            * Write property to the data node
+           * @param target Pointer to the field
            * @param dict DataProxy will contain value with specified key
            */
-          bool dump(DataProxy& dict)
+          bool dump(void* target, DataProxy& dict) const
           {
             if(AbstractProperty::isFlagSet(Writeonly))
               return true;
 
-            if(mPropertyPtr == NULL)
+            if(target == NULL)
               return false;
 
-            return put(dict, AbstractProperty::mName, *mPropertyPtr);
+            return put(dict, AbstractProperty::mName, *static_cast<T*>(target));
+          }
+
+          AbstractProperty* clone() const
+          {
+            return new Property<T>(*this);
+          }
+
+          bool equals(const AbstractProperty& other) const
+          {
+            return dynamic_cast<const Property<T>*>(&other) != 0 && AbstractProperty::equals(other);
           }
-        private:
-          std::string mName;
-          T* mPropertyPtr;
       };
 
       /**
@@ -285,18 +370,18 @@ namespace Gsage
       class PropertyAccessor : public AbstractProperty
       {
         public:
-          PropertyAccessor(std::string name, TInstance* instance, TGetter getter, TSetter setter, int flags)
-            : mInstance(instance)
-            , mGetter(getter)
+          PropertyAccessor(const std::string& name, TGetter getter, TSetter setter, int flags)
+            : mGetter(getter)
             , mSetter(setter)
             , AbstractProperty(name, flags)
           {
           }
           /**
            * Read property value from the node and call class setter
+           * @param target Pointer to the instance
            * @param dict Should contain value with key, that is defined in constructor of object
            */
-          bool read(const DataProxy& dict)
+          bool read(void* target, const DataProxy& dict) const
           {
             T value;
             // setter is not set, it is normal
@@ -305,38 +390,187 @@ namespace Gsage
             if(!get(dict, AbstractProperty::mName, value))
               return AbstractProperty::isFlagSet(Optional);
 
-            (mInstance->*mSetter)(value);
+            (static_cast<TInstance*>(target)->*mSetter)(value);
+            return true;
+          }
+
+          /**
+           * Convert property value and call class setter
+           * @param target Pointer to the instance
+           * @param value Property value
+           */
+          bool readValue(void* target, const DataProxy& value) const
+          {
+            T res;
+            if(mSetter == 0)
+              return true;
+            if(!getValue(value, res))
+              return AbstractProperty::isFlagSet(Optional);
+
+            (static_cast<TInstance*>(target)->*mSetter)(res);
             return true;
           }
 
           /**
            * Call class getter and write return value to the data node
+           * @param target Pointer to the instance
            * @param dict DataProxy will contain value with specified key
            */
-          bool dump(DataProxy& dict)
+          bool dump(void* target, DataProxy& dict) const
           {
             if(mGetter == 0)
               return true;
 
-            return put(dict, AbstractProperty::mName, (mInstance->*mGetter)());
+            return put(dict, AbstractProperty::mName, (static_cast<TInstance*>(target)->*mGetter)());
+          }
+
+          AbstractProperty* clone() const
+          {
+            return new PropertyAccessor<T, TSetter, TGetter, TInstance>(*this);
+          }
+
+          bool equals(const AbstractProperty& other) const
+          {
+            const PropertyAccessor<T, TSetter, TGetter, TInstance>* accessor = dynamic_cast<const PropertyAccessor<T, TSetter, TGetter, TInstance>*>(&other);
+            return accessor != 0 &&
+              accessor->mGetter == mGetter &&
+              accessor->mSetter == mSetter &&
+              AbstractProperty::equals(other);
           }
         private:
-          TInstance* mInstance;
           TGetter mGetter;
           TSetter mSetter;
       };
 
-      virtual ~Serializable()
+      /**
+       * Single property binding in the property table
+       */
+      struct Binding
+      {
+        std::shared_ptr<AbstractProperty> property;
+        int priority;
+        // offset of the bound field or instance from the Serializable base
+        std::ptrdiff_t offset;
+        // index in the per instance slots, used for targets living outside of the object
+        int slot;
+
+        bool matches(const AbstractProperty& p, int prio) const
+        {
+          return priority == prio && property->equals(p);
+        }
+      };
+
+      /**
+       * Immutable list of bindings, shared by all instances with the same registration sequence.
+       * Each table owns the tables created by adding one more binding to it.
+       */
+      class PropertyTable
       {
-        for(auto pair : mProperties) {
-          for(unsigned int i = 0; i < pair.second.size(); i++)
+        public:
+          PropertyTable()
+            : mSlotCount(0)
           {
-            AbstractProperty* p = pair.second[i];
-            delete p;
           }
-          pair.second.clear();
-        }
-        mProperties.clear();
+
+          /**
+           * Get table that has one more binding
+           *
+           * @param property Property to add, copied only when the table is created
+           * @param priority Property priority
+           * @param offset Offset of the target from the Serializable base
+           * @param slot Set to the slot index when the target should be stored per instance, -1 otherwise
+           */
+          const PropertyTable* extend(const AbstractProperty& property, int priority, std::ptrdiff_t offset, int& slot) const
+          {
+            std::lock_guard<std::mutex> lock(getMutex());
+            bool unstable = false;
+            for(auto& child : mChildren) {
+              const Binding& added = child->mAdded;
+              if(!added.matches(property, priority)) {
+                continue;
+              }
+
+              if(added.slot != -1 || added.offset == offset) {
+                slot = added.slot;
+                return child.get();
+              }
+              unstable = true;
+            }
+
+            // target is not at the same offset for the instances of this class,
+            // so it must live outside of the object and is stored per instance
+            Binding binding = {std::shared_ptr<AbstractProperty>(property.clone()), priority, offset, unstable ? mSlotCount : -1};
+            mChildren.emplace_back(new PropertyTable(*this, binding));
+            slot = binding.slot;
+            return mChildren.back().get();
+          }
+
+          /**
+           * Get all bindings, ordered by priority
+           */
+          const std::vector<Binding>& getBindings() const
+          {
+            return mBindings;
+          }
+
+          /**
+           * Find binding by property name
+           *
+           * @param name Property name
+           * @returns pointer to the binding or 0
+           */
+          const Binding* find(const std::string& name) const
+          {
+            auto iter = mMappings.find(name);
+            if(iter == mMappings.end())
+              return 0;
+
+            return &mBindings[iter->second];
+          }
+
+          static PropertyTable& getRoot()
+          {
+            static PropertyTable root;
+            return root;
+          }
+        private:
+          PropertyTable(const PropertyTable& parent, const Binding& added)
+            : mBindings(parent.mBindings)
+            , mSlotCount(parent.mSlotCount + (added.slot == -1 ? 0 : 1))
+            , mAdded(added)
+          {
+            // properties with higher priority value are read first, order is kept otherwise
+            auto iter = mBindings.begin();
+            while(iter != mBindings.end() && iter->priority >= added.priority) {
+              iter++;
+            }
+            mBindings.insert(iter, added);
+
+            for(size_t i = 0; i < mBindings.size(); i++) {
+              mMappings[mBindings[i].property->mName] = i;
+            }
+          }
+
+          static std::mutex& getMutex()
+          {
+            static std::mutex mutex;
+            return mutex;
+          }
+
+          std::vector<Binding> mBindings;
+          std::map<std::string, size_t> mMappings;
+          int mSlotCount;
+          Binding mAdded;
+          mutable std::vector<std::unique_ptr<PropertyTable>> mChildren;
+      };
+
+      Serializable()
+        : mTable(&PropertyTable::getRoot())
+      {
+      }
+
+      virtual ~Serializable()
+      {
       }
 
       /**
@@ -346,10 +580,11 @@ namespace Gsage
        */
       virtual bool read(const DataProxy& dict, const std::string& id)
       {
-        if(mPropMappings.count(id) == 0)
+        const Binding* binding = mTable->find(id);
+        if(binding == 0)
           return false;
 
-        return mPropMappings[id]->read(dict);
+        return binding->property->read(getTarget(*binding), dict);
       }
 
       /**
@@ -359,18 +594,62 @@ namespace Gsage
       virtual bool read(const DataProxy& dict)
       {
         bool allSucceed = true;
-        for(auto pair : mProperties) {
-          for(AbstractProperty* prop : pair.second)
+        for(const Binding& binding : mTable->getBindings()) {
+          if(!binding.property->read(getTarget(binding), dict))
           {
-            if(!prop->read(dict))
-            {
-              allSucceed = false;
-            }
+            allSucceed = false;
           }
         }
         return allSucceed;
       }
 
+      /**
+       * Find values of all bound properties in the node.
+       * Resolved properties can be read by any instance with the same property table
+       *
+       * @param dict DataProxy to resolve
+       * @param dest Resolved properties
+       */
+      void resolve(const DataProxy& dict, ResolvedProperties& dest) const
+      {
+        const std::vector<Binding>& bindings = mTable->getBindings();
+        dest.table = mTable;
+        dest.values.clear();
+        dest.values.reserve(bindings.size());
+        for(size_t i = 0; i < bindings.size(); i++) {
+          auto value = dict.get<DataProxy>(bindings[i].property->mName);
+          ResolvedProperties::Value resolved = {i, value.first, value.second};
+          dest.values.push_back(resolved);
+        }
+      }
+
+      /**
+       * Read properties resolved by the same class instance.
+       * Falls back to reading the node, if they were resolved for another property table
+       *
+       * @param properties Resolved properties
+       * @param dict DataProxy the properties were resolved from
+       */
+      virtual bool read(const ResolvedProperties& properties, const DataProxy& dict)
+      {
+        if(properties.table != mTable)
+          return read(dict);
+
+        bool allSucceed = true;
+        const std::vector<Binding>& bindings = mTable->getBindings();
+        for(const ResolvedProperties::Value& value : properties.values) {
+          const Binding& binding = bindings[value.index];
+          // missing value is handled by the regular read, it knows if the property is optional
+          bool succeed = value.found ?
+            binding.property->readValue(getTarget(binding), value.value) :
+            binding.property->read(getTarget(binding), dict);
+
+          if(!succeed)
+            allSucceed = false;
+        }
+        return allSucceed;
+      }
+
       /**
        * Iterates through all specified properties and puts each to the node
        * @param dict DataProxy to write
@@ -378,12 +657,9 @@ namespace Gsage
       virtual bool dump(DataProxy& dict)
       {
         bool allSucceed = true;
-        for(auto pair : mProperties) {
-          for(AbstractProperty* prop : pair.second)
-          {
-            if(!prop->dump(dict))
-              allSucceed = false;
-          }
+        for(const Binding& binding : mTable->getBindings()) {
+          if(!binding.property->dump(getTarget(binding), dict))
+            allSucceed = false;
         }
         return allSucceed;
       }
@@ -410,6 +686,14 @@ namespace Gsage
         return read(props);
       }
 
+      /**
+       * Get property table, shared between instances of the same class
+       */
+      const PropertyTable* getPropertyTable() const
+      {
+        return mTable;
+      }
+
       /**
        * Register property as serializable
        * @param name Key to search in DataProxy
@@ -419,7 +703,7 @@ namespace Gsage
       template<typename TDest>
       void registerProperty(const std::string& name, TDest* dest, int flags = 0x00, int priority = 0)
       {
-        addProperty(new Property<TDest>(name, dest, flags), priority);
+        addProperty(Property<TDest>(name, flags), dest, priority);
       }
 
       /**
@@ -433,7 +717,7 @@ namespace Gsage
       template<typename TDest, class TInstance, class TRetVal>
       void registerProperty(const std::string& name, TInstance* instance, TRetVal (TInstance::*setter)(const TDest& value), TDest (TInstance::*getter)(), int flags = 0x00, int priority = 0)
       {
-        addProperty(new PropertyAccessor<TDest, TRetVal (TInstance::*)(const TDest& value), TDest (TInstance::*)(), TInstance>(name, instance, getter, setter, flags), priority);
+        addProperty(PropertyAccessor<TDest, TRetVal (TInstance::*)(const TDest& value), TDest (TInstance::*)(), TInstance>(name, getter, setter, flags), instance, priority);
       }
       /**
        * Register property setter/getter as serializable.
@@ -446,7 +730,7 @@ namespace Gsage
       template<typename TDest, class TInstance, class TRetVal>
       void registerProperty(const std::string& name, TInstance* instance, TRetVal (TInstance::*setter)(const TDest& value), const TDest& (TInstance::*getter)()const, int flags = 0x00, int priority = 0)
       {
-        addProperty(new PropertyAccessor<TDest, TRetVal (TInstance::*)(const TDest& value), const TDest& (TInstance::*)()const, TInstance>(name, instance, getter, setter, flags), priority);
+        addProperty(PropertyAccessor<TDest, TRetVal (TInstance::*)(const TDest& value), const TDest& (TInstance::*)()const, TInstance>(name, getter, setter, flags), instance, priority);
       }
       /**
        * Register property getter as serializable.
@@ -458,7 +742,7 @@ namespace Gsage
       template<typename TDest, class TInstance>
       void registerGetter(const std::string& name, TInstance* instance, TDest (TInstance::*getter)(), int flags = 0x00, int priority = 0)
       {
-        addProperty(new PropertyAccessor<TDest, void (TInstance::*)(const TDest& value), TDest (TInstance::*)(), TInstance>(name, instance, getter, 0, flags), priority);
+        addProperty(PropertyAccessor<TDest, void (TInstance::*)(const TDest& value), TDest (TInstance::*)(), TInstance>(name, getter, 0, flags), instance, priority);
       }
       /**
        * Register property setter as serializable.
@@ -471,7 +755,7 @@ namespace Gsage
       template<typename TDest, class TInstance, class TRetVal>
       void registerSetter(const std::string& name, TInstance* instance, TRetVal (TInstance::*setter)(const TDest& value), int flags = 0x00, int priority = 0)
       {
-        addProperty(new PropertyAccessor<TDest, TRetVal (TInstance::*)(const TDest& value), TDest (TInstance::*)(), TInstance>(name, instance, 0, setter, flags), priority);
+        addProperty(PropertyAccessor<TDest, TRetVal (TInstance::*)(const TDest& value), TDest (TInstance::*)(), TInstance>(name, 0, setter, flags), instance, priority);
       }
       /**
        * Register property setter/getter as serializable
@@ -482,34 +766,40 @@ namespace Gsage
       template<typename TDest, typename TRetVal>
       void registerProperty(const std::string& name, TRetVal (C::*setter)(const TDest& value), TDest (C::*getter)(), int flags = 0x00, int priority = 0)
       {
-        addProperty(new PropertyAccessor<TDest, TRetVal (C::*)(const TDest& value), TDest (C::*)()>(name, static_cast<C*>(this), getter, setter, flags), priority);
+        addProperty(PropertyAccessor<TDest, TRetVal (C::*)(const TDest& value), TDest (C::*)()>(name, getter, setter, flags), static_cast<C*>(this), priority);
       }
 
     protected:
-      // vector is used to keep an order
-      typedef std::vector<AbstractProperty*> PropertyChain;
-      // several vectors are used to create property chains with different priorities
-      typedef std::map<int, PropertyChain, std::greater<int>> Properties;
-      Properties mProperties;
-
-      // map is used to quickly access property by key
-      typedef std::map<std::string, AbstractProperty*> PropMappings;
-      PropMappings mPropMappings;
-
       /**
-       * Add property to the property list
-       * @param property AbstractProperty accessor
+       * Add property to the property table
+       * @param property AbstractProperty accessor, copied only when the class registers it for the first time
+       * @param target Pointer to the field or instance the property is bound to
        * @param priority Priority of the property, properties with higher value are read first. Default priority is the lowest
        */
-      void addProperty(AbstractProperty* property, int priority = 0)
+      void addProperty(const AbstractProperty& property, void* target, int priority = 0)
+      {
+        std::ptrdiff_t offset = reinterpret_cast<std::intptr_t>(target) - reinterpret_cast<std::intptr_t>(this);
+        int slot = -1;
+        mTable = mTable->extend(property, priority, offset, slot);
+        if(slot != -1) {
+          mSlots.resize(slot + 1);
+          mSlots[slot] = target;
+        }
+      }
+
+    private:
+      void* getTarget(const Binding& binding)
       {
-        if(mProperties.count(priority) == 0) {
-          mProperties[priority] = PropertyChain();
+        if(binding.slot != -1) {
+          return mSlots[binding.slot];
         }
 
-        mProperties[priority].push_back(property);
-        mPropMappings[property->mName] = property;
+        return reinterpret_cast<void*>(reinterpret_cast<std::intptr_t>(this) + binding.offset);
       }
+
+      const PropertyTable* mTable;
+      // targets that are not a part of the object
+      std::vector<void*> mSlots;
   };
 }
 
@@ -0,0 +1,145 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _SystemScheduler_H_
+#define _SystemScheduler_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DataProxy.h"
+#include "ThreadPool.h"
+
+namespace Gsage
+{
+  class EngineSystem;
+
+  /**
+   * Runs engine systems updates.
+   *
+   * In serial mode systems are updated one by one in the engine order (deterministic).
+   * In parallel mode scheduler builds dependency graph from the declared component access:
+   * a system depends on each previous system, which writes what it reads or writes, or reads what it writes.
+   * Independent systems are updated concurrently on the work stealing thread pool,
+   * main thread only systems are updated by the thread, which calls SystemScheduler::update.
+   * A thread, which finished a system update, continues with the released dependent system,
+   * so a chain of conflicting systems does not bounce between the threads.
+   */
+  class GSAGE_API SystemScheduler
+  {
+    public:
+      typedef std::map<std::string, EngineSystem*> Systems;
+
+      SystemScheduler();
+      virtual ~SystemScheduler();
+
+      /**
+       * Configure scheduler
+       *  parallel: enable parallel mode, false by default
+       *  workers: worker thread count, 0 means hardware concurrency - 1
+       * @param config DataProxy
+       */
+      void configure(const DataProxy& config);
+
+      /**
+       * Switch between parallel and serial mode
+       * @param value Enable parallel mode
+       * @param workers Worker thread count, 0 means hardware concurrency - 1
+       */
+      void setParallel(bool value, size_t workers = 0);
+
+      /**
+       * Check if parallel mode is enabled
+       */
+      bool isParallel() const;
+
+      /**
+       * Mark dependency graph dirty, should be called when systems are added or removed
+       */
+      void invalidate();
+
+      /**
+       * Update all enabled systems
+       * @param systems Systems to update
+       * @param time Delta time
+       */
+      void update(const Systems& systems, const double& time);
+
+      /**
+       * Get thread pool shared by the engine, it is created on the first access
+       */
+      ThreadPool* getThreadPool();
+    private:
+      struct Node
+      {
+        EngineSystem* system;
+        std::vector<size_t> dependents;
+        size_t dependencies;
+        bool mainThread;
+      };
+
+      /**
+       * Build dependency graph
+       */
+      void build(const Systems& systems);
+
+      /**
+       * Check if two systems can not be updated concurrently
+       */
+      bool conflicts(EngineSystem* first, EngineSystem* second) const;
+
+      /**
+       * Queue node, which has all dependencies resolved
+       */
+      void dispatch(size_t index);
+
+      /**
+       * Update node system and release dependents
+       */
+      void run(size_t index);
+
+      std::vector<Node> mNodes;
+      std::vector<size_t> mRoots;
+      std::unique_ptr<std::atomic<size_t>[]> mRemaining;
+
+      std::vector<size_t> mMainQueue;
+      size_t mPending;
+      std::mutex mMutex;
+      std::condition_variable mWake;
+
+      double mTime;
+      bool mDirty;
+      bool mParallel;
+      std::unique_ptr<ThreadPool> mPool;
+  };
+}
+
+#endif
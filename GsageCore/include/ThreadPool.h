@@ -0,0 +1,137 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _ThreadPool_H_
+#define _ThreadPool_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "GsageDefinitions.h"
+
+namespace Gsage {
+  /**
+   * Work stealing thread pool.
+   *
+   * Each worker owns a job queue: it takes jobs from the back of own queue
+   * and steals from the front of other queues when it runs out of work.
+   * Jobs submitted from the worker thread go to the worker's own queue.
+   */
+  class GSAGE_API ThreadPool
+  {
+    public:
+      typedef std::function<void()> Job;
+      /**
+       * Function which processes [begin, end) range chunk
+       * participant is an index of the thread that runs the chunk: 0 is the calling thread, then helpers
+       */
+      typedef std::function<void(size_t begin, size_t end, size_t participant)> ChunkFunction;
+
+      /**
+       * @param workers Worker thread count, 0 means hardware concurrency - 1
+       */
+      ThreadPool(size_t workers = 0);
+      virtual ~ThreadPool();
+
+      /**
+       * Start worker threads. Stops running workers first
+       * @param workers Worker thread count, 0 means hardware concurrency - 1
+       */
+      void start(size_t workers = 0);
+
+      /**
+       * Stop all worker threads. Workers finish pending jobs before exiting
+       */
+      void stop();
+
+      /**
+       * Queue a job
+       * @param job Job to run
+       */
+      void submit(const Job& job);
+
+      /**
+       * Split [0, count) range into chunks and process them concurrently.
+       * Calling thread takes part in the processing, the call returns when all chunks are done
+       *
+       * @param count Range size
+       * @param grainSize Max chunk size
+       * @param func Function to run for each chunk
+       * @returns participant count, at most getWorkerCount() + 1
+       */
+      size_t parallelFor(size_t count, size_t grainSize, const ChunkFunction& func);
+
+      /**
+       * Get max participant count of parallelFor call
+       */
+      size_t getMaxParticipants() const;
+
+      /**
+       * Take one pending job and run it on the calling thread.
+       * Can be used to help workers while waiting for the results
+       * @returns true if a job was run
+       */
+      bool runPendingJob();
+
+      /**
+       * Get count of running worker threads
+       */
+      size_t getWorkerCount() const;
+
+      /**
+       * Get default worker count for this machine
+       */
+      static size_t getDefaultWorkerCount();
+    private:
+      struct Queue
+      {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+      };
+
+      void workerLoop(size_t index);
+      bool pop(size_t index, Job& job);
+      bool steal(size_t thief, Job& job);
+
+      std::vector<std::unique_ptr<Queue>> mQueues;
+      std::vector<std::thread> mThreads;
+
+      std::mutex mWakeMutex;
+      std::condition_variable mWake;
+
+      std::atomic<size_t> mPending;
+      std::atomic<size_t> mNextQueue;
+      std::atomic<bool> mRunning;
+  };
+}
+
+#endif
@@ -0,0 +1,255 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _TimerWheel_H_
+#define _TimerWheel_H_
+
+#include "ObjectPool.h"
+#include <stdint.h>
+#include <vector>
+
+namespace Gsage
+{
+  /**
+   * Hierarchical timer wheel.
+   *
+   * Time is split into ticks of the fixed resolution. Timers, that expire in the next 64 ticks,
+   * are stored in the slots of the first level, later timers go to the coarser levels and are
+   * moved down when the wheel reaches their slot. Scheduling and cancelling is O(1),
+   * advancing touches only expired timers and the slots being cascaded.
+   *
+   * Timer entries are kept in the pool with the free list, so in steady state
+   * the wheel does not allocate memory.
+   */
+  class TimerWheel
+  {
+    public:
+      typedef PoolHandle Handle;
+
+      enum : uint32_t {
+        SLOT_BITS = 6,
+        SLOTS = 1 << SLOT_BITS,
+        LEVELS = 4
+      };
+
+      /**
+       * @param resolution Tick length in seconds
+       */
+      TimerWheel(double resolution = 0.001);
+      virtual ~TimerWheel();
+
+      /**
+       * Schedule a timer
+       *
+       * @param delay Delay in seconds
+       * @param data User data, passed to the advance callback
+       * @returns timer handle
+       */
+      Handle schedule(double delay, void* data);
+
+      /**
+       * Cancel the timer
+       *
+       * @param handle Timer handle
+       * @returns false if the timer has already expired or was cancelled
+       */
+      bool cancel(const Handle& handle);
+
+      /**
+       * Check that timer is still waiting
+       *
+       * @param handle Timer handle
+       */
+      bool isScheduled(const Handle& handle) const;
+
+      /**
+       * Get time left until the timer expires
+       *
+       * @param handle Timer handle
+       * @returns 0 if timer is not scheduled
+       */
+      double getTimeLeft(const Handle& handle) const;
+
+      /**
+       * Get handle of the timer, stored in the entry
+       *
+       * @param index Entry index
+       * @returns invalid handle if the entry is not scheduled
+       */
+      Handle getHandleAt(uint32_t index) const;
+
+      /**
+       * Get user data of the timer
+       *
+       * @param handle Timer handle
+       * @returns 0 if the timer is not scheduled
+       */
+      void* getData(const Handle& handle) const;
+
+      /**
+       * Advance the wheel and fire expired timers.
+       * Callback can schedule new timers, they are added to the wheel after the last tick is processed,
+       * so they are not fired in the same call, even if it advances several ticks.
+       *
+       * @param time Elapsed time in seconds
+       * @param callback Callable (const Handle&, void* data)
+       * @returns count of fired timers
+       */
+      template<typename F>
+      size_t advance(double time, F callback)
+      {
+        mAccumulated += time;
+        uint64_t ticks = (uint64_t)(mAccumulated / mResolution);
+        if(ticks == 0)
+          return 0;
+
+        mAccumulated -= ticks * mResolution;
+        if(mCount == 0) {
+          mTick += ticks;
+          return 0;
+        }
+
+        size_t fired = 0;
+        mAdvancing = true;
+        for(uint64_t i = 0; i < ticks; ++i) {
+          uint32_t index = (uint32_t)(mTick & (SLOTS - 1));
+          if(index == 0)
+            cascade();
+
+          ++mTick;
+          // expired timers are moved to the separate list, so callback can cancel any of them
+          moveSlot(index, FIRING);
+          while(mSlots[FIRING] != INVALID) {
+            uint32_t current = mSlots[FIRING];
+            Entry& entry = mEntries[current];
+            void* data = entry.data;
+            Handle handle(current, entry.generation);
+            unlink(current);
+            release(current);
+            fired++;
+            callback(handle, data);
+          }
+
+          if(mCount == mPending) {
+            mTick += ticks - i - 1;
+            break;
+          }
+        }
+        mAdvancing = false;
+        insertPending();
+        return fired;
+      }
+
+      /**
+       * Get count of scheduled timers
+       */
+      size_t size() const;
+
+      /**
+       * Preallocate timer entries
+       *
+       * @param count Entry count
+       */
+      void reserve(size_t count);
+
+      /**
+       * Cancel all timers
+       */
+      void clear();
+
+      /**
+       * Get current wheel time in seconds
+       */
+      double getTime() const;
+    private:
+      enum : uint32_t {
+        INVALID = 0xFFFFFFFF,
+        // list of the timers, fired in the current tick
+        FIRING = LEVELS * SLOTS,
+        // list of the timers, scheduled while advancing
+        PENDING = FIRING + 1
+      };
+
+      struct Entry
+      {
+        uint64_t expires;
+        void* data;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation;
+        // slot index in mSlots, INVALID if the entry is free
+        uint32_t slot;
+      };
+
+      /**
+       * Put scheduled entry into the slot, matching its expiration time
+       */
+      void insert(uint32_t index);
+
+      /**
+       * Put entry to the head of the slot list
+       */
+      void link(uint32_t index, uint32_t slot);
+
+      /**
+       * Insert timers, that were scheduled while advancing
+       */
+      void insertPending();
+
+      /**
+       * Unlink entry from the slot
+       */
+      void unlink(uint32_t index);
+
+      /**
+       * Move all entries of one slot to another
+       */
+      void moveSlot(uint32_t from, uint32_t to);
+
+      /**
+       * Move timers of the upper levels down, called when the first level wraps
+       */
+      void cascade();
+
+      /**
+       * Return entry to the free list
+       */
+      void release(uint32_t index);
+
+      std::vector<Entry> mEntries;
+      uint32_t mSlots[PENDING + 1];
+      uint32_t mFree;
+      size_t mCount;
+      size_t mPending;
+      bool mAdvancing;
+
+      uint64_t mTick;
+      double mResolution;
+      double mAccumulated;
+  };
+}
+
+#endif
@@ -104,7 +104,7 @@ namespace Gsage {
        * @param width current window window
        * @param height current window height
        */
-      virtual void fireWindowEvent(Event::ConstType type, unsigned long handle, unsigned int width = 0, unsigned int height = 0);
+      virtual void fireWindowEvent(Event::TypeId type, unsigned long handle, unsigned int width = 0, unsigned int height = 0);
     protected:
       const std::string mType;
   };
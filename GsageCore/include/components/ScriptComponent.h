@@ -131,6 +131,17 @@ namespace Gsage {
        */
       sol::table& getBtree();
 
+      /**
+       * Set time left until the behavior tree wakes up
+       * @param value Time in seconds, 0 if the tree is not waiting
+       */
+      void setSleepTime(double value);
+
+      /**
+       * Get time left until the behavior tree wakes up
+       */
+      double getSleepTime() const;
+
       /**
        * Build initial context state
        *
@@ -184,6 +195,7 @@ namespace Gsage {
       bool mSetupExecuted;
       bool mTearDownExecuted;
       bool mHasBehavior;
+      double mSleepTime;
   };
 }
 
@@ -27,11 +27,21 @@ THE SOFTWARE.
 #ifndef _StatsComponent_H_
 #define _StatsComponent_H_
 
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
 #include "EventDispatcher.h"
+#include "EventQueue.h"
 #include "Component.h"
 
 namespace Gsage {
 
+  /**
+   * Interned stat identifier
+   */
+  typedef uint32_t StatId;
+
   /**
    * Event that signals that some stat was updated
    */
@@ -39,6 +49,8 @@ namespace Gsage {
   {
     public:
       static const Type STAT_CHANGE;
+      static const Event::TypeId STAT_CHANGE_ID;
+      StatEvent(Event::TypeId type, const std::string& statId);
       StatEvent(ConstType type, const std::string& statId);
 
       /**
@@ -49,11 +61,47 @@ namespace Gsage {
       std::string mStatId;
   };
 
+  /**
+   * Keeps entity stats in a flat typed table.
+   *
+   * Stat names are interned into StatId. Each component has a small array of typed slots
+   * and StatId -> slot index, so reads and writes do not touch any strings.
+   * Numbers, bools and strings live in the slots, any other values are kept in a DataProxy.
+   *
+   * Changed stats are marked dirty. If the component has no event queue, StatEvent is fired immediately,
+   * otherwise changes are collected and posted to the queue in a batch by flushChanges.
+   */
   class StatsComponent : public EntityComponent, public EventDispatcher
   {
     public:
       static const std::string SYSTEM;
 
+      enum : StatId {
+        INVALID_STAT = 0xFFFFFFFF
+      };
+
+      /**
+       * Get stat id, registers the stat name if it's new
+       *
+       * @param name Stat name
+       */
+      static StatId getStatId(const std::string& name);
+
+      /**
+       * Find id of the registered stat, does not register new names
+       *
+       * @param name Stat name
+       * @returns INVALID_STAT if not registered
+       */
+      static StatId findStatId(const std::string& name);
+
+      /**
+       * Get stat name by id
+       *
+       * @param id Stat id
+       */
+      static const std::string& getStatName(StatId id);
+
       StatsComponent();
       virtual ~StatsComponent();
       /**
@@ -62,6 +110,15 @@ namespace Gsage {
        * @param id Stat identifier
        */
       bool hasStat(const std::string& id);
+      /**
+       * Chech if component has the specified stat
+       *
+       * @param id Interned stat identifier
+       */
+      bool hasStat(StatId id) const
+      {
+        return findStat(id) != 0;
+      }
       /**
        * Get stat by id
        *
@@ -70,7 +127,17 @@ namespace Gsage {
       template<typename T>
       const T getStat(const std::string& id)
       {
-        return mStats.get<T>(id).first;
+        return getStat<T>(findStatId(id));
+      }
+      /**
+       * Get stat by interned id
+       *
+       * @param id Interned stat identifier
+       */
+      template<typename T>
+      const T getStat(StatId id) const
+      {
+        return getStat(id, T());
       }
       /**
        * Get stat by id
@@ -81,7 +148,23 @@ namespace Gsage {
       template<typename T>
       const T getStat(const std::string& id, const T& defaultValue)
       {
-        return mStats.get(id, defaultValue);
+        return getStat(findStatId(id), defaultValue);
+      }
+      /**
+       * Get stat by interned id
+       *
+       * @param id Interned stat identifier
+       * @param defaultValue Return this value if not found
+       */
+      template<typename T>
+      const T getStat(StatId id, const T& defaultValue) const
+      {
+        const Stat* stat = findStat(id);
+        T value;
+        if(!stat || !readValue(*stat, value))
+          return defaultValue;
+
+        return value;
       }
       /**
        * Set stat by id
@@ -92,13 +175,33 @@ namespace Gsage {
       template<typename T>
       void setStat(const std::string& id, const T& value)
       {
-        if(mStats.count(id) != 0 && mStats.get<T>(id).first == value)
+        setStat(getStatId(id), value);
+      }
+      /**
+       * Set stat by interned id
+       *
+       * @param id Interned stat identifier
+       * @param value Stat value
+       */
+      template<typename T>
+      void setStat(StatId id, const T& value)
+      {
+        if(id == INVALID_STAT)
           return;
 
-        mStats.put(id, value);
-        fireEvent(StatEvent(StatEvent::STAT_CHANGE, id));
+        Stat& stat = getOrCreateStat(id);
+        if(writeValue(stat, value))
+          markChanged(stat);
       }
 
+      /**
+       * Post StatEvent for each stat changed since the last flush to the event queue.
+       * Events are coalesced per stat id, so each stat gets only one event per queue flush
+       *
+       * @returns number of posted events
+       */
+      size_t flushChanges();
+
       /**
        * Overrides default behavior of the decoding
        * @param dict DataProxy with all stats
@@ -123,11 +226,115 @@ namespace Gsage {
       const float increase(const std::string& key, const float& n);
 
       /**
-       * Get data
+       * Get copy of all stats
        */
-      DataProxy& data();
+      DataProxy data();
     private:
-      DataProxy mStats;
+      /**
+       * Single stat slot
+       */
+      struct Stat
+      {
+        enum Type : uint8_t
+        {
+          Empty,
+          Int,
+          Float,
+          Bool,
+          String,
+          // value is stored in mData
+          Data
+        };
+
+        Stat(StatId id)
+          : id(id)
+          , type(Empty)
+          , dirty(false)
+          , number(0)
+        {
+        }
+
+        StatId id;
+        Type type;
+        bool dirty;
+        double number;
+        std::string string;
+      };
+
+      const Stat* findStat(StatId id) const
+      {
+        if(id >= mIndex.size() || mIndex[id] == 0)
+          return 0;
+
+        return &mStats[mIndex[id] - 1];
+      }
+
+      Stat& getOrCreateStat(StatId id);
+
+      void markChanged(Stat& stat);
+
+      template<typename T>
+      typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, bool>::type
+      readValue(const Stat& stat, T& dest) const
+      {
+        if(stat.type != Stat::Int && stat.type != Stat::Float && stat.type != Stat::Bool)
+          return false;
+
+        dest = static_cast<T>(stat.number);
+        return true;
+      }
+
+      bool readValue(const Stat& stat, bool& dest) const;
+
+      bool readValue(const Stat& stat, std::string& dest) const;
+
+      template<typename T>
+      typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type
+      readValue(const Stat& stat, T& dest) const
+      {
+        if(stat.type == Stat::String)
+          return typename TranslatorBetween<std::string, T>::type().to(stat.string, dest);
+
+        if(stat.type == Stat::Data)
+          return mData.read(getStatName(stat.id), dest);
+
+        return false;
+      }
+
+      template<typename T>
+      typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, bool>::type
+      writeValue(Stat& stat, const T& value)
+      {
+        double number = static_cast<double>(value);
+        if((stat.type == Stat::Int || stat.type == Stat::Float) && stat.number == number)
+          return false;
+
+        stat.type = std::is_integral<T>::value ? Stat::Int : Stat::Float;
+        stat.number = number;
+        return true;
+      }
+
+      bool writeValue(Stat& stat, const bool& value);
+
+      bool writeValue(Stat& stat, const std::string& value);
+
+      template<typename T>
+      typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type
+      writeValue(Stat& stat, const T& value)
+      {
+        mData.put(getStatName(stat.id), value);
+        stat.type = Stat::Data;
+        stat.string.clear();
+        return true;
+      }
+
+      typedef std::vector<Stat> Stats;
+      Stats mStats;
+      // StatId -> slot index + 1, 0 means no stat
+      std::vector<uint32_t> mIndex;
+      // values, that can't be stored in slots
+      DataProxy mData;
+      size_t mDirtyCount;
   };
 }
 
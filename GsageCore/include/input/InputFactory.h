@@ -56,9 +56,9 @@ namespace Gsage {
     protected:
       bool handleWindowEvent(EventDispatcher* sender, const Event& event);
 
-      virtual void fireMouseEvent(Event::ConstType type, int x, int y, int z);
+      virtual void fireMouseEvent(Event::TypeId type, int x, int y, int z);
 
-      virtual void fireMouseEvent(Event::ConstType type, int x, int y, int z, const MouseEvent::ButtonType button);
+      virtual void fireMouseEvent(Event::TypeId type, int x, int y, int z, const MouseEvent::ButtonType button);
 
       size_t mHandle;
       int mWidth;
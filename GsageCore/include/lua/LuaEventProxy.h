@@ -29,6 +29,8 @@ THE SOFTWARE.
 
 #include "EventSubscriber.h"
 
+#include <unordered_map>
+#include <typeindex>
 #include "sol.hpp"
 
 namespace Gsage {
@@ -38,15 +40,23 @@ namespace Gsage {
   class LuaEventProxy : public EventSubscriber<LuaEventProxy>
   {
     public:
+      /**
+       * Fields of the event, which are passed to the lua function instead of the event object
+       */
+      typedef std::vector<std::string> Fields;
+
       /**
        * sol::protected_function wrapper
        */
       class GenericCallback
       {
         public:
-          GenericCallback(sol::protected_function func)
+          GenericCallback(sol::protected_function func, sol::reference* event, const Fields& fields = Fields())
             : mFunc(func)
-            , mState(func.lua_state()) {};
+            , mState(func.lua_state())
+            , mEvent(event)
+            , mFields(fields)
+            , mRemoved(false) {};
 
           virtual ~GenericCallback() {};
           /**
@@ -58,15 +68,14 @@ namespace Gsage {
           }
 
           /**
-           * Calls underlying lua callback
+           * Calls underlying lua callback.
+           * Event object is shared between all callbacks of the same event type and is reused on each call,
+           * so it should not be stored by the lua function.
            *
            * @param event Event to process
-           * @returnds sol::protected_function_result
+           * @returns false if the lua function failed
            */
-          virtual sol::protected_function_result operator()(const Event& event)
-          {
-            return mFunc(std::ref(event));
-          }
+          bool operator()(const Event& event);
 
           operator const sol::protected_function&() const {
             return mFunc;
@@ -81,9 +90,45 @@ namespace Gsage {
             return mFunc;
           }
 
+          /**
+           * Callback was removed while the event was being dispatched
+           */
+          bool removed() const
+          {
+            return mRemoved;
+          }
+
+          void setRemoved()
+          {
+            mRemoved = true;
+          }
+
         protected:
+          /**
+           * Cast event to the type, expected by the lua function
+           *
+           * @param event Event to cast
+           */
+          virtual const void* cast(const Event& event) const
+          {
+            return &event;
+          }
+
+          /**
+           * Create lua object for the event
+           *
+           * @param event Event to wrap
+           */
+          virtual sol::reference wrap(const Event& event) const
+          {
+            return sol::make_reference(mState, &event);
+          }
+
           sol::protected_function mFunc;
           lua_State* mState;
+          sol::reference* mEvent;
+          Fields mFields;
+          bool mRemoved;
       };
 
       /**
@@ -93,24 +138,34 @@ namespace Gsage {
       class Callback : public GenericCallback
       {
         public:
-          Callback(sol::protected_function func) : GenericCallback(func) {}
+          Callback(sol::protected_function func, sol::reference* event, const Fields& fields = Fields())
+            : GenericCallback(func, event, fields) {}
           virtual ~Callback() {}
-          /**
-           * Calls underlying lua callback
-           *
-           * @param event Event to process (will be cast to the particular templated event).
-           * @returns sol::protected_function_result
-           */
-          virtual sol::protected_function_result operator()(const Event& event)
+        protected:
+          virtual const void* cast(const Event& event) const
+          {
+            return static_cast<const T*>(&event);
+          }
+
+          virtual sol::reference wrap(const Event& event) const
           {
-            return mFunc(std::ref(static_cast<const T&>(event)));
+            return sol::make_reference(mState, static_cast<const T*>(&event));
           }
       };
 
-      typedef std::shared_ptr<GenericCallback> GenericCallbackPtr;
-      typedef std::pair<EventDispatcher*, const Event::Type> CallbackBinding;
+      typedef std::unique_ptr<GenericCallback> GenericCallbackPtr;
+      typedef std::pair<EventDispatcher*, Event::TypeId> CallbackBinding;
       typedef std::vector<GenericCallbackPtr> Callbacks;
-      typedef std::map<CallbackBinding, Callbacks> CallbackBindings;
+
+      struct CallbackBindingHash
+      {
+        size_t operator()(const CallbackBinding& binding) const
+        {
+          return std::hash<EventDispatcher*>()(binding.first) ^ ((size_t)binding.second * 0x9E3779B9u);
+        }
+      };
+
+      typedef std::unordered_map<CallbackBinding, Callbacks, CallbackBindingHash> CallbackBindings;
 
       LuaEventProxy();
       virtual ~LuaEventProxy();
@@ -124,6 +179,17 @@ namespace Gsage {
        */
       bool addEventListener(EventDispatcher* dispatcher, Event::ConstType eventType, const sol::object& callback);
 
+      /**
+       * Adds event listener, that gets event fields as arguments instead of the event object
+       *
+       * @param dispatcher Object that dispatches the event
+       * @param eventType Event id
+       * @param callback Lua object that is called on event dispatch
+       * @param fields List of event fields to pass
+       * @returns true if the callback was added successfully
+       */
+      bool addUnpackedEventListener(EventDispatcher* dispatcher, Event::ConstType eventType, const sol::object& callback, const sol::table& fields);
+
       /**
        * @copydoc LuaEventProxy::addEventListener
        */
@@ -133,10 +199,24 @@ namespace Gsage {
         if(callback.get_type() != sol::type::function)
           return false;
 
-        Callbacks* cb = getCallbacks(dispatcher, eventType);
-        Callbacks& callbacks = cb != 0 ? *cb : subscribe(dispatcher, eventType);
-        GenericCallback* c = new Callback<T>(callback.as<sol::protected_function>());
-        callbacks.push_back(GenericCallbackPtr(c));
+        getCallbacks(dispatcher, eventType, true)->emplace_back(
+            new Callback<T>(callback.as<sol::protected_function>(), getEventObject<T>())
+        );
+        return true;
+      }
+
+      /**
+       * @copydoc LuaEventProxy::addUnpackedEventListener
+       */
+      template<class T>
+      bool addUnpackedEventListener(EventDispatcher* dispatcher, Event::ConstType eventType, const sol::object& callback, const sol::table& fields)
+      {
+        if(callback.get_type() != sol::type::function)
+          return false;
+
+        getCallbacks(dispatcher, eventType, true)->emplace_back(
+            new Callback<T>(callback.as<sol::protected_function>(), getEventObject<T>(), readFields(fields))
+        );
         return true;
       }
 
@@ -154,8 +234,9 @@ namespace Gsage {
        * Get callbacks for binding
        * @param dispatcher Object that dispatches the event
        * @param eventType Event id
+       * @param create Subscribe to the event if there are no callbacks yet
        */
-      Callbacks* getCallbacks(EventDispatcher* dispatcher, Event::ConstType eventType);
+      Callbacks* getCallbacks(EventDispatcher* dispatcher, Event::ConstType eventType, bool create = false);
 
       /**
        * Overriding standard callback which is called on dispatcher deletion
@@ -170,16 +251,38 @@ namespace Gsage {
        * @param event Any event
        */
       bool handleEvent(EventDispatcher* sender, const Event& event);
+
       /**
-       * Add c++ event listener to the event
-       *
-       * @param dispatcher Event dispatcher
-       * @param eventType Event id
-       * @returns list of callbacks
+       * Remove callbacks, that were unbound during the event dispatch
        */
-      Callbacks& subscribe(EventDispatcher* dispatcher, Event::ConstType eventType);
+      void cleanup();
+
+      /**
+       * Get shared lua event object slot for the event type
+       */
+      template<class T>
+      sol::reference* getEventObject()
+      {
+        // unordered_map never moves the values, so callbacks can keep the pointer
+        return &mEventObjects[std::type_index(typeid(T))];
+      }
+
+      /**
+       * Convert lua list of field names
+       */
+      Fields readFields(const sol::table& fields) const;
 
       CallbackBindings mCallbackBindings;
+
+      typedef std::unordered_map<std::type_index, sol::reference> EventObjects;
+      EventObjects mEventObjects;
+
+      // callbacks of the events being dispatched, nested dispatch appends to the end
+      std::vector<GenericCallback*> mDispatchStack;
+      // callbacks of the dispatchers, removed during the event dispatch
+      Callbacks mRemoved;
+      int mDispatching;
+      bool mDirty;
   };
 }
 
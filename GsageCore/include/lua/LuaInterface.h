@@ -251,7 +251,10 @@ namespace Gsage
         sol::state_view& lua = *mStateView;
 
         lua.set_usertype(name, ut);
-        lua["LuaEventProxy"][handler] = &LuaEventProxy::addEventListener<T>;
+        lua["LuaEventProxy"][handler] = sol::overload(
+            &LuaEventProxy::addEventListener<T>,
+            &LuaEventProxy::addUnpackedEventListener<T>
+        );
       }
 
       template<typename C, typename... Args>
@@ -272,7 +275,10 @@ namespace Gsage
         sol::state_view& lua = *mStateView;
         lua.new_usertype<C>(name, std::forward<Args>(args)...);
         lua["LuaEventConnection"][handler] = &LuaEventConnection::bind<C>;
-        lua["LuaEventProxy"][handler] = &LuaEventProxy::addEventListener<C>;
+        lua["LuaEventProxy"][handler] = sol::overload(
+            &LuaEventProxy::addEventListener<C>,
+            &LuaEventProxy::addUnpackedEventListener<C>
+        );
       }
     private:
       void closeLuaState();
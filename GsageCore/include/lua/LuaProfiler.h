@@ -0,0 +1,276 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _LuaProfiler_H_
+#define _LuaProfiler_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+
+struct lua_State;
+struct lua_Debug;
+
+namespace Gsage {
+  /**
+   * Sampling profiler for lua code.
+   *
+   * Uses lua count hook: each N instructions the hook checks the clock and takes a sample
+   * once per sampling interval. Sample is the lua call stack, it is aggregated by function, by source line
+   * and by the whole stack, which can be exported in the folded stacks format, used by flame graph tools.
+   *
+   * C++ code, which calls lua, can mark the calls with scopes: each scope counts calls, time spent in lua
+   * and, optionally, calls from lua back to C functions.
+   *
+   * LuaJIT hooks are global, so coroutines are sampled as well. JIT compiled traces do not call hooks,
+   * so the code, which runs in traces, is underrepresented.
+   * Only one profiler can run at a time.
+   */
+  class LuaProfiler
+  {
+    public:
+      typedef std::chrono::steady_clock Clock;
+
+      enum : uint32_t {
+        /**
+         * Deepest stack level to sample
+         */
+        MAX_DEPTH = 64,
+        /**
+         * Scope id for calls outside of any scope
+         */
+        NO_SCOPE = 0xFFFFFFFF
+      };
+
+      struct FunctionStats
+      {
+        // function name, as it was called when seen first time
+        std::string name;
+        std::string source;
+        int line;
+        // samples, where the function was running
+        size_t selfSamples;
+        // samples, where the function was on the stack
+        size_t totalSamples;
+      };
+
+      struct LineStats
+      {
+        uint32_t function;
+        int line;
+        size_t samples;
+      };
+
+      struct ScopeStats
+      {
+        std::string name;
+        // C++ to lua calls
+        size_t calls;
+        // lua to C function calls, counted if native call counting is enabled
+        size_t nativeCalls;
+        size_t samples;
+        // seconds spent in the scope
+        double time;
+      };
+
+      LuaProfiler();
+      virtual ~LuaProfiler();
+
+      /**
+       * Set lua state to profile, stops profiling of the previous state
+       *
+       * @param L lua state
+       */
+      void setState(lua_State* L);
+
+      /**
+       * Start sampling
+       *
+       * @param interval Sampling interval in seconds
+       * @param instructions Count of lua instructions between clock checks
+       * @returns false if there is no lua state or another profiler is running
+       */
+      bool start(double interval = 0.001, int instructions = 1000);
+
+      /**
+       * Stop sampling, collected data is kept
+       */
+      void stop();
+
+      /**
+       * Check if the profiler is running
+       */
+      bool isRunning() const;
+
+      /**
+       * Get the running profiler
+       *
+       * @returns 0 if no profiler is running
+       */
+      static LuaProfiler* getActive();
+
+      /**
+       * Remove collected data, registered scopes are kept
+       */
+      void reset();
+
+      /**
+       * Count lua to C function calls per scope. Call hook makes each call slower, so it is disabled by default.
+       * Applied on start
+       *
+       * @param value Enable counting
+       */
+      void setCountNativeCalls(bool value);
+
+      /**
+       * Check if native calls counting is enabled
+       */
+      bool getCountNativeCalls() const;
+
+      /**
+       * Register scope
+       *
+       * @param name Scope name
+       * @returns scope id, the same id for the same name
+       */
+      uint32_t getScope(const std::string& name);
+
+      /**
+       * Mark the start of C++ to lua call
+       *
+       * @param scope Scope id
+       */
+      void enterScope(uint32_t scope);
+
+      /**
+       * Mark the end of the call, started by enterScope
+       */
+      void leaveScope();
+
+      /**
+       * Get total count of samples
+       */
+      size_t getSampleCount() const;
+
+      /**
+       * Get sampled functions, function id is the index in this list
+       */
+      const std::vector<FunctionStats>& getFunctions() const;
+
+      /**
+       * Get samples by source line, sorted by samples count
+       */
+      std::vector<LineStats> getLines() const;
+
+      /**
+       * Get registered scopes, scope id is the index in this list
+       */
+      const std::vector<ScopeStats>& getScopes() const;
+
+      /**
+       * Get function display name: name source:line
+       *
+       * @param function Function id
+       */
+      std::string getFunctionName(uint32_t function) const;
+
+      /**
+       * Get collected stacks in folded format: scope;outer function;inner function samples, one stack per line
+       */
+      std::string getFoldedStacks() const;
+
+      /**
+       * Write folded stacks to the file
+       *
+       * @param path File path
+       * @returns false if failed to write the file
+       */
+      bool saveFoldedStacks(const std::string& path) const;
+    private:
+      static void hook(lua_State* L, lua_Debug* ar);
+
+      /**
+       * Walk lua stack and aggregate it
+       */
+      void sample(lua_State* L);
+
+      /**
+       * Get id of the function, described by ar
+       */
+      uint32_t getFunctionId(lua_State* L, lua_Debug* ar);
+
+      static LuaProfiler* mActive;
+
+      lua_State* mState;
+      bool mRunning;
+      bool mCountNativeCalls;
+      Clock::duration mInterval;
+      Clock::time_point mNextSample;
+      size_t mSampleCount;
+
+      struct FunctionKey
+      {
+        const void* source;
+        int line;
+
+        bool operator==(const FunctionKey& other) const
+        {
+          return source == other.source && line == other.line;
+        }
+      };
+
+      struct FunctionKeyHash
+      {
+        size_t operator()(const FunctionKey& key) const
+        {
+          return std::hash<const void*>()(key.source) ^ ((size_t)key.line * 0x9E3779B9u);
+        }
+      };
+
+      std::vector<FunctionStats> mFunctions;
+      std::unordered_map<FunctionKey, uint32_t, FunctionKeyHash> mFunctionIds;
+      // function id in the high bits, line in the low bits
+      std::unordered_map<uint64_t, size_t> mLines;
+      // stack key: scope id followed by function ids, outermost first
+      std::map<std::vector<uint32_t>, size_t> mStacks;
+      std::vector<uint32_t> mStack;
+
+      std::vector<ScopeStats> mScopes;
+      std::unordered_map<std::string, uint32_t> mScopeIds;
+
+      struct ActiveScope
+      {
+        uint32_t id;
+        Clock::time_point start;
+      };
+      std::vector<ActiveScope> mActiveScopes;
+  };
+}
+
+#endif
@@ -0,0 +1,153 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _LuaScriptCache_H_
+#define _LuaScriptCache_H_
+
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "sol_forward.hpp"
+
+struct lua_State;
+
+namespace Gsage {
+  /**
+   * Cache of compiled lua chunks, keyed by the script path.
+   *
+   * Each chunk is compiled once and then reused while the file modification time stays the same.
+   * If there is a precompiled file (script.luac for script.lua), which is not older than the source,
+   * bytecode is loaded from it instead of parsing the source.
+   *
+   * Chunks are kept as loaded functions and as bytecode: bytecode survives lua state change,
+   * so scripts are not parsed again after the state is recreated.
+   */
+  class LuaScriptCache
+  {
+    public:
+      /**
+       * Extension of precompiled scripts
+       */
+      static const std::string COMPILED_EXTENSION;
+
+      LuaScriptCache();
+      virtual ~LuaScriptCache();
+
+      /**
+       * Set lua state to load chunks into
+       *
+       * @param L lua state
+       */
+      void setState(lua_State* L);
+
+      /**
+       * Get compiled chunk
+       *
+       * @param path Path to the script
+       * @returns invalid function if the script could not be loaded
+       */
+      sol::protected_function load(const std::string& path);
+
+      /**
+       * Install package loader, that loads required modules through the cache.
+       * Modules are searched using package.path, precompiled files are picked the same way as for load
+       */
+      void installLoader();
+
+      /**
+       * Get path of the precompiled script
+       *
+       * @param path Path to the script source
+       */
+      static std::string getCompiledPath(const std::string& path);
+
+      /**
+       * Remove the package loader, installed by installLoader
+       */
+      void uninstallLoader();
+
+      /**
+       * Remove all cached chunks
+       */
+      void clear();
+
+      /**
+       * Get count of cached chunks
+       */
+      size_t size() const;
+
+      /**
+       * Get count of chunks compiled from source or loaded from files
+       */
+      size_t getCompileCount() const;
+    private:
+      struct Entry
+      {
+        Entry();
+
+        // modification times of source and precompiled files in nanoseconds, 0 if there is no file
+        int64_t sourceTime;
+        int64_t compiledTime;
+        // file system timestamps can be coarse, so size is checked as well
+        size_t sourceSize;
+        std::string bytecode;
+        int ref;
+      };
+
+      /**
+       * Push the chunk to the lua stack
+       *
+       * @returns false if failed to load the chunk, error message is logged
+       */
+      bool push(const std::string& path);
+
+      /**
+       * Load chunk from the file or the bytecode and push it to the lua stack
+       */
+      bool compile(const std::string& path, Entry& entry, bool useBytecode);
+
+      /**
+       * Package loader function, the cache is passed as upvalue
+       */
+      static int searchModule(lua_State* L);
+
+      /**
+       * Find the module in package.path and push its chunk to the stack of L
+       *
+       * @returns 1 if the module was found, 0 if not, -1 if it failed to load (error message is pushed)
+       */
+      int findModule(lua_State* L, const std::string& name);
+
+      typedef std::unordered_map<std::string, Entry> Entries;
+      Entries mEntries;
+
+      lua_State* mState;
+      size_t mCompileCount;
+      int mLoaderRef;
+  };
+}
+
+#endif
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include <string>
 #include <stdexcept>
 #include <memory>
+#include <vector>
 
 #include "Converters.h"
 #include "Logger.h"
@@ -180,6 +181,23 @@ namespace Gsage {
        */
       virtual const DataWrapper* getChildAt(int index) const = 0;
 
+      /**
+       * Find descendant object by the list of keys.
+       * Stops at the last existing object, intermediate objects are not wrapped.
+       * Returned wrapper may reference the data of this wrapper, so it should not outlive it
+       *
+       * @param keys keys from this object down
+       * @returns 0 if the first key does not exist
+       */
+      virtual DataWrapper* getDescendant(const std::vector<std::string>& keys);
+
+      /**
+       * Create descendant objects for each key, intermediate objects are not wrapped.
+       *
+       * @param keys keys from this object down, not empty
+       */
+      virtual DataWrapper* createDescendant(const std::vector<std::string>& keys);
+
       /**
        * Swap DataWrapper data with an other value.
        *
@@ -200,6 +218,15 @@ namespace Gsage {
        */
       virtual bool fromString(const std::string& s);
 
+      /**
+       * Fill data by parsing raw buffer, without copying it into a string first
+       *
+       * @param data buffer to parse
+       * @param size buffer size
+       * @returns true if succeed
+       */
+      virtual bool fromBuffer(const char* data, size_t size);
+
       /**
        * Get underlying concrete wrapper type
        */
@@ -226,6 +253,12 @@ namespace Gsage {
 
       template<typename C>
       bool read(const C* dw, const std::string& key, T& dest) const {
+        NumericArray array;
+        if(HasNumericCaster<T>::value && dw->readArray(key, array)) {
+          return typename TranslatorBetween<NumericArray, T>::type().to(array, dest);
+        }
+
+        // fallback to string parsing
         std::string value;
         if(dw->readExact(key, value)) {
           return typename TranslatorBetween<std::string, T>::type().to(value, dest);
@@ -239,6 +272,11 @@ namespace Gsage {
 
       template<typename C>
       bool read(const C* dw, T& dest) const {
+        NumericArray array;
+        if(HasNumericCaster<T>::value && dw->readArray(array)) {
+          return typename TranslatorBetween<NumericArray, T>::type().to(array, dest);
+        }
+
         std::string value;
         if(dw->readExact(value)) {
           return typename TranslatorBetween<std::string, T>::type().to(value, dest);
@@ -249,16 +287,28 @@ namespace Gsage {
 
       template<typename C>
       void dump(C* dw, const std::string& key, const T& value) const {
+        if(HasNumericCaster<T>::value) {
+          dw->putArray(key, typename TranslatorBetween<NumericArray, T>::type().from(value));
+          return;
+        }
         dw->put(key, typename TranslatorBetween<std::string, T>::type().from(value));
       }
 
       template<typename C>
       void dump(C* dw, int key, const T& value) const {
+        if(HasNumericCaster<T>::value) {
+          dw->putArray(key, typename TranslatorBetween<NumericArray, T>::type().from(value));
+          return;
+        }
         dw->put(key, typename TranslatorBetween<std::string, T>::type().from(value));
       }
 
       template<typename C>
       void dump(C* dw, const T& value) const {
+        if(HasNumericCaster<T>::value) {
+          dw->setArray(typename TranslatorBetween<NumericArray, T>::type().from(value));
+          return;
+        }
         dw->set(typename TranslatorBetween<std::string, T>::type().from(value));
       }
   };
@@ -170,6 +170,51 @@ namespace Gsage {
         return readString(getObject()[key], dest);
       }
 
+      /**
+       * Read array of numbers
+       *
+       * @param key child key
+       * @param dest destination
+       */
+      bool readArray(const std::string& key, NumericArray& dest) const {
+        return readNumbers(getObject()[key], dest);
+      }
+
+      /**
+       * Read this object as array of numbers
+       *
+       * @param dest destination
+       */
+      bool readArray(NumericArray& dest) const {
+        return readNumbers(getObject(), dest);
+      }
+
+      /**
+       * Put array of numbers
+       *
+       * @param key child key
+       * @param value numbers
+       */
+      void putArray(const std::string& key, const NumericArray& value) {
+        writeNumbers(getObject()[key], value);
+      }
+
+      /**
+       * @copydoc putArray(key, value)
+       */
+      void putArray(int key, const NumericArray& value) {
+        writeNumbers(getObject()[key], value);
+      }
+
+      /**
+       * Set this object to array of numbers
+       *
+       * @param value numbers
+       */
+      void setArray(const NumericArray& value) {
+        writeNumbers(getObject(), value);
+      }
+
       int size() const {
         return getObject().size();
       }
@@ -220,15 +265,25 @@ namespace Gsage {
 
       virtual const DataWrapper* getChildAt(int key) const;
 
+      virtual DataWrapper* getDescendant(const std::vector<std::string>& keys);
+
+      virtual DataWrapper* createDescendant(const std::vector<std::string>& keys);
+
       Type getStoredType();
 
       std::string toString() const;
 
       bool fromString(const std::string& s);
+
+      bool fromBuffer(const char* data, size_t size);
     private:
 
       bool readString(const Json::Value& value, std::string& dest) const;
 
+      bool readNumbers(const Json::Value& value, NumericArray& dest) const;
+
+      void writeNumbers(Json::Value& dest, const NumericArray& value);
+
       Json::Value* mObject;
 
       bool mSelfAllocatedObject;
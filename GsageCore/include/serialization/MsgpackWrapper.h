@@ -0,0 +1,368 @@
+#ifndef _MsgpackWrapper_H_
+#define _MsgpackWrapper_H_
+
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2017 Gsage Authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include <unordered_map>
+#include <vector>
+
+#include <msgpack.hpp>
+
+#include "serialization/DataWrapper.h"
+
+namespace Gsage {
+
+  /**
+   * Reads msgpack data directly from the unpacked zone.
+   *
+   * Strings are not copied on load: unpacked objects reference the buffer stored in the zone.
+   * Modifications allocate new objects in the same zone.
+   *
+   * Storage of the replaced and grown arrays and maps is reused by the later modifications,
+   * but strings and packed buffers stay in the zone until the document is released.
+   * The wrapper is meant for load-mostly data: state which is modified all the time should be kept in JSON.
+   * Unpacking into the root wrapper which has no children alive starts a new document.
+   */
+  class MsgpackWrapper : public DataWrapper
+  {
+    public:
+      /**
+       * Unpacked data, shared by the root wrapper and all the children
+       */
+      struct Document
+      {
+        Document();
+
+        /**
+         * Allocate storage for the array or the map, reuses released blocks
+         *
+         * @param count Number of elements
+         */
+        template<class T>
+        T* allocate(uint32_t count);
+
+        /**
+         * Return array or map storage for reuse
+         *
+         * @param ptr Storage
+         * @param size Number of elements, used if the storage was not allocated by the document
+         */
+        template<class T>
+        void deallocate(T* ptr, uint32_t size);
+
+        /**
+         * Return storage of all arrays and maps in the object for reuse
+         */
+        void release(msgpack::object& object);
+
+        msgpack::zone zone;
+        msgpack::object* root;
+        // sizes of the array and map blocks allocated by the document, in bytes
+        std::unordered_map<const void*, size_t> blockSizes;
+        // released blocks, by the power of two of the block size in bytes
+        std::vector<void*> freeBlocks[64];
+        // incremented on each modification, children resolve their objects again when it changes
+        unsigned int generation;
+      };
+
+      typedef std::shared_ptr<Document> DocumentPtr;
+
+      /**
+       * Keys from the root to the wrapped object.
+       * Map keys reference the strings in the zone, array indices are stored as integer objects
+       */
+      typedef std::vector<msgpack::object> Path;
+
+      class iterator : public DataWrapper::iterator
+      {
+        public:
+          iterator(MsgpackWrapper* wrapper, uint32_t index);
+
+          virtual ~iterator();
+
+          void update();
+
+          virtual void increment();
+
+          virtual bool operator==(const self_type& rhs);
+
+          virtual bool operator!=(const self_type& rhs);
+        private:
+          MsgpackWrapper* mWrapper;
+          MsgpackWrapper* mCurrentValue;
+          uint32_t mIndex;
+      };
+
+      MsgpackWrapper(bool allocate = false);
+      MsgpackWrapper(DocumentPtr document, Path path, msgpack::object* object);
+      virtual ~MsgpackWrapper();
+
+      template<typename T>
+      void put(const std::string& key, const T& value)
+      {
+        CastHandler<T>().dump(this, key, value);
+      }
+
+      template<typename T>
+      void put(int key, const T& value)
+      {
+        CastHandler<T>().dump(this, key, value);
+      }
+
+      void put(const std::string& key, const char* value)
+      {
+        put(key, std::string(value));
+      }
+
+      void put(const std::string& key, const std::string& value);
+
+      void put(int key, const char* value)
+      {
+        put(key, std::string(value));
+      }
+
+      void put(int key, const std::string& value);
+
+      void set(const std::string& value);
+
+      void set(const char* value)
+      {
+        set(std::string(value));
+      }
+
+      template<typename T>
+      void set(const T& value)
+      {
+        CastHandler<T>().dump(this, value);
+      }
+
+      template<typename T>
+      bool read(const std::string& key, T& dest) const
+      {
+        if(!readExact(key, dest)) {
+          try {
+            return CastHandler<T>().read(this, key, dest);
+          } catch (...) {
+            LOG(WARNING) << "Exception in cast handler when trying to read msgpack object " << key;
+            return false;
+          }
+        }
+        return true;
+      }
+
+      template<typename T>
+      bool readExact(const std::string& key, T& dest) const
+      {
+        const msgpack::object* object = find(key);
+        return object != 0 && readValue(*object, dest);
+      }
+
+      template<typename T>
+      bool read(T& dest) const
+      {
+        if(!readExact(dest)) {
+          try {
+            return CastHandler<T>().read(this, dest);
+          } catch (...) {
+            LOG(WARNING) << "Exception in cast handler when trying to read msgpack object";
+            return false;
+          }
+        }
+        return true;
+      }
+
+      template<typename T>
+      bool readExact(T& dest) const
+      {
+        const msgpack::object* object = getObject();
+        return object != 0 && readValue(*object, dest);
+      }
+
+      template<typename T>
+      bool readValue(const msgpack::object& object, T& dest) const {
+        return false;
+      }
+
+      /**
+       * Read array of numbers
+       *
+       * @param key child key
+       * @param dest destination
+       */
+      bool readArray(const std::string& key, NumericArray& dest) const;
+
+      /**
+       * Read this object as array of numbers
+       *
+       * @param dest destination
+       */
+      bool readArray(NumericArray& dest) const;
+
+      /**
+       * Put array of numbers
+       *
+       * @param key child key
+       * @param value numbers
+       */
+      void putArray(const std::string& key, const NumericArray& value);
+
+      /**
+       * @copydoc putArray(key, value)
+       */
+      void putArray(int key, const NumericArray& value);
+
+      /**
+       * Set this object to array of numbers
+       *
+       * @param value numbers
+       */
+      void setArray(const NumericArray& value);
+
+      int size() const;
+
+      int count(const std::string& key) const;
+
+      iteratorPtr begin();
+
+      iteratorPtr end();
+
+      /**
+       * Get wrapped object, resolves it again if the document was modified
+       *
+       * @returns 0 if the object no longer exists
+       */
+      msgpack::object* getObject();
+
+      /**
+       * @copydoc getObject()
+       */
+      const msgpack::object* getObject() const;
+
+      bool putChild(const std::string& key, DataWrapper& value);
+
+      bool putChild(int key, DataWrapper& value);
+
+      virtual DataWrapper* createChildAt(const std::string& key);
+
+      virtual DataWrapper* createChildAt(int key);
+
+      virtual const DataWrapper* getChildAt(const std::string& key) const;
+
+      virtual const DataWrapper* getChildAt(int key) const;
+
+      virtual DataWrapper* getDescendant(const std::vector<std::string>& keys);
+
+      virtual DataWrapper* createDescendant(const std::vector<std::string>& keys);
+
+      Type getStoredType();
+
+      /**
+       * Pack wrapped object to msgpack string
+       */
+      std::string toString() const;
+
+      /**
+       * Unpack msgpack string
+       */
+      bool fromString(const std::string& s);
+
+      /**
+       * Unpack msgpack buffer
+       */
+      bool fromBuffer(const char* data, size_t size);
+
+      void makeArray();
+    private:
+      /**
+       * Find value in the map by key, without allocating the key string
+       */
+      const msgpack::object* find(const std::string& key) const;
+
+      /**
+       * Assign value to the key, appends new key if it does not exist
+       */
+      msgpack::object_kv* assign(const std::string& key, const msgpack::object& value);
+
+      /**
+       * Assign value to the key of the object in the document, appends new key if it does not exist
+       */
+      msgpack::object_kv* assign(msgpack::object* object, const std::string& key, const msgpack::object& value);
+
+      /**
+       * Assign value to the array index, grows the array if needed
+       */
+      msgpack::object* assign(int key, const msgpack::object& value);
+
+      /**
+       * Replace wrapped object
+       */
+      void assign(const msgpack::object& value);
+
+      /**
+       * Create array of floats in the document zone
+       */
+      msgpack::object createArray(const NumericArray& value);
+
+      /**
+       * Copy object and all nested objects to the document zone
+       */
+      void copy(const msgpack::object& src, msgpack::object& dest);
+
+      template<class T>
+      T* grow(T* ptr, uint32_t size, uint32_t required);
+
+      DocumentPtr mDocument;
+      Path mPath;
+      mutable msgpack::object* mObject;
+      mutable unsigned int mGeneration;
+  };
+
+#define _PRIMITIVE_TYPE_SPECIALIZATION(T) \
+  template<> \
+  bool MsgpackWrapper::readValue<T>(const msgpack::object& object, T& dest) const; \
+  \
+  template<> \
+  void MsgpackWrapper::put<T>(const std::string& key, const T& value); \
+  \
+  template<> \
+  void MsgpackWrapper::put<T>(int key, const T& value); \
+  \
+  template<> \
+  void MsgpackWrapper::set<T>(const T& value);
+
+  _PRIMITIVE_TYPE_SPECIALIZATION(int)
+  _PRIMITIVE_TYPE_SPECIALIZATION(unsigned int)
+  _PRIMITIVE_TYPE_SPECIALIZATION(double)
+  _PRIMITIVE_TYPE_SPECIALIZATION(float)
+  _PRIMITIVE_TYPE_SPECIALIZATION(bool)
+#undef _PRIMITIVE_TYPE_SPECIALIZATION
+
+  template<>
+  bool MsgpackWrapper::readValue<std::string>(const msgpack::object& object, std::string& dest) const;
+}
+
+#endif
@@ -132,6 +132,28 @@ namespace Gsage {
         return false;
       }
 
+      /**
+       * Read lua array of numbers
+       *
+       * @param key child key
+       * @param dest destination
+       */
+      bool readArray(const std::string& key, NumericArray& dest) const
+      {
+        sol::optional<sol::table> res = mObject[key];
+        return res && readNumbers(res.value(), dest);
+      }
+
+      /**
+       * Read this table as array of numbers
+       *
+       * @param dest destination
+       */
+      bool readArray(NumericArray& dest) const
+      {
+        return readNumbers(mObject, dest);
+      }
+
       template<typename T>
       void set(const T& value)
       {
@@ -165,6 +187,10 @@ namespace Gsage {
 
       virtual const DataWrapper* getChildAt(int key) const;
 
+      virtual DataWrapper* getDescendant(const std::vector<std::string>& keys);
+
+      virtual DataWrapper* createDescendant(const std::vector<std::string>& keys);
+
       virtual Type getStoredType() const;
 
       virtual Type getStoredType();
@@ -176,6 +202,8 @@ namespace Gsage {
        */
       typedef std::map<sol::type, Type> TypeMap;
 
+      bool readNumbers(sol::table table, NumericArray& dest) const;
+
       sol::table mObject;
 
       template<class K>
@@ -43,12 +43,29 @@ namespace Gsage
       virtual ~CombatSystem();
 
       /**
-       * Update stats component
+       * Update stats component: posts batched stat change events to the event queue
        * @param component StatsComponent pointer
        * @param entity Entity that owns the component
        * @param time Elapsed time
        */
       void updateComponent(StatsComponent* component, Entity* entity, const double& time);
+
+      /**
+       * Reads "queueEvents" setting: if enabled, stat change events are queued
+       * in the engine event queue and coalesced per stat id
+       *
+       * @param config DataProxy with settings
+       */
+      bool configure(const DataProxy& config);
+    protected:
+      /**
+       * Attaches the engine event queue to the component if queued events are enabled
+       *
+       * @param component StatsComponent
+       */
+      bool prepareComponent(StatsComponent* component);
+    private:
+      bool mQueueEvents;
   };
 }
 
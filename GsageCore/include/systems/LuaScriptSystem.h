@@ -31,6 +31,9 @@ THE SOFTWARE.
 #include "systems/SystemFactory.h"
 #include "lua/LuaInterface.h"
 #include "Engine.h"
+#include "TimerWheel.h"
+#include "lua/LuaScriptCache.h"
+#include "lua/LuaProfiler.h"
 #include "sol_forward.hpp"
 
 struct lua_State;
@@ -80,6 +83,17 @@ namespace Gsage
        */
       void update(const double& time);
 
+      /**
+       * Update a chunk of script components.
+       * Behavior trees of all components are collected and updated by a single btree.updateAll call
+       *
+       * @param components Pointer to the first component in the chunk
+       * @param count Component count
+       * @param time Elapsed time
+       * @param scratch Chunk scratch allocator
+       */
+      void updateChunk(ScriptComponent** components, size_t count, const double& time, ScratchAllocator& scratch);
+
       /**
        * Override script component update logic
        *
@@ -141,22 +155,116 @@ namespace Gsage
        * Unload components.
        */
       void unloadComponents();
+
+      /**
+       * Suspend the calling coroutine for the specified time.
+       * Coroutine should yield after this call, it is resumed by the script system when the time passes
+       *
+       * @param state Calling coroutine
+       * @param seconds Time to wait
+       * @returns false if called from the main thread
+       */
+      bool waitSeconds(sol::this_state state, double seconds);
+
+      /**
+       * Check if the coroutine waits for the timer
+       *
+       * @param co Coroutine
+       */
+      bool isSleeping(const sol::object& co);
+
+      /**
+       * Get time left until the coroutine is woken up
+       *
+       * @param co Coroutine
+       * @returns 0 if the coroutine does not wait
+       */
+      double getSleepTime(const sol::object& co);
+
+      /**
+       * Get count of coroutines waiting for the timer
+       */
+      size_t getSleepingCount() const;
+
+      /**
+       * Get lua sampling profiler.
+       * When it is running, update listeners, behavior trees and timers are tracked as separate scopes
+       */
+      LuaProfiler* getProfiler();
     private:
       struct Listener
       {
         Listener(sol::protected_function function, bool global)
           : function(function)
           , global(global)
+          , scope(LuaProfiler::NO_SCOPE)
         {}
 
         sol::protected_function function;
         bool global;
+        // profiler scope, resolved when the listener is called with the profiler running
+        uint32_t scope;
       };
 
-      std::string getScriptData(const std::string& data);
+      /**
+       * Get profiler scope of the update listener, named after the function definition
+       *
+       * @param listener Update listener
+       */
+      uint32_t getListenerScope(Listener& listener);
+
+      /**
+       * Get compiled script chunk, @File:path scripts are taken from the script cache
+       *
+       * @param data: script or @File:path
+       * @returns invalid function if failed to load the script
+       */
+      sol::protected_function loadScript(const std::string& data);
+
+      /**
+       * Run setup scripts and create behavior tree of the component, if they were not done yet
+       *
+       * @param component ScriptComponent
+       * @returns true if the component has a behavior tree to update
+       */
+      bool setupComponent(ScriptComponent* component);
+
+      /**
+       * Update behavior trees of the components in a single lua call
+       *
+       * @param components Pointer to the first component
+       * @param count Component count
+       * @param time Elapsed time
+       */
+      void updateBehaviors(ScriptComponent** components, size_t count, const double& time);
+
+      /**
+       * Get cached btree library functions, looks them up on the first call
+       */
+      bool resolveBtreeFunctions();
 
       sol::state_view* mState;
 
+      sol::protected_function mInitializeBtree;
+      sol::protected_function mDeinitializeBtree;
+      sol::protected_function mUpdateBtrees;
+
+      // reused between frames: trees passed to btree.updateAll and sleep time of each of them
+      sol::table mBatch;
+      sol::table mSleepTimes;
+      size_t mBatchSize;
+      std::vector<PoolHandle> mBatchHandles;
+
+      bool mSkipSuspended;
+
+      // coroutines waiting for the timer, sleeping table maps coroutine to the timer entry index
+      TimerWheel mTimers;
+      sol::table mSleeping;
+
+      LuaScriptCache mScripts;
+
+      LuaProfiler mProfiler;
+
       typedef std::vector<Listener> UpdateListeners;
       UpdateListeners mUpdateListeners;
 
@@ -25,10 +25,15 @@ THE SOFTWARE.
 */
 
 #include "Component.h"
+#include "Entity.h"
 
 using namespace Gsage;
 
 EntityComponent::EntityComponent()
+  : mOwner(0)
+  , mDirty(true)
+  , mTracksChanges(false)
+  , mReadsResolvedProperties(false)
 {
 }
 
@@ -45,3 +50,32 @@ Entity* EntityComponent::getOwner()
 {
   return mOwner;
 }
+
+bool EntityComponent::read(const DataProxy& dict)
+{
+  setDirty();
+  return Serializable<EntityComponent>::read(dict);
+}
+
+bool EntityComponent::read(const DataProxy& dict, const std::string& id)
+{
+  setDirty();
+  return Serializable<EntityComponent>::read(dict, id);
+}
+
+bool EntityComponent::read(const ResolvedProperties& properties, const DataProxy& dict)
+{
+  // derived class can have its own reading logic
+  if(!mReadsResolvedProperties)
+    return read(dict);
+
+  setDirty();
+  return Serializable<EntityComponent>::read(properties, dict);
+}
+
+void EntityComponent::setDirty(bool value)
+{
+  mDirty = value;
+  if(value && mOwner)
+    mOwner->setDirty();
+}
@@ -0,0 +1,128 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "ComponentRegistry.h"
+#include "Logger.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace Gsage
+{
+  namespace {
+    /**
+     * Entries are only appended: name and hash are written under the mutex,
+     * then published by the release store of count.
+     * Readers never take the mutex, they only see fully written entries
+     */
+    struct Registry
+    {
+      Registry() : count(0) {}
+
+      std::mutex mutex;
+      std::atomic<uint32_t> count;
+      size_t hashes[MAX_COMPONENT_TYPES];
+      std::string names[MAX_COMPONENT_TYPES];
+
+      static Registry& instance()
+      {
+        static Registry registry;
+        return registry;
+      }
+
+      ComponentId find(const std::string& name, size_t hash, uint32_t size) const
+      {
+        for(uint32_t id = 0; id < size; id++)
+        {
+          if(hashes[id] == hash && names[id] == name)
+            return id;
+        }
+        return ComponentRegistry::INVALID_ID;
+      }
+    };
+  }
+
+  ComponentId ComponentRegistry::getId(const std::string& name)
+  {
+    Registry& registry = Registry::instance();
+    size_t hash = std::hash<std::string>()(name);
+    ComponentId id = registry.find(name, hash, registry.count.load(std::memory_order_acquire));
+    if(id != INVALID_ID)
+      return id;
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    uint32_t size = registry.count.load(std::memory_order_relaxed);
+    // other thread could register it while the lock was taken
+    id = registry.find(name, hash, size);
+    if(id != INVALID_ID)
+      return id;
+
+    if(size >= MAX_COMPONENT_TYPES)
+    {
+      LOG(ERROR) << "Failed to register component type \"" << name << "\": too many component types";
+      return INVALID_ID;
+    }
+
+    registry.hashes[size] = hash;
+    registry.names[size] = name;
+    registry.count.store(size + 1, std::memory_order_release);
+    return size;
+  }
+
+  ComponentId ComponentRegistry::find(const std::string& name)
+  {
+    Registry& registry = Registry::instance();
+    return registry.find(name, std::hash<std::string>()(name), registry.count.load(std::memory_order_acquire));
+  }
+
+  const std::string& ComponentRegistry::getName(ComponentId id)
+  {
+    static const std::string empty;
+    Registry& registry = Registry::instance();
+    if(id >= registry.count.load(std::memory_order_acquire))
+      return empty;
+
+    return registry.names[id];
+  }
+
+  ComponentMask ComponentRegistry::getMask(const std::vector<std::string>& names, bool* registered)
+  {
+    ComponentMask res = 0;
+    if(registered)
+      *registered = true;
+
+    for(auto& name : names)
+    {
+      ComponentId id = find(name);
+      if(id == INVALID_ID && registered)
+        *registered = false;
+
+      res |= getBit(id);
+    }
+    return res;
+  }
+}
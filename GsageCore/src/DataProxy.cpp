@@ -25,67 +25,27 @@ THE SOFTWARE.
 */
 
 #include "DataProxy.h"
+#include "MappedFile.h"
 
 #include <msgpack.hpp>
+#include <mutex>
+#include <unordered_map>
 
 namespace msgpack {
   MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
     namespace adaptor {
 
-      template<>
-      struct convert<Gsage::DataProxy> {
-        void create_array(msgpack::object const& o, Gsage::DataProxy& v) const {
-          for(int i = 0; i < o.via.array.size; ++i) {
-            Gsage::DataProxy child = Gsage::DataProxy::create(v.getWrappedType());
-            (*this)(o.via.array.ptr[i], child);
-            v.put(i, child);
-          }
-        }
-
-        void create_map(msgpack::object const& o, Gsage::DataProxy& v) const {
-          object_kv* kv = o.via.map.ptr;
-          object_kv* const kvend = o.via.map.ptr + o.via.map.size;
-          for(; kv != kvend; ++kv) {
-            Gsage::DataProxy child = Gsage::DataProxy::create(v.getWrappedType());
-            (*this)(kv->val, child);
-            v.put(kv->key.as<std::string>(), child);
-          }
-        }
-
-        msgpack::object const& operator()(msgpack::object const& o, Gsage::DataProxy& v) const {
-          switch(o.type) {
-            case msgpack::type::ARRAY:
-              create_array(o, v);
-              break;
-            case msgpack::type::MAP:
-              create_map(o, v);
-              break;
-            case msgpack::type::BOOLEAN:
-              v.set(o.as<bool>());
-              break;
-            case msgpack::type::POSITIVE_INTEGER:
-              v.set(o.as<unsigned int>());
-              break;
-            case msgpack::type::NEGATIVE_INTEGER:
-              v.set(o.as<int>());
-              break;
-            case msgpack::type::FLOAT:
-              v.set(o.as<double>());
-              break;
-            case msgpack::type::STR:
-              v.set(o.as<std::string>());
-              break;
-            default:
-              LOG(WARNING) << "Unhandled type " << o.type;
-          }
-          return o;
-        }
-      };
-
       template<>
       struct pack<Gsage::DataProxy> {
         template <typename Stream>
         packer<Stream>& operator()(msgpack::packer<Stream>& o, Gsage::DataProxy const& v) const {
+          if(v.getWrappedType() == Gsage::DataWrapper::MSGPACK_OBJECT) {
+            // already msgpack, pack the unpacked object as is
+            const msgpack::object* object = v.getWrapper<Gsage::DataWrapper::MSGPACK_OBJECT>()->getObject();
+            object ? o.pack(*object) : o.pack_nil();
+            return o;
+          }
+
           switch(v.getStoredType()) {
             case Gsage::DataWrapper::Int:
               o.pack(v.getValueOptional<int>(0));
@@ -192,6 +152,8 @@ namespace Gsage {
         throw CreateException("cannot use LUA_TABLE to create the DataProxy. Lua table can be wrapped or created by copying sol::object only.");
       case DataWrapper::JSON_OBJECT:
         return DataProxy(new typename TypeToWrapper<DataWrapper::JSON_OBJECT>::type(true));
+      case DataWrapper::MSGPACK_OBJECT:
+        return DataProxy(new typename TypeToWrapper<DataWrapper::MSGPACK_OBJECT>::type(true));
       default:
         break;
     }
@@ -356,6 +318,11 @@ namespace Gsage {
     return mDataWrapper->fromString(s);
   }
 
+  bool DataProxy::fromBuffer(const char* data, size_t size)
+  {
+    return mDataWrapper->fromBuffer(data, size);
+  }
+
   std::string DataProxy::get(const std::string& key, const char* def) const
   {
     auto pair = get<std::string>(key);
@@ -366,32 +333,79 @@ namespace Gsage {
     return def;
   }
 
-  DataProxy::DataWrapperPtr DataProxy::traverseSearch(const std::vector<std::string>& parts) const
+  std::string DataProxy::get(const Path& path, const char* def) const
   {
-    DataWrapperPtr res = this->mDataWrapper;
+    auto pair = get<std::string>(path);
+    if(pair.second)
+    {
+      return pair.first;
+    }
+    return def;
+  }
 
-    for(auto& part : parts) {
-      DataWrapperPtr tmp;
-      tmp = DataWrapperPtr(res->getChildAt(part));
-      if(!tmp) {
-        break;
-      }
+  namespace {
+    /**
+     * Interned compiled paths storage
+     */
+    struct PathRegistry
+    {
+      std::mutex mutex;
+      std::unordered_map<std::string, std::unique_ptr<DataProxy::Path::Parts>> paths;
+    };
 
-      res = tmp;
+    PathRegistry& getPathRegistry()
+    {
+      static PathRegistry registry;
+      return registry;
     }
+  }
 
-    return res;
+  DataProxy::Path::Path(const std::string& key)
+  {
+    PathRegistry& registry = getPathRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto& parts = registry.paths[key];
+    if(!parts) {
+      parts.reset(new Parts());
+      parts->key = key;
+      parts->parents = split(key, '.');
+      if(!parts->parents.empty()) {
+        parts->last = parts->parents.back();
+        parts->parents.pop_back();
+      }
+    }
+    mParts = parts.get();
   }
 
-  DataProxy::DataWrapperPtr DataProxy::traverseWrite(const std::vector<std::string>& parts)
+  DataProxy::Path::Path(const char* key)
+    : Path(std::string(key))
   {
-    DataWrapperPtr res = this->mDataWrapper;
+  }
 
-    for(auto& part : parts) {
-      res = DataWrapperPtr(res->createChildAt(part));
-    }
+  const std::string& DataProxy::Path::str() const
+  {
+    return mParts->key;
+  }
 
-    return res;
+  const std::vector<std::string>& DataProxy::Path::getParents() const
+  {
+    return mParts->parents;
+  }
+
+  const std::string& DataProxy::Path::getKey() const
+  {
+    return mParts->last;
+  }
+
+  DataProxy::DataWrapperPtr DataProxy::traverseSearch(const std::vector<std::string>& parts) const
+  {
+    DataWrapper* res = mDataWrapper->getDescendant(parts);
+    return res ? DataWrapperPtr(res) : mDataWrapper;
+  }
+
+  DataProxy::DataWrapperPtr DataProxy::traverseWrite(const std::vector<std::string>& parts)
+  {
+    return DataWrapperPtr(mDataWrapper->createDescendant(parts));
   }
 
   bool dump(const DataProxy& value, const std::string& path, DataWrapper::WrappedType type)
@@ -402,7 +416,7 @@ namespace Gsage {
 
     os << dumps(value, type);
     os.close();
-    return true;
+    return !os.fail();
   }
 
   std::string dumps(const DataProxy& value, DataWrapper::WrappedType type)
@@ -420,40 +434,12 @@ namespace Gsage {
 
   std::tuple<DataProxy, bool> load(const std::string& path, DataWrapper::WrappedType type)
   {
-    std::ifstream stream(path);
-    if(!stream)
-      return std::make_tuple(DataProxy(), false);
-
-    std::string str;
-    stream.seekg(0, std::ios::end);
-    str.reserve(stream.tellg());
-    stream.seekg(0, std::ios::beg);
-    bool success = true;
-    try
-    {
-      str.assign((std::istreambuf_iterator<char>(stream)),
-                  std::istreambuf_iterator<char>());
-    }
-    catch(...)
-    {
-      LOG(ERROR) << "Failed to read file";
-      success = false;
-    }
-
-    stream.close();
-    if(!success)
-    {
+    MappedFile file(path);
+    if(!file.isOpen())
       return std::make_tuple(DataProxy(), false);
-    }
 
     DataProxy res;
-    try {
-      res = loads(str, type);
-    } catch(DecodeException e) {
-      LOG(INFO) << e.what();
-      success = false;
-    }
-
+    bool success = loads(res, file.data(), file.size(), type);
     return std::make_tuple(res, success);
   }
 
@@ -469,25 +455,25 @@ namespace Gsage {
     return success;
   }
 
+  bool loads(DataProxy& dest, const char* data, size_t size, DataWrapper::WrappedType type)
+  {
+    DataProxy res = DataProxy::create(type);
+    if(!res.fromBuffer(data, size)) {
+      LOG(INFO) << "Failed to create object of type " << type << " from buffer of size " << size;
+      return false;
+    }
+
+    dest = res;
+    return true;
+  }
+
   DataProxy loads(const std::string& s, DataWrapper::WrappedType type)
   {
     DataProxy res = DataProxy::create(type);
-    if(type == DataWrapper::MSGPACK_OBJECT)
-    {
-      msgpack::object_handle oh =
-              msgpack::unpack(s.data(), s.size());
-      msgpack::object obj = oh.get();
-      try {
-        obj.convert(res);
-      } catch (const std::bad_cast& e) {
-        throw DecodeException(e.what());
-      }
-    } else {
-      if(!res.fromString(s)) {
-        std::stringstream ss;
-        ss << " failed to create object of type " << type << " from string " << s;
-        throw DecodeException(ss.str());
-      }
+    if(!res.fromString(s)) {
+      std::stringstream ss;
+      ss << " failed to create object of type " << type << " from string " << s;
+      throw DecodeException(ss.str());
     }
 
     return res;
@@ -38,6 +38,7 @@ Engine::Engine(const unsigned int& poolSize) :
   mInitialized(false),
   mEntityCounter(0)
 {
+  setEventQueue(&mEventQueue);
 }
 
 Engine::~Engine()
@@ -51,6 +52,10 @@ bool Engine::initialize(const DataProxy& configuration, const DataProxy& environ
   mConfiguration = configuration;
   mEnvironment = environment;
 
+  auto scheduler = mConfiguration.get<DataProxy>("scheduler");
+  if(scheduler.second)
+    mScheduler.configure(scheduler.first);
+
   bool succeed = true;
   for(auto& systemName : mSetUpOrder)
   {
@@ -87,17 +92,13 @@ bool Engine::configureSystems(const DataProxy& config)
     mEngineSystems[systemName]->configure(systemConfig.second ? systemConfig.first : DataProxy());
   }
 
-  fireEvent(SettingsEvent(SettingsEvent::UPDATE, mConfiguration));
+  fireEvent(SettingsEvent(SettingsEvent::UPDATE_ID, mConfiguration));
   return true;
 }
 
 void Engine::update(const double& time)
 {
-  for(auto& pair : mEngineSystems)
-  {
-    if(pair.second->isEnabled())
-      pair.second->update(time);
-  }
+  mScheduler.update(mEngineSystems, time);
 }
 
 bool Engine::addSystem(const std::string& name, EngineSystem* system, bool configure)
@@ -111,12 +112,13 @@ bool Engine::addSystem(const std::string& name, EngineSystem* system, bool confi
 
   mSetUpOrder.push_back(name);
   mEngineSystems[name] = system;
+  mScheduler.invalidate();
   system->setEngineInstance(this);
   if(mInitialized && configure)
   {
     if(!configureSystem(name)) {
       LOG(ERROR) << "Failed to setup " << name << " system";
-      fireEvent(SystemChangeEvent(SystemChangeEvent::SYSTEM_ADDED, name, system));
+      fireEvent(SystemChangeEvent(SystemChangeEvent::SYSTEM_ADDED_ID, name, system));
       return false;
     }
   }
@@ -136,7 +138,7 @@ bool Engine::configureSystem(const std::string& name) {
     return false;
   }
 
-  fireEvent(SystemChangeEvent(SystemChangeEvent::SYSTEM_ADDED, name, s));
+  fireEvent(SystemChangeEvent(SystemChangeEvent::SYSTEM_ADDED_ID, name, s));
   return true;
 }
 
@@ -159,18 +161,19 @@ bool Engine::removeSystem(const std::string& name)
     return false;
 
   SystemNames::iterator it = std::find(mManagedByEngine.begin(), mManagedByEngine.end(), name);
-  fireEvent(SystemChangeEvent(SystemChangeEvent::SYSTEM_REMOVED, name));
+  fireEvent(SystemChangeEvent(SystemChangeEvent::SYSTEM_REMOVED_ID, name));
   if(it != mManagedByEngine.end())
     delete mEngineSystems[name];
 
   mEngineSystems.erase(name);
+  mScheduler.invalidate();
   return true;
 }
 
 void Engine::removeSystems()
 {
   for(auto& pair : mEngineSystems) {
-    fireEvent(SystemChangeEvent(SystemChangeEvent::SYSTEM_REMOVED, pair.first));
+    fireEvent(SystemChangeEvent(SystemChangeEvent::SYSTEM_REMOVED_ID, pair.first));
   }
 
   for(auto& name : mManagedByEngine) {
@@ -179,6 +182,7 @@ void Engine::removeSystems()
 
   mEngineSystems.clear();
   mManagedByEngine.clear();
+  mScheduler.invalidate();
 }
 
 Entity* Engine::createEntity(DataProxy& data)
@@ -195,20 +199,71 @@ Entity* Engine::createEntity(DataProxy& data)
   bool created = false;
   if(!entity)
   {
-    entity = mEntities.create();
-    entity->mId = id;
-    entity->setClass(data.get<std::string>("class", "default"));
-    auto pair = data.get<DataProxy>("props");
-    if(pair.second) {
-      entity->setProps(pair.first);
-    }
-    mEntityMap[id] = entity;
+    entity = allocateEntity(id, data);
     created = true;
   }
   readEntityData(entity, data);
+  updateViews(entity);
   if(created) {
-    fireEvent(EntityEvent(EntityEvent::CREATE, entity->getId()));
+    fireEvent(EntityEvent(EntityEvent::CREATE_ID, entity->getId(), entity->getHandle()));
+  }
+  return entity;
+}
+
+Entity* Engine::createEntity(EntityTemplate& entityTemplate)
+{
+  const DataProxy& data = entityTemplate.data;
+  if(!entityTemplate.resolved)
+  {
+    for(auto& pair : data)
+    {
+      if(pair.first == KEY_ID || pair.first == KEY_FLAGS || pair.first == "class" || pair.first == "props")
+        continue;
+
+      EntityTemplate::Component component;
+      component.id = ComponentRegistry::getId(pair.first);
+      component.type = pair.first;
+      // iterator values are reused by the iterator, so nodes are taken by key
+      component.data = data[pair.first];
+      entityTemplate.components.push_back(component);
+    }
+    entityTemplate.resolved = true;
+  }
+
+  auto pair = data.get<std::string>(KEY_ID);
+  std::string id = pair.second ? pair.first : std::string("entity") + std::to_string(mEntityCounter++);
+  Entity* entity = getEntity(id);
+  if(entity)
+  {
+    // existing entity is updated by the data
+    readEntityData(entity, data);
+    updateViews(entity);
+    return entity;
+  }
+
+  entity = allocateEntity(id, data);
+  readEntityFlags(entity, data);
+  for(auto& component : entityTemplate.components)
+  {
+    createComponent(entity, component);
+  }
+  updateViews(entity);
+  fireEvent(EntityEvent(EntityEvent::CREATE_ID, entity->getId(), entity->getHandle()));
+  return entity;
+}
+
+Entity* Engine::allocateEntity(const std::string& id, const DataProxy& data)
+{
+  Entity* entity = mEntities.create();
+  ObjectPool<Entity>::Handle handle = mEntities.getHandle(entity);
+  entity->mId = id;
+  entity->mHandle = Entity::makeHandle(handle.index, handle.generation);
+  entity->setClass(data.get<std::string>("class", "default"));
+  auto pair = data.get<DataProxy>("props");
+  if(pair.second) {
+    entity->setProps(pair.first);
   }
+  mEntityMap[id] = entity;
   return entity;
 }
 
@@ -217,18 +272,30 @@ bool Engine::removeEntity(const std::string& id)
   return removeEntity(getEntity(id));
 }
 
+bool Engine::removeEntity(Entity::Handle handle)
+{
+  return removeEntity(getEntity(handle));
+}
+
 bool Engine::removeEntity(Entity* entity)
 {
-  if(entity == 0 || mEntityMap.count(entity->getId()) == 0)
+  if(entity == 0 || getEntity(entity->getHandle()) != entity)
     return false;
-  fireEvent(EntityEvent(EntityEvent::REMOVE, entity->getId()));
-  for(auto& pair : entity->mComponents)
+  fireEvent(EntityEvent(EntityEvent::REMOVE_ID, entity->getId(), entity->getHandle()));
+  for(ComponentMask mask = entity->getComponentMask(); mask != 0; mask &= mask - 1)
   {
-    if(!hasSystem(pair.first))
+    ComponentId id = ComponentRegistry::lowest(mask);
+    const std::string& name = ComponentRegistry::getName(id);
+    if(!hasSystem(name))
       continue;
 
-    if(!mEngineSystems[pair.first]->removeComponent(pair.second))
-      LOG(WARNING) << "Got false return value while removing " << pair.first << " component";
+    if(!mEngineSystems[name]->removeComponent(entity->getComponent(id)))
+      LOG(WARNING) << "Got false return value while removing " << name << " component";
+  }
+
+  for(auto& pair : mViews)
+  {
+    pair.second->remove(entity);
   }
 
   mEntityMap.erase(entity->getId());
@@ -245,13 +312,61 @@ void Engine::unloadAll()
   }
   mEntities.clear();
   mEntityMap.clear();
+  for(auto& pair : mViews)
+  {
+    pair.second->clear();
+  }
 }
 
 Entity* Engine::getEntity(const std::string& id)
 {
-  if(mEntityMap.count(id) == 0)
+  EntityMap::iterator iter = mEntityMap.find(id);
+  if(iter == mEntityMap.end())
     return 0;
-  return mEntityMap[id];
+  return iter->second;
+}
+
+Entity* Engine::getEntity(Entity::Handle handle)
+{
+  ObjectPool<Entity>::Handle poolHandle = mEntities.getHandleAt(Entity::getIndex(handle));
+  if(!poolHandle.isValid() || (poolHandle.generation & Entity::GENERATION_MASK) != Entity::getGeneration(handle))
+    return 0;
+
+  return mEntities.get(poolHandle);
+}
+
+EntityView& Engine::view(ComponentMask mask)
+{
+  Views::iterator iter = mViews.find(mask);
+  if(iter != mViews.end())
+    return *iter->second;
+
+  EntityView* view = new EntityView(mask);
+  mViews[mask] = std::unique_ptr<EntityView>(view);
+  for(Entity* entity : mEntities.getElements())
+  {
+    view->update(entity);
+  }
+  return *view;
+}
+
+EntityView& Engine::view(const std::vector<std::string>& components)
+{
+  ComponentMask mask = 0;
+  for(auto& name : components)
+  {
+    // register the type, so that the view matches components created later
+    mask |= ComponentRegistry::getBit(ComponentRegistry::getId(name));
+  }
+  return view(mask);
+}
+
+void Engine::updateViews(Entity* entity)
+{
+  for(auto& pair : mViews)
+  {
+    pair.second->update(entity);
+  }
 }
 
 bool Engine::createComponent(Entity* entity, const std::string& type, const DataProxy& dict)
@@ -269,11 +384,41 @@ bool Engine::createComponent(Entity* entity, const std::string& type, const Data
     return false;
   }
 
-  entity->addComponent(type, component);
+  if(!entity->addComponent(type, component))
+  {
+    LOG(ERROR) << "Component for system \"" << type << "\" was not added: failed to register component type";
+    getSystem(type)->removeComponent(component);
+    return false;
+  }
   return true;
 }
 
-bool Engine::readEntityData(Entity* entity, const DataProxy& dict)
+bool Engine::createComponent(Entity* entity, EntityTemplate::Component& component)
+{
+  EngineSystems::iterator iter = mEngineSystems.find(component.type);
+  if(iter == mEngineSystems.end())
+  {
+    LOG(ERROR) << "Component for system \"" << component.type << "\" was not created: no such system";
+    return false;
+  }
+
+  EntityComponent* c = iter->second->createComponent(component.data, entity, component.properties);
+  if(c == 0)
+  {
+    LOG(ERROR) << "Component for system \"" << component.type << "\" was not created: read error";
+    return false;
+  }
+
+  if(!entity->addComponent(component.id, c))
+  {
+    LOG(ERROR) << "Component for system \"" << component.type << "\" was not added: failed to register component type";
+    iter->second->removeComponent(c);
+    return false;
+  }
+  return true;
+}
+
+void Engine::readEntityFlags(Entity* entity, const DataProxy& dict)
 {
   auto flags = dict.get<DataProxy>("flags");
   if(flags.second)
@@ -283,6 +428,11 @@ bool Engine::readEntityData(Entity* entity, const DataProxy& dict)
       entity->setFlag(pair.second.as<std::string>());
     }
   }
+}
+
+bool Engine::readEntityData(Entity* entity, const DataProxy& dict)
+{
+  readEntityFlags(entity, dict);
 
   for(auto& pair : dict)
   {
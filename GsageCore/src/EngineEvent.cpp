@@ -30,44 +30,68 @@ THE SOFTWARE.
 namespace Gsage {
 
   const Event::Type EngineEvent::LUA_STATE_CHANGE = "luaStateChange";
+  const Event::TypeId EngineEvent::LUA_STATE_CHANGE_ID = Event::intern(EngineEvent::LUA_STATE_CHANGE);
 
   const Event::Type EngineEvent::SHUTDOWN = "shutdown";
+  const Event::TypeId EngineEvent::SHUTDOWN_ID = Event::intern(EngineEvent::SHUTDOWN);
 
   const Event::Type EngineEvent::STOPPING = "stopping";
+  const Event::TypeId EngineEvent::STOPPING_ID = Event::intern(EngineEvent::STOPPING);
 
   const Event::Type EntityEvent::REMOVE = "entityDeleted";
+  const Event::TypeId EntityEvent::REMOVE_ID = Event::intern(EntityEvent::REMOVE);
 
   const Event::Type EntityEvent::CREATE = "entityCreated";
+  const Event::TypeId EntityEvent::CREATE_ID = Event::intern(EntityEvent::CREATE);
 
   const Event::Type SettingsEvent::UPDATE = "update";
+  const Event::TypeId SettingsEvent::UPDATE_ID = Event::intern(SettingsEvent::UPDATE);
 
   const Event::Type SystemChangeEvent::SYSTEM_ADDED = "systemAdded";
+  const Event::TypeId SystemChangeEvent::SYSTEM_ADDED_ID = Event::intern(SystemChangeEvent::SYSTEM_ADDED);
 
   const Event::Type SystemChangeEvent::SYSTEM_REMOVED = "systemRemoved";
+  const Event::TypeId SystemChangeEvent::SYSTEM_REMOVED_ID = Event::intern(SystemChangeEvent::SYSTEM_REMOVED);
 
   const Event::Type SelectEvent::OBJECT_SELECTED = "objectSelected";
+  const Event::TypeId SelectEvent::OBJECT_SELECTED_ID = Event::intern(SelectEvent::OBJECT_SELECTED);
 
   const Event::Type SelectEvent::ROLL_OVER = "rollOver";
+  const Event::TypeId SelectEvent::ROLL_OVER_ID = Event::intern(SelectEvent::ROLL_OVER);
 
   const Event::Type SelectEvent::ROLL_OUT = "rollOut";
+  const Event::TypeId SelectEvent::ROLL_OUT_ID = Event::intern(SelectEvent::ROLL_OUT);
 
   const Event::Type WindowEvent::CREATE = "create";
+  const Event::TypeId WindowEvent::CREATE_ID = Event::intern(WindowEvent::CREATE);
 
   const Event::Type WindowEvent::RESIZE = "resize";
+  const Event::TypeId WindowEvent::RESIZE_ID = Event::intern(WindowEvent::RESIZE);
 
   const Event::Type WindowEvent::CLOSE = "close";
+  const Event::TypeId WindowEvent::CLOSE_ID = Event::intern(WindowEvent::CLOSE);
 
   EngineEvent::EngineEvent(Event::ConstType type) : Event(type)
   {
   }
 
+  EngineEvent::EngineEvent(Event::TypeId type) : Event(type)
+  {
+  }
+
   EngineEvent::~EngineEvent()
   {
   }
 
-  EntityEvent::EntityEvent(Event::ConstType type, const std::string& entityId)
+  EntityEvent::EntityEvent(Event::ConstType type, const std::string& entityId, Entity::Handle entityHandle)
+    : EntityEvent(Event::intern(type), entityId, entityHandle)
+  {
+  }
+
+  EntityEvent::EntityEvent(Event::TypeId type, const std::string& entityId, Entity::Handle entityHandle)
     : Event(type)
     , mEntityId(entityId)
+    , mEntityHandle(entityHandle)
   {
   }
 
@@ -76,6 +100,11 @@ namespace Gsage {
   }
 
   SettingsEvent::SettingsEvent(Event::ConstType type, const DataProxy& settings)
+    : SettingsEvent(Event::intern(type), settings)
+  {
+  }
+
+  SettingsEvent::SettingsEvent(Event::TypeId type, const DataProxy& settings)
     : Event(type)
     , settings(settings)
   {
@@ -86,6 +115,11 @@ namespace Gsage {
   }
 
   SystemChangeEvent::SystemChangeEvent(Event::ConstType type, const std::string& systemId, EngineSystem* system)
+    : SystemChangeEvent(Event::intern(type), systemId, system)
+  {
+  }
+
+  SystemChangeEvent::SystemChangeEvent(Event::TypeId type, const std::string& systemId, EngineSystem* system)
     : Event(type)
     , mSystemId(systemId)
     , mSystem(system)
@@ -97,6 +131,11 @@ namespace Gsage {
   }
 
   WindowEvent::WindowEvent(Event::ConstType type, size_t pHandle, unsigned int pWidth, unsigned int pHeight)
+    : WindowEvent(Event::intern(type), pHandle, pWidth, pHeight)
+  {
+  }
+
+  WindowEvent::WindowEvent(Event::TypeId type, size_t pHandle, unsigned int pWidth, unsigned int pHeight)
     : Event(type)
     , handle(pHandle)
     , width(pWidth)
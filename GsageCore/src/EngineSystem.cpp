@@ -25,14 +25,18 @@ THE SOFTWARE.
 */
 
 #include "EngineSystem.h"
+#include "Engine.h"
 
 namespace Gsage
 {
 
   EngineSystem::EngineSystem() :
+    mEngine(0),
     mReady(false),
     mConfigDirty(false),
-    mEnabled(true)
+    mEnabled(true),
+    mMainThreadOnly(false),
+    mExclusive(false)
   {
   }
 
@@ -99,4 +103,57 @@ namespace Gsage
   {
     mName = name;
   }
+
+  const EngineSystem::ComponentTypes& EngineSystem::getReads() const
+  {
+    return mReads;
+  }
+
+  const EngineSystem::ComponentTypes& EngineSystem::getWrites() const
+  {
+    return mWrites;
+  }
+
+  bool EngineSystem::hasDeclaredAccess() const
+  {
+    return !mReads.empty() || !mWrites.empty();
+  }
+
+  bool EngineSystem::isExclusive() const
+  {
+    return mExclusive || !hasDeclaredAccess();
+  }
+
+  bool EngineSystem::isMainThreadOnly() const
+  {
+    return mMainThreadOnly || isExclusive();
+  }
+
+  void EngineSystem::declareRead(const std::string& componentType)
+  {
+    mReads.insert(componentType);
+  }
+
+  void EngineSystem::declareWrite(const std::string& componentType)
+  {
+    mWrites.insert(componentType);
+  }
+
+  void EngineSystem::setMainThreadOnly(bool value)
+  {
+    mMainThreadOnly = value;
+  }
+
+  void EngineSystem::setExclusive(bool value)
+  {
+    mExclusive = value;
+  }
+
+  ThreadPool* EngineSystem::getThreadPool()
+  {
+    if(!mEngine)
+      return 0;
+
+    return mEngine->getScheduler().getThreadPool();
+  }
 }
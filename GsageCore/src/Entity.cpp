@@ -31,6 +31,10 @@ namespace Gsage
 {
 
   Entity::Entity()
+    : mHandle(INVALID_HANDLE)
+    , mComponentMask(0)
+    , mDirty(true)
+    , mUntrackedComponents(0)
   {
   }
 
@@ -38,22 +42,59 @@ namespace Gsage
   {
   }
 
-  void Entity::addComponent(const std::string& name, EntityComponent* c)
+  bool Entity::addComponent(const std::string& name, EntityComponent* c)
   {
-    mComponents[name] = c;
+    return addComponent(ComponentRegistry::getId(name), c);
+  }
+
+  bool Entity::addComponent(ComponentId id, EntityComponent* c)
+  {
+    ComponentMask bit = ComponentRegistry::getBit(id);
+    if(bit == 0)
+      return false;
+
+    mDirty = true;
+    if(!c->tracksChanges())
+      mUntrackedComponents++;
+
+    size_t index = ComponentRegistry::count(mComponentMask & (bit - 1));
+    if((mComponentMask & bit) != 0)
+    {
+      if(!mSlots[index]->tracksChanges())
+        mUntrackedComponents--;
+      mSlots[index] = c;
+      return true;
+    }
+
+    mSlots.insert(mSlots.begin() + index, c);
+    mComponentMask |= bit;
+    return true;
   }
 
   bool Entity::removeComponent(const std::string& name)
   {
-    if(mComponents.count(name) == 0)
+    return removeComponent(ComponentRegistry::find(name));
+  }
+
+  bool Entity::removeComponent(ComponentId id)
+  {
+    ComponentMask bit = ComponentRegistry::getBit(id);
+    if((mComponentMask & bit) == 0)
       return false;
 
-    return mComponents.erase(name);
+    ComponentSlots::iterator iter = mSlots.begin() + ComponentRegistry::count(mComponentMask & (bit - 1));
+    if(!(*iter)->tracksChanges())
+      mUntrackedComponents--;
+
+    mSlots.erase(iter);
+    mComponentMask &= ~bit;
+    mDirty = true;
+    return true;
   }
 
   EntityComponent* Entity::getComponent(const std::string& name)
   {
-    return mComponents[name];
+    return getComponent(ComponentRegistry::find(name));
   }
 
   void Entity::setFlag(const std::string& flag)
@@ -62,6 +103,7 @@ namespace Gsage
       return;
 
     mFlags.push_back(flag);
+    mDirty = true;
   }
 
   bool Entity::hasFlag(const std::string& flag)
@@ -77,23 +119,26 @@ namespace Gsage
   void Entity::setClass(const std::string& cls)
   {
     mClass = cls;
+    mDirty = true;
   }
 
   DataProxy& Entity::getProps()
   {
+    mDirty = true;
     return mProps;
   }
 
   void Entity::setProps(const DataProxy& props)
   {
     mProps = props;
+    mDirty = true;
   }
 
   std::vector<std::string> Entity::getComponentNames() const
   {
     std::vector<std::string> res;
-    for(auto pair : mComponents) {
-      res.push_back(pair.first);
+    for(ComponentMask mask = mComponentMask; mask != 0; mask &= mask - 1) {
+      res.push_back(ComponentRegistry::getName(ComponentRegistry::lowest(mask)));
     }
     return res;
   }
@@ -0,0 +1,77 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "EntityView.h"
+
+namespace Gsage
+{
+  EntityView::EntityView(ComponentMask mask)
+    : mMask(mask)
+  {
+  }
+
+  EntityView::~EntityView()
+  {
+  }
+
+  void EntityView::update(Entity* entity)
+  {
+    bool matched = matches(entity->getComponentMask());
+    bool included = contains(entity);
+    if(matched && !included)
+    {
+      mIndex[entity] = mEntities.size();
+      mEntities.push_back(entity);
+    }
+    else if(!matched && included)
+    {
+      remove(entity);
+    }
+  }
+
+  void EntityView::remove(Entity* entity)
+  {
+    Index::iterator iter = mIndex.find(entity);
+    if(iter == mIndex.end())
+      return;
+
+    size_t index = iter->second;
+    mIndex.erase(iter);
+    // swap-and-pop, order of entities is not preserved
+    if(index != mEntities.size() - 1)
+    {
+      mEntities[index] = mEntities.back();
+      mIndex[mEntities[index]] = index;
+    }
+    mEntities.pop_back();
+  }
+
+  void EntityView::clear()
+  {
+    mEntities.clear();
+    mIndex.clear();
+  }
+}
@@ -25,55 +25,193 @@ THE SOFTWARE.
 */
 
 #include "EventDispatcher.h"
+#include "EventQueue.h"
 #include "Logger.h"
 
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
 namespace Gsage {
+  /**
+   * Storage for interned event types. Type strings are never removed,
+   * so events can keep pointers to them.
+   * Names are stored in chunks which are never reallocated, so that lookup by id does not lock
+   */
+  struct EventTypeRegistry
+  {
+    typedef std::unordered_map<Event::Type, Event::TypeId> Ids;
+    typedef std::atomic<const Event::Type*> Name;
+
+    enum {
+      CHUNK_SIZE = 256,
+      MAX_CHUNKS = 256
+    };
+
+    std::mutex mutex;
+    Ids ids;
+    std::atomic<Name*> chunks[MAX_CHUNKS];
+
+    EventTypeRegistry()
+    {
+      for(int i = 0; i < MAX_CHUNKS; ++i)
+        chunks[i].store(0, std::memory_order_relaxed);
+    }
+
+    ~EventTypeRegistry()
+    {
+      for(int i = 0; i < MAX_CHUNKS; ++i)
+        delete[] chunks[i].load(std::memory_order_relaxed);
+    }
+
+    static EventTypeRegistry& instance()
+    {
+      static EventTypeRegistry registry;
+      return registry;
+    }
+
+    Event::TypeId intern(Event::ConstType type, const Event::Type** name)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      Ids::iterator iter = ids.find(type);
+      if(iter == ids.end()) {
+        Event::TypeId id = (Event::TypeId)ids.size();
+        if(id >= CHUNK_SIZE * MAX_CHUNKS) {
+          LOG(ERROR) << "Too many event types, failed to register " << type;
+          id = 0;
+        } else {
+          iter = ids.emplace(type, id).first;
+          Name* chunk = chunks[id / CHUNK_SIZE].load(std::memory_order_relaxed);
+          if(!chunk) {
+            chunk = new Name[CHUNK_SIZE]();
+            chunks[id / CHUNK_SIZE].store(chunk, std::memory_order_release);
+          }
+          chunk[id % CHUNK_SIZE].store(&iter->first, std::memory_order_release);
+        }
+      }
+
+      if(iter == ids.end()) {
+        if(name) {
+          *name = getName(0);
+        }
+        return 0;
+      }
+
+      if(name) {
+        *name = &iter->first;
+      }
+      return iter->second;
+    }
+
+    const Event::Type* getName(Event::TypeId id)
+    {
+      Name* chunk = id < CHUNK_SIZE * MAX_CHUNKS ? chunks[id / CHUNK_SIZE].load(std::memory_order_acquire) : 0;
+      const Event::Type* name = chunk ? chunk[id % CHUNK_SIZE].load(std::memory_order_acquire) : 0;
+      if(!name) {
+        LOG(ERROR) << "Unknown event type id " << id;
+      }
+      return name;
+    }
+  };
+
+  Event::Event(ConstType type)
+  {
+    mTypeId = EventTypeRegistry::instance().intern(type, &mType);
+  }
+
+  Event::Event(TypeId id)
+    : mType(EventTypeRegistry::instance().getName(id))
+    , mTypeId(id)
+  {
+    if(!mType) {
+      mTypeId = intern("");
+      mType = EventTypeRegistry::instance().getName(mTypeId);
+    }
+  }
+
+  Event::TypeId Event::intern(ConstType type)
+  {
+    return EventTypeRegistry::instance().intern(type, 0);
+  }
+
+  Event::ConstType Event::getTypeName(TypeId id)
+  {
+    static const Type empty;
+    const Type* name = EventTypeRegistry::instance().getName(id);
+    return name ? *name : empty;
+  }
+
   const Event::Type DispatcherEvent::FORCE_UNSUBSCRIBE = "forceUnsubscribe";
+  const Event::TypeId DispatcherEvent::FORCE_UNSUBSCRIBE_ID = Event::intern(DispatcherEvent::FORCE_UNSUBSCRIBE);
 
   EventDispatcher::EventDispatcher()
+    : mEventQueue(0)
+    , mQueuedEvents(0)
   {
   }
 
   EventDispatcher::~EventDispatcher()
   {
+    setEventQueue(0);
     removeAllListeners();
   }
 
+  void EventDispatcher::setEventQueue(EventQueue* queue)
+  {
+    if(mEventQueue && mQueuedEvents > 0)
+      mEventQueue->cancel(this);
+
+    mEventQueue = queue;
+  }
+
   EventConnection EventDispatcher::addEventListener(Event::ConstType eventType, EventCallback callback, const int priority)
   {
-    if(!hasListenersForType(eventType))
-      mSignals[eventType] = new EventSignal();
+    Event::TypeId id = Event::intern(eventType);
+    if(id >= mSignals.size())
+      mSignals.resize(id + 1, 0);
+
+    if(!mSignals[id])
+      mSignals[id] = new EventSignal();
 
-    return mSignals[eventType]->connect(priority, callback);
+    return mSignals[id]->connect(priority, callback);
   }
 
   bool EventDispatcher::hasListenersForType(Event::ConstType type)
   {
-    return mSignals.count(type) > 0;
+    return hasListenersForType(Event::intern(type));
+  }
+
+  bool EventDispatcher::hasListenersForType(Event::TypeId id)
+  {
+    return id < mSignals.size() && mSignals[id] != 0;
   }
 
   void EventDispatcher::fireEvent(const Event& event)
   {
-    if(!hasListenersForType(event.getType()))
+    Event::TypeId id = event.getTypeId();
+    EventSignal* signal = id < mSignals.size() ? mSignals[id] : 0;
+    if(!signal)
       return;
 
-    (*mSignals[event.getType()])(this, event);
+    (*signal)(this, event);
   }
 
   void EventDispatcher::removeAllListeners()
   {
-    for(std::pair<Event::Type, EventSignal*> element : mSignals)
+    Event::TypeId id = DispatcherEvent::FORCE_UNSUBSCRIBE_ID;
+    if(hasListenersForType(id))
     {
-      if (element.first == DispatcherEvent::FORCE_UNSUBSCRIBE)
-      {
-        (*element.second)(this, DispatcherEvent(DispatcherEvent::FORCE_UNSUBSCRIBE));
-        delete element.second;
-      }
+      EventSignal* signal = mSignals[id];
+      (*signal)(this, DispatcherEvent(DispatcherEvent::FORCE_UNSUBSCRIBE_ID));
+      delete signal;
     }
     mSignals.clear();
   }
 
   EventSignal::EventSignal()
+    : mNextId(0)
+    , mCallDepth(0)
+    , mDirty(false)
   {
 
   }
@@ -84,36 +222,95 @@ namespace Gsage {
 
   EventConnection EventSignal::connect(const int priority, EventCallback callback)
   {
-    if(mConnections.count(priority) == 0)
+    int id = mNextId++;
+    if(mCallDepth > 0)
     {
-      mConnections[priority] = CallbacksList();
+      mPending.emplace_back(priority, id, callback);
+      mDirty = true;
+    }
+    else
+    {
+      insert(Connection(priority, id, callback));
     }
-
-    int id = mConnections[priority].empty() ? 0 : mConnections[priority].size();
-    mConnections[priority].insert(std::make_pair(id, callback));
     return EventConnection(this, priority, id);
   }
 
   void EventSignal::operator()(EventDispatcher* dispatcher, const Event& event)
   {
-    for(auto pair : mConnections)
+    // connections vector is not modified until the outermost call is finished
+    mCallDepth++;
+    for(size_t i = 0; i < mConnections.size(); ++i)
     {
-      for(auto p : pair.second)
+      Connection& connection = mConnections[i];
+      if(connection.active && !connection.callback(dispatcher, event))
       {
-        if(!p.second(dispatcher, event))
-        {
-          return;
-        }
+        break;
       }
     }
+
+    if(--mCallDepth == 0 && mDirty)
+    {
+      flush();
+    }
   }
 
   void EventSignal::disconnect(int priority, int id)
   {
-    if(mConnections.count(priority) == 0)
+    auto matches = [priority, id](const Connection& c) { return c.priority == priority && c.id == id; };
+    Connections::iterator iter = std::find_if(mConnections.begin(), mConnections.end(), matches);
+    if(iter != mConnections.end())
+    {
+      if(mCallDepth > 0)
+      {
+        iter->active = false;
+        mDirty = true;
+      }
+      else
+      {
+        mConnections.erase(iter);
+      }
       return;
+    }
 
-    mConnections[priority].erase(id);
+    iter = std::find_if(mPending.begin(), mPending.end(), matches);
+    if(iter != mPending.end())
+      mPending.erase(iter);
+  }
+
+  bool EventSignal::empty() const
+  {
+    for(const Connection& connection : mConnections)
+    {
+      if(connection.active)
+        return false;
+    }
+    return mPending.empty();
+  }
+
+  void EventSignal::insert(Connection&& connection)
+  {
+    Connections::iterator iter = std::upper_bound(
+        mConnections.begin(),
+        mConnections.end(),
+        connection.priority,
+        [](int priority, const Connection& c) { return priority < c.priority; }
+    );
+    mConnections.insert(iter, std::move(connection));
+  }
+
+  void EventSignal::flush()
+  {
+    mConnections.erase(
+        std::remove_if(mConnections.begin(), mConnections.end(), [](const Connection& c) { return !c.active; }),
+        mConnections.end()
+    );
+
+    for(Connection& connection : mPending)
+    {
+      insert(std::move(connection));
+    }
+    mPending.clear();
+    mDirty = false;
   }
 
   EventConnection::EventConnection(EventSignal* signal, int priority, int id)
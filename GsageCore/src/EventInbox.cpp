@@ -0,0 +1,88 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "EventInbox.h"
+
+namespace Gsage {
+
+  EventInbox::EventInbox(size_t capacity)
+    : mDequeuePosition(0)
+    , mDropped(0)
+    , mDraining(false)
+    , mEnqueuePosition(0)
+  {
+    size_t size = 2;
+    while(size < capacity)
+      size <<= 1;
+
+    mMask = size - 1;
+    mCells = std::unique_ptr<Cell[]>(new Cell[size]);
+    for(size_t i = 0; i < size; ++i)
+    {
+      mCells[i].sequence.store(i, std::memory_order_relaxed);
+      mCells[i].event = 0;
+    }
+  }
+
+  EventInbox::~EventInbox()
+  {
+    // drop events that were not dispatched
+    for(;;)
+    {
+      Cell& cell = mCells[mDequeuePosition & mMask];
+      if(cell.sequence.load(std::memory_order_acquire) != mDequeuePosition + 1)
+        break;
+
+      cell.destroy(cell.event);
+      mDequeuePosition++;
+    }
+  }
+
+  size_t EventInbox::drain()
+  {
+    if(mDraining)
+      return 0;
+
+    mDraining = true;
+    size_t count = 0;
+    // limited by capacity, so that busy producers can't block the consumer
+    while(count <= mMask)
+    {
+      Cell& cell = mCells[mDequeuePosition & mMask];
+      if(cell.sequence.load(std::memory_order_acquire) != mDequeuePosition + 1)
+        break;
+
+      cell.target->fireEvent(*cell.event);
+      cell.destroy(cell.event);
+      cell.event = 0;
+      cell.sequence.store(mDequeuePosition + mMask + 1, std::memory_order_release);
+      mDequeuePosition++;
+      count++;
+    }
+    mDraining = false;
+    return count;
+  }
+}
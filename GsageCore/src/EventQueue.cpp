@@ -0,0 +1,155 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "EventQueue.h"
+
+namespace Gsage {
+
+  EventQueue::EventQueue(size_t capacity)
+    : mCurrent(0)
+    , mFlushingBatch(0)
+  {
+    mBatches.emplace_back(capacity);
+    mBatches.emplace_back(capacity);
+  }
+
+  EventQueue::~EventQueue()
+  {
+    clear();
+  }
+
+  void EventQueue::append(Batch& batch, EventDispatcher* target, Event* event, DestroyFunction destroy)
+  {
+    Entry entry = {target, event, destroy};
+    batch.entries.push_back(entry);
+    target->mQueuedEvents++;
+  }
+
+  size_t EventQueue::flush()
+  {
+    Batch* batch;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if(mFlushingBatch)
+        return 0;
+
+      batch = mFlushingBatch = &mBatches[mCurrent];
+      mCurrent = (mCurrent + 1) % mBatches.size();
+    }
+
+    size_t count = 0;
+    for(size_t i = 0; i < batch->entries.size(); ++i)
+    {
+      Entry entry;
+      {
+        // the target can be destroyed by the handler of the previous event, it cancels its entries
+        std::lock_guard<std::mutex> lock(mMutex);
+        entry = batch->entries[i];
+        if(!entry.event)
+          continue;
+
+        batch->entries[i].event = 0;
+        entry.target->mQueuedEvents--;
+      }
+
+      entry.target->fireEvent(*entry.event);
+      entry.destroy(entry.event);
+      count++;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    clear(*batch);
+    mFlushingBatch = 0;
+    return count;
+  }
+
+  void EventQueue::cancel(EventDispatcher* target)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for(Batch& batch : mBatches)
+    {
+      for(Entry& entry : batch.entries)
+      {
+        if(entry.target != target || !entry.event)
+          continue;
+
+        entry.destroy(entry.event);
+        entry.event = 0;
+        target->mQueuedEvents--;
+      }
+    }
+  }
+
+  void EventQueue::clear()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for(Batch& batch : mBatches)
+    {
+      // memory of the batch being flushed is released when the flush is finished
+      if(&batch == mFlushingBatch)
+        drop(batch);
+      else
+        clear(batch);
+    }
+  }
+
+  size_t EventQueue::size()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t count = 0;
+    for(Batch& batch : mBatches)
+    {
+      for(Entry& entry : batch.entries)
+      {
+        if(entry.event)
+          count++;
+      }
+    }
+    return count;
+  }
+
+  void EventQueue::drop(Batch& batch)
+  {
+    for(Entry& entry : batch.entries)
+    {
+      if(!entry.event)
+        continue;
+
+      entry.destroy(entry.event);
+      entry.event = 0;
+      entry.target->mQueuedEvents--;
+    }
+    batch.index.clear();
+  }
+
+  void EventQueue::clear(Batch& batch)
+  {
+    drop(batch);
+    batch.entries.clear();
+    batch.index.clear();
+    batch.arena.reset();
+  }
+}
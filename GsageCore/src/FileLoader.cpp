@@ -25,11 +25,70 @@ THE SOFTWARE.
 */
 
 #include "FileLoader.h"
+#include "MappedFile.h"
+#include "Prefab.h"
+#include "GsageDefinitions.h"
 #include <assert.h>
+#include <sys/stat.h>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace Gsage {
   FileLoader* FileLoader::mInstance = 0;
 
+  const size_t FileLoader::DEFAULT_CACHE_CAPACITY = 32 * 1024 * 1024;
+
+  /**
+   * Parsed files, keyed by path.
+   * Cached trees are never handed out directly, so they stay immutable
+   */
+  struct FileLoader::Cache
+  {
+    struct Entry {
+      DataProxy data;
+      // msgpack data is kept packed, copying and unpacking it is cheaper than copying the tree
+      std::string packed;
+      // nanoseconds, whole seconds granularity can miss same size rewrites
+      int64_t mtime;
+      size_t size;
+      std::list<std::string>::iterator lru;
+    };
+
+    typedef std::unordered_map<std::string, Entry> Entries;
+
+    Cache()
+      : capacity(DEFAULT_CACHE_CAPACITY)
+      , size(0)
+      , hits(0)
+      , misses(0)
+    {
+    }
+
+    void erase(Entries::iterator iter)
+    {
+      size -= iter->second.size;
+      lru.erase(iter->second.lru);
+      entries.erase(iter);
+    }
+
+    void shrink()
+    {
+      while(size > capacity && !lru.empty()) {
+        erase(entries.find(lru.back()));
+      }
+    }
+
+    std::mutex mutex;
+    Entries entries;
+    // most recently used first
+    std::list<std::string> lru;
+    size_t capacity;
+    size_t size;
+    size_t hits;
+    size_t misses;
+  };
+
   FileLoader FileLoader::getSingleton()
   {
     assert(mInstance != 0);
@@ -50,6 +109,7 @@ namespace Gsage {
   FileLoader::FileLoader(FileLoader::Encoding format, const DataProxy& environment)
     : mFormat(format)
     , mEnvironment(environment)
+    , mCache(std::make_shared<Cache>())
   {
   }
 
@@ -59,16 +119,12 @@ namespace Gsage {
 
   bool FileLoader::load(const std::string& path, const DataProxy& params, DataProxy& dest) const
   {
-    DataProxy p = merge(mEnvironment, params);
-    auto pair = loadFile(path);
-    if (!pair.second) {
-      return false;
-    }
-
-    if(!parse(pair.first, dest))
+    if(!loadCached(path, dest))
       return false;
 
-    mergeInto(dest, p);
+    // merge one by one: merge() would write params into the shared environment
+    mergeInto(dest, mEnvironment);
+    mergeInto(dest, params);
     return true;
   }
 
@@ -84,7 +140,7 @@ namespace Gsage {
     return load(path, DataProxy());
   }
 
-  void FileLoader::dump(const std::string& path, const DataProxy& value) const
+  bool FileLoader::dump(const std::string& path, const DataProxy& value) const
   {
     DataWrapper::WrappedType type;
     switch(mFormat) {
@@ -95,39 +151,158 @@ namespace Gsage {
         type = DataWrapper::MSGPACK_OBJECT;
         break;
     }
-    Gsage::dump(value, path, type);
+    bool success = Gsage::dump(value, path, type);
+
+    // file system timestamps can be coarser than the time between two dumps
+    std::lock_guard<std::mutex> lock(mCache->mutex);
+    auto iter = mCache->entries.find(path);
+    if(iter != mCache->entries.end()) {
+      mCache->erase(iter);
+    }
+    return success;
+  }
+
+  void FileLoader::setCacheCapacity(size_t bytes)
+  {
+    std::lock_guard<std::mutex> lock(mCache->mutex);
+    mCache->capacity = bytes;
+    mCache->shrink();
+  }
+
+  size_t FileLoader::getCacheCapacity() const
+  {
+    std::lock_guard<std::mutex> lock(mCache->mutex);
+    return mCache->capacity;
+  }
+
+  void FileLoader::flushCache()
+  {
+    std::lock_guard<std::mutex> lock(mCache->mutex);
+    mCache->entries.clear();
+    mCache->lru.clear();
+    mCache->size = 0;
+  }
+
+  void FileLoader::flushCache(const std::string& path)
+  {
+    std::lock_guard<std::mutex> lock(mCache->mutex);
+    auto iter = mCache->entries.find(path);
+    if(iter != mCache->entries.end()) {
+      mCache->erase(iter);
+    }
+  }
+
+  FileLoader::CacheStats FileLoader::getCacheStats() const
+  {
+    std::lock_guard<std::mutex> lock(mCache->mutex);
+    CacheStats stats;
+    stats.hits = mCache->hits;
+    stats.misses = mCache->misses;
+    stats.entries = mCache->entries.size();
+    stats.size = mCache->size;
+    return stats;
   }
 
-  std::pair<std::string, bool> FileLoader::loadFile(const std::string& path) const
+  bool FileLoader::getModificationTime(const std::string& path, int64_t& mtime, size_t* size)
   {
-    std::ifstream stream(path);
-    std::string res;
-    bool success = true;
-    if(!stream) {
-      return std::make_pair("", false);
+    struct stat info;
+    if(stat(path.c_str(), &info) != 0) {
+      return false;
     }
-    try
-    {
-      stream.seekg(0, std::ios::end);
-      res.reserve(stream.tellg());
-      stream.seekg(0, std::ios::beg);
-      res.assign((std::istreambuf_iterator<char>(stream)),
-                  std::istreambuf_iterator<char>());
+
+    const int64_t nanoseconds = 1000000000;
+#if GSAGE_PLATFORM == GSAGE_APPLE
+    mtime = static_cast<int64_t>(info.st_mtimespec.tv_sec) * nanoseconds + info.st_mtimespec.tv_nsec;
+#elif GSAGE_PLATFORM == GSAGE_WIN32
+    mtime = static_cast<int64_t>(info.st_mtime) * nanoseconds;
+#else
+    mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * nanoseconds + info.st_mtim.tv_nsec;
+#endif
+    if(size) {
+      *size = static_cast<size_t>(info.st_size);
+    }
+    return true;
+  }
+
+  bool FileLoader::loadCached(const std::string& path, DataProxy& dest) const
+  {
+    int64_t mtime;
+    size_t size;
+    if(!getModificationTime(path, mtime, &size)) {
+      std::lock_guard<std::mutex> lock(mCache->mutex);
+      auto iter = mCache->entries.find(path);
+      if(iter != mCache->entries.end()) {
+        mCache->erase(iter);
+      }
+      return false;
     }
-    catch(std::exception& e)
+
     {
-      success = false;
-      LOG(ERROR) << "Failed to read file: " << path << ", reason: " << e.what();
+      std::lock_guard<std::mutex> lock(mCache->mutex);
+      auto iter = mCache->entries.find(path);
+      if(iter != mCache->entries.end()) {
+        Cache::Entry& entry = iter->second;
+        if(entry.mtime == mtime && entry.size == size) {
+          mCache->hits++;
+          mCache->lru.splice(mCache->lru.begin(), mCache->lru, entry.lru);
+          if(!entry.packed.empty()) {
+            dest = DataProxy::create(DataWrapper::MSGPACK_OBJECT);
+            return dest.fromBuffer(entry.packed.data(), entry.packed.size());
+          }
+          // copy while holding the lock: wrappers resolve values lazily,
+          // so even reading the cached tree is not thread safe
+          dest = DataProxy::create(entry.data.getWrappedType());
+          return entry.data.dump(dest, DataProxy::ForceCopy);
+        }
+        mCache->erase(iter);
+      }
+      mCache->misses++;
     }
 
-    stream.close();
+    MappedFile file(path);
+    if(!file.isOpen()) {
+      return false;
+    }
 
-    return std::make_pair(res, success);
+    DataProxy parsed;
+    std::string packed;
+    if(Prefab::isPrefab(file.data(), file.size())) {
+      Prefab prefab;
+      if(!prefab.read(file.data(), file.size()) || !prefab.instantiate(parsed))
+        return false;
+      packed = prefab.getPayload();
+    } else if(!parse(file, parsed)) {
+      return false;
+    } else if(mFormat == Msgpack) {
+      packed = file.str();
+    }
+
+    dest = parsed;
+    std::lock_guard<std::mutex> lock(mCache->mutex);
+    if(size == 0 || size > mCache->capacity || mCache->entries.count(path) != 0) {
+      return true;
+    }
+
+    Cache::Entry& entry = mCache->entries[path];
+    if(packed.empty()) {
+      dest = DataProxy::create(parsed.getWrappedType());
+      parsed.dump(dest, DataProxy::ForceCopy);
+      entry.data = parsed;
+    } else {
+      entry.packed.swap(packed);
+    }
+
+    mCache->lru.push_front(path);
+    entry.mtime = mtime;
+    entry.size = size;
+    entry.lru = mCache->lru.begin();
+    mCache->size += size;
+    mCache->shrink();
+    return true;
   }
 
-  bool FileLoader::parse(const std::string& data, DataProxy& dest) const
+  bool FileLoader::parse(const MappedFile& file, DataProxy& dest) const
   {
-    bool success = false;
     DataWrapper::WrappedType type;
 
     switch(mFormat) {
@@ -138,7 +313,7 @@ namespace Gsage {
         type = DataWrapper::MSGPACK_OBJECT;
         break;
     }
-    return loads(dest, data, type);
+    return loads(dest, file.data(), file.size(), type);
   }
 
 }
@@ -30,17 +30,483 @@ THE SOFTWARE.
 #include "Entity.h"
 #include "Component.h"
 #include "FileLoader.h"
+#include "MappedFile.h"
+#include "Prefab.h"
+#include "ThreadPool.h"
 
 #include "Logger.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#if GSAGE_PLATFORM == GSAGE_WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
 namespace Gsage {
 
+  namespace {
+    const DataProxy::Path PLACEMENT_POSITION("position");
+    const DataProxy::Path RENDER_POSITION("render.root.position");
+    const DataProxy::Path RENDER_ROOT_POSITION("root.position");
+
+    /**
+     * Copy position, that can be stored as array of numbers or as a legacy "x,y,z" string
+     */
+    template<class SrcKey, class DestKey>
+    void copyPosition(const DataProxy& src, const SrcKey& srcKey, DataProxy& dest, const DestKey& destKey)
+    {
+      auto position = src.get<DataProxy>(srcKey);
+      if(position.second && position.first.getStoredType() == DataWrapper::Array) {
+        dest.put(destKey, position.first);
+      } else {
+        dest.put(destKey, src.get(srcKey, "0,0,0"));
+      }
+    }
+
+    /**
+     * Get path of the data file in the folder.
+     * Compiled prefab is preferred if it exists and it is not older than the source file
+     */
+    std::string getDataFilePath(const std::string& folder, const std::string& name, const std::string& extension)
+    {
+      std::string path = folder + "/" + name + ".";
+      int64_t prefabTime;
+      if(!FileLoader::getModificationTime(path + Prefab::EXTENSION, prefabTime))
+        return path + extension;
+
+      // source file was edited after the prefab was compiled
+      int64_t sourceTime;
+      if(FileLoader::getModificationTime(path + extension, sourceTime) && sourceTime > prefabTime)
+        return path + extension;
+
+      return path + Prefab::EXTENSION;
+    }
+
+    /**
+     * Check if the path is the path of the compiled prefab
+     */
+    bool isPrefabPath(const std::string& path)
+    {
+      std::string suffix = "." + Prefab::EXTENSION;
+      return path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    /**
+     * Flush written file contents to the disk
+     */
+    bool syncFile(const std::string& path)
+    {
+#if GSAGE_PLATFORM == GSAGE_WIN32
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+      if(file == INVALID_HANDLE_VALUE)
+        return false;
+
+      bool success = FlushFileBuffers(file) != 0;
+      CloseHandle(file);
+#else
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if(fd < 0)
+        return false;
+
+      bool success = ::fsync(fd) == 0;
+      ::close(fd);
+#endif
+      return success;
+    }
+
+    /**
+     * Read character data from the save file or from the characters folder.
+     * Does not log anything, so it can be called by the worker thread
+     */
+    bool readCharacter(const DataProxy& saveFile, const std::string& path, const std::string& name, const DataProxy* params, DataProxy& dest, std::string& error)
+    {
+      auto entityNodeOpt = saveFile.get<DataProxy>("characters." + name);
+
+      if(entityNodeOpt.second)
+      {
+        dest = entityNodeOpt.first;
+      }
+      else if(!FileLoader::getSingletonPtr()->load(path, DataProxy(), dest))
+      {
+        error = "Failed to create character: " + name + " not found in db";
+        return false;
+      }
+
+      if(params) {
+        mergeInto(dest, *params);
+      }
+      return true;
+    }
+
+    const std::string DELTA_SUFFIX = ".delta";
+
+    /**
+     * Serialize save record into a single line
+     */
+    std::string dumpRecord(const DataProxy& record)
+    {
+      std::string res = dumps(record, DataWrapper::JSON_OBJECT);
+      while(!res.empty() && res.back() == '\n')
+        res.pop_back();
+      return res;
+    }
+
+    /**
+     * Characters and settings of the save file, assembled from the save records
+     */
+    struct SaveContents
+    {
+      struct Character
+      {
+        std::pair<DataProxy, bool> data;
+        std::pair<DataProxy, bool> placement;
+      };
+
+      /**
+       * Read characters and placement of the area from the save file
+       */
+      void read(const DataProxy& save, const std::string& area)
+      {
+        settings = save.get<DataProxy>("settings");
+        // iterator values are reused by the iterator, so nodes are taken by key
+        auto charactersNode = save.get<DataProxy>("characters");
+        if(charactersNode.second)
+        {
+          for(auto& pair : charactersNode.first)
+            characters[pair.first].data = std::make_pair(charactersNode.first[pair.first], true);
+        }
+
+        auto placementNode = save.get<DataProxy>("placement." + area);
+        if(placementNode.second)
+        {
+          for(auto& pair : placementNode.first)
+            characters[pair.first].placement = std::make_pair(placementNode.first[pair.first], true);
+        }
+      }
+
+      /**
+       * Apply single save record: character update, removal or settings
+       */
+      void apply(const DataProxy& record)
+      {
+        auto id = record.get<std::string>("id");
+        if(id.second)
+        {
+          Character& character = characters[id.first];
+          character.data = record.get<DataProxy>("character");
+          character.placement = std::make_pair(DataProxy(), false);
+          if(record.count("position"))
+          {
+            character.placement.second = true;
+            copyPosition(record, PLACEMENT_POSITION, character.placement.first, PLACEMENT_POSITION);
+          }
+          return;
+        }
+
+        auto removed = record.get<std::string>("remove");
+        if(removed.second)
+        {
+          characters.erase(removed.first);
+          return;
+        }
+
+        auto settingsNode = record.get<DataProxy>("settings");
+        if(settingsNode.second)
+          settings = settingsNode;
+      }
+
+      /**
+       * Write contents to the save file
+       */
+      void write(DataProxy& save, const std::string& area) const
+      {
+        DataProxy charactersNode;
+        DataProxy placementNode;
+        for(auto& pair : characters)
+        {
+          if(pair.second.data.second)
+            charactersNode.put(pair.first, pair.second.data.first);
+          if(pair.second.placement.second)
+            placementNode.put(pair.first, pair.second.placement.first);
+        }
+
+        save.put("settings", settings.second ? settings.first : DataProxy());
+        save.put("characters", charactersNode);
+        save.put("placement." + area, placementNode);
+      }
+
+      std::map<std::string, Character> characters;
+      std::pair<DataProxy, bool> settings;
+    };
+
+    /**
+     * Apply delta records to the save file.
+     * Does not log anything, so it can be called by the worker thread
+     */
+    bool applySaveDelta(DataProxy& save, const std::string& path, std::string& error)
+    {
+      MappedFile file(path);
+      if(!file.isOpen() || file.size() == 0)
+        return true;
+
+      const char* data = file.data();
+      const char* end = data + file.size();
+      std::string area = save.get("area", "none");
+      SaveContents contents;
+      bool header = true;
+      while(data < end)
+      {
+        const char* lineEnd = std::find(data, end, '\n');
+        DataProxy record = DataProxy::create(DataWrapper::JSON_OBJECT);
+        // last record can be truncated if the game was interrupted while writing it
+        if(!record.fromBuffer(data, lineEnd - data))
+          break;
+
+        data = lineEnd + 1;
+        if(header)
+        {
+          header = false;
+          // delta log of the older save file, rewrite was interrupted
+          if(record.get("revision", "") != save.get("revision", ""))
+          {
+            error = "Ignored outdated save delta " + path;
+            return false;
+          }
+          contents.read(save, area);
+          continue;
+        }
+
+        contents.apply(record);
+      }
+
+      if(!header)
+        contents.write(save, area);
+      return true;
+    }
+  }
+
+  /**
+   * Area prefabs, kept with the entity templates, so that the next loads skip resolving them.
+   * Worker thread gets prefabs from the cache, templates are resolved by the main thread
+   */
+  struct GameDataManager::PrefabCache
+  {
+    struct Entry
+    {
+      int64_t mtime;
+      std::shared_ptr<Prefab> prefab;
+    };
+
+    /**
+     * Get prefab with unpacked entity templates, prefab is read again if the file was changed
+     */
+    std::shared_ptr<Prefab> load(const std::string& path)
+    {
+      int64_t mtime;
+      if(!FileLoader::getModificationTime(path, mtime))
+        return std::shared_ptr<Prefab>();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      auto iter = entries.find(path);
+      if(iter != entries.end() && iter->second.mtime == mtime)
+        return iter->second.prefab;
+
+      MappedFile file(path);
+      std::shared_ptr<Prefab> prefab = std::make_shared<Prefab>();
+      if(!file.isOpen() || !prefab->read(file.data(), file.size()))
+      {
+        entries.erase(path);
+        return std::shared_ptr<Prefab>();
+      }
+
+      prefab->getEntityTemplates();
+      Entry& entry = entries[path];
+      entry.mtime = mtime;
+      entry.prefab = prefab;
+      return prefab;
+    }
+
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+  };
+
+  /**
+   * Files and entities of a single load.
+   * Worker thread fills it and sets the state, then it is only accessed by the main thread
+   */
+  struct GameDataManager::LoadTask
+  {
+    enum Source
+    {
+      Area,
+      Save,
+      // new game save template
+      Template
+    };
+
+    enum State
+    {
+      Reading,
+      Ready,
+      Failed
+    };
+
+    struct Entry
+    {
+      DataProxy data;
+      // entity is a character, it is stored in the save file
+      bool character;
+      // entity of the area prefab, it is created from the resolved template
+      Engine::EntityTemplate* entityTemplate;
+    };
+
+    LoadTask(Source source, const std::string& name)
+      : source(source)
+      , name(name)
+      , area(name)
+      , state(Reading)
+      , started(false)
+      , created(0)
+    {
+    }
+
+    Source source;
+    std::string name;
+    std::string area;
+    std::string extension;
+    std::string charactersFolder;
+    std::string levelsFolder;
+    std::string savesFolder;
+
+    DataProxy saveFile;
+    // entities reference this document, so it should live as long as the task
+    DataProxy areaData;
+    std::shared_ptr<PrefabCache> prefabs;
+    // keeps entity templates of the area alive
+    std::shared_ptr<Prefab> prefab;
+    std::pair<DataProxy, bool> settings;
+    std::vector<Entry> entities;
+    // worker thread does not log, messages are logged by the main thread
+    std::vector<std::string> errors;
+    std::atomic<int> state;
+
+    bool started;
+    size_t created;
+  };
+
+  /**
+   * Save file write, it is created on the main thread and then only accessed by the worker
+   */
+  struct GameDataManager::SaveJob
+  {
+    std::string path;
+    // rewrite save file and start new delta log, otherwise records are appended to the delta log
+    bool full;
+    std::string revision;
+    std::string area;
+    std::string settings;
+    std::vector<std::string> records;
+  };
+
+  /**
+   * State of incremental saves
+   */
+  struct GameDataManager::SaveState
+  {
+    SaveState()
+      : deltas(0)
+      , writing(false)
+    {
+    }
+
+    /**
+     * Forget written records, so that next save rewrites the whole file
+     */
+    void reset()
+    {
+      file.clear();
+      settings.clear();
+      records.clear();
+      deltas = 0;
+    }
+
+    struct Record
+    {
+      // nodes of the components, that track their changes
+      std::map<std::string, DataProxy> components;
+      // serialized record, as it was written to the save
+      std::string data;
+    };
+
+    // accessed by the main thread only
+    std::string file;
+    std::string area;
+    std::string revision;
+    std::string settings;
+    std::map<std::string, Record> records;
+    size_t deltas;
+
+    // shared with the writer
+    std::mutex mutex;
+    std::deque<SaveJob> jobs;
+    bool writing;
+    std::vector<std::string> errors;
+    // revision, which failed to write, its deltas can't be applied to the file on disk
+    std::string failedRevision;
+  };
+
+  const Event::Type AreaLoadEvent::PROGRESS = "areaLoadProgress";
+  const Event::TypeId AreaLoadEvent::PROGRESS_ID = Event::intern(AreaLoadEvent::PROGRESS);
+
+  const Event::Type AreaLoadEvent::COMPLETE = "areaLoadComplete";
+  const Event::TypeId AreaLoadEvent::COMPLETE_ID = Event::intern(AreaLoadEvent::COMPLETE);
+
+  const Event::Type AreaLoadEvent::FAILED = "areaLoadFailed";
+  const Event::TypeId AreaLoadEvent::FAILED_ID = Event::intern(AreaLoadEvent::FAILED);
+
+  AreaLoadEvent::AreaLoadEvent(ConstType type, const std::string& area, size_t loaded, size_t total)
+    : AreaLoadEvent(Event::intern(type), area, loaded, total)
+  {
+  }
+
+  AreaLoadEvent::AreaLoadEvent(Event::TypeId type, const std::string& area, size_t loaded, size_t total)
+    : Event(type)
+    , mArea(area)
+    , mLoaded(loaded)
+    , mTotal(total)
+  {
+  }
+
+  AreaLoadEvent::~AreaLoadEvent()
+  {
+  }
+
   const std::string GameDataManager::CONFIG_SECTION = "dataManager";
 
   GameDataManager::GameDataManager(Engine* engine, const DataProxy& config)
     : mEngine(engine)
     , mCurrentSaveFile(0)
+    , mPrefabs(std::make_shared<PrefabCache>())
+    , mSaveState(std::make_shared<SaveState>())
+    , mAutosaveElapsed(0)
   {
+    mFrameBudget      = config.get(CONFIG_SECTION + ".frameBudget", 5.0);
+    mCompactionThreshold = config.get(CONFIG_SECTION + ".compactSaveAfter", 256);
+    mAutosaveFile     = config.get(CONFIG_SECTION + ".autosave.file", "");
+    mAutosaveInterval = config.get(CONFIG_SECTION + ".autosave.interval", 0.0f);
     std::string workdir = engine->env().get("workdir", ".");
     mFileExtension    = config.get(CONFIG_SECTION + ".extension", "json");
     mCharactersFolder = workdir + GSAGE_PATH_SEPARATOR + config.get(CONFIG_SECTION + ".charactersFolder", ".");
@@ -50,112 +516,315 @@ namespace Gsage {
 
   GameDataManager::~GameDataManager()
   {
+    waitForSaves();
   }
 
   bool GameDataManager::initGame(const std::string& templateFile)
   {
-    resetSaveFile();
-    DataProxy& root = getSaveFile();
+    return startLoad(createLoadTask(LoadTask::Template, templateFile)) && finishLoad();
+  }
 
-    if(!FileLoader::getSingletonPtr()->load(mSavesFolder + GSAGE_PATH_SEPARATOR + templateFile + "." + mFileExtension, DataProxy(), root))
-      return false;
+  bool GameDataManager::loadSave(const std::string& saveFile)
+  {
+    return startLoad(createLoadTask(LoadTask::Save, saveFile)) && finishLoad();
+  }
 
-    const std::string& area = root.get("area", "none");
-    if(!loadArea(area))
+  bool GameDataManager::loadSaveAsync(const std::string& saveFile)
+  {
+    return startLoad(createLoadTask(LoadTask::Save, saveFile));
+  }
+
+  bool GameDataManager::dumpSave(const std::string& saveFile)
+  {
+    SaveState& state = *mSaveState;
+    SaveJob job;
+    job.path = saveFile + "." + mFileExtension;
+    job.area = getSaveFile().get("area", "none");
+    job.full = saveFile != state.file || job.area != state.area || state.deltas >= mCompactionThreshold;
     {
-      LOG(ERROR) << "Failed to load area: " << area;
-      return false;
+      std::lock_guard<std::mutex> lock(state.mutex);
+      // save file on disk does not have the written records, so it is rewritten with the new revision
+      if(!state.revision.empty() && state.failedRevision == state.revision)
+        job.full = true;
+    }
+
+    std::unordered_set<std::string> saved;
+    for(auto entity : mEngine->getEntities())
+    {
+      if(!entity->hasFlag("dynamic"))
+        continue;
+
+      SaveState::Record& record = state.records[entity->getId()];
+      saved.insert(entity->getId());
+      // clean entity is not changed since the last dump, so there is nothing to serialize
+      if(!entity->isDirty() && !record.data.empty())
+        continue;
+
+      std::string data = dumpCharacter(entity, record.components);
+      entity->setDirty(false);
+      if(data == record.data)
+        continue;
+
+      record.data.swap(data);
+      if(!job.full)
+        job.records.push_back(record.data);
+    }
+
+    for(auto iter = state.records.begin(); iter != state.records.end();)
+    {
+      if(saved.count(iter->first) != 0)
+      {
+        ++iter;
+        continue;
+      }
+
+      if(!job.full)
+      {
+        DataProxy removal;
+        removal.put("remove", iter->first);
+        job.records.push_back(dumpRecord(removal));
+      }
+      iter = state.records.erase(iter);
+    }
+
+    DataProxy settingsNode;
+    Engine::EngineSystems& systems = mEngine->getSystems();
+    for(auto pair : systems)
+    {
+      DataProxy config = pair.second->getConfig();
+      if(config.empty())
+        continue;
+
+      settingsNode.put(pair.first, config);
+    }
+
+    std::string settings = dumps(settingsNode, DataWrapper::JSON_OBJECT);
+    if(settings != state.settings)
+    {
+      state.settings.swap(settings);
+      if(!job.full)
+      {
+        DataProxy record;
+        record.put("settings", settingsNode);
+        job.records.push_back(dumpRecord(record));
+      }
+    }
+
+    if(job.full)
+    {
+      for(auto& pair : state.records)
+        job.records.push_back(pair.second.data);
+
+      // unique revision links delta log to the save file it was written for
+      state.revision = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+      state.file = saveFile;
+      state.area = job.area;
+      state.deltas = 0;
+      job.settings = state.settings;
+    }
+    else if(job.records.empty())
+    {
+      return true;
+    }
+    else
+    {
+      state.deltas += job.records.size();
     }
 
-    loadCharacters(area);
+    job.revision = state.revision;
+    queueSave(job);
     return true;
   }
 
-  bool GameDataManager::loadSave(const std::string& saveFile)
+  std::string GameDataManager::dumpCharacter(Entity* entity, std::map<std::string, DataProxy>& components)
   {
-    resetSaveFile();
-    DataProxy& root = getSaveFile();
+    DataProxy entityNode;
+    std::map<std::string, DataProxy> tracked;
+    for(auto& name : entity->getComponentNames())
+    {
+      EntityComponent* c = mEngine->getComponent(entity, name);
+      if(!c)
+        continue;
 
-    if(!FileLoader::getSingletonPtr()->load(saveFile + "." + mFileExtension, DataProxy(), root))
-      return initGame(saveFile);
+      auto cached = components.find(name);
+      if(!c->isDirty() && cached != components.end())
+      {
+        tracked[name] = cached->second;
+        entityNode.put(name, cached->second);
+        continue;
+      }
+
+      DataProxy node = c->getNode();
+      c->setDirty(false);
+      // component tracks changes, so the node can be reused until the next change
+      if(!c->isDirty())
+        tracked[name] = node;
+      entityNode.put(name, node);
+    }
+    components.swap(tracked);
+
+    entityNode.put("id", entity->getId());
+    entityNode.put("class", entity->getClass());
+    entityNode.put("props", entity->getProps());
 
-    const std::string& area = root.get<std::string>("area", "none");
-    if(!loadArea(area))
+    DataProxy record;
+    record.put("id", entity->getId());
+    record.put("character", entityNode);
+    // TODO figure out more flexible way to do it
+    if(entityNode.count("render"))
+      copyPosition(entityNode, RENDER_POSITION, record, PLACEMENT_POSITION);
+
+    return dumpRecord(record);
+  }
+
+  void GameDataManager::queueSave(SaveJob& job)
+  {
+    std::shared_ptr<SaveState> state = mSaveState;
     {
-      LOG(ERROR) << "Failed to load area: " << area;
-      return false;
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->jobs.push_back(std::move(job));
+      if(state->writing)
+        return;
+
+      state->writing = true;
     }
 
-    auto placement = root.get<DataProxy>("placement." + area);
-    if(placement.second)
+    mEngine->getScheduler().getThreadPool()->submit([state] () {
+      writeSaves(*state);
+    });
+  }
+
+  void GameDataManager::waitForSaves()
+  {
+    ThreadPool* pool = mEngine->getScheduler().getThreadPool();
+    while(true)
     {
-      for(auto& pair : placement.first)
       {
-        // TODO figure out more flexible way to do it
-        DataProxy params;
-        params.put("render.root.position", pair.second.get("position", "0,0,0"));
-        Entity* e = addCharacter(pair.first, &params);
+        std::lock_guard<std::mutex> lock(mSaveState->mutex);
+        if(!mSaveState->writing)
+          break;
       }
+
+      if(!pool->runPendingJob())
+        std::this_thread::yield();
     }
 
-    return true;
+    logSaveErrors();
   }
 
-  bool GameDataManager::dumpSave(const std::string& saveFile)
+  void GameDataManager::setAutosave(const std::string& saveFile, float interval)
   {
-    const ObjectPool<Entity>::PointerVector& entities = mEngine->getEntities();
-    DataProxy saveData;
-    DataProxy entitiesNode;
-    DataProxy placementNode;
-
-    std::string currentArea = getSaveFile().get("area", "none");
-    saveData.put("area", currentArea);
+    mAutosaveFile = saveFile;
+    mAutosaveInterval = interval;
+    mAutosaveElapsed = 0;
+  }
 
-    for(auto entity : entities)
+  void GameDataManager::logSaveErrors()
+  {
+    std::vector<std::string> errors;
     {
-      if(!entity->hasFlag("dynamic"))
-        continue;
+      std::lock_guard<std::mutex> lock(mSaveState->mutex);
+      errors.swap(mSaveState->errors);
+    }
+
+    for(auto& error : errors)
+      LOG(ERROR) << error;
+  }
 
-      DataProxy entityNode;
-      for(auto pair : entity->mComponents)
+  void GameDataManager::writeSaves(SaveState& state)
+  {
+    while(true)
+    {
+      SaveJob job;
       {
-        EntityComponent* c = mEngine->getComponent(entity, pair.first);
-        if(c)
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(state.jobs.empty())
         {
-          entityNode.put(pair.first, c->getNode());
+          state.writing = false;
+          return;
         }
+
+        job = std::move(state.jobs.front());
+        state.jobs.pop_front();
+        // deltas of the failed revision would be applied to the outdated save
+        if(!job.full && job.revision == state.failedRevision)
+          continue;
       }
-      entityNode.put("id", entity->getId());
-      entityNode.put("class", entity->getClass());
-      entityNode.put("props", entity->getProps());
-      entitiesNode.put(entity->getId(), entityNode);
 
-      // TODO figure out more flexible way to do it
-      EntityComponent* render = mEngine->getComponent(entity, "render");
+      std::string error;
+      if(!writeSave(job, error))
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.errors.push_back(error);
+        state.failedRevision = job.revision;
+      }
+    }
+  }
 
-      if(render)
+  bool GameDataManager::writeSave(const SaveJob& job, std::string& error)
+  {
+    std::string deltaPath = job.path + DELTA_SUFFIX;
+    if(!job.full)
+    {
+      std::ofstream stream(deltaPath, std::ios::app | std::ios::binary);
+      for(auto& record : job.records)
+        stream << record << '\n';
+
+      if(!stream)
       {
-        DataProxy renderData;
-        render->dump(renderData);
-        placementNode.put(entity->getId() + ".position", renderData.get("root.position", "0,0,0"));
+        error = "Failed to write save delta " + deltaPath;
+        return false;
       }
+      return true;
     }
 
-    DataProxy settingsNode;
-    Engine::EngineSystems& systems = mEngine->getSystems();
-    for(auto pair : systems)
+    SaveContents contents;
+    for(auto& data : job.records)
     {
-      DataProxy config = pair.second->getConfig();
-      if(config.empty())
-        continue;
+      DataProxy record = DataProxy::create(DataWrapper::JSON_OBJECT);
+      if(record.fromString(data))
+        contents.apply(record);
+    }
 
-      settingsNode.put(pair.first, config);
+    DataProxy settings = DataProxy::create(DataWrapper::JSON_OBJECT);
+    contents.settings = std::make_pair(settings, settings.fromString(job.settings));
+
+    DataProxy save;
+    save.put("area", job.area);
+    save.put("revision", job.revision);
+    contents.write(save, job.area);
+
+    // write the new file first, so that interrupted write does not break the old one
+    FileLoader* loader = FileLoader::getSingletonPtr();
+    std::string tmpPath = job.path + ".tmp";
+    if(!loader->dump(tmpPath, save) || !syncFile(tmpPath))
+    {
+      std::remove(tmpPath.c_str());
+      error = "Failed to write save file " + tmpPath;
+      return false;
     }
+    // replace the old file in one step, there is always a complete save on disk
+#if GSAGE_PLATFORM == GSAGE_WIN32
+    bool replaced = MoveFileExA(tmpPath.c_str(), job.path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    bool replaced = std::rename(tmpPath.c_str(), job.path.c_str()) == 0;
+#endif
+    if(!replaced)
+    {
+      error = "Failed to write save file " + job.path;
+      return false;
+    }
+    loader->flushCache(job.path);
 
-    saveData.put("settings", settingsNode);
-    saveData.put("characters", entitiesNode);
-    saveData.put("placement." + currentArea, placementNode);
-    FileLoader::getSingletonPtr()->dump(saveFile + "." + mFileExtension, saveData);
+    std::ofstream stream(deltaPath, std::ios::trunc | std::ios::binary);
+    DataProxy header;
+    header.put("revision", job.revision);
+    stream << dumpRecord(header) << '\n';
+    if(!stream)
+    {
+      error = "Failed to write save delta " + deltaPath;
+      return false;
+    }
     return true;
   }
 
@@ -186,82 +855,290 @@ namespace Gsage {
 
   bool GameDataManager::loadArea(const std::string& area)
   {
-    DataProxy areaInfo;
-    std::string path = mLevelsFolder + "/" + area + "." + mFileExtension;
-    LOG(INFO) << "Loading area " << path;
-    if(!FileLoader::getSingletonPtr()->load(path, DataProxy(), areaInfo))
+    return startLoad(createLoadTask(LoadTask::Area, area)) && finishLoad();
+  }
+
+  bool GameDataManager::loadAreaAsync(const std::string& area)
+  {
+    return startLoad(createLoadTask(LoadTask::Area, area));
+  }
+
+  Entity* GameDataManager::addCharacter(const std::string& name, DataProxy* params)
+  {
+    DataProxy entityNode;
+    std::string error;
+    if(!readCharacter(getSaveFile(), getDataFilePath(mCharactersFolder, name, mFileExtension), name, params, entityNode, error))
+    {
+      LOG(ERROR) << error;
+      return 0;
+    }
+
+    Entity* e = mEngine->createEntity(entityNode);
+    e->setFlag("dynamic");
+    return e;
+  }
+
+  void GameDataManager::cancelLoad()
+  {
+    mLoadTask.reset();
+  }
+
+  void GameDataManager::update(const float& time)
+  {
+    processLoad(mFrameBudget);
+    logSaveErrors();
+
+    if(mAutosaveFile.empty() || mAutosaveInterval <= 0 || mLoadTask)
+      return;
+
+    mAutosaveElapsed += time;
+    if(mAutosaveElapsed < mAutosaveInterval)
+      return;
+
+    mAutosaveElapsed = 0;
+    dumpSave(mAutosaveFile);
+  }
+
+  GameDataManager::LoadTaskPtr GameDataManager::createLoadTask(int source, const std::string& name)
+  {
+    LoadTaskPtr task = std::make_shared<LoadTask>((LoadTask::Source)source, name);
+    task->extension = mFileExtension;
+    task->charactersFolder = mCharactersFolder;
+    task->levelsFolder = mLevelsFolder;
+    task->savesFolder = mSavesFolder;
+    task->prefabs = mPrefabs;
+    if(source == LoadTask::Area)
+      task->settings = getSaveFile().get<DataProxy>("settings");
+
+    return task;
+  }
+
+  bool GameDataManager::startLoad(LoadTaskPtr task)
+  {
+    if(mLoadTask)
+    {
+      LOG(ERROR) << "Failed to load " << task->name << ": another load is in progress";
       return false;
+    }
 
-    auto entities = areaInfo.get<DataProxy>("entities");
-    if(!entities.second)
+    // save files can be read by the task, so pending writes should land first
+    waitForSaves();
+    // world is replaced, next save should rewrite the whole file
+    mSaveState->reset();
+
+    mLoadTask = task;
+    mEngine->getScheduler().getThreadPool()->submit([task] () {
+      task->state.store(readLoadTask(*task) ? LoadTask::Ready : LoadTask::Failed, std::memory_order_release);
+    });
+    return true;
+  }
+
+  bool GameDataManager::finishLoad()
+  {
+    LoadTaskPtr task = mLoadTask;
+    ThreadPool* pool = mEngine->getScheduler().getThreadPool();
+    // help the pool instead of sleeping, reading job may be still queued
+    while(task->state.load(std::memory_order_acquire) == LoadTask::Reading)
+    {
+      if(!pool->runPendingJob())
+        std::this_thread::yield();
+    }
+
+    return processLoad(-1);
+  }
+
+  bool GameDataManager::processLoad(double budget)
+  {
+    LoadTaskPtr task = mLoadTask;
+    if(!task)
+      return true;
+
+    int state = task->state.load(std::memory_order_acquire);
+    if(state == LoadTask::Reading)
+      return true;
+
+    for(auto& error : task->errors)
+      LOG(ERROR) << error;
+    task->errors.clear();
+
+    if(state == LoadTask::Failed)
     {
-      LOG(ERROR) << "No entities in area: " << area;
+      mLoadTask.reset();
+      mEngine->fireEvent(AreaLoadEvent(AreaLoadEvent::FAILED_ID, task->area));
       return false;
     }
 
-    auto systemsConfigs = getSaveFile().get<DataProxy>("settings");
-    if(!systemsConfigs.second)
-      systemsConfigs = areaInfo.get<DataProxy>("settings");
+    if(!task->started)
+    {
+      LOG(INFO) << "Loading area " << task->area << ", entities: " << task->entities.size();
+      task->started = true;
+      if(task->source != LoadTask::Area)
+      {
+        resetSaveFile();
+        getSaveFile() = task->saveFile;
+      }
+
+      if(task->settings.second)
+        mEngine->configureSystems(task->settings.first);
+    }
 
-    if(systemsConfigs.second)
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t total = task->entities.size();
+    // entity creation listeners can cancel the load
+    while(task->created < total && mLoadTask == task)
     {
-      mEngine->configureSystems(systemsConfigs.first);
+      LoadTask::Entry& entry = task->entities[task->created++];
+      Entity* e = entry.entityTemplate ? mEngine->createEntity(*entry.entityTemplate) : mEngine->createEntity(entry.data);
+      if(e && entry.character)
+        e->setFlag("dynamic");
+
+      if(budget >= 0 && std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() >= budget)
+        break;
     }
 
-    for(auto& element : entities.first)
+    if(mLoadTask != task)
+      return true;
+
+    if(task->created < total)
     {
-      mEngine->createEntity(element.second);
+      mEngine->fireEvent(AreaLoadEvent(AreaLoadEvent::PROGRESS_ID, task->area, task->created, total));
+      return true;
     }
+
+    mLoadTask.reset();
+    mEngine->fireEvent(AreaLoadEvent(AreaLoadEvent::COMPLETE_ID, task->area, total, total));
     return true;
   }
 
-  Entity* GameDataManager::addCharacter(const std::string& name, DataProxy* params)
+  bool GameDataManager::readLoadTask(LoadTask& task)
   {
-    DataProxy entityNode;
-    DataProxy& saveFile = getSaveFile();
-    auto entityNodeOpt = saveFile.get<DataProxy>("characters." + name);
+    FileLoader* loader = FileLoader::getSingletonPtr();
+    LoadTask::Source source = task.source;
+    if(source == LoadTask::Save)
+    {
+      std::string path = task.name + "." + task.extension;
+      std::string error;
+      if(!loader->load(path, DataProxy(), task.saveFile))
+        source = LoadTask::Template;
+      else if(!applySaveDelta(task.saveFile, path + DELTA_SUFFIX, error))
+        task.errors.push_back(error);
+    }
 
-    if(entityNodeOpt.second)
+    if(source == LoadTask::Template && !loader->load(task.savesFolder + GSAGE_PATH_SEPARATOR + task.name + "." + task.extension, DataProxy(), task.saveFile))
+      return false;
+
+    if(source != LoadTask::Area)
     {
-      entityNode = entityNodeOpt.first;
+      task.area = task.saveFile.get("area", "none");
+      task.settings = task.saveFile.get<DataProxy>("settings");
     }
-    else if(FileLoader::getSingletonPtr()->load(mCharactersFolder + "/" + name + "." + mFileExtension, DataProxy(), entityNode))
+
+    if(!readArea(task))
     {
-      LOG(INFO) << "Creating new character";
+      task.errors.push_back("Failed to load area: " + task.area);
+      return false;
     }
-    else
+
+    if(source == LoadTask::Save)
     {
-      LOG(ERROR) << "Failed to create character: " << name << " not found in db";
-      return 0;
+      auto placement = task.saveFile.get<DataProxy>("placement." + task.area);
+      if(placement.second)
+      {
+        for(auto& pair : placement.first)
+        {
+          // TODO figure out more flexible way to do it
+          DataProxy params;
+          copyPosition(pair.second, PLACEMENT_POSITION, params, RENDER_POSITION);
+          LoadTask::Entry entry = {DataProxy(), true};
+          std::string error;
+          if(readCharacter(task.saveFile, getDataFilePath(task.charactersFolder, pair.first, task.extension), pair.first, &params, entry.data, error))
+            task.entities.push_back(entry);
+          else
+            task.errors.push_back(error);
+        }
+      }
     }
+    else if(source == LoadTask::Template)
+    {
+      // new game: characters are taken from the placement index
+      DataProxy charactersIndex;
+      if(!loader->load(task.levelsFolder + "/placement." + task.extension, DataProxy(), charactersIndex))
+        return true;
+
+      auto locationCharacters = charactersIndex.get<DataProxy>(task.area);
+      if(!locationCharacters.second)
+        return true;
 
-    if(params) {
-      mergeInto(entityNode, *params);
+      for(auto& node : locationCharacters.first)
+      {
+        std::string entityId = node.second.as<std::string>();
+        LoadTask::Entry entry = {DataProxy(), true};
+        std::string error;
+        if(readCharacter(task.saveFile, getDataFilePath(task.charactersFolder, entityId, task.extension), entityId, 0, entry.data, error))
+          task.entities.push_back(entry);
+        else
+          task.errors.push_back(error);
+      }
     }
 
-    Entity* e = mEngine->createEntity(entityNode);
-    e->setFlag("dynamic");
-    return e;
+    return true;
   }
 
-  bool GameDataManager::loadCharacters(const std::string& area)
+  bool GameDataManager::readArea(LoadTask& task)
   {
-    DataProxy charactersIndex;
-    if(!FileLoader::getSingletonPtr()->load(mLevelsFolder + "/placement." + mFileExtension, DataProxy(), charactersIndex))
+    DataProxy& areaInfo = task.areaData;
+    std::string path = getDataFilePath(task.levelsFolder, task.area, task.extension);
+    if(isPrefabPath(path))
+    {
+      task.prefab = task.prefabs->load(path);
+      if(task.prefab)
+        areaInfo = task.prefab->getData();
+    }
+
+    if(!task.prefab && !FileLoader::getSingletonPtr()->load(path, DataProxy(), areaInfo))
+    {
+      task.errors.push_back("Failed to read area file " + path);
       return false;
+    }
 
-    auto locationCharacters = charactersIndex.get<DataProxy>(area);
-    // no charactes on specified area
-    if(!locationCharacters.second)
-      return true;
+    auto entities = areaInfo.get<DataProxy>("entities");
+    if(!entities.second)
+    {
+      task.errors.push_back("No entities in area: " + task.area);
+      return false;
+    }
+
+    if(!task.settings.second)
+      task.settings = areaInfo.get<DataProxy>("settings");
 
-    std::string entityId;
-    for(auto& node : locationCharacters.first)
+    if(task.prefab)
     {
-      entityId = node.second.as<std::string>();
-      addCharacter(entityId);
+      for(auto& entityTemplate : task.prefab->getEntityTemplates())
+      {
+        LoadTask::Entry entry = {entityTemplate.data, false, &entityTemplate};
+        task.entities.push_back(entry);
+      }
+      return true;
     }
 
+    // iterator values are reused by the iterator, so entities are taken by index or key
+    DataProxy& list = entities.first;
+    if(list.getStoredType() == DataWrapper::Array)
+    {
+      for(int i = 0; i < list.size(); i++)
+      {
+        LoadTask::Entry entry = {list[i], false};
+        task.entities.push_back(entry);
+      }
+    }
+    else
+    {
+      for(auto& element : list)
+      {
+        LoadTask::Entry entry = {list[element.first], false};
+        task.entities.push_back(entry);
+      }
+    }
     return true;
   }
 
@@ -46,8 +46,11 @@ namespace Gsage {
 
   const std::string PLUGINS_SECTION = "plugins";
   const Event::Type GsageFacade::LOAD = "load";
+  const Event::TypeId GsageFacade::LOAD_ID = Event::intern(GsageFacade::LOAD);
   const Event::Type GsageFacade::RESET = "reset";
+  const Event::TypeId GsageFacade::RESET_ID = Event::intern(GsageFacade::RESET);
   const Event::Type GsageFacade::BEFORE_RESET = "beforeReset";
+  const Event::TypeId GsageFacade::BEFORE_RESET_ID = Event::intern(GsageFacade::BEFORE_RESET);
 
   GsageFacade::GsageFacade() :
       mStarted(false),
@@ -141,6 +144,7 @@ namespace Gsage {
     }
 
     addEventListener(&mEngine, EngineEvent::SHUTDOWN, &GsageFacade::onEngineShutdown);
+    addEventListener(&mEngine, AreaLoadEvent::COMPLETE, &GsageFacade::onAreaLoaded);
 
     auto inputHandler = mConfig.get<std::string>("inputHandler");
     if(inputHandler.second) {
@@ -152,6 +156,7 @@ namespace Gsage {
       return false;
 
     mGameDataManager = new GameDataManager(&mEngine, mConfig);
+    addUpdateListener(mGameDataManager);
     mLuaInterface->setResourcePath(resourcePath);
     if(mConfig.get<bool>("startLuaInterface", true)) {
       mLuaInterface->initialize(mLuaState);
@@ -279,9 +284,13 @@ namespace Gsage {
     {
       listener->update(frameTime);
     }
+    // poll input first, so that input events are dispatched in the same frame
+    mInputManager.update(frameTime);
+    // dispatch events posted by the background threads and queued since the previous frame
+    mEngine.getEventInbox().drain();
+    mEngine.getEventQueue()->flush();
     // update engine
     mEngine.update(frameTime);
-    mInputManager.update(frameTime);
     mPreviousUpdateTime = now;
     std::this_thread::sleep_for(std::chrono::microseconds((long)(6000 - frameTime)));
 
@@ -295,35 +304,39 @@ namespace Gsage {
 
   void GsageFacade::shutdown(int exitCode)
   {
-    mEngine.fireEvent(EngineEvent(EngineEvent::STOPPING));
+    mEngine.fireEvent(EngineEvent(EngineEvent::STOPPING_ID));
     mExitCode = exitCode;
     mStopped = true;
   }
 
   void GsageFacade::reset()
   {
-    mEngine.fireEvent(Event(BEFORE_RESET));
+    mEngine.fireEvent(Event(BEFORE_RESET_ID));
+    if(mGameDataManager)
+      mGameDataManager->cancelLoad();
     mEngine.unloadAll();
-    mEngine.fireEvent(Event(RESET));
+    mEngine.fireEvent(Event(RESET_ID));
   }
 
   bool GsageFacade::loadArea(const std::string& name)
   {
-    if(!mGameDataManager->loadArea(name))
-    {
-      return false;
-    }
-
-    mEngine.fireEvent(Event(LOAD));
-    return true;
+    // LOAD event is fired by onAreaLoaded
+    return mGameDataManager->loadArea(name);
   }
 
   bool GsageFacade::loadSave(const std::string& name)
   {
-    if(!mGameDataManager->loadSave(name))
-      return false;
-    mEngine.fireEvent(Event(LOAD));
-    return true;
+    return mGameDataManager->loadSave(name);
+  }
+
+  bool GsageFacade::loadAreaAsync(const std::string& name)
+  {
+    return mGameDataManager->loadAreaAsync(name);
+  }
+
+  bool GsageFacade::loadSaveAsync(const std::string& name)
+  {
+    return mGameDataManager->loadSaveAsync(name);
   }
 
   bool GsageFacade::dumpSave(const std::string& name)
@@ -365,6 +378,12 @@ namespace Gsage {
     return true;
   }
 
+  bool GsageFacade::onAreaLoaded(EventDispatcher* sender, const Event& event)
+  {
+    mEngine.fireEvent(Event(LOAD_ID));
+    return true;
+  }
+
   bool GsageFacade::loadPlugin(const std::string& path)
   {
     DynLib* lib = 0;
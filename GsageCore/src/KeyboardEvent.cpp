@@ -28,9 +28,16 @@ THE SOFTWARE.
 
 namespace Gsage {
   const Event::Type KeyboardEvent::KEY_DOWN = "KeyboardEvent::KEY_DOWN";
+  const Event::TypeId KeyboardEvent::KEY_DOWN_ID = Event::intern(KeyboardEvent::KEY_DOWN);
   const Event::Type KeyboardEvent::KEY_UP = "KeyboardEvent::KEY_UP";
+  const Event::TypeId KeyboardEvent::KEY_UP_ID = Event::intern(KeyboardEvent::KEY_UP);
 
   KeyboardEvent::KeyboardEvent(Event::ConstType type, const Key& code, const unsigned int t, const unsigned int modState)
+    : KeyboardEvent(Event::intern(type), code, t, modState)
+  {
+  }
+
+  KeyboardEvent::KeyboardEvent(Event::TypeId type, const Key& code, const unsigned int t, const unsigned int modState)
     : Event(type)
     , key(code)
     , text(t)
@@ -53,8 +60,14 @@ namespace Gsage {
   }
 
   const Event::Type TextInputEvent::INPUT = "TextInputEvent::INPUT";
+  const Event::TypeId TextInputEvent::INPUT_ID = Event::intern(TextInputEvent::INPUT);
 
   TextInputEvent::TextInputEvent(Event::ConstType type, const char* text)
+    : TextInputEvent(Event::intern(type), text)
+  {
+  }
+
+  TextInputEvent::TextInputEvent(Event::TypeId type, const char* text)
     : Event(type)
     , mUTF8Chars(text)
   {
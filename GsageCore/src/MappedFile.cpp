@@ -0,0 +1,223 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "MappedFile.h"
+#include "GsageDefinitions.h"
+
+#include <fstream>
+
+#if GSAGE_PLATFORM == GSAGE_WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace Gsage
+{
+  MappedFile::MappedFile()
+    : mData(0)
+    , mSize(0)
+    , mOpen(false)
+    , mMapping(0)
+  {
+  }
+
+  MappedFile::MappedFile(const std::string& path)
+    : MappedFile()
+  {
+    open(path);
+  }
+
+  MappedFile::~MappedFile()
+  {
+    close();
+  }
+
+  MappedFile::MappedFile(MappedFile&& other)
+    : MappedFile()
+  {
+    swap(other);
+  }
+
+  MappedFile& MappedFile::operator=(MappedFile&& other)
+  {
+    if(this != &other) {
+      close();
+      swap(other);
+    }
+    return *this;
+  }
+
+  void MappedFile::swap(MappedFile& other)
+  {
+    std::swap(mPath, other.mPath);
+    std::swap(mData, other.mData);
+    std::swap(mSize, other.mSize);
+    std::swap(mOpen, other.mOpen);
+    std::swap(mMapping, other.mMapping);
+    // vector swap keeps element addresses, so mData stays valid
+    mBuffer.swap(other.mBuffer);
+  }
+
+  bool MappedFile::open(const std::string& path)
+  {
+    close();
+    mPath = path;
+    mOpen = map() || read();
+    return mOpen;
+  }
+
+  void MappedFile::close()
+  {
+    if(mMapping) {
+#if GSAGE_PLATFORM == GSAGE_WIN32
+      UnmapViewOfFile(mMapping);
+#else
+      munmap(mMapping, mSize);
+#endif
+      mMapping = 0;
+    }
+
+    mBuffer.clear();
+    mBuffer.shrink_to_fit();
+    mData = 0;
+    mSize = 0;
+    mOpen = false;
+  }
+
+  bool MappedFile::isOpen() const
+  {
+    return mOpen;
+  }
+
+  bool MappedFile::isMapped() const
+  {
+    return mMapping != 0;
+  }
+
+  const char* MappedFile::data() const
+  {
+    return mData;
+  }
+
+  size_t MappedFile::size() const
+  {
+    return mSize;
+  }
+
+  const std::string& MappedFile::getPath() const
+  {
+    return mPath;
+  }
+
+  std::string MappedFile::str() const
+  {
+    return mSize == 0 ? std::string() : std::string(mData, mSize);
+  }
+
+  bool MappedFile::map()
+  {
+#if GSAGE_PLATFORM == GSAGE_WIN32
+    HANDLE file = CreateFileA(mPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+      CloseHandle(file);
+      return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if(mapping == NULL) {
+      return false;
+    }
+
+    // the view holds a reference to the mapping object, so it can be closed right away
+    mMapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(mMapping == NULL) {
+      mMapping = 0;
+      return false;
+    }
+    mSize = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(mPath.c_str(), O_RDONLY);
+    if(fd == -1) {
+      return false;
+    }
+
+    struct stat info;
+    // empty files and special files can't be mapped
+    if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+      ::close(fd);
+      return false;
+    }
+
+    void* mapping = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED) {
+      return false;
+    }
+
+    mMapping = mapping;
+    mSize = static_cast<size_t>(info.st_size);
+#endif
+    mData = static_cast<const char*>(mMapping);
+    return true;
+  }
+
+  bool MappedFile::read()
+  {
+    std::ifstream stream(mPath, std::ios::binary);
+    if(!stream) {
+      return false;
+    }
+
+    stream.seekg(0, std::ios::end);
+    std::streamoff size = stream.tellg();
+    if(size < 0) {
+      return false;
+    }
+    stream.seekg(0, std::ios::beg);
+
+    mBuffer.resize(static_cast<size_t>(size));
+    if(size > 0 && !stream.read(mBuffer.data(), size)) {
+      mBuffer.clear();
+      return false;
+    }
+
+    mData = mBuffer.empty() ? "" : mBuffer.data();
+    mSize = mBuffer.size();
+    return true;
+  }
+}
@@ -29,10 +29,18 @@ THE SOFTWARE.
 using namespace Gsage;
 
 const Event::Type MouseEvent::MOUSE_DOWN = "mouseDown";
+const Event::TypeId MouseEvent::MOUSE_DOWN_ID = Event::intern(MouseEvent::MOUSE_DOWN);
 const Event::Type MouseEvent::MOUSE_UP = "mouseUp";
+const Event::TypeId MouseEvent::MOUSE_UP_ID = Event::intern(MouseEvent::MOUSE_UP);
 const Event::Type MouseEvent::MOUSE_MOVE = "mouseMove";
+const Event::TypeId MouseEvent::MOUSE_MOVE_ID = Event::intern(MouseEvent::MOUSE_MOVE);
 
-MouseEvent::MouseEvent(Event::ConstType type, const float& w, const float& h, const ButtonType& b, const std::string& dispatcher) 
+MouseEvent::MouseEvent(Event::ConstType type, const float& w, const float& h, const ButtonType& b, const std::string& dispatcher)
+  : MouseEvent(Event::intern(type), w, h, b, dispatcher)
+{
+}
+
+MouseEvent::MouseEvent(Event::TypeId type, const float& w, const float& h, const ButtonType& b, const std::string& dispatcher)
   : Event(type)
   , width(w)
   , height(h)
@@ -0,0 +1,140 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "Prefab.h"
+
+#include <cstring>
+
+namespace Gsage
+{
+  namespace {
+    const char MAGIC[4] = {'G', 'S', 'P', 'F'};
+
+    void writeUInt32(std::string& dest, uint32_t value)
+    {
+      for(int i = 0; i < 4; i++)
+        dest.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+
+    uint32_t readUInt32(const char* data)
+    {
+      uint32_t res = 0;
+      for(int i = 0; i < 4; i++)
+        res |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (i * 8);
+      return res;
+    }
+  }
+
+  const std::string Prefab::EXTENSION = "prefab";
+
+  Prefab::Prefab()
+    : mUnpacked(false)
+  {
+  }
+
+  Prefab::~Prefab()
+  {
+  }
+
+  bool Prefab::compile(const DataProxy& data, std::string& dest)
+  {
+    std::string payload = dumps(data, DataWrapper::MSGPACK_OBJECT);
+    if(payload.empty())
+      return false;
+
+    dest.clear();
+    dest.reserve(HEADER_SIZE + payload.size());
+    dest.append(MAGIC, sizeof(MAGIC));
+    writeUInt32(dest, VERSION);
+    writeUInt32(dest, static_cast<uint32_t>(payload.size()));
+    dest.append(payload);
+    return true;
+  }
+
+  bool Prefab::isPrefab(const char* data, size_t size)
+  {
+    return size >= HEADER_SIZE && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+  }
+
+  bool Prefab::read(const char* data, size_t size)
+  {
+    mPayload.clear();
+    mData = DataProxy();
+    mEntityTemplates.clear();
+    mUnpacked = false;
+    if(!isPrefab(data, size) || readUInt32(data + 4) != VERSION)
+      return false;
+
+    size_t payloadSize = readUInt32(data + 8);
+    if(payloadSize == 0 || payloadSize > size - HEADER_SIZE)
+      return false;
+
+    mPayload.assign(data + HEADER_SIZE, payloadSize);
+    return true;
+  }
+
+  bool Prefab::instantiate(DataProxy& dest) const
+  {
+    if(empty())
+      return false;
+
+    DataProxy res = DataProxy::create(DataWrapper::MSGPACK_OBJECT);
+    if(!res.fromBuffer(mPayload.data(), mPayload.size()))
+      return false;
+
+    dest = res;
+    return true;
+  }
+
+  std::vector<Engine::EntityTemplate>& Prefab::getEntityTemplates()
+  {
+    if(mUnpacked)
+      return mEntityTemplates;
+
+    mUnpacked = true;
+    if(!instantiate(mData))
+      return mEntityTemplates;
+
+    auto entities = mData.get<DataProxy>("entities");
+    if(!entities.second)
+      return mEntityTemplates;
+
+    // iterator values are reused by the iterator, so entities are taken by index or key
+    DataProxy& list = entities.first;
+    mEntityTemplates.reserve(list.size());
+    if(list.getStoredType() == DataWrapper::Array)
+    {
+      for(int i = 0; i < list.size(); i++)
+        mEntityTemplates.emplace_back(list[i]);
+    }
+    else
+    {
+      for(auto& element : list)
+        mEntityTemplates.emplace_back(list[element.first]);
+    }
+    return mEntityTemplates;
+  }
+}
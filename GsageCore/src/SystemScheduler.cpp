@@ -0,0 +1,246 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "SystemScheduler.h"
+#include "EngineSystem.h"
+#include "Logger.h"
+
+namespace Gsage
+{
+
+  SystemScheduler::SystemScheduler()
+    : mPending(0)
+    , mTime(0)
+    , mDirty(true)
+    , mParallel(false)
+  {
+  }
+
+  SystemScheduler::~SystemScheduler()
+  {
+  }
+
+  void SystemScheduler::configure(const DataProxy& config)
+  {
+    setParallel(config.get("parallel", false), config.get("workers", 0));
+  }
+
+  void SystemScheduler::setParallel(bool value, size_t workers)
+  {
+    mParallel = value;
+    if(!mParallel)
+      return;
+
+    if(!mPool)
+      mPool = std::unique_ptr<ThreadPool>(new ThreadPool(workers));
+    else if(workers != 0 && workers != mPool->getWorkerCount())
+      mPool->start(workers);
+
+    LOG(INFO) << "Parallel system update enabled, worker count: " << mPool->getWorkerCount();
+  }
+
+  bool SystemScheduler::isParallel() const
+  {
+    return mParallel;
+  }
+
+  void SystemScheduler::invalidate()
+  {
+    mDirty = true;
+  }
+
+  ThreadPool* SystemScheduler::getThreadPool()
+  {
+    if(!mPool)
+      mPool = std::unique_ptr<ThreadPool>(new ThreadPool());
+
+    return mPool.get();
+  }
+
+  void SystemScheduler::update(const Systems& systems, const double& time)
+  {
+    if(!mParallel)
+    {
+      for(auto& pair : systems)
+      {
+        if(pair.second->isEnabled())
+          pair.second->update(time);
+      }
+      return;
+    }
+
+    if(mDirty)
+      build(systems);
+
+    if(mNodes.empty())
+      return;
+
+    mTime = time;
+    for(size_t i = 0; i < mNodes.size(); ++i)
+    {
+      mRemaining[i] = mNodes[i].dependencies;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mPending = mNodes.size();
+    }
+
+    for(size_t index : mRoots)
+    {
+      dispatch(index);
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(mPending > 0)
+    {
+      if(!mMainQueue.empty())
+      {
+        size_t index = mMainQueue.back();
+        mMainQueue.pop_back();
+        lock.unlock();
+        run(index);
+        lock.lock();
+        continue;
+      }
+
+      // help workers instead of waiting idle
+      lock.unlock();
+      bool worked = mPool->runPendingJob();
+      lock.lock();
+      if(worked)
+        continue;
+
+      mWake.wait(lock, [this] { return mPending == 0 || !mMainQueue.empty(); });
+    }
+  }
+
+  void SystemScheduler::build(const Systems& systems)
+  {
+    mNodes.clear();
+    mRoots.clear();
+    for(auto& pair : systems)
+    {
+      Node node;
+      node.system = pair.second;
+      node.dependencies = 0;
+      node.mainThread = pair.second->isMainThreadOnly();
+      mNodes.push_back(node);
+    }
+
+    // keep engine order for the conflicting systems
+    for(size_t i = 0; i < mNodes.size(); ++i)
+    {
+      for(size_t j = i + 1; j < mNodes.size(); ++j)
+      {
+        if(!conflicts(mNodes[i].system, mNodes[j].system))
+          continue;
+
+        mNodes[i].dependents.push_back(j);
+        mNodes[j].dependencies++;
+      }
+
+      if(mNodes[i].dependencies == 0)
+        mRoots.push_back(i);
+    }
+
+    mRemaining = std::unique_ptr<std::atomic<size_t>[]>(new std::atomic<size_t>[mNodes.size()]);
+    mMainQueue.clear();
+    mMainQueue.reserve(mNodes.size());
+    mDirty = false;
+  }
+
+  bool SystemScheduler::conflicts(EngineSystem* first, EngineSystem* second) const
+  {
+    if(first->isExclusive() || second->isExclusive())
+      return true;
+
+    for(auto& type : first->getWrites())
+    {
+      if(second->getWrites().count(type) != 0 || second->getReads().count(type) != 0)
+        return true;
+    }
+
+    for(auto& type : second->getWrites())
+    {
+      if(first->getReads().count(type) != 0)
+        return true;
+    }
+    return false;
+  }
+
+  void SystemScheduler::dispatch(size_t index)
+  {
+    if(mNodes[index].mainThread)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMainQueue.push_back(index);
+      }
+      mWake.notify_one();
+      return;
+    }
+
+    mPool->submit([this, index] { run(index); });
+  }
+
+  void SystemScheduler::run(size_t index)
+  {
+    while(true)
+    {
+      Node& node = mNodes[index];
+      if(node.system->isEnabled())
+        node.system->update(mTime);
+
+      // the first released dependent, which can run on any thread, is updated right away by this thread
+      size_t next = mNodes.size();
+      for(size_t dependent : node.dependents)
+      {
+        if(--mRemaining[dependent] != 0)
+          continue;
+
+        if(next == mNodes.size() && !mNodes[dependent].mainThread)
+          next = dependent;
+        else
+          dispatch(dependent);
+      }
+
+      bool done;
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        done = --mPending == 0;
+      }
+
+      if(done)
+        mWake.notify_one();
+
+      if(next == mNodes.size())
+        break;
+
+      index = next;
+    }
+  }
+}
@@ -0,0 +1,249 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace Gsage {
+
+  namespace {
+    // pool and queue index of the current worker thread
+    thread_local ThreadPool* currentPool = 0;
+    thread_local size_t currentWorker = 0;
+
+    /**
+     * Shared state of the single parallelFor call
+     */
+    struct ParallelForState
+    {
+      const ThreadPool::ChunkFunction* func;
+      size_t count;
+      size_t grainSize;
+      size_t chunks;
+      std::atomic<size_t> nextChunk;
+      std::atomic<size_t> nextParticipant;
+      std::atomic<size_t> finishedHelpers;
+
+      void process(size_t participant)
+      {
+        size_t chunk;
+        while((chunk = nextChunk++) < chunks)
+        {
+          size_t begin = chunk * grainSize;
+          size_t end = std::min(begin + grainSize, count);
+          (*func)(begin, end, participant);
+        }
+      }
+    };
+  }
+
+  ThreadPool::ThreadPool(size_t workers)
+    : mPending(0)
+    , mNextQueue(0)
+    , mRunning(false)
+  {
+    start(workers);
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    stop();
+  }
+
+  size_t ThreadPool::getDefaultWorkerCount()
+  {
+    size_t concurrency = std::thread::hardware_concurrency();
+    return concurrency > 1 ? concurrency - 1 : 1;
+  }
+
+  void ThreadPool::start(size_t workers)
+  {
+    stop();
+    if(workers == 0)
+      workers = getDefaultWorkerCount();
+
+    mRunning = true;
+    for(size_t i = 0; i < workers; ++i)
+    {
+      mQueues.emplace_back(new Queue());
+    }
+
+    for(size_t i = 0; i < workers; ++i)
+    {
+      mThreads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+  }
+
+  void ThreadPool::stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mWakeMutex);
+      mRunning = false;
+    }
+    mWake.notify_all();
+
+    for(auto& thread : mThreads)
+    {
+      thread.join();
+    }
+    mThreads.clear();
+    mQueues.clear();
+    mPending = 0;
+  }
+
+  void ThreadPool::submit(const Job& job)
+  {
+    size_t index = currentPool == this ? currentWorker : mNextQueue++ % mQueues.size();
+    // counter is increased before the push, so pop can never make it negative
+    {
+      std::lock_guard<std::mutex> lock(mWakeMutex);
+      mPending++;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mQueues[index]->mutex);
+      mQueues[index]->jobs.push_back(job);
+    }
+    mWake.notify_one();
+  }
+
+  size_t ThreadPool::parallelFor(size_t count, size_t grainSize, const ChunkFunction& func)
+  {
+    if(count == 0)
+      return 0;
+
+    if(grainSize == 0)
+      grainSize = 1;
+
+    ParallelForState state;
+    state.func = &func;
+    state.count = count;
+    state.grainSize = grainSize;
+    state.chunks = (count + grainSize - 1) / grainSize;
+    state.nextChunk = 0;
+    state.nextParticipant = 1;
+    state.finishedHelpers = 0;
+
+    size_t helpers = std::min(state.chunks - 1, mThreads.size());
+    ParallelForState* statePtr = &state;
+    for(size_t i = 0; i < helpers; ++i)
+    {
+      submit([statePtr] {
+        statePtr->process(statePtr->nextParticipant++);
+        statePtr->finishedHelpers++;
+      });
+    }
+
+    state.process(0);
+
+    // state lives on the stack, so wait for all helpers, even those which got no chunks
+    while(state.finishedHelpers < helpers)
+    {
+      if(!runPendingJob())
+        std::this_thread::yield();
+    }
+    return helpers + 1;
+  }
+
+  size_t ThreadPool::getMaxParticipants() const
+  {
+    return mThreads.size() + 1;
+  }
+
+  bool ThreadPool::runPendingJob()
+  {
+    if(mQueues.empty())
+      return false;
+
+    Job job;
+    if(!steal(mQueues.size(), job))
+      return false;
+
+    job();
+    return true;
+  }
+
+  size_t ThreadPool::getWorkerCount() const
+  {
+    return mThreads.size();
+  }
+
+  void ThreadPool::workerLoop(size_t index)
+  {
+    currentPool = this;
+    currentWorker = index;
+
+    Job job;
+    while(true)
+    {
+      if(pop(index, job) || steal(index, job))
+      {
+        job();
+        job = nullptr;
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mWakeMutex);
+      mWake.wait(lock, [this] { return !mRunning || mPending > 0; });
+      if(!mRunning)
+        break;
+    }
+
+    currentPool = 0;
+  }
+
+  bool ThreadPool::pop(size_t index, Job& job)
+  {
+    Queue& queue = *mQueues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.jobs.empty())
+      return false;
+
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    mPending--;
+    return true;
+  }
+
+  bool ThreadPool::steal(size_t thief, Job& job)
+  {
+    const size_t count = mQueues.size();
+    for(size_t i = 1; i <= count; ++i)
+    {
+      Queue& queue = *mQueues[(thief + i) % count];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if(queue.jobs.empty())
+        continue;
+
+      job = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+      mPending--;
+      return true;
+    }
+    return false;
+  }
+}
@@ -0,0 +1,259 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "TimerWheel.h"
+#include <cmath>
+
+namespace Gsage
+{
+
+  TimerWheel::TimerWheel(double resolution)
+    : mFree(INVALID)
+    , mCount(0)
+    , mPending(0)
+    , mAdvancing(false)
+    , mTick(0)
+    , mResolution(resolution)
+    , mAccumulated(0)
+  {
+    for(uint32_t i = 0; i <= PENDING; ++i) {
+      mSlots[i] = INVALID;
+    }
+  }
+
+  TimerWheel::~TimerWheel()
+  {
+  }
+
+  TimerWheel::Handle TimerWheel::schedule(double delay, void* data)
+  {
+    uint32_t index;
+    if(mFree != INVALID) {
+      index = mFree;
+      mFree = mEntries[index].next;
+    } else {
+      index = (uint32_t)mEntries.size();
+      Entry entry;
+      entry.generation = 0;
+      mEntries.push_back(entry);
+    }
+
+    // tick mTick + n is processed in (n + 1) * resolution - accumulated seconds
+    double ticks = std::ceil((delay + mAccumulated) / mResolution - 1e-9) - 1;
+    Entry& entry = mEntries[index];
+    entry.expires = mTick + (ticks > 0 ? (uint64_t)ticks : 0);
+    entry.data = data;
+    mCount++;
+    if(mAdvancing) {
+      link(index, PENDING);
+      mPending++;
+    } else {
+      insert(index);
+    }
+    return Handle(index, entry.generation);
+  }
+
+  bool TimerWheel::cancel(const Handle& handle)
+  {
+    if(!isScheduled(handle))
+      return false;
+
+    if(mEntries[handle.index].slot == PENDING)
+      mPending--;
+
+    unlink(handle.index);
+    release(handle.index);
+    return true;
+  }
+
+  bool TimerWheel::isScheduled(const Handle& handle) const
+  {
+    return handle.index < mEntries.size() &&
+      mEntries[handle.index].slot != INVALID &&
+      mEntries[handle.index].generation == handle.generation;
+  }
+
+  double TimerWheel::getTimeLeft(const Handle& handle) const
+  {
+    if(!isScheduled(handle))
+      return 0;
+
+    const Entry& entry = mEntries[handle.index];
+    uint64_t ticks = entry.expires > mTick ? entry.expires - mTick : 0;
+    return (ticks + 1) * mResolution - mAccumulated;
+  }
+
+  TimerWheel::Handle TimerWheel::getHandleAt(uint32_t index) const
+  {
+    if(index >= mEntries.size() || mEntries[index].slot == INVALID)
+      return Handle();
+
+    return Handle(index, mEntries[index].generation);
+  }
+
+  void* TimerWheel::getData(const Handle& handle) const
+  {
+    if(!isScheduled(handle))
+      return 0;
+
+    return mEntries[handle.index].data;
+  }
+
+  size_t TimerWheel::size() const
+  {
+    return mCount;
+  }
+
+  void TimerWheel::reserve(size_t count)
+  {
+    size_t size = mEntries.size();
+    if(count <= size)
+      return;
+
+    Entry entry;
+    entry.generation = 0;
+    mEntries.resize(count, entry);
+    // chain new entries into the free list, lowest index first
+    for(size_t i = count; i > size; --i) {
+      Entry& e = mEntries[i - 1];
+      e.slot = INVALID;
+      e.next = mFree;
+      mFree = (uint32_t)(i - 1);
+    }
+  }
+
+  void TimerWheel::clear()
+  {
+    for(uint32_t i = 0; i <= PENDING; ++i) {
+      while(mSlots[i] != INVALID) {
+        uint32_t index = mSlots[i];
+        unlink(index);
+        release(index);
+      }
+    }
+    mPending = 0;
+  }
+
+  double TimerWheel::getTime() const
+  {
+    return mTick * mResolution + mAccumulated;
+  }
+
+  void TimerWheel::insert(uint32_t index)
+  {
+    Entry& entry = mEntries[index];
+    uint64_t expires = entry.expires < mTick ? mTick : entry.expires;
+    uint64_t delta = expires - mTick;
+
+    uint32_t level = 0;
+    while(level < LEVELS - 1 && delta >= ((uint64_t)1 << (SLOT_BITS * (level + 1)))) {
+      level++;
+    }
+
+    // timers beyond the wheel range wait in the last slot of the top level and are cascaded again
+    uint64_t range = (uint64_t)1 << (SLOT_BITS * LEVELS);
+    if(delta >= range) {
+      expires = mTick + range - 1;
+    }
+
+    link(index, level * SLOTS + (uint32_t)((expires >> (SLOT_BITS * level)) & (SLOTS - 1)));
+  }
+
+  void TimerWheel::link(uint32_t index, uint32_t slot)
+  {
+    Entry& entry = mEntries[index];
+    entry.slot = slot;
+    entry.prev = INVALID;
+    entry.next = mSlots[slot];
+    if(entry.next != INVALID) {
+      mEntries[entry.next].prev = index;
+    }
+    mSlots[slot] = index;
+  }
+
+  void TimerWheel::insertPending()
+  {
+    // overdue timers are put into the current tick slot, so they fire in the next call
+    while(mSlots[PENDING] != INVALID) {
+      uint32_t index = mSlots[PENDING];
+      unlink(index);
+      insert(index);
+    }
+    mPending = 0;
+  }
+
+  void TimerWheel::unlink(uint32_t index)
+  {
+    Entry& entry = mEntries[index];
+    if(entry.prev != INVALID) {
+      mEntries[entry.prev].next = entry.next;
+    } else {
+      mSlots[entry.slot] = entry.next;
+    }
+
+    if(entry.next != INVALID) {
+      mEntries[entry.next].prev = entry.prev;
+    }
+  }
+
+  void TimerWheel::moveSlot(uint32_t from, uint32_t to)
+  {
+    while(mSlots[from] != INVALID) {
+      uint32_t index = mSlots[from];
+      unlink(index);
+      link(index, to);
+    }
+  }
+
+  void TimerWheel::cascade()
+  {
+    for(uint32_t level = 1; level < LEVELS; ++level) {
+      uint32_t slot = (uint32_t)((mTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+      uint32_t current = mSlots[level * SLOTS + slot];
+      mSlots[level * SLOTS + slot] = INVALID;
+      while(current != INVALID) {
+        uint32_t next = mEntries[current].next;
+        insert(current);
+        current = next;
+      }
+
+      // upper level is cascaded only when this one wraps
+      if(slot != 0)
+        break;
+    }
+  }
+
+  void TimerWheel::release(uint32_t index)
+  {
+    Entry& entry = mEntries[index];
+    entry.slot = INVALID;
+    entry.data = 0;
+    entry.generation++;
+    entry.next = mFree;
+    mFree = index;
+    mCount--;
+  }
+}
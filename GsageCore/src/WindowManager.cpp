@@ -43,7 +43,7 @@ namespace Gsage {
     return mType;
   }
 
-  void WindowManager::fireWindowEvent(Event::ConstType type, unsigned long handle, unsigned int width, unsigned int height)
+  void WindowManager::fireWindowEvent(Event::TypeId type, unsigned long handle, unsigned int width, unsigned int height)
   {
     fireEvent(WindowEvent(type, handle, width, height));
   }
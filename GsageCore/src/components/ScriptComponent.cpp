@@ -38,6 +38,7 @@ namespace Gsage {
     : mSetupExecuted(false)
     , mTearDownExecuted(false)
     , mHasBehavior(false)
+    , mSleepTime(0)
   {
     BIND_ACCESSOR_OPTIONAL("behavior", &ScriptComponent::setBehavior, &ScriptComponent::getBehavior);
     BIND_ACCESSOR_OPTIONAL("setupScript", &ScriptComponent::setSetupScript, &ScriptComponent::getSetupScript);
@@ -46,6 +47,7 @@ namespace Gsage {
 
     BIND_SETTER_OPTIONAL("setupFunction", &ScriptComponent::setSetupFunction);
     BIND_SETTER_OPTIONAL("tearDownFunction", &ScriptComponent::setTearDownFunction);
+    setReadsResolvedProperties(true);
   }
 
   ScriptComponent::~ScriptComponent()
@@ -160,6 +162,16 @@ namespace Gsage {
     return mHasBehavior;
   }
 
+  void ScriptComponent::setSleepTime(double value)
+  {
+    mSleepTime = value;
+  }
+
+  double ScriptComponent::getSleepTime() const
+  {
+    return mSleepTime;
+  }
+
   void ScriptComponent::setContext(const DataProxy& context)
   {
     mUpdatedContext = context;
@@ -26,11 +26,38 @@ THE SOFTWARE.
 
 #include "components/StatsComponent.h"
 
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
 namespace Gsage {
 
+  namespace {
+    struct StatRegistry
+    {
+      std::mutex mutex;
+      std::unordered_map<std::string, StatId> ids;
+      // deque keeps name references valid on growth
+      std::deque<std::string> names;
+
+      static StatRegistry& instance()
+      {
+        static StatRegistry registry;
+        return registry;
+      }
+    };
+  }
+
   const Event::Type StatEvent::STAT_CHANGE = "statChange";
+  const Event::TypeId StatEvent::STAT_CHANGE_ID = Event::intern(StatEvent::STAT_CHANGE);
 
   StatEvent::StatEvent(const std::string& type, const std::string& statId)
+    : StatEvent(Event::intern(type), statId)
+  {
+  }
+
+  StatEvent::StatEvent(Event::TypeId type, const std::string& statId)
     : Event(type)
     , mStatId(statId)
   {
@@ -43,9 +70,41 @@ namespace Gsage {
 
   const std::string StatsComponent::SYSTEM = "stats";
 
+  StatId StatsComponent::getStatId(const std::string& name)
+  {
+    StatRegistry& registry = StatRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto iter = registry.ids.find(name);
+    if(iter != registry.ids.end())
+      return iter->second;
+
+    StatId id = (StatId)registry.names.size();
+    registry.ids[name] = id;
+    registry.names.push_back(name);
+    return id;
+  }
+
+  StatId StatsComponent::findStatId(const std::string& name)
+  {
+    StatRegistry& registry = StatRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto iter = registry.ids.find(name);
+    return iter == registry.ids.end() ? INVALID_STAT : iter->second;
+  }
+
+  const std::string& StatsComponent::getStatName(StatId id)
+  {
+    static const std::string empty;
+    StatRegistry& registry = StatRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return id < registry.names.size() ? registry.names[id] : empty;
+  }
+
   StatsComponent::StatsComponent()
-    : mStats(DataProxy::create(DataWrapper::JSON_OBJECT))
+    : mData(DataProxy::create(DataWrapper::JSON_OBJECT))
+    , mDirtyCount(0)
   {
+    setTracksChanges(true);
   }
 
   StatsComponent::~StatsComponent()
@@ -55,31 +114,178 @@ namespace Gsage {
 
   bool StatsComponent::hasStat(const std::string& id)
   {
-    return mStats.count(id) != 0;
+    return hasStat(findStatId(id));
   }
 
   bool StatsComponent::read(const DataProxy& dict)
   {
-    dict.dump(mStats, DataProxy::ForceCopy);
+    setDirty();
+    for(auto& pair : dict)
+    {
+      Stat& stat = getOrCreateStat(getStatId(pair.first));
+      switch(pair.second.getStoredType())
+      {
+        case DataWrapper::Int:
+        case DataWrapper::UInt:
+          stat.type = Stat::Int;
+          stat.number = pair.second.getValueOptional<double>(0);
+          break;
+        case DataWrapper::Float:
+        case DataWrapper::Double:
+          stat.type = Stat::Float;
+          stat.number = pair.second.getValueOptional<double>(0);
+          break;
+        case DataWrapper::Bool:
+          stat.type = Stat::Bool;
+          stat.number = pair.second.getValueOptional<bool>(false) ? 1 : 0;
+          break;
+        case DataWrapper::String:
+          stat.type = Stat::String;
+          stat.string = pair.second.getValueOptional<std::string>("");
+          break;
+        default:
+          stat.type = Stat::Data;
+          stat.string.clear();
+          mData.put(pair.first, pair.second);
+      }
+    }
     return true;
   }
 
-  DataProxy& StatsComponent::data()
+  DataProxy StatsComponent::data()
   {
-    return mStats;
+    DataProxy res = DataProxy::create(DataWrapper::JSON_OBJECT);
+    dump(res);
+    return res;
   }
 
   bool StatsComponent::dump(DataProxy& dict)
   {
-    mStats.dump(dict, DataProxy::ForceCopy);
+    for(auto& stat : mStats)
+    {
+      const std::string& name = getStatName(stat.id);
+      switch(stat.type)
+      {
+        case Stat::Int:
+          if(stat.number >= std::numeric_limits<int>::min() && stat.number <= std::numeric_limits<int>::max())
+            dict.put(name, static_cast<int>(stat.number));
+          else
+            dict.put(name, stat.number);
+          break;
+        case Stat::Float:
+          dict.put(name, stat.number);
+          break;
+        case Stat::Bool:
+          dict.put(name, stat.number != 0);
+          break;
+        case Stat::String:
+          dict.put(name, stat.string);
+          break;
+        case Stat::Data:
+          dict.put(name, mData.get<DataProxy>(name).first);
+          break;
+        default:
+          break;
+      }
+    }
     return true;
   }
 
   const float StatsComponent::increase(const std::string& key, const float& n)
   {
-    float newVal = getStat(key, 0.0f) + n;
-    setStat(key, newVal);
+    StatId id = getStatId(key);
+    float newVal = getStat(id, 0.0f) + n;
+    setStat(id, newVal);
     return newVal;
   }
 
+  size_t StatsComponent::flushChanges()
+  {
+    if(mDirtyCount == 0)
+      return 0;
+
+    size_t count = 0;
+    mDirtyCount = 0;
+    // handlers can modify stats if events are fired immediately, so iterate by index
+    for(size_t i = 0; i < mStats.size(); ++i)
+    {
+      if(!mStats[i].dirty)
+        continue;
+
+      mStats[i].dirty = false;
+      StatId id = mStats[i].id;
+      queueEvent(StatEvent(StatEvent::STAT_CHANGE_ID, getStatName(id)), id);
+      count++;
+    }
+    return count;
+  }
+
+  StatsComponent::Stat& StatsComponent::getOrCreateStat(StatId id)
+  {
+    if(id >= mIndex.size())
+      mIndex.resize(id + 1, 0);
+
+    if(mIndex[id] == 0)
+    {
+      mStats.emplace_back(id);
+      mIndex[id] = (uint32_t)mStats.size();
+    }
+
+    return mStats[mIndex[id] - 1];
+  }
+
+  void StatsComponent::markChanged(Stat& stat)
+  {
+    setDirty();
+    if(!getEventQueue())
+    {
+      fireEvent(StatEvent(StatEvent::STAT_CHANGE_ID, getStatName(stat.id)));
+      return;
+    }
+
+    if(stat.dirty)
+      return;
+
+    stat.dirty = true;
+    mDirtyCount++;
+  }
+
+  bool StatsComponent::readValue(const Stat& stat, bool& dest) const
+  {
+    if(stat.type != Stat::Int && stat.type != Stat::Float && stat.type != Stat::Bool)
+      return false;
+
+    dest = stat.number != 0;
+    return true;
+  }
+
+  bool StatsComponent::readValue(const Stat& stat, std::string& dest) const
+  {
+    if(stat.type != Stat::String)
+      return false;
+
+    dest = stat.string;
+    return true;
+  }
+
+  bool StatsComponent::writeValue(Stat& stat, const bool& value)
+  {
+    double number = value ? 1 : 0;
+    if(stat.type == Stat::Bool && stat.number == number)
+      return false;
+
+    stat.type = Stat::Bool;
+    stat.number = number;
+    return true;
+  }
+
+  bool StatsComponent::writeValue(Stat& stat, const std::string& value)
+  {
+    if(stat.type == Stat::String && stat.string == value)
+      return false;
+
+    stat.type = Stat::String;
+    stat.string = value;
+    return true;
+  }
 }
@@ -53,12 +53,12 @@ namespace Gsage {
     return true;
   }
 
-  void InputHandler::fireMouseEvent(Event::ConstType type, int x, int y, int z)
+  void InputHandler::fireMouseEvent(Event::TypeId type, int x, int y, int z)
   {
     fireMouseEvent(type, x, y, z, MouseEvent::None);
   }
 
-  void InputHandler::fireMouseEvent(Event::ConstType type, int x, int y, int z, const MouseEvent::ButtonType button)
+  void InputHandler::fireMouseEvent(Event::TypeId type, int x, int y, int z, const MouseEvent::ButtonType button)
   {
     MouseEvent e(type, mWidth, mHeight, button);
     e.setAbsolutePosition(x, y, z);
@@ -66,7 +66,20 @@ namespace Gsage {
     mPreviousX = x;
     mPreviousY = y;
     mPreviousZ = z;
-    mEngine->fireEvent(e);
+    if(type != MouseEvent::MOUSE_MOVE_ID)
+    {
+      mEngine->queueEvent(e);
+      return;
+    }
+
+    // only the last mouse position is dispatched, relative movement is accumulated
+    mEngine->queueEvent(e, mHandle, [](MouseEvent& queued, const MouseEvent& event) {
+      float x = queued.relativeX + event.relativeX;
+      float y = queued.relativeY + event.relativeY;
+      float z = queued.relativeZ + event.relativeZ;
+      queued = event;
+      queued.setRelativePosition(x, y, z);
+    });
   }
 
   InputManager::InputManager(Engine* engine)
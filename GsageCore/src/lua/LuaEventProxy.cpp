@@ -25,11 +25,55 @@ THE SOFTWARE.
 */
 
 #include "lua/LuaEventProxy.h"
+#include "lua/LuaProfiler.h"
 #include "Logger.h"
 
 namespace Gsage  {
 
+  bool LuaEventProxy::GenericCallback::operator()(const Event& event)
+  {
+    lua_State* L = mState;
+    int top = lua_gettop(L);
+    mFunc.push();
+
+    // lua object is created once per event type, then only the pointer it holds is replaced
+    void** ptr = 0;
+    void* previous = 0;
+    if(mEvent->valid()) {
+      mEvent->push();
+      ptr = static_cast<void**>(sol::detail::align_usertype_pointer(lua_touserdata(L, -1)));
+      previous = *ptr;
+      *ptr = const_cast<void*>(cast(event));
+    } else {
+      *mEvent = wrap(event);
+      mEvent->push();
+      ptr = static_cast<void**>(sol::detail::align_usertype_pointer(lua_touserdata(L, -1)));
+    }
+
+    int nargs = 1;
+    if(!mFields.empty()) {
+      int index = lua_gettop(L);
+      for(auto& field : mFields) {
+        lua_getfield(L, index, field.c_str());
+      }
+      lua_remove(L, index);
+      nargs = (int)mFields.size();
+    }
+
+    int status = lua_pcall(L, nargs, 0, 0);
+    // restore the object for the outer dispatch of the same event type
+    *ptr = previous;
+    if(status != 0) {
+      const char* error = lua_tostring(L, -1);
+      LOG(WARNING) << "Failed to call " << event.getType() << " lua listener: " << (error ? error : "unknown error");
+    }
+    lua_settop(L, top);
+    return status == 0;
+  }
+
   LuaEventProxy::LuaEventProxy()
+    : mDispatching(0)
+    , mDirty(false)
   {
 
   }
@@ -37,17 +81,18 @@ namespace Gsage  {
   LuaEventProxy::~LuaEventProxy()
   {
     mCallbackBindings.clear();
+    mRemoved.clear();
+    mEventObjects.clear();
   }
 
   bool LuaEventProxy::addEventListener(EventDispatcher* dispatcher, Event::ConstType eventType, const sol::object& callback)
   {
-    if(callback.get_type() != sol::type::function)
-      return false;
+    return addEventListener<Event>(dispatcher, eventType, callback);
+  }
 
-    Callbacks* cb = getCallbacks(dispatcher, eventType);
-    Callbacks& callbacks = cb != 0 ? *cb : subscribe(dispatcher, eventType);
-    callbacks.push_back(GenericCallbackPtr(new GenericCallback(callback.as<sol::protected_function>())));
-    return true;
+  bool LuaEventProxy::addUnpackedEventListener(EventDispatcher* dispatcher, Event::ConstType eventType, const sol::object& callback, const sol::table& fields)
+  {
+    return addUnpackedEventListener<Event>(dispatcher, eventType, callback, fields);
   }
 
   bool LuaEventProxy::removeEventListener(EventDispatcher* dispatcher, Event::ConstType eventType, const sol::object& callback)
@@ -60,22 +105,28 @@ namespace Gsage  {
       return false;
 
     sol::protected_function listener = callback.as<sol::protected_function>();
-    Callbacks::iterator iter = std::find_if(callbacks->begin(), callbacks->end(), [listener](GenericCallbackPtr e){
-      return e->func() == listener;
+    Callbacks::iterator iter = std::find_if(callbacks->begin(), callbacks->end(), [listener](const GenericCallbackPtr& e){
+      return !e->removed() && e->func() == listener;
     });
     if(iter == callbacks->end())
       return false;
 
-    int previousSize = callbacks->size();
+    if(mDispatching > 0) {
+      // callback can be still in use, it is deleted when the dispatch is over
+      (*iter)->setRemoved();
+      mDirty = true;
+      LOG(INFO) << "Removed event callback " << eventType;
+      return true;
+    }
+
     callbacks->erase(iter);
     if(callbacks->size() == 0)
     {
       EventSubscriber<LuaEventProxy>::removeEventListener(dispatcher, eventType, &LuaEventProxy::handleEvent);
-      mCallbackBindings.erase(CallbackBinding(dispatcher, eventType));
+      mCallbackBindings.erase(CallbackBinding(dispatcher, Event::intern(eventType)));
       LOG(INFO) << "Removed event listener for event " << eventType << " as there is no more lua callbacks";
     } else {
       LOG(INFO) << "Removed event callback " << eventType;
-      assert(getCallbacks(dispatcher, eventType)->size() != previousSize);
     }
 
     return true;
@@ -83,34 +134,81 @@ namespace Gsage  {
 
   bool LuaEventProxy::handleEvent(EventDispatcher* sender, const Event& event)
   {
-    Callbacks* callbacks = getCallbacks(sender, event.getType());
-    if(callbacks != 0)
+    CallbackBindings::iterator iter = mCallbackBindings.find(CallbackBinding(sender, event.getTypeId()));
+    if(iter == mCallbackBindings.end())
+      return true;
+
+    // callbacks can be added or removed by lua listeners, so the list is copied first
+    size_t begin = mDispatchStack.size();
+    for(auto& callback : iter->second) {
+      mDispatchStack.push_back(callback.get());
+    }
+    size_t end = mDispatchStack.size();
+
+    // listeners can start or stop the profiler, so it is checked before each call
+    LuaProfiler* scopeProfiler = 0;
+    uint32_t scope = LuaProfiler::NO_SCOPE;
+
+    mDispatching++;
+    for(size_t i = begin; i < end; ++i)
     {
-      for(auto callback : (*callbacks))
+      GenericCallback* callback = mDispatchStack[i];
+      if(callback->removed())
+        continue;
+
+      if(!callback->valid())
       {
-        if(!callback->valid())
-        {
-          removeEventListener(sender, event.getType(), callback->func());
-          LOG(ERROR) << "Failed to call " << event.getType() << " listener invalid, removed from subscribers";
-          continue;
-        }
-        std::string error;
-        auto res = (*callback)(event);
-        if(!res.valid()) {
-          sol::error err = res;
-          error = err.what();
-        }
+        callback->setRemoved();
+        mDirty = true;
+        LOG(ERROR) << "Failed to call " << event.getType() << " listener invalid, removed from subscribers";
+        continue;
+      }
 
-        if(!error.empty())
-        {
-          LOG(WARNING) << "Failed to call " << event.getType() << " lua listener: " << error;
+      LuaProfiler* profiler = LuaProfiler::getActive();
+      if(profiler) {
+        if(profiler != scopeProfiler) {
+          scope = profiler->getScope("event " + event.getType());
+          scopeProfiler = profiler;
         }
+        profiler->enterScope(scope);
+      }
+
+      (*callback)(event);
+      if(profiler) {
+        profiler->leaveScope();
       }
     }
+    mDispatchStack.resize(begin);
+
+    if(--mDispatching == 0 && mDirty)
+      cleanup();
 
     return true;
   }
 
+  void LuaEventProxy::cleanup()
+  {
+    mDirty = false;
+    mRemoved.clear();
+    CallbackBindings::iterator iter = mCallbackBindings.begin();
+    while(iter != mCallbackBindings.end())
+    {
+      Callbacks& callbacks = (*iter).second;
+      callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), [](const GenericCallbackPtr& e){
+        return e->removed();
+      }), callbacks.end());
+
+      if(callbacks.empty()) {
+        Event::ConstType eventType = Event::getTypeName((*iter).first.second);
+        EventSubscriber<LuaEventProxy>::removeEventListener((*iter).first.first, eventType, &LuaEventProxy::handleEvent);
+        LOG(INFO) << "Removed event listener for event " << eventType << " as there is no more lua callbacks";
+        iter = mCallbackBindings.erase(iter);
+      } else {
+        iter++;
+      }
+    }
+  }
+
   bool LuaEventProxy::onForceUnsubscribe(EventDispatcher* sender, const Event& event)
   {
     EventSubscriber<LuaEventProxy>::onForceUnsubscribe(sender, event);
@@ -119,9 +217,16 @@ namespace Gsage  {
     {
       if((*iter).first.first == sender)
       {
-        LOG(TRACE) << "Unbinding lua callbacks, event type: " << (*iter).first.second;
-        CallbackBindings::iterator tmp = iter++;
-        mCallbackBindings.erase(tmp);
+        LOG(TRACE) << "Unbinding lua callbacks, event type: " << Event::getTypeName((*iter).first.second);
+        if(mDispatching > 0) {
+          // keep callbacks alive until the dispatch is over
+          for(auto& callback : (*iter).second) {
+            callback->setRemoved();
+            mRemoved.push_back(std::move(callback));
+          }
+          mDirty = true;
+        }
+        iter = mCallbackBindings.erase(iter);
       }
       else
       {
@@ -131,19 +236,30 @@ namespace Gsage  {
     return true;
   }
 
-  LuaEventProxy::Callbacks* LuaEventProxy::getCallbacks(EventDispatcher* dispatcher, Event::ConstType eventType)
+  LuaEventProxy::Callbacks* LuaEventProxy::getCallbacks(EventDispatcher* dispatcher, Event::ConstType eventType, bool create)
   {
-    CallbackBinding binding(dispatcher, eventType);
-    if(mCallbackBindings.count(binding) == 0)
+    CallbackBinding binding(dispatcher, Event::intern(eventType));
+    CallbackBindings::iterator iter = mCallbackBindings.find(binding);
+    if(iter != mCallbackBindings.end())
+      return &(*iter).second;
+
+    if(!create)
       return 0;
 
-    return &mCallbackBindings[binding];
+    Callbacks& res = mCallbackBindings[binding];
+    EventSubscriber<LuaEventProxy>::addEventListener(dispatcher, eventType, &LuaEventProxy::handleEvent);
+    return &res;
   }
 
-  LuaEventProxy::Callbacks& LuaEventProxy::subscribe(EventDispatcher* dispatcher, Event::ConstType eventType)
+  LuaEventProxy::Fields LuaEventProxy::readFields(const sol::table& fields) const
   {
-    Callbacks& res = mCallbackBindings[CallbackBinding(dispatcher, eventType)];
-    EventSubscriber<LuaEventProxy>::addEventListener(dispatcher, eventType, &LuaEventProxy::handleEvent);
+    Fields res;
+    for(size_t i = 1; i <= fields.size(); ++i) {
+      sol::optional<std::string> field = fields[i];
+      if(field) {
+        res.push_back(field.value());
+      }
+    }
     return res;
   }
 }
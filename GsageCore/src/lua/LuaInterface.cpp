@@ -192,6 +192,8 @@ namespace Gsage {
         "loadSave", &GsageFacade::loadSave,
         "dumpSave", &GsageFacade::dumpSave,
         "loadArea", &GsageFacade::loadArea,
+        "loadSaveAsync", &GsageFacade::loadSaveAsync,
+        "loadAreaAsync", &GsageFacade::loadAreaAsync,
         "loadPlugin", &GsageFacade::loadPlugin,
         "unloadPlugin", &GsageFacade::unloadPlugin,
         "createSystem", &GsageFacade::createSystem,
@@ -215,7 +217,54 @@ namespace Gsage {
 
     lua.new_usertype<LuaScriptSystem>("ScriptSystem",
         "addUpdateListener", &LuaScriptSystem::addUpdateListener,
-        "removeUpdateListener", &LuaScriptSystem::removeUpdateListener
+        "removeUpdateListener", &LuaScriptSystem::removeUpdateListener,
+        "waitSeconds", &LuaScriptSystem::waitSeconds,
+        "isSleeping", &LuaScriptSystem::isSleeping,
+        "getSleepTime", &LuaScriptSystem::getSleepTime,
+        "sleepingCount", sol::property(&LuaScriptSystem::getSleepingCount),
+        "profiler", sol::property(&LuaScriptSystem::getProfiler)
+    );
+
+    lua.new_usertype<LuaProfiler>("LuaProfiler",
+        "new", sol::no_constructor,
+        "start", sol::overload(
+          [] (LuaProfiler* self) { return self->start(); },
+          [] (LuaProfiler* self, double interval) { return self->start(interval); },
+          &LuaProfiler::start
+        ),
+        "stop", &LuaProfiler::stop,
+        "reset", &LuaProfiler::reset,
+        "running", sol::property(&LuaProfiler::isRunning),
+        "sampleCount", sol::property(&LuaProfiler::getSampleCount),
+        "countNativeCalls", sol::property(&LuaProfiler::getCountNativeCalls, &LuaProfiler::setCountNativeCalls),
+        "functions", sol::property(&LuaProfiler::getFunctions),
+        "lines", sol::property(&LuaProfiler::getLines),
+        "scopes", sol::property(&LuaProfiler::getScopes),
+        "getFunctionName", &LuaProfiler::getFunctionName,
+        "folded", sol::property(&LuaProfiler::getFoldedStacks),
+        "saveFolded", &LuaProfiler::saveFoldedStacks
+    );
+
+    lua.new_usertype<LuaProfiler::FunctionStats>("LuaProfilerFunction",
+        "name", sol::readonly(&LuaProfiler::FunctionStats::name),
+        "source", sol::readonly(&LuaProfiler::FunctionStats::source),
+        "line", sol::readonly(&LuaProfiler::FunctionStats::line),
+        "selfSamples", sol::readonly(&LuaProfiler::FunctionStats::selfSamples),
+        "totalSamples", sol::readonly(&LuaProfiler::FunctionStats::totalSamples)
+    );
+
+    lua.new_usertype<LuaProfiler::LineStats>("LuaProfilerLine",
+        "functionId", sol::readonly(&LuaProfiler::LineStats::function),
+        "line", sol::readonly(&LuaProfiler::LineStats::line),
+        "samples", sol::readonly(&LuaProfiler::LineStats::samples)
+    );
+
+    lua.new_usertype<LuaProfiler::ScopeStats>("LuaProfilerScope",
+        "name", sol::readonly(&LuaProfiler::ScopeStats::name),
+        "calls", sol::readonly(&LuaProfiler::ScopeStats::calls),
+        "nativeCalls", sol::readonly(&LuaProfiler::ScopeStats::nativeCalls),
+        "samples", sol::readonly(&LuaProfiler::ScopeStats::samples),
+        "time", sol::readonly(&LuaProfiler::ScopeStats::time)
     );
 
     // --------------------------------------------------------------------------------
@@ -223,7 +272,7 @@ namespace Gsage {
 
     lua.new_usertype<StatsComponent>("StatsComponent",
         sol::base_classes, sol::bases<EventDispatcher, Reflection>(),
-        "hasStat", &StatsComponent::hasStat,
+        "hasStat", (bool(StatsComponent::*)(const std::string&))&StatsComponent::hasStat,
         "getBool", sol::overload(
           (const bool(StatsComponent::*)(const std::string&))&StatsComponent::getStat<bool>,
           (const bool(StatsComponent::*)(const std::string&, const bool&))&StatsComponent::getStat<bool>
@@ -238,9 +287,9 @@ namespace Gsage {
         ),
         "data", sol::property(&StatsComponent::data),
         "set", sol::overload(
-          &StatsComponent::setStat<bool>,
-          &StatsComponent::setStat<std::string>,
-          &StatsComponent::setStat<float>
+          (void(StatsComponent::*)(const std::string&, const bool&))&StatsComponent::setStat<bool>,
+          (void(StatsComponent::*)(const std::string&, const std::string&))&StatsComponent::setStat<std::string>,
+          (void(StatsComponent::*)(const std::string&, const float&))&StatsComponent::setStat<float>
         ),
         "increase", &StatsComponent::increase
     );
@@ -252,11 +301,12 @@ namespace Gsage {
 
     lua.new_usertype<Entity>("Entity",
         "id", sol::property(&Entity::getId),
+        "handle", sol::property(&Entity::getHandle),
         "class", sol::property(&Entity::getClass),
         "props", sol::property(&Entity::getProps, &Entity::setProps),
         "getProps", &Entity::getProps,
         "hasComponent", &Entity::hasComponent,
-        "hasComponents", &Entity::hasComponents,
+        "hasComponents", (bool(Entity::*)(std::vector<std::string>))&Entity::hasComponents,
         "componentNames", sol::property(&Entity::getComponentNames)
     );
 
@@ -269,8 +319,14 @@ namespace Gsage {
         "settings", sol::property(&Engine::settings)
     );
 
-    lua["Engine"]["removeEntity"] = (bool(Engine::*)(const std::string& id))&Engine::removeEntity;
-    lua["Engine"]["getEntity"] = &Engine::getEntity;
+    lua["Engine"]["removeEntity"] = sol::overload(
+      (bool(Engine::*)(Entity::Handle))&Engine::removeEntity,
+      (bool(Engine::*)(const std::string&))&Engine::removeEntity
+    );
+    lua["Engine"]["getEntity"] = sol::overload(
+      (Entity*(Engine::*)(Entity::Handle))&Engine::getEntity,
+      (Entity*(Engine::*)(const std::string&))&Engine::getEntity
+    );
     lua["Engine"]["getSystem"] = (EngineSystem*(Engine::*)(const std::string& name))&Engine::getSystem;
     lua["Engine"]["getSystems"] = &Engine::getSystems;
     lua["Engine"]["hasSystem"] = (bool(Engine::*)(const std::string& name))&Engine::hasSystem;
@@ -283,6 +339,9 @@ namespace Gsage {
       return res;
     };
     lua["Engine"]["getEntities"] = &Engine::getEntities;
+    lua["Engine"]["view"] = [](Engine* e, std::vector<std::string> components) -> EntityView::Entities {
+      return e->view(components).getEntities();
+    };
 
     lua.new_usertype<GameDataManager>("DataManager",
         "createEntity", sol::overload(
@@ -299,7 +358,10 @@ namespace Gsage {
     lua.new_usertype<LuaEventProxy>("LuaEventProxy",
         "new", sol::constructors<void()>()
     );
-    lua["LuaEventProxy"]["bind"] = (bool(LuaEventProxy::*)(EventDispatcher*, const std::string&, const sol::object&))&LuaEventProxy::addEventListener;
+    lua["LuaEventProxy"]["bind"] = sol::overload(
+        (bool(LuaEventProxy::*)(EventDispatcher*, const std::string&, const sol::object&))&LuaEventProxy::addEventListener,
+        (bool(LuaEventProxy::*)(EventDispatcher*, const std::string&, const sol::object&, const sol::table&))&LuaEventProxy::addUnpackedEventListener
+    );
     lua["LuaEventProxy"]["unbind"] = &LuaEventProxy::removeEventListener;
 
     lua.new_usertype<LuaEventConnection>("LuaEventConnection",
@@ -346,6 +408,18 @@ namespace Gsage {
         "STAT_CHANGE", sol::var(StatEvent::STAT_CHANGE)
     );
 
+    registerEvent<AreaLoadEvent>("AreaLoadEvent",
+        "onAreaLoad",
+        sol::base_classes, sol::bases<Event>(),
+        "area", sol::property(&AreaLoadEvent::getArea),
+        "loaded", sol::property(&AreaLoadEvent::getLoaded),
+        "total", sol::property(&AreaLoadEvent::getTotal),
+        "progress", sol::property(&AreaLoadEvent::getProgress),
+        "PROGRESS", sol::var(AreaLoadEvent::PROGRESS),
+        "COMPLETE", sol::var(AreaLoadEvent::COMPLETE),
+        "FAILED", sol::var(AreaLoadEvent::FAILED)
+    );
+
     registerEvent<KeyboardEvent>("KeyboardEvent",
         "onKeyboard",
         sol::base_classes, sol::bases<Event>(),
@@ -360,6 +434,7 @@ namespace Gsage {
         "onEntity",
         sol::base_classes, sol::bases<Event>(),
         "id", sol::readonly(&EntityEvent::mEntityId),
+        "handle", sol::readonly(&EntityEvent::mEntityHandle),
         "CREATE", sol::var(EntityEvent::CREATE),
         "REMOVE", sol::var(EntityEvent::REMOVE)
     );
@@ -553,7 +628,7 @@ namespace Gsage {
     lua["Mouse"]["Button7"] = sol::var(MouseEvent::Button7);
     lua["Mouse"]["None"] = sol::var(MouseEvent::None);
 
-    mInstance->getEngine()->fireEvent(EngineEvent(EngineEvent::LUA_STATE_CHANGE));
+    mInstance->getEngine()->fireEvent(EngineEvent(EngineEvent::LUA_STATE_CHANGE_ID));
 
     // Logging
     lua.new_usertype<LogProxy>("LogProxy",
@@ -0,0 +1,367 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "lua/LuaProfiler.h"
+#include "Logger.h"
+#include "lua.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+namespace Gsage {
+
+  LuaProfiler* LuaProfiler::mActive = 0;
+
+  LuaProfiler::LuaProfiler()
+    : mState(0)
+    , mRunning(false)
+    , mCountNativeCalls(false)
+    , mInterval(std::chrono::milliseconds(1))
+    , mSampleCount(0)
+  {
+    mStack.reserve(MAX_DEPTH + 1);
+  }
+
+  LuaProfiler::~LuaProfiler()
+  {
+    stop();
+  }
+
+  void LuaProfiler::setState(lua_State* L)
+  {
+    if(L == mState)
+      return;
+
+    stop();
+    mState = L;
+    mFunctionIds.clear();
+  }
+
+  bool LuaProfiler::start(double interval, int instructions)
+  {
+    if(!mState) {
+      LOG(ERROR) << "Failed to start lua profiler: no lua state";
+      return false;
+    }
+
+    if(mActive && mActive != this) {
+      LOG(ERROR) << "Failed to start lua profiler: another profiler is running";
+      return false;
+    }
+
+    mInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+    mNextSample = Clock::now() + mInterval;
+    int mask = LUA_MASKCOUNT;
+    if(mCountNativeCalls) {
+      mask |= LUA_MASKCALL;
+    }
+
+    lua_sethook(mState, &LuaProfiler::hook, mask, std::max(instructions, 1));
+    mActive = this;
+    mRunning = true;
+    return true;
+  }
+
+  void LuaProfiler::stop()
+  {
+    if(!mRunning)
+      return;
+
+    lua_sethook(mState, 0, 0, 0);
+    mActive = 0;
+    mRunning = false;
+  }
+
+  bool LuaProfiler::isRunning() const
+  {
+    return mRunning;
+  }
+
+  LuaProfiler* LuaProfiler::getActive()
+  {
+    return mActive;
+  }
+
+  void LuaProfiler::reset()
+  {
+    mSampleCount = 0;
+    mFunctions.clear();
+    mFunctionIds.clear();
+    mLines.clear();
+    mStacks.clear();
+    for(auto& scope : mScopes) {
+      scope.calls = 0;
+      scope.nativeCalls = 0;
+      scope.samples = 0;
+      scope.time = 0;
+    }
+  }
+
+  void LuaProfiler::setCountNativeCalls(bool value)
+  {
+    mCountNativeCalls = value;
+  }
+
+  bool LuaProfiler::getCountNativeCalls() const
+  {
+    return mCountNativeCalls;
+  }
+
+  uint32_t LuaProfiler::getScope(const std::string& name)
+  {
+    auto iter = mScopeIds.find(name);
+    if(iter != mScopeIds.end())
+      return iter->second;
+
+    uint32_t id = (uint32_t)mScopes.size();
+    ScopeStats stats;
+    stats.name = name;
+    stats.calls = 0;
+    stats.nativeCalls = 0;
+    stats.samples = 0;
+    stats.time = 0;
+    mScopes.push_back(stats);
+    mScopeIds[name] = id;
+    return id;
+  }
+
+  void LuaProfiler::enterScope(uint32_t scope)
+  {
+    if(scope >= mScopes.size())
+      return;
+
+    mScopes[scope].calls++;
+    ActiveScope active;
+    active.id = scope;
+    active.start = Clock::now();
+    mActiveScopes.push_back(active);
+  }
+
+  void LuaProfiler::leaveScope()
+  {
+    if(mActiveScopes.empty())
+      return;
+
+    ActiveScope& active = mActiveScopes.back();
+    mScopes[active.id].time += std::chrono::duration<double>(Clock::now() - active.start).count();
+    mActiveScopes.pop_back();
+  }
+
+  size_t LuaProfiler::getSampleCount() const
+  {
+    return mSampleCount;
+  }
+
+  const std::vector<LuaProfiler::FunctionStats>& LuaProfiler::getFunctions() const
+  {
+    return mFunctions;
+  }
+
+  std::vector<LuaProfiler::LineStats> LuaProfiler::getLines() const
+  {
+    std::vector<LineStats> res;
+    res.reserve(mLines.size());
+    for(auto& pair : mLines) {
+      LineStats stats;
+      stats.function = (uint32_t)(pair.first >> 32);
+      stats.line = (int)(int32_t)(pair.first & 0xFFFFFFFF);
+      stats.samples = pair.second;
+      res.push_back(stats);
+    }
+
+    std::sort(res.begin(), res.end(), [] (const LineStats& a, const LineStats& b) {
+      return a.samples > b.samples;
+    });
+    return res;
+  }
+
+  const std::vector<LuaProfiler::ScopeStats>& LuaProfiler::getScopes() const
+  {
+    return mScopes;
+  }
+
+  std::string LuaProfiler::getFunctionName(uint32_t function) const
+  {
+    if(function >= mFunctions.size())
+      return "";
+
+    const FunctionStats& stats = mFunctions[function];
+    std::stringstream ss;
+    if(!stats.name.empty()) {
+      ss << stats.name << " ";
+    }
+    ss << stats.source;
+    if(stats.line > 0) {
+      ss << ":" << stats.line;
+    }
+    return ss.str();
+  }
+
+  std::string LuaProfiler::getFoldedStacks() const
+  {
+    std::vector<std::string> names;
+    names.reserve(mFunctions.size());
+    for(uint32_t i = 0; i < mFunctions.size(); ++i) {
+      std::string name = getFunctionName(i);
+      // ; separates frames in the folded format
+      std::replace(name.begin(), name.end(), ';', ':');
+      names.push_back(name);
+    }
+
+    std::stringstream ss;
+    for(auto& pair : mStacks) {
+      const std::vector<uint32_t>& stack = pair.first;
+      if(stack[0] != NO_SCOPE) {
+        std::string scope = mScopes[stack[0]].name;
+        std::replace(scope.begin(), scope.end(), ';', ':');
+        ss << scope;
+      } else {
+        ss << "lua";
+      }
+
+      for(size_t i = 1; i < stack.size(); ++i) {
+        ss << ";" << names[stack[i]];
+      }
+      ss << " " << pair.second << "\n";
+    }
+    return ss.str();
+  }
+
+  bool LuaProfiler::saveFoldedStacks(const std::string& path) const
+  {
+    std::ofstream stream(path);
+    if(!stream) {
+      LOG(ERROR) << "Failed to write lua profiler stacks to " << path;
+      return false;
+    }
+
+    stream << getFoldedStacks();
+    return stream.good();
+  }
+
+  void LuaProfiler::hook(lua_State* L, lua_Debug* ar)
+  {
+    LuaProfiler* profiler = mActive;
+    if(!profiler)
+      return;
+
+    if(ar->event == LUA_HOOKCALL) {
+      if(profiler->mActiveScopes.empty() || !lua_getinfo(L, "S", ar) || ar->what[0] != 'C')
+        return;
+
+      profiler->mScopes[profiler->mActiveScopes.back().id].nativeCalls++;
+      return;
+    }
+
+    Clock::time_point now = Clock::now();
+    if(now < profiler->mNextSample)
+      return;
+
+    profiler->mNextSample = now + profiler->mInterval;
+    profiler->sample(L);
+  }
+
+  void LuaProfiler::sample(lua_State* L)
+  {
+    uint32_t scope = mActiveScopes.empty() ? (uint32_t)NO_SCOPE : mActiveScopes.back().id;
+    lua_Debug ar;
+    // collect innermost first, reversed afterwards
+    mStack.clear();
+    mStack.push_back(scope);
+    int line = -1;
+    for(int level = 0; level < (int)MAX_DEPTH && lua_getstack(L, level, &ar); ++level) {
+      if(!lua_getinfo(L, "Sln", &ar))
+        break;
+
+      if(level == 0) {
+        line = ar.currentline;
+      }
+      mStack.push_back(getFunctionId(L, &ar));
+    }
+
+    if(mStack.size() == 1)
+      return;
+
+    mSampleCount++;
+    if(scope != NO_SCOPE) {
+      mScopes[scope].samples++;
+    }
+
+    uint32_t top = mStack[1];
+    mFunctions[top].selfSamples++;
+    mLines[((uint64_t)top << 32) | (uint32_t)line]++;
+    for(size_t i = 1; i < mStack.size(); ++i) {
+      // recursive functions are counted once per sample
+      if(std::find(mStack.begin() + 1, mStack.begin() + i, mStack[i]) == mStack.begin() + i) {
+        mFunctions[mStack[i]].totalSamples++;
+      }
+    }
+
+    std::reverse(mStack.begin() + 1, mStack.end());
+    auto iter = mStacks.find(mStack);
+    if(iter == mStacks.end()) {
+      mStacks[mStack] = 1;
+    } else {
+      iter->second++;
+    }
+  }
+
+  uint32_t LuaProfiler::getFunctionId(lua_State* L, lua_Debug* ar)
+  {
+    FunctionKey key;
+    key.line = ar->linedefined;
+    key.source = ar->source;
+    if(ar->what[0] == 'C') {
+      // all C functions share the source, so the function pointer is used to tell them apart
+      lua_getinfo(L, "f", ar);
+      key.source = (const void*)lua_tocfunction(L, -1);
+      lua_pop(L, 1);
+    }
+
+    auto iter = mFunctionIds.find(key);
+    // source string can be collected and its memory reused, so the source is compared as well
+    if(iter != mFunctionIds.end() && mFunctions[iter->second].source == ar->short_src) {
+      FunctionStats& stats = mFunctions[iter->second];
+      if(stats.name.empty() && ar->name) {
+        stats.name = ar->name;
+      }
+      return iter->second;
+    }
+
+    uint32_t id = (uint32_t)mFunctions.size();
+    FunctionStats stats;
+    stats.name = ar->name ? ar->name : (ar->what[0] == 'm' ? "main chunk" : "");
+    stats.source = ar->short_src;
+    stats.line = ar->linedefined;
+    stats.selfSamples = 0;
+    stats.totalSamples = 0;
+    mFunctions.push_back(stats);
+    mFunctionIds[key] = id;
+    return id;
+  }
+}
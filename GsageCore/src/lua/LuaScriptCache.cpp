@@ -0,0 +1,346 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "lua/LuaScriptCache.h"
+#include "MappedFile.h"
+#include "FileLoader.h"
+#include "Logger.h"
+#include "sol.hpp"
+#include "lua.hpp"
+
+#include <algorithm>
+
+namespace Gsage {
+
+  const std::string LuaScriptCache::COMPILED_EXTENSION = ".luac";
+
+  static int writeBytecode(lua_State* L, const void* data, size_t size, void* dest)
+  {
+    static_cast<std::string*>(dest)->append(static_cast<const char*>(data), size);
+    return 0;
+  }
+
+  LuaScriptCache::Entry::Entry()
+    : sourceTime(0)
+    , compiledTime(0)
+    , sourceSize(0)
+    , ref(LUA_NOREF)
+  {
+  }
+
+  LuaScriptCache::LuaScriptCache()
+    : mState(0)
+    , mCompileCount(0)
+    , mLoaderRef(LUA_NOREF)
+  {
+  }
+
+  LuaScriptCache::~LuaScriptCache()
+  {
+    uninstallLoader();
+    clear();
+  }
+
+  void LuaScriptCache::setState(lua_State* L)
+  {
+    if(L == mState)
+      return;
+
+    // previous state can be already closed, so references are just dropped, bytecode is kept
+    for(auto& pair : mEntries) {
+      pair.second.ref = LUA_NOREF;
+    }
+    mLoaderRef = LUA_NOREF;
+    mState = L;
+  }
+
+  sol::protected_function LuaScriptCache::load(const std::string& path)
+  {
+    if(!mState || !push(path))
+      return sol::protected_function();
+
+    sol::protected_function res(mState, -1);
+    lua_pop(mState, 1);
+    return res;
+  }
+
+  std::string LuaScriptCache::getCompiledPath(const std::string& path)
+  {
+    static const std::string extension = ".lua";
+    if(path.size() > extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0) {
+      return path.substr(0, path.size() - extension.size()) + COMPILED_EXTENSION;
+    }
+
+    return path + COMPILED_EXTENSION;
+  }
+
+  void LuaScriptCache::installLoader()
+  {
+    if(!mState || mLoaderRef != LUA_NOREF)
+      return;
+
+    lua_State* L = mState;
+    lua_getglobal(L, "package");
+    if(!lua_istable(L, -1)) {
+      lua_pop(L, 1);
+      return;
+    }
+
+    lua_getfield(L, -1, "loaders");
+    if(!lua_istable(L, -1)) {
+      lua_pop(L, 1);
+      lua_getfield(L, -1, "searchers");
+    }
+
+    if(!lua_istable(L, -1)) {
+      LOG(WARNING) << "Failed to install lua script cache loader: no package loaders";
+      lua_pop(L, 2);
+      return;
+    }
+
+    // cache loader goes right after the preload loader, before the default file loader
+    int count = (int)lua_objlen(L, -1);
+    for(int i = count; i >= 2; --i) {
+      lua_rawgeti(L, -1, i);
+      lua_rawseti(L, -2, i + 1);
+    }
+
+    lua_pushlightuserdata(L, this);
+    lua_pushcclosure(L, &LuaScriptCache::searchModule, 1);
+    lua_pushvalue(L, -1);
+    mLoaderRef = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_rawseti(L, -2, 2);
+    lua_pop(L, 2);
+  }
+
+  void LuaScriptCache::uninstallLoader()
+  {
+    if(!mState || mLoaderRef == LUA_NOREF)
+      return;
+
+    lua_State* L = mState;
+    lua_getglobal(L, "package");
+    if(lua_istable(L, -1)) {
+      lua_getfield(L, -1, "loaders");
+      if(!lua_istable(L, -1)) {
+        lua_pop(L, 1);
+        lua_getfield(L, -1, "searchers");
+      }
+
+      if(lua_istable(L, -1)) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, mLoaderRef);
+        int count = (int)lua_objlen(L, -2);
+        for(int i = 1; i <= count; ++i) {
+          lua_rawgeti(L, -2, i);
+          bool found = lua_rawequal(L, -1, -2) != 0;
+          lua_pop(L, 1);
+          if(!found)
+            continue;
+
+          for(int j = i; j < count; ++j) {
+            lua_rawgeti(L, -2, j + 1);
+            lua_rawseti(L, -3, j);
+          }
+          lua_pushnil(L);
+          lua_rawseti(L, -3, count);
+          break;
+        }
+        lua_pop(L, 1);
+      }
+      lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+
+    luaL_unref(L, LUA_REGISTRYINDEX, mLoaderRef);
+    mLoaderRef = LUA_NOREF;
+  }
+
+  void LuaScriptCache::clear()
+  {
+    if(mState) {
+      for(auto& pair : mEntries) {
+        luaL_unref(mState, LUA_REGISTRYINDEX, pair.second.ref);
+      }
+    }
+    mEntries.clear();
+  }
+
+  size_t LuaScriptCache::size() const
+  {
+    return mEntries.size();
+  }
+
+  size_t LuaScriptCache::getCompileCount() const
+  {
+    return mCompileCount;
+  }
+
+  bool LuaScriptCache::push(const std::string& path)
+  {
+    int64_t sourceTime = 0;
+    int64_t compiledTime = 0;
+    size_t sourceSize = 0;
+    size_t compiledSize = 0;
+
+    bool hasSource = FileLoader::getModificationTime(path, sourceTime, &sourceSize);
+    // precompiled file, which is older than the source, is ignored
+    if(!FileLoader::getModificationTime(getCompiledPath(path), compiledTime, &compiledSize) || (hasSource && compiledTime < sourceTime)) {
+      compiledTime = 0;
+    }
+
+    if(!hasSource && compiledTime == 0) {
+      LOG(ERROR) << "Failed to read script file: " << path;
+      return false;
+    }
+
+    Entry& entry = mEntries[path];
+    bool upToDate = entry.sourceTime == sourceTime && entry.sourceSize == sourceSize && entry.compiledTime == compiledTime;
+    if(upToDate && entry.ref != LUA_NOREF) {
+      lua_rawgeti(mState, LUA_REGISTRYINDEX, entry.ref);
+      return true;
+    }
+
+    if(!upToDate) {
+      luaL_unref(mState, LUA_REGISTRYINDEX, entry.ref);
+      entry.ref = LUA_NOREF;
+      entry.bytecode.clear();
+      entry.sourceTime = sourceTime;
+      entry.sourceSize = sourceSize;
+      entry.compiledTime = compiledTime;
+    }
+
+    if(!compile(path, entry, !entry.bytecode.empty())) {
+      mEntries.erase(path);
+      return false;
+    }
+
+    lua_pushvalue(mState, -1);
+    entry.ref = luaL_ref(mState, LUA_REGISTRYINDEX);
+    return true;
+  }
+
+  bool LuaScriptCache::compile(const std::string& path, Entry& entry, bool useBytecode)
+  {
+    std::string chunkname = "@" + path;
+    int status = 0;
+    if(useBytecode) {
+      status = luaL_loadbuffer(mState, entry.bytecode.data(), entry.bytecode.size(), chunkname.c_str());
+    } else {
+      bool precompiled = entry.compiledTime != 0;
+      MappedFile file(precompiled ? getCompiledPath(path) : path);
+      if(!file.isOpen()) {
+        LOG(ERROR) << "Failed to read script file: " << file.getPath();
+        return false;
+      }
+
+      status = luaL_loadbuffer(mState, file.data(), file.size(), chunkname.c_str());
+      mCompileCount++;
+      if(status == 0) {
+        if(precompiled) {
+          entry.bytecode = file.str();
+        } else {
+          lua_dump(mState, &writeBytecode, &entry.bytecode, 0);
+        }
+      }
+    }
+
+    if(status != 0) {
+      const char* error = lua_tostring(mState, -1);
+      LOG(ERROR) << "Failed to load lua script " << path << ": " << (error ? error : "unknown error");
+      lua_pop(mState, 1);
+      return false;
+    }
+
+    return true;
+  }
+
+  int LuaScriptCache::searchModule(lua_State* L)
+  {
+    LuaScriptCache* cache = static_cast<LuaScriptCache*>(lua_touserdata(L, lua_upvalueindex(1)));
+    const char* name = luaL_checkstring(L, 1);
+    int res = cache->findModule(L, name);
+    // error is raised here, after all C++ objects of findModule are destroyed
+    if(res < 0) {
+      return lua_error(L);
+    }
+
+    return res;
+  }
+
+  int LuaScriptCache::findModule(lua_State* L, const std::string& name)
+  {
+    lua_getglobal(L, "package");
+    if(!lua_istable(L, -1)) {
+      lua_pop(L, 1);
+      return 0;
+    }
+
+    lua_getfield(L, -1, "path");
+    const char* p = lua_tostring(L, -1);
+    std::string templates = p ? p : "";
+    lua_pop(L, 2);
+
+    std::string module = name;
+    std::replace(module.begin(), module.end(), '.', '/');
+
+    size_t start = 0;
+    while(start <= templates.size()) {
+      size_t end = templates.find(';', start);
+      if(end == std::string::npos) {
+        end = templates.size();
+      }
+
+      std::string candidate = templates.substr(start, end - start);
+      start = end + 1;
+      if(candidate.empty()) {
+        continue;
+      }
+
+      size_t pos = 0;
+      while((pos = candidate.find('?', pos)) != std::string::npos) {
+        candidate.replace(pos, 1, module);
+        pos += module.size();
+      }
+
+      int64_t mtime;
+      if(!FileLoader::getModificationTime(candidate, mtime) && !FileLoader::getModificationTime(getCompiledPath(candidate), mtime)) {
+        continue;
+      }
+
+      if(!push(candidate)) {
+        lua_pushfstring(L, "error loading module '%s' from file '%s'", name.c_str(), candidate.c_str());
+        return -1;
+      }
+
+      if(L != mState) {
+        lua_xmove(mState, L, 1);
+      }
+      return 1;
+    }
+
+    return 0;
+  }
+}
@@ -52,6 +52,31 @@ namespace Gsage {
     return const_cast<DataWrapper*>(const_cast<const DataWrapper*>(this)->getChildAt(key));
   }
 
+  DataWrapper* DataWrapper::getDescendant(const std::vector<std::string>& keys)
+  {
+    DataWrapper* res = 0;
+    for(auto& key : keys) {
+      DataWrapper* child = (res ? res : this)->getChildAt(key);
+      if(!child) {
+        break;
+      }
+      delete res;
+      res = child;
+    }
+    return res;
+  }
+
+  DataWrapper* DataWrapper::createDescendant(const std::vector<std::string>& keys)
+  {
+    DataWrapper* res = 0;
+    for(auto& key : keys) {
+      DataWrapper* child = (res ? res : this)->createChildAt(key);
+      delete res;
+      res = child;
+    }
+    return res;
+  }
+
   void DataWrapper::swap(const DataWrapper* other)
   {
     *this = *other;
@@ -69,6 +94,11 @@ namespace Gsage {
     return false;
   }
 
+  bool DataWrapper::fromBuffer(const char* data, size_t size)
+  {
+    return fromString(std::string(data, size));
+  }
+
   void DataWrapper::makeArray()
   {
     // no-op by default
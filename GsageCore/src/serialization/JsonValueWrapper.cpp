@@ -190,6 +190,32 @@ namespace Gsage {
     return new JsonValueWrapper(value);
   }
 
+  DataWrapper* JsonValueWrapper::getDescendant(const std::vector<std::string>& keys)
+  {
+    Json::Value* value = &getObject();
+    Json::Value* res = 0;
+    for(auto& key : keys) {
+      const Json::Value* child = value->isObject() ? value->find(key.data(), key.data() + key.size()) : 0;
+      if(!child || child->isNull()) {
+        break;
+      }
+      value = res = const_cast<Json::Value*>(child);
+    }
+    // references the value, the tree is not copied
+    return res ? new JsonValueWrapper(res) : 0;
+  }
+
+  DataWrapper* JsonValueWrapper::createDescendant(const std::vector<std::string>& keys)
+  {
+    Json::Value* value = &getObject();
+    for(auto& key : keys) {
+      Json::Value& child = (*value)[key];
+      child = Json::Value();
+      value = &child;
+    }
+    return new JsonValueWrapper(value);
+  }
+
   DataWrapper::Type JsonValueWrapper::getStoredType()
   {
     Type res = Null;
@@ -228,9 +254,14 @@ namespace Gsage {
   }
 
   bool JsonValueWrapper::fromString(const std::string& s)
+  {
+    return fromBuffer(s.data(), s.size());
+  }
+
+  bool JsonValueWrapper::fromBuffer(const char* data, size_t size)
   {
     Json::Reader reader;
-    return reader.parse(s, getObject());
+    return reader.parse(data, data + size, getObject());
   }
 
 #define _PRIMITIVE_TYPE_PUT(t) template<> void JsonValueWrapper::put<t>(const std::string& key, const t& value) { getObject()[key] = value; }\
@@ -279,6 +310,31 @@ namespace Gsage {
     return true;
   }
 
+  bool JsonValueWrapper::readNumbers(const Json::Value& value, NumericArray& dest) const
+  {
+    if(!value.isArray() || value.size() > NumericArray::MAX_SIZE) {
+      return false;
+    }
+
+    dest.size = 0;
+    for(auto& element : value) {
+      if(!element.isNumeric()) {
+        return false;
+      }
+      dest.push(element.asDouble());
+    }
+    return true;
+  }
+
+  void JsonValueWrapper::writeNumbers(Json::Value& dest, const NumericArray& value)
+  {
+    Json::Value array(Json::arrayValue);
+    for(size_t i = 0; i < value.size; ++i) {
+      array.append(value[i]);
+    }
+    dest.swap(array);
+  }
+
   JsonValueWrapper::iterator::iterator(Json::Value::iterator wrappedIterator, Json::Value& object)
     : mIterator(wrappedIterator)
     , mObject(object)
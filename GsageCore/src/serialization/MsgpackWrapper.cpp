@@ -0,0 +1,831 @@
+/*
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2017 Gsage Authors
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "serialization/MsgpackWrapper.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace Gsage {
+
+  namespace {
+    /**
+     * Unpacked strings reference the buffer, which is copied to the zone before unpacking
+     */
+    bool referenceBuffer(msgpack::type::object_type type, std::size_t size, void* userData)
+    {
+      return true;
+    }
+
+    msgpack::object_kv* findKey(const msgpack::object& object, const char* key, size_t size)
+    {
+      if(object.type != msgpack::type::MAP) {
+        return 0;
+      }
+
+      msgpack::object_kv* kv = object.via.map.ptr;
+      msgpack::object_kv* const end = kv + object.via.map.size;
+      for(; kv != end; ++kv) {
+        if(kv->key.type == msgpack::type::STR &&
+           kv->key.via.str.size == size &&
+           std::memcmp(kv->key.via.str.ptr, key, size) == 0) {
+          return kv;
+        }
+      }
+      return 0;
+    }
+
+    msgpack::object* findIndex(const msgpack::object& object, uint64_t index)
+    {
+      if(object.type != msgpack::type::ARRAY || index >= object.via.array.size) {
+        return 0;
+      }
+      return object.via.array.ptr + index;
+    }
+
+    template<class T>
+    bool readNumber(const msgpack::object& object, T& dest);
+
+    bool readNumbers(const msgpack::object* object, NumericArray& dest)
+    {
+      if(!object || object->type != msgpack::type::ARRAY || object->via.array.size > NumericArray::MAX_SIZE) {
+        return false;
+      }
+
+      dest.size = 0;
+      for(uint32_t i = 0; i < object->via.array.size; ++i) {
+        double value;
+        if(object->via.array.ptr[i].type == msgpack::type::BOOLEAN || !readNumber(object->via.array.ptr[i], value)) {
+          return false;
+        }
+        dest.push(value);
+      }
+      return true;
+    }
+
+    template<class T>
+    bool readNumber(const msgpack::object& object, T& dest)
+    {
+      switch(object.type) {
+        case msgpack::type::POSITIVE_INTEGER:
+          dest = static_cast<T>(object.via.u64);
+          break;
+        case msgpack::type::NEGATIVE_INTEGER:
+          dest = static_cast<T>(object.via.i64);
+          break;
+        case msgpack::type::FLOAT32:
+        case msgpack::type::FLOAT64:
+          dest = static_cast<T>(object.via.f64);
+          break;
+        case msgpack::type::BOOLEAN:
+          dest = static_cast<T>(object.via.boolean);
+          break;
+        default:
+          return false;
+      }
+      return true;
+    }
+  }
+
+  MsgpackWrapper::Document::Document()
+    : root(static_cast<msgpack::object*>(zone.allocate_align(sizeof(msgpack::object))))
+    , generation(0)
+  {
+    new (root) msgpack::object();
+  }
+
+  template<class T>
+  T* MsgpackWrapper::Document::allocate(uint32_t count)
+  {
+    // blocks are powers of two, so that released blocks fit the next allocation of the same size
+    uint32_t bits = 4;
+    while(((size_t)1 << bits) < sizeof(T) * count) {
+      bits++;
+    }
+
+    void* ptr;
+    std::vector<void*>& blocks = freeBlocks[bits];
+    if(blocks.empty()) {
+      ptr = zone.allocate_align((size_t)1 << bits);
+    } else {
+      ptr = blocks.back();
+      blocks.pop_back();
+    }
+    blockSizes[ptr] = (size_t)1 << bits;
+    return static_cast<T*>(ptr);
+  }
+
+  template<class T>
+  void MsgpackWrapper::Document::deallocate(T* ptr, uint32_t size)
+  {
+    if(!ptr) {
+      return;
+    }
+
+    size_t bytes = sizeof(T) * size;
+    auto iter = blockSizes.find(ptr);
+    if(iter != blockSizes.end()) {
+      bytes = iter->second;
+      blockSizes.erase(iter);
+    }
+
+    if(bytes < 16) {
+      return;
+    }
+
+    uint32_t bits = 4;
+    while(((size_t)2 << bits) <= bytes) {
+      bits++;
+    }
+    freeBlocks[bits].push_back(ptr);
+  }
+
+  void MsgpackWrapper::Document::release(msgpack::object& object)
+  {
+    switch(object.type) {
+      case msgpack::type::ARRAY:
+        for(uint32_t i = 0; i < object.via.array.size; ++i) {
+          release(object.via.array.ptr[i]);
+        }
+        deallocate(object.via.array.ptr, object.via.array.size);
+        break;
+      case msgpack::type::MAP:
+        // keys are strings, they are not reused
+        for(uint32_t i = 0; i < object.via.map.size; ++i) {
+          release(object.via.map.ptr[i].val);
+        }
+        deallocate(object.via.map.ptr, object.via.map.size);
+        break;
+      default:
+        break;
+    }
+  }
+
+  MsgpackWrapper::MsgpackWrapper(bool allocate)
+    : DataWrapper(MSGPACK_OBJECT)
+    , mDocument(allocate ? std::make_shared<Document>() : nullptr)
+    , mObject(allocate ? mDocument->root : 0)
+    , mGeneration(0)
+  {
+  }
+
+  MsgpackWrapper::MsgpackWrapper(DocumentPtr document, Path path, msgpack::object* object)
+    : DataWrapper(MSGPACK_OBJECT)
+    , mDocument(document)
+    , mPath(std::move(path))
+    , mObject(object)
+    , mGeneration(document->generation)
+  {
+  }
+
+  MsgpackWrapper::~MsgpackWrapper()
+  {
+  }
+
+  template<>
+  bool MsgpackWrapper::readValue<int>(const msgpack::object& object, int& dest) const
+  {
+    return readNumber(object, dest);
+  }
+
+  template<>
+  bool MsgpackWrapper::readValue<unsigned int>(const msgpack::object& object, unsigned int& dest) const
+  {
+    return readNumber(object, dest);
+  }
+
+  template<>
+  bool MsgpackWrapper::readValue<double>(const msgpack::object& object, double& dest) const
+  {
+    return readNumber(object, dest);
+  }
+
+  template<>
+  bool MsgpackWrapper::readValue<float>(const msgpack::object& object, float& dest) const
+  {
+    return readNumber(object, dest);
+  }
+
+  template<>
+  bool MsgpackWrapper::readValue<bool>(const msgpack::object& object, bool& dest) const
+  {
+    return readNumber(object, dest);
+  }
+
+  template<>
+  bool MsgpackWrapper::readValue<std::string>(const msgpack::object& object, std::string& dest) const
+  {
+    switch(object.type) {
+      case msgpack::type::STR:
+        dest.assign(object.via.str.ptr, object.via.str.size);
+        break;
+      case msgpack::type::BOOLEAN:
+        dest = typename TranslatorBetween<std::string, bool>::type().from(object.via.boolean);
+        break;
+      case msgpack::type::POSITIVE_INTEGER:
+        dest = typename TranslatorBetween<std::string, unsigned int>::type().from(static_cast<unsigned int>(object.via.u64));
+        break;
+      case msgpack::type::NEGATIVE_INTEGER:
+        dest = typename TranslatorBetween<std::string, int>::type().from(static_cast<int>(object.via.i64));
+        break;
+      case msgpack::type::FLOAT32:
+      case msgpack::type::FLOAT64:
+        dest = typename TranslatorBetween<std::string, double>::type().from(object.via.f64);
+        break;
+      default:
+        return false;
+    }
+    return true;
+  }
+
+#define _PRIMITIVE_TYPE_PUT(t) template<> void MsgpackWrapper::put<t>(const std::string& key, const t& value) { assign(key, msgpack::object(value)); }\
+                               template<> void MsgpackWrapper::put<t>(int key, const t& value) { assign(key, msgpack::object(value)); }\
+                               template<> void MsgpackWrapper::set<t>(const t& value) { assign(msgpack::object(value)); }
+
+  _PRIMITIVE_TYPE_PUT(int)
+  _PRIMITIVE_TYPE_PUT(unsigned int)
+  _PRIMITIVE_TYPE_PUT(double)
+  _PRIMITIVE_TYPE_PUT(float)
+  _PRIMITIVE_TYPE_PUT(bool)
+
+#undef _PRIMITIVE_TYPE_PUT
+
+  void MsgpackWrapper::put(const std::string& key, const std::string& value)
+  {
+    if(!mDocument) {
+      return;
+    }
+    assign(key, msgpack::object(value, mDocument->zone));
+  }
+
+  void MsgpackWrapper::put(int key, const std::string& value)
+  {
+    if(!mDocument) {
+      return;
+    }
+    assign(key, msgpack::object(value, mDocument->zone));
+  }
+
+  void MsgpackWrapper::set(const std::string& value)
+  {
+    if(!mDocument) {
+      return;
+    }
+    assign(msgpack::object(value, mDocument->zone));
+  }
+
+  bool MsgpackWrapper::readArray(const std::string& key, NumericArray& dest) const
+  {
+    return readNumbers(find(key), dest);
+  }
+
+  bool MsgpackWrapper::readArray(NumericArray& dest) const
+  {
+    return readNumbers(getObject(), dest);
+  }
+
+  void MsgpackWrapper::putArray(const std::string& key, const NumericArray& value)
+  {
+    if(!mDocument) {
+      return;
+    }
+    assign(key, createArray(value));
+  }
+
+  void MsgpackWrapper::putArray(int key, const NumericArray& value)
+  {
+    if(!mDocument) {
+      return;
+    }
+    assign(key, createArray(value));
+  }
+
+  void MsgpackWrapper::setArray(const NumericArray& value)
+  {
+    if(!mDocument) {
+      return;
+    }
+    assign(createArray(value));
+  }
+
+  int MsgpackWrapper::size() const
+  {
+    const msgpack::object* object = getObject();
+    if(!object) {
+      return 0;
+    }
+
+    switch(object->type) {
+      case msgpack::type::ARRAY:
+        return object->via.array.size;
+      case msgpack::type::MAP:
+        return object->via.map.size;
+      default:
+        return 0;
+    }
+  }
+
+  int MsgpackWrapper::count(const std::string& key) const
+  {
+    return find(key) ? 1 : 0;
+  }
+
+  DataWrapper::iteratorPtr MsgpackWrapper::begin()
+  {
+    return new iterator(this, 0);
+  }
+
+  DataWrapper::iteratorPtr MsgpackWrapper::end()
+  {
+    return new iterator(this, size());
+  }
+
+  msgpack::object* MsgpackWrapper::getObject()
+  {
+    return const_cast<msgpack::object*>(static_cast<const MsgpackWrapper*>(this)->getObject());
+  }
+
+  const msgpack::object* MsgpackWrapper::getObject() const
+  {
+    if(!mDocument || mGeneration == mDocument->generation) {
+      return mObject;
+    }
+
+    // containers could have been moved by put, walk from the root again
+    mObject = mDocument->root;
+    for(auto& key : mPath) {
+      if(key.type == msgpack::type::STR) {
+        msgpack::object_kv* kv = findKey(*mObject, key.via.str.ptr, key.via.str.size);
+        mObject = kv ? &kv->val : 0;
+      } else if(key.type == msgpack::type::POSITIVE_INTEGER) {
+        mObject = findIndex(*mObject, key.via.u64);
+      } else {
+        mObject = 0;
+      }
+
+      if(!mObject) {
+        break;
+      }
+    }
+    mGeneration = mDocument->generation;
+    return mObject;
+  }
+
+  bool MsgpackWrapper::putChild(const std::string& key, DataWrapper& value)
+  {
+    if(value.getType() != getType()) {
+      return false;
+    }
+
+    const msgpack::object* object = static_cast<MsgpackWrapper&>(value).getObject();
+    if(!object) {
+      return false;
+    }
+
+    msgpack::object child;
+    copy(*object, child);
+    return assign(key, child) != 0;
+  }
+
+  bool MsgpackWrapper::putChild(int key, DataWrapper& value)
+  {
+    if(value.getType() != getType()) {
+      return false;
+    }
+
+    const msgpack::object* object = static_cast<MsgpackWrapper&>(value).getObject();
+    if(!object) {
+      return false;
+    }
+
+    msgpack::object child;
+    copy(*object, child);
+    return assign(key, child) != 0;
+  }
+
+  DataWrapper* MsgpackWrapper::createChildAt(const std::string& key)
+  {
+    msgpack::object_kv* kv = assign(key, msgpack::object());
+    if(!kv) {
+      return 0;
+    }
+
+    Path path(mPath);
+    path.push_back(kv->key);
+    return new MsgpackWrapper(mDocument, std::move(path), &kv->val);
+  }
+
+  DataWrapper* MsgpackWrapper::createChildAt(int key)
+  {
+    msgpack::object* object = assign(key, msgpack::object());
+    if(!object) {
+      return 0;
+    }
+
+    Path path(mPath);
+    path.push_back(msgpack::object(static_cast<uint64_t>(key)));
+    return new MsgpackWrapper(mDocument, std::move(path), object);
+  }
+
+  const DataWrapper* MsgpackWrapper::getChildAt(const std::string& key) const
+  {
+    const msgpack::object* object = getObject();
+    msgpack::object_kv* kv = object ? findKey(*object, key.c_str(), key.size()) : 0;
+    if(!kv) {
+      return 0;
+    }
+
+    Path path(mPath);
+    path.push_back(kv->key);
+    return new MsgpackWrapper(mDocument, std::move(path), &kv->val);
+  }
+
+  const DataWrapper* MsgpackWrapper::getChildAt(int key) const
+  {
+    const msgpack::object* object = getObject();
+    msgpack::object* child = object && key >= 0 ? findIndex(*object, key) : 0;
+    if(!child) {
+      return 0;
+    }
+
+    Path path(mPath);
+    path.push_back(msgpack::object(static_cast<uint64_t>(key)));
+    return new MsgpackWrapper(mDocument, std::move(path), child);
+  }
+
+  DataWrapper* MsgpackWrapper::getDescendant(const std::vector<std::string>& keys)
+  {
+    msgpack::object* value = getObject();
+    msgpack::object* res = 0;
+    Path path;
+    path.reserve(mPath.size() + keys.size());
+    path.insert(path.end(), mPath.begin(), mPath.end());
+    for(auto& key : keys) {
+      msgpack::object_kv* kv = value ? findKey(*value, key.c_str(), key.size()) : 0;
+      if(!kv) {
+        break;
+      }
+      path.push_back(kv->key);
+      value = res = &kv->val;
+    }
+    return res ? new MsgpackWrapper(mDocument, std::move(path), res) : 0;
+  }
+
+  DataWrapper* MsgpackWrapper::createDescendant(const std::vector<std::string>& keys)
+  {
+    msgpack::object* value = getObject();
+    Path path;
+    path.reserve(mPath.size() + keys.size());
+    path.insert(path.end(), mPath.begin(), mPath.end());
+    for(auto& key : keys) {
+      msgpack::object_kv* kv = assign(value, key, msgpack::object());
+      if(!kv) {
+        return 0;
+      }
+      path.push_back(kv->key);
+      value = &kv->val;
+    }
+    return new MsgpackWrapper(mDocument, std::move(path), value);
+  }
+
+  DataWrapper::Type MsgpackWrapper::getStoredType()
+  {
+    const msgpack::object* object = getObject();
+    if(!object) {
+      return Type::Null;
+    }
+
+    Type res = Null;
+    switch(object->type) {
+      case msgpack::type::BOOLEAN:
+        res = Type::Bool;
+        break;
+      case msgpack::type::POSITIVE_INTEGER:
+        res = Type::UInt;
+        break;
+      case msgpack::type::NEGATIVE_INTEGER:
+        res = Type::Int;
+        break;
+      case msgpack::type::FLOAT32:
+      case msgpack::type::FLOAT64:
+        res = Type::Double;
+        break;
+      case msgpack::type::STR:
+        res = Type::String;
+        break;
+      case msgpack::type::ARRAY:
+        res = Type::Array;
+        break;
+      case msgpack::type::MAP:
+      case msgpack::type::NIL:
+        // nil is an empty object, same as in JsonValueWrapper
+        res = Type::Object;
+        break;
+      default:
+        res = Type::Null;
+    }
+    return res;
+  }
+
+  std::string MsgpackWrapper::toString() const
+  {
+    msgpack::sbuffer buffer;
+    const msgpack::object* object = getObject();
+    if(object) {
+      msgpack::pack(buffer, *object);
+    } else {
+      msgpack::pack(buffer, msgpack::object());
+    }
+    return std::string(buffer.data(), buffer.size());
+  }
+
+  bool MsgpackWrapper::fromString(const std::string& s)
+  {
+    return fromBuffer(s.data(), s.size());
+  }
+
+  bool MsgpackWrapper::fromBuffer(const char* data, size_t size)
+  {
+    if(size == 0) {
+      return false;
+    }
+
+    // nothing else references the document, so the old data can be dropped with it
+    if(!mDocument || (mPath.empty() && mDocument.use_count() == 1)) {
+      mDocument = std::make_shared<Document>();
+      mPath.clear();
+      mObject = mDocument->root;
+      mGeneration = mDocument->generation;
+    }
+
+    // keep the packed data in the zone, so that unpacked strings can reference it
+    char* buffer = static_cast<char*>(mDocument->zone.allocate_no_align(size));
+    std::memcpy(buffer, data, size);
+    try {
+      assign(msgpack::unpack(mDocument->zone, buffer, size, &referenceBuffer));
+    } catch(const std::exception& e) {
+      LOG(WARNING) << "Failed to unpack msgpack data: " << e.what();
+      return false;
+    }
+    return true;
+  }
+
+  void MsgpackWrapper::makeArray()
+  {
+    msgpack::object* object = getObject();
+    if(!object) {
+      return;
+    }
+
+    if(object->type == msgpack::type::NIL || (object->type == msgpack::type::MAP && object->via.map.size == 0)) {
+      object->type = msgpack::type::ARRAY;
+      object->via.array.size = 0;
+      object->via.array.ptr = 0;
+    }
+  }
+
+  const msgpack::object* MsgpackWrapper::find(const std::string& key) const
+  {
+    const msgpack::object* object = getObject();
+    msgpack::object_kv* kv = object ? findKey(*object, key.c_str(), key.size()) : 0;
+    return kv ? &kv->val : 0;
+  }
+
+  msgpack::object_kv* MsgpackWrapper::assign(const std::string& key, const msgpack::object& value)
+  {
+    return assign(getObject(), key, value);
+  }
+
+  msgpack::object_kv* MsgpackWrapper::assign(msgpack::object* object, const std::string& key, const msgpack::object& value)
+  {
+    if(!object) {
+      return 0;
+    }
+
+    if(object->type == msgpack::type::NIL || (object->type == msgpack::type::ARRAY && object->via.array.size == 0)) {
+      object->type = msgpack::type::MAP;
+      object->via.map.size = 0;
+      object->via.map.ptr = 0;
+    }
+
+    if(object->type != msgpack::type::MAP) {
+      LOG(WARNING) << "Can't put key " << key << " to msgpack object of type " << object->type;
+      return 0;
+    }
+
+    mDocument->generation++;
+    msgpack::object_kv* kv = findKey(*object, key.c_str(), key.size());
+    if(!kv) {
+      msgpack::object_map& map = object->via.map;
+      map.ptr = grow(map.ptr, map.size, map.size + 1);
+      kv = map.ptr + map.size++;
+      kv->key = msgpack::object(key, mDocument->zone);
+    } else {
+      mDocument->release(kv->val);
+    }
+    kv->val = value;
+    return kv;
+  }
+
+  msgpack::object* MsgpackWrapper::assign(int key, const msgpack::object& value)
+  {
+    msgpack::object* object = getObject();
+    if(!object || key < 0) {
+      return 0;
+    }
+
+    if(object->type == msgpack::type::NIL || (object->type == msgpack::type::MAP && object->via.map.size == 0)) {
+      object->type = msgpack::type::ARRAY;
+      object->via.array.size = 0;
+      object->via.array.ptr = 0;
+    }
+
+    if(object->type != msgpack::type::ARRAY) {
+      LOG(WARNING) << "Can't put index " << key << " to msgpack object of type " << object->type;
+      return 0;
+    }
+
+    mDocument->generation++;
+    msgpack::object_array& array = object->via.array;
+    uint32_t index = static_cast<uint32_t>(key);
+    if(index >= array.size) {
+      array.ptr = grow(array.ptr, array.size, index + 1);
+      // fill the gap with nils, same as Json::Value does
+      for(uint32_t i = array.size; i < index; ++i) {
+        new (array.ptr + i) msgpack::object();
+      }
+      array.size = index + 1;
+    } else {
+      mDocument->release(array.ptr[index]);
+    }
+    array.ptr[index] = value;
+    return array.ptr + index;
+  }
+
+  void MsgpackWrapper::assign(const msgpack::object& value)
+  {
+    msgpack::object* object = getObject();
+    if(!object) {
+      return;
+    }
+
+    mDocument->generation++;
+    mDocument->release(*object);
+    *object = value;
+  }
+
+  msgpack::object MsgpackWrapper::createArray(const NumericArray& value)
+  {
+    msgpack::object res;
+    res.type = msgpack::type::ARRAY;
+    res.via.array.size = static_cast<uint32_t>(value.size);
+    res.via.array.ptr = value.size ? mDocument->allocate<msgpack::object>(static_cast<uint32_t>(value.size)) : 0;
+    for(size_t i = 0; i < value.size; ++i) {
+      new (res.via.array.ptr + i) msgpack::object(value[i]);
+    }
+    return res;
+  }
+
+  void MsgpackWrapper::copy(const msgpack::object& src, msgpack::object& dest)
+  {
+    dest = src;
+    msgpack::zone& zone = mDocument->zone;
+    switch(src.type) {
+      case msgpack::type::STR:
+      case msgpack::type::BIN:
+      {
+        char* ptr = static_cast<char*>(zone.allocate_no_align(src.via.str.size));
+        std::memcpy(ptr, src.via.str.ptr, src.via.str.size);
+        dest.via.str.ptr = ptr;
+        break;
+      }
+      case msgpack::type::EXT:
+      {
+        // first byte is the extension type
+        char* ptr = static_cast<char*>(zone.allocate_no_align(src.via.ext.size + 1));
+        std::memcpy(ptr, src.via.ext.ptr, src.via.ext.size + 1);
+        dest.via.ext.ptr = ptr;
+        break;
+      }
+      case msgpack::type::ARRAY:
+      {
+        uint32_t size = src.via.array.size;
+        dest.via.array.ptr = size ? mDocument->allocate<msgpack::object>(size) : 0;
+        for(uint32_t i = 0; i < size; ++i) {
+          copy(src.via.array.ptr[i], dest.via.array.ptr[i]);
+        }
+        break;
+      }
+      case msgpack::type::MAP:
+      {
+        uint32_t size = src.via.map.size;
+        dest.via.map.ptr = size ? mDocument->allocate<msgpack::object_kv>(size) : 0;
+        for(uint32_t i = 0; i < size; ++i) {
+          copy(src.via.map.ptr[i].key, dest.via.map.ptr[i].key);
+          copy(src.via.map.ptr[i].val, dest.via.map.ptr[i].val);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  template<class T>
+  T* MsgpackWrapper::grow(T* ptr, uint32_t size, uint32_t required)
+  {
+    auto iter = mDocument->blockSizes.find(ptr);
+    uint32_t capacity = iter == mDocument->blockSizes.end() ? size : static_cast<uint32_t>(iter->second / sizeof(T));
+    if(required <= capacity) {
+      return ptr;
+    }
+
+    T* res = mDocument->allocate<T>(std::max(std::max(required, capacity * 2), 4u));
+    if(size > 0) {
+      std::copy(ptr, ptr + size, res);
+    }
+
+    // old storage is reused by the next allocation of the same size
+    mDocument->deallocate(ptr, size);
+    return res;
+  }
+
+  MsgpackWrapper::iterator::iterator(MsgpackWrapper* wrapper, uint32_t index)
+    : mWrapper(wrapper)
+    , mCurrentValue(new MsgpackWrapper())
+    , mIndex(index)
+  {
+    DataWrapper::iterator::mCurrent = DataWrapper::iterator::value_type("", mCurrentValue);
+    update();
+  }
+
+  MsgpackWrapper::iterator::~iterator()
+  {
+    delete mCurrentValue;
+  }
+
+  void MsgpackWrapper::iterator::update()
+  {
+    msgpack::object* object = mWrapper->getObject();
+    if(!object || mIndex >= (uint32_t)mWrapper->size()) {
+      return;
+    }
+
+    mCurrentValue->mDocument = mWrapper->mDocument;
+    mCurrentValue->mPath = mWrapper->mPath;
+    mCurrentValue->mGeneration = mWrapper->mDocument->generation;
+    if(object->type == msgpack::type::ARRAY) {
+      mCurrent.first = std::to_string(mIndex);
+      mCurrentValue->mPath.push_back(msgpack::object(static_cast<uint64_t>(mIndex)));
+      mCurrentValue->mObject = object->via.array.ptr + mIndex;
+    } else {
+      msgpack::object_kv& kv = object->via.map.ptr[mIndex];
+      if(!mWrapper->readValue(kv.key, mCurrent.first)) {
+        mCurrent.first.clear();
+      }
+      mCurrentValue->mPath.push_back(kv.key);
+      mCurrentValue->mObject = &kv.val;
+    }
+  }
+
+  void MsgpackWrapper::iterator::increment()
+  {
+    mIndex++;
+    update();
+  }
+
+  bool MsgpackWrapper::iterator::operator==(const MsgpackWrapper::iterator::self_type& rhs)
+  {
+    return mIndex == ((const MsgpackWrapper::iterator&)rhs).mIndex;
+  }
+
+  bool MsgpackWrapper::iterator::operator!=(const MsgpackWrapper::iterator::self_type& rhs)
+  {
+    return mIndex != ((const MsgpackWrapper::iterator&)rhs).mIndex;
+  }
+}
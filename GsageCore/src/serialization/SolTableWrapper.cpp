@@ -44,6 +44,28 @@ namespace Gsage {
   SolTableWrapper::~SolTableWrapper() {
   };
 
+  bool SolTableWrapper::readNumbers(sol::table table, NumericArray& dest) const
+  {
+    if(table.get_type() != sol::type::table) {
+      return false;
+    }
+
+    size_t size = table.size();
+    if(size == 0 || size > NumericArray::MAX_SIZE) {
+      return false;
+    }
+
+    dest.size = 0;
+    for(size_t i = 1; i <= size; ++i) {
+      sol::optional<double> value = table[i];
+      if(!value) {
+        return false;
+      }
+      dest.push(value.value());
+    }
+    return true;
+  }
+
   bool SolTableWrapper::putChild(const std::string& key, DataWrapper& value) {
     if(value.getType() != getType()) {
       return false;
@@ -97,6 +119,34 @@ namespace Gsage {
     return new SolTableWrapper(child.value());
   }
 
+  DataWrapper* SolTableWrapper::getDescendant(const std::vector<std::string>& keys)
+  {
+    sol::table value = mObject;
+    bool found = false;
+    for(auto& key : keys) {
+      if(value.get_type() != sol::type::table) {
+        break;
+      }
+
+      sol::optional<sol::object> child = value[key];
+      if(!child) {
+        break;
+      }
+      value = child.value();
+      found = true;
+    }
+    return found ? new SolTableWrapper(value) : 0;
+  }
+
+  DataWrapper* SolTableWrapper::createDescendant(const std::vector<std::string>& keys)
+  {
+    sol::table value = mObject;
+    for(auto& key : keys) {
+      value = value.create(key);
+    }
+    return new SolTableWrapper(value);
+  }
+
   DataWrapper::Type SolTableWrapper::getStoredType() const
   {
     return const_cast<SolTableWrapper*>(this)->getStoredType();
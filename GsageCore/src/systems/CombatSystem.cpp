@@ -32,8 +32,11 @@ namespace Gsage {
   const std::string CombatSystem::ID = "dynamicStats";
 
   CombatSystem::CombatSystem()
+    : mQueueEvents(false)
   {
     mSystemInfo.put("type", CombatSystem::ID);
+    // stat change events are either fired by the stat setters or queued by the update
+    declareWrite(StatsComponent::SYSTEM);
   }
 
   CombatSystem::~CombatSystem()
@@ -42,5 +45,22 @@ namespace Gsage {
 
   void CombatSystem::updateComponent(StatsComponent* component, Entity* entity, const double& time)
   {
+    component->flushChanges();
+  }
+
+  bool CombatSystem::configure(const DataProxy& config)
+  {
+    if(!ComponentStorage<StatsComponent>::configure(config))
+      return false;
+
+    mQueueEvents = mConfig.get("queueEvents", false);
+    return true;
+  }
+
+  bool CombatSystem::prepareComponent(StatsComponent* component)
+  {
+    if(mQueueEvents && mEngine)
+      component->setEventQueue(mEngine->getEventQueue());
+    return true;
   }
 }
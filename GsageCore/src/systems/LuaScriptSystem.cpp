@@ -32,15 +32,23 @@ THE SOFTWARE.
 #include "lua/LuaInterface.h"
 #include "lua.hpp"
 
+#include <sstream>
+
 namespace Gsage {
 
   const std::string LuaScriptSystem::ID = "lua";
 
   LuaScriptSystem::LuaScriptSystem()
     : mState(0)
+    , mBatchSize(0)
+    , mSkipSuspended(true)
     , mWorkdir(".")
   {
     mSystemInfo.put("type", LuaScriptSystem::ID);
+    // scripts can access any component and lua state is not thread safe
+    declareWrite(ScriptComponent::SYSTEM);
+    setExclusive(true);
+    setMainThreadOnly(true);
   }
 
   LuaScriptSystem::~LuaScriptSystem()
@@ -55,6 +63,7 @@ namespace Gsage {
 
   void LuaScriptSystem::configUpdated() {
     EngineSystem::configUpdated();
+    mSkipSuspended = mConfig.get("skipSuspended", true);
     std::pair<DataProxy, bool> hooks = mConfig.get<DataProxy>("hooks");
     if(hooks.second) {
       for(auto& pair : hooks.first) {
@@ -94,6 +103,17 @@ namespace Gsage {
       return true;
 
     mState = new sol::state_view(L);
+    mInitializeBtree = sol::protected_function();
+    mDeinitializeBtree = sol::protected_function();
+    mUpdateBtrees = sol::protected_function();
+    mBatch = mState->create_table();
+    mSleepTimes = mState->create_table();
+    mBatchSize = 0;
+    mTimers.clear();
+    mSleeping = mState->create_table();
+    mScripts.setState(L);
+    mScripts.installLoader();
+    mProfiler.setState(L);
     return true;
   }
 
@@ -102,9 +122,49 @@ namespace Gsage {
     if(!mState)
       return;
 
+    lua_State* L = mState->lua_state();
+    bool profile = mProfiler.isRunning();
+    if(profile) {
+      mProfiler.enterScope(mProfiler.getScope("timers"));
+    }
+
+    mTimers.advance(time, [this, L] (const TimerWheel::Handle& handle, void* data) {
+      lua_State* co = static_cast<lua_State*>(data);
+      // remove the coroutine from the sleeping table, but keep it on the stack until it is resumed
+      mSleeping.push(L);
+      lua_pushthread(co);
+      lua_xmove(co, L, 1);
+      lua_pushvalue(L, -1);
+      lua_pushnil(L);
+      lua_rawset(L, -4);
+
+      // coroutine can be already resumed by someone else or finished
+      if(lua_status(co) == LUA_YIELD) {
+        lua_settop(co, 0);
+        int status = lua_resume(co, nullptr, 0);
+        if(status != 0 && status != LUA_YIELD) {
+          LOG(ERROR) << "Failed to resume coroutine: " << lua_tostring(co, -1);
+        }
+        lua_settop(co, 0);
+      }
+      lua_pop(L, 2);
+    });
+
+    if(profile) {
+      mProfiler.leaveScope();
+    }
+
     for(Listener& listener : mUpdateListeners)
     {
+      if(profile) {
+        mProfiler.enterScope(getListenerScope(listener));
+      }
+
       auto res = listener.function(time);
+      if(profile) {
+        mProfiler.leaveScope();
+      }
+
       if(!res.valid()) {
         sol::error err = res;
         removeUpdateListener(listener.function);
@@ -115,45 +175,142 @@ namespace Gsage {
     ComponentStorage<ScriptComponent>::update(time);
   }
 
+  void LuaScriptSystem::updateChunk(ScriptComponent** components, size_t count, const double& time, ScratchAllocator& scratch)
+  {
+    updateBehaviors(components, count, time);
+  }
+
   void LuaScriptSystem::updateComponent(ScriptComponent* component, Entity* entity, const double& time)
+  {
+    updateBehaviors(&component, 1, time);
+  }
+
+  bool LuaScriptSystem::setupComponent(ScriptComponent* component)
   {
     if(!component->getSetupExecuted())
     {
       runFunction(component, component->getSetupFunction());
-      LOG(INFO) << entity->getId() << " executing script";
+      LOG(INFO) << component->getOwner()->getId() << " executing script";
       runScript(component, component->getSetupScript());
       component->setSetupExecuted(true);
     }
 
     if(!component->getBehavior().empty() && component->getBtree() == sol::lua_nil) {
-      sol::function initializeBtree = (*mState)["btree"]["initialize"].get<sol::function>();
-      sol::table btree = initializeBtree(component->getOwner()->getId(), component->getBehavior());
-      component->setBtree(btree);
-      sol::table context = btree["context"];
+      if(!resolveBtreeFunctions())
+        return false;
+
+      auto res = mInitializeBtree(component->getOwner()->getId(), component->getBehavior());
+      if(!res.valid()) {
+        sol::error err = res;
+        LOG(ERROR) << "Failed to initialize btree " << err.what();
+        return false;
+      }
+
+      sol::optional<sol::table> btree = res.get<sol::optional<sol::table>>();
+      if(!btree)
+        return false;
+
+      component->setBtree(btree.value());
+      sol::table context = btree.value()["context"];
 
       component->setData(context);
 
       LOG(INFO) << "Successfuly registered script component for entity " << component->getOwner()->getId();
     }
 
-    if(component->hasBehavior())
+    return component->hasBehavior();
+  }
+
+  void LuaScriptSystem::updateBehaviors(ScriptComponent** components, size_t count, const double& time)
+  {
+    size_t batched = 0;
+    mBatchHandles.clear();
+    for(size_t i = 0; i < count; ++i)
     {
-      sol::table& btree = component->getBtree();
-      btree["update"](btree, time);
+      ScriptComponent* component = components[i];
+      if(!setupComponent(component))
+        continue;
+
+      // the tree waits for a timer, it is checked again when the time is close to the wake up
+      double sleepTime = component->getSleepTime();
+      if(mSkipSuspended && sleepTime > time) {
+        component->setSleepTime(sleepTime - time);
+        continue;
+      }
+
+      mBatch.raw_set(++batched, component->getBtree());
+      mBatchHandles.push_back(mComponents.getHandle(component));
+    }
+
+    // release trees, left from the previous bigger batch
+    for(size_t i = batched + 1; i <= mBatchSize; ++i) {
+      mBatch.raw_set(i, sol::lua_nil);
+    }
+    mBatchSize = batched;
+
+    if(batched == 0 || !resolveBtreeFunctions())
+      return;
+
+    bool profile = mProfiler.isRunning();
+    if(profile) {
+      mProfiler.enterScope(mProfiler.getScope("behaviors"));
+    }
+
+    auto res = mSkipSuspended ?
+      mUpdateBtrees(mBatch, batched, time, mSleepTimes) :
+      mUpdateBtrees(mBatch, batched, time);
+
+    if(profile) {
+      mProfiler.leaveScope();
+    }
+
+    if(!res.valid()) {
+      sol::error err = res;
+      LOG(ERROR) << "Failed to update behavior trees: " << err.what();
+      return;
+    }
+
+    if(!mSkipSuspended)
+      return;
+
+    // trees can remove entities, so components are resolved by handles
+    for(size_t i = 0; i < mBatchHandles.size(); ++i)
+    {
+      ScriptComponent* component = mComponents.get(mBatchHandles[i]);
+      if(component)
+        component->setSleepTime(mSleepTimes.raw_get_or(i + 1, 0.0));
     }
   }
 
+  bool LuaScriptSystem::resolveBtreeFunctions()
+  {
+    if(mUpdateBtrees.valid())
+      return true;
+
+    sol::optional<sol::table> lib = (*mState)["btree"];
+    if(!lib) {
+      LOG(ERROR) << "Failed to get btree library, behaviors can't be updated";
+      return false;
+    }
+
+    mInitializeBtree = lib.value()["initialize"];
+    mDeinitializeBtree = lib.value()["deinitialize"];
+    mUpdateBtrees = lib.value()["updateAll"];
+    return mUpdateBtrees.valid();
+  }
+
   bool LuaScriptSystem::removeComponent(ScriptComponent* component)
   {
     const std::string id = component->getOwner()->getId();
     bool stopped = true;
     if(mState && component->hasBehavior())
     {
-      sol::function stopBtree = (*mState)["btree"]["deinitialize"].get<sol::protected_function>();
-      auto res = stopBtree(id);
-      if(!res.valid()) {
-        sol::error err = res;
-        LOG(ERROR) << "Failed to stop btree " << err.what();
+      if(resolveBtreeFunctions()) {
+        auto res = mDeinitializeBtree(id);
+        if(!res.valid()) {
+          sol::error err = res;
+          LOG(ERROR) << "Failed to stop btree " << err.what();
+        }
       }
 
 
@@ -187,7 +344,11 @@ namespace Gsage {
   bool LuaScriptSystem::runScript(ScriptComponent* component, const std::string& script)
   {
     try {
-      auto res = mState->script(getScriptData(script).c_str());
+      sol::protected_function chunk = loadScript(script);
+      if(!chunk.valid())
+        return false;
+
+      auto res = chunk();
       if(!res.valid())
       {
         sol::error err = res;
@@ -220,48 +381,34 @@ namespace Gsage {
     return true;
   }
 
-  std::string LuaScriptSystem::getScriptData(const std::string& data)
+  sol::protected_function LuaScriptSystem::loadScript(const std::string& data)
   {
     std::vector<std::string> parts = split(data, ':');
-    std::string scriptData;
     if (parts.size() == 2 && parts[0] == "@File")
     {
-      std::string filename = mWorkdir + GSAGE_PATH_SEPARATOR + parts[1];
-      std::ifstream stream(filename);
-      stream.seekg(0, std::ios::end);
-      long int size = stream.tellg();
-      if(size == -1)
-      {
-        LOG(ERROR) << "Failed to read script file: " << filename;
-		    return "";
-      }
-
-      scriptData.reserve(size);
-      stream.seekg(0, std::ios::beg);
-      try
-      {
-        scriptData.assign((std::istreambuf_iterator<char>(stream)),
-            std::istreambuf_iterator<char>());
-      }
-      catch(std::ifstream::failure e)
-      {
-        LOG(ERROR) << "Failed to read script file: " << data;
-        stream.close();
-		    return "";
-      }
+      return mScripts.load(mWorkdir + GSAGE_PATH_SEPARATOR + parts[1]);
+    }
 
-      stream.close();
-    } else {
-      scriptData = data;
+    sol::load_result res = mState->load(data);
+    if(!res.valid()) {
+      sol::error err = res;
+      LOG(ERROR) << "Failed to load lua script " << err.what();
+      return sol::protected_function();
     }
-    return scriptData;
+    return res.get<sol::protected_function>();
   }
 
   bool LuaScriptSystem::runScript(const std::string& script)
   {
     try {
-      auto res = mState->script(getScriptData(script).c_str());
+      sol::protected_function chunk = loadScript(script);
+      if(!chunk.valid())
+        return false;
+
+      auto res = chunk();
       if(!res.valid()) {
+        sol::error err = res;
+        LOG(ERROR) << "Failed to execute lua script " << err.what();
         return false;
       }
     } catch(sol::error e) {
@@ -311,6 +458,82 @@ namespace Gsage {
       i = mUpdateListeners.erase(i);
     }
     ComponentStorage<ScriptComponent>::unloadComponents();
+    if(mState) {
+      mBatch = mState->create_table();
+      mBatchSize = 0;
+    }
     setEnabled(true);
   }
+
+  bool LuaScriptSystem::waitSeconds(sol::this_state state, double seconds)
+  {
+    lua_State* co = state;
+    if(lua_pushthread(co)) {
+      lua_pop(co, 1);
+      LOG(ERROR) << "The main thread cannot wait";
+      return false;
+    }
+
+    mSleeping.push(co);
+    // coroutine may be already waiting, then the old timer is replaced
+    lua_pushvalue(co, -2);
+    lua_rawget(co, -2);
+    if(lua_isnumber(co, -1)) {
+      TimerWheel::Handle handle = mTimers.getHandleAt((uint32_t)lua_tointeger(co, -1));
+      if(mTimers.getData(handle) == co)
+        mTimers.cancel(handle);
+    }
+    lua_pop(co, 1);
+
+    TimerWheel::Handle handle = mTimers.schedule(seconds, co);
+    lua_pushvalue(co, -2);
+    lua_pushinteger(co, handle.index);
+    lua_rawset(co, -3);
+    lua_pop(co, 2);
+    return true;
+  }
+
+  bool LuaScriptSystem::isSleeping(const sol::object& co)
+  {
+    return mSleeping.raw_get<sol::optional<uint32_t>>(co) ? true : false;
+  }
+
+  double LuaScriptSystem::getSleepTime(const sol::object& co)
+  {
+    sol::optional<uint32_t> index = mSleeping.raw_get<sol::optional<uint32_t>>(co);
+    if(!index)
+      return 0;
+
+    return mTimers.getTimeLeft(mTimers.getHandleAt(index.value()));
+  }
+
+  size_t LuaScriptSystem::getSleepingCount() const
+  {
+    return mTimers.size();
+  }
+
+  LuaProfiler* LuaScriptSystem::getProfiler()
+  {
+    return &mProfiler;
+  }
+
+  uint32_t LuaScriptSystem::getListenerScope(Listener& listener)
+  {
+    if(listener.scope != LuaProfiler::NO_SCOPE)
+      return listener.scope;
+
+    lua_State* L = mState->lua_state();
+    lua_Debug ar;
+    listener.function.push();
+    std::stringstream name;
+    name << "listener ";
+    if(lua_getinfo(L, ">S", &ar)) {
+      name << ar.short_src << ":" << ar.linedefined;
+    } else {
+      name << mUpdateListeners.size();
+    }
+
+    listener.scope = mProfiler.getScope(name.str());
+    return listener.scope;
+  }
 }
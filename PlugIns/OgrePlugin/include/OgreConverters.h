@@ -43,6 +43,12 @@ namespace Gsage {
   TYPE_CASTER(OgrePixelFormatCaster, Ogre::PixelFormat, std::string);
 
   TYPE_CASTER(RenderTargetTypeCaster, RenderTarget::Type, std::string);
+
+  // numeric casters, string casters are used as a fallback for the legacy data
+  TYPE_CASTER(OgreColourValueArrayCaster, Ogre::ColourValue, NumericArray);
+  TYPE_CASTER(OgreVector3ArrayCaster, Ogre::Vector3, NumericArray);
+  TYPE_CASTER(OgreQuaternionArrayCaster, Ogre::Quaternion, NumericArray);
+  TYPE_CASTER(OgreFloatRectArrayCaster, Ogre::FloatRect, NumericArray);
 }
 
 #endif
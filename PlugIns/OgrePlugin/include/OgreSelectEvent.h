@@ -36,6 +36,7 @@ namespace Gsage {
   class GSAGE_OGRE_PLUGIN_API OgreSelectEvent : public SelectEvent
   {
     public:
+      OgreSelectEvent(Event::TypeId type, const unsigned int& flags, const std::string& entityId, const Ogre::Vector3& intersection);
       OgreSelectEvent(Event::ConstType type, const unsigned int& flags, const std::string& entityId, const Ogre::Vector3& intersection);
       virtual ~OgreSelectEvent();
       /**
@@ -42,17 +42,21 @@ namespace Gsage {
   {
     public:
       static const Event::Type RENDER_QUEUE_STARTED;
+      static const Event::TypeId RENDER_QUEUE_STARTED_ID;
 
       /**
        * Main update
        */
       static const Event::Type UPDATE;
+      static const Event::TypeId UPDATE_ID;
 
       /**
        * Same to ogre render queue ended
        */
       static const Event::Type RENDER_QUEUE_ENDED;
+      static const Event::TypeId RENDER_QUEUE_ENDED_ID;
 
+      RenderEvent(Event::TypeId type, OgreRenderSystem* renderSystem, Ogre::uint8 queueID = 0, RenderTargetPtr renderTarget = nullptr);
       RenderEvent(Event::ConstType type, OgreRenderSystem* renderSystem, Ogre::uint8 queueID = 0, RenderTargetPtr renderTarget = nullptr);
       virtual ~RenderEvent();
       /**
@@ -56,7 +56,7 @@ namespace Gsage {
        */
       virtual void windowClosed(Ogre::RenderWindow* window);
     private:
-      void fireWindowEvent(Event::ConstType type, Ogre::RenderWindow* window);
+      void fireWindowEvent(Event::TypeId type, Ogre::RenderWindow* window);
       Engine* mEngine;
   };
 }
@@ -99,7 +99,7 @@ namespace Gsage {
        *
        * @param value Speed in unit per second
        */
-      void setSpeed(const double& value) { mSpeed = value; }
+      void setSpeed(const double& value) { mSpeed = value; setDirty(); }
       /**
        * Get component movement speed
        */
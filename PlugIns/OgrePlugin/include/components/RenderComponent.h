@@ -58,6 +58,7 @@ namespace Gsage {
       };
       static const std::string SYSTEM;
       static const Event::Type POSITION_CHANGE;
+      static const Event::TypeId POSITION_CHANGE_ID;
 
       RenderComponent();
       virtual ~RenderComponent();
@@ -154,7 +155,8 @@ namespace Gsage {
       DataProxy getAnimations();
 
       /**
-       * Get root SceneNodeWrapper
+       * Get root SceneNodeWrapper.
+       * Component is marked dirty, as the node can be modified by the caller
        */
       SceneNodeWrapper* getRoot();
 
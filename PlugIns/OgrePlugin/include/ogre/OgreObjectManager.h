@@ -51,6 +51,7 @@ namespace Gsage {
   class OgreObjectManagerEvent : public Event
   {
     public:
+      OgreObjectManagerEvent(Event::TypeId type, const std::string& factoryId) : Event(type), mId(factoryId) {}
       OgreObjectManagerEvent(Event::ConstType type, const std::string& factoryId) : Event(type), mId(factoryId) {}
       virtual ~OgreObjectManagerEvent() {}
 
@@ -58,6 +59,7 @@ namespace Gsage {
        * Factory was unregistered
        */
       static const Event::Type FACTORY_UNREGISTERED;
+      static const Event::TypeId FACTORY_UNREGISTERED_ID;
 
       /**
        * Get factory id that was unregistered
@@ -141,7 +143,7 @@ namespace Gsage {
         if(mObjects.count(type) == 0)
           return false; // no such type registered
 
-        fireEvent(OgreObjectManagerEvent(OgreObjectManagerEvent::FACTORY_UNREGISTERED, type));
+        fireEvent(OgreObjectManagerEvent(OgreObjectManagerEvent::FACTORY_UNREGISTERED_ID, type));
         delete mObjects[type];
         mObjects.erase(type);
         return true;
@@ -262,4 +262,98 @@ namespace Gsage {
     return "";
   }
 
+  // -----------------------------------------------------------------------------
+
+  bool OgreColourValueArrayCaster::to(const OgreColourValueArrayCaster::FromType& src, OgreColourValueArrayCaster::Type& dst) const
+  {
+    if(src.size != 3 && src.size != 4)
+      return false;
+
+    dst.r = (float)src[0];
+    dst.g = (float)src[1];
+    dst.b = (float)src[2];
+    dst.a = src.size == 4 ? (float)src[3] : 1.0f;
+    return true;
+  }
+
+  const OgreColourValueArrayCaster::FromType OgreColourValueArrayCaster::from(const OgreColourValueArrayCaster::Type& value) const
+  {
+    NumericArray res;
+    res.push(value.r);
+    res.push(value.g);
+    res.push(value.b);
+    res.push(value.a);
+    return res;
+  }
+
+  // -----------------------------------------------------------------------------
+
+  bool OgreVector3ArrayCaster::to(const OgreVector3ArrayCaster::FromType& src, OgreVector3ArrayCaster::Type& dst) const
+  {
+    if(src.size != 3)
+      return false;
+
+    dst.x = (float)src[0];
+    dst.y = (float)src[1];
+    dst.z = (float)src[2];
+    return true;
+  }
+
+  const OgreVector3ArrayCaster::FromType OgreVector3ArrayCaster::from(const OgreVector3ArrayCaster::Type& value) const
+  {
+    NumericArray res;
+    res.push(value.x);
+    res.push(value.y);
+    res.push(value.z);
+    return res;
+  }
+
+  // -----------------------------------------------------------------------------
+
+  bool OgreQuaternionArrayCaster::to(const OgreQuaternionArrayCaster::FromType& src, OgreQuaternionArrayCaster::Type& dst) const
+  {
+    if(src.size != 4)
+      return false;
+
+    dst.w = (float)src[0];
+    dst.x = (float)src[1];
+    dst.y = (float)src[2];
+    dst.z = (float)src[3];
+    return true;
+  }
+
+  const OgreQuaternionArrayCaster::FromType OgreQuaternionArrayCaster::from(const OgreQuaternionArrayCaster::Type& value) const
+  {
+    NumericArray res;
+    res.push(value.w);
+    res.push(value.x);
+    res.push(value.y);
+    res.push(value.z);
+    return res;
+  }
+
+  // -----------------------------------------------------------------------------
+
+  bool OgreFloatRectArrayCaster::to(const OgreFloatRectArrayCaster::FromType& src, OgreFloatRectArrayCaster::Type& dst) const
+  {
+    if(src.size != 4)
+      return false;
+
+    dst.left = (float)src[0];
+    dst.top = (float)src[1];
+    dst.right = (float)src[2];
+    dst.bottom = (float)src[3];
+    return true;
+  }
+
+  const OgreFloatRectArrayCaster::FromType OgreFloatRectArrayCaster::from(const OgreFloatRectArrayCaster::Type& value) const
+  {
+    NumericArray res;
+    res.push(value.left);
+    res.push(value.top);
+    res.push(value.right);
+    res.push(value.bottom);
+    return res;
+  }
+
 }
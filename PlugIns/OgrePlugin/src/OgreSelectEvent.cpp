@@ -29,6 +29,11 @@ THE SOFTWARE.
 namespace Gsage {
 
   OgreSelectEvent::OgreSelectEvent(Event::ConstType type, const unsigned int& flags, const std::string& entityId, const Ogre::Vector3& intersection)
+    : OgreSelectEvent(Event::intern(type), flags, entityId, intersection)
+  {
+  }
+
+  OgreSelectEvent::OgreSelectEvent(Event::TypeId type, const unsigned int& flags, const std::string& entityId, const Ogre::Vector3& intersection)
     : SelectEvent(type, flags, entityId)
     , mIntersection(intersection)
   {
@@ -29,12 +29,20 @@ THE SOFTWARE.
 namespace Gsage {
 
   const Event::Type RenderEvent::RENDER_QUEUE_STARTED = "renderQueueStarted";
+  const Event::TypeId RenderEvent::RENDER_QUEUE_STARTED_ID = Event::intern(RenderEvent::RENDER_QUEUE_STARTED);
 
   const Event::Type RenderEvent::UPDATE = "renderUpdate";
+  const Event::TypeId RenderEvent::UPDATE_ID = Event::intern(RenderEvent::UPDATE);
 
   const Event::Type RenderEvent::RENDER_QUEUE_ENDED = "renderQueueEnded";
+  const Event::TypeId RenderEvent::RENDER_QUEUE_ENDED_ID = Event::intern(RenderEvent::RENDER_QUEUE_ENDED);
 
   RenderEvent::RenderEvent(Event::ConstType type, OgreRenderSystem* renderSystem, Ogre::uint8 queueID, RenderTargetPtr renderTarget)
+    : RenderEvent(Event::intern(type), renderSystem, queueID, renderTarget)
+  {
+  }
+
+  RenderEvent::RenderEvent(Event::TypeId type, OgreRenderSystem* renderSystem, Ogre::uint8 queueID, RenderTargetPtr renderTarget)
     : Event(type)
     , mRenderSystem(renderSystem)
     , queueID(queueID)
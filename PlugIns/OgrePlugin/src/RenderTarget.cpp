@@ -167,7 +167,7 @@ namespace Gsage {
     {
       if(!mRolledOverObject.empty())
       {
-        mEngine->fireEvent(OgreSelectEvent(SelectEvent::ROLL_OUT, 0x00, mRolledOverObject, result));
+        mEngine->fireEvent(OgreSelectEvent(SelectEvent::ROLL_OUT_ID, 0x00, mRolledOverObject, result));
         mRolledOverObject.clear();
       }
       return;
@@ -185,13 +185,13 @@ namespace Gsage {
     const std::string& id = entityId.get<const std::string>();
     if(mRolledOverObject != id)
     {
-      mEngine->fireEvent(OgreSelectEvent(OgreSelectEvent::ROLL_OUT, target->getQueryFlags(), mRolledOverObject, result));
+      mEngine->fireEvent(OgreSelectEvent(OgreSelectEvent::ROLL_OUT_ID, target->getQueryFlags(), mRolledOverObject, result));
       mRolledOverObject = id;
-      mEngine->fireEvent(OgreSelectEvent(OgreSelectEvent::ROLL_OVER, target->getQueryFlags(), id, result));
+      mEngine->fireEvent(OgreSelectEvent(OgreSelectEvent::ROLL_OVER_ID, target->getQueryFlags(), id, result));
     }
 
     if(select)
-      mEngine->fireEvent(OgreSelectEvent(OgreSelectEvent::OBJECT_SELECTED, target->getQueryFlags(), id, result));
+      mEngine->fireEvent(OgreSelectEvent(OgreSelectEvent::OBJECT_SELECTED_ID, target->getQueryFlags(), id, result));
   }
 
   const std::string& RenderTarget::getName() const
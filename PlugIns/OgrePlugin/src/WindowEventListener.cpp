@@ -33,7 +33,7 @@ namespace Gsage {
   WindowEventListener::WindowEventListener(Ogre::RenderWindow* window, Engine* engine)
     : mEngine(engine)
   {
-    fireWindowEvent(WindowEvent::CREATE, window);
+    fireWindowEvent(WindowEvent::CREATE_ID, window);
   }
 
   WindowEventListener::~WindowEventListener()
@@ -42,15 +42,15 @@ namespace Gsage {
 
   void WindowEventListener::windowResized(Ogre::RenderWindow* window)
   {
-    fireWindowEvent(WindowEvent::RESIZE, window);
+    fireWindowEvent(WindowEvent::RESIZE_ID, window);
   }
 
   void WindowEventListener::windowClosed(Ogre::RenderWindow* window)
   {
-    fireWindowEvent(WindowEvent::CLOSE, window);
+    fireWindowEvent(WindowEvent::CLOSE_ID, window);
   }
 
-  void WindowEventListener::fireWindowEvent(Event::ConstType type, Ogre::RenderWindow* window)
+  void WindowEventListener::fireWindowEvent(Event::TypeId type, Ogre::RenderWindow* window)
   {
     size_t handle;
     window->getCustomAttribute("WINDOW", &handle);
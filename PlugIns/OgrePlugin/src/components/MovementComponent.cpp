@@ -40,6 +40,8 @@ namespace Gsage {
     BIND_PROPERTY("speed", &mSpeed);
     BIND_PROPERTY("moveAnimation", &mMoveAnimationState);
     BIND_PROPERTY("animSpeedRatio", &mAnimSpeedRatio);
+    setTracksChanges(true);
+    setReadsResolvedProperties(true);
   }
 
   MovementComponent::~MovementComponent()
@@ -37,6 +37,7 @@ namespace Gsage {
    * Fired on render component position change
    */
   const std::string RenderComponent::POSITION_CHANGE = "RenderComponent.POSITION_CHANGE";
+  const Event::TypeId RenderComponent::POSITION_CHANGE_ID = Event::intern(RenderComponent::POSITION_CHANGE);
 
   RenderComponent::RenderComponent() :
     mAddedToScene(false),
@@ -45,6 +46,8 @@ namespace Gsage {
     BIND_ACCESSOR_OPTIONAL("resources", &RenderComponent::setResources, &RenderComponent::getResources);
     BIND_GETTER("root", &RenderComponent::getRootNode);
     BIND_GETTER("animations", &RenderComponent::getAnimations);
+    setTracksChanges(true);
+    setReadsResolvedProperties(true);
   }
 
   RenderComponent::~RenderComponent()
@@ -55,20 +58,27 @@ namespace Gsage {
   {
     if(mRootNode) {
       mRootNode->setPosition(position);
-      fireEvent(Event(RenderComponent::POSITION_CHANGE));
+      setDirty();
+      fireEvent(Event(RenderComponent::POSITION_CHANGE_ID));
     }
   }
 
   void RenderComponent::setOrientation(const Ogre::Quaternion& orientation)
   {
-    if(mRootNode)
-      mRootNode->setOrientation(orientation);
+    if(!mRootNode)
+      return;
+
+    mRootNode->setOrientation(orientation);
+    setDirty();
   }
 
   void RenderComponent::rotate(const Ogre::Quaternion& rotation)
   {
-    if(mRootNode)
-      mRootNode->rotate(rotation, Ogre::Node::TransformSpace::TS_LOCAL);
+    if(!mRootNode)
+      return;
+
+    mRootNode->rotate(rotation, Ogre::Node::TransformSpace::TS_LOCAL);
+    setDirty();
   }
 
   void RenderComponent::lookAt(const Ogre::Vector3& position, const RotationAxis rotationAxis, Ogre::Node::TransformSpace transformSpace)
@@ -76,6 +86,7 @@ namespace Gsage {
     if(!mRootNode)
       return;
 
+    setDirty();
     Ogre::Vector3 axis = Ogre::Vector3::ZERO;
 
     switch(rotationAxis) {
@@ -119,6 +130,8 @@ namespace Gsage {
 
   SceneNodeWrapper* RenderComponent::getRoot()
   {
+    // root node can be modified through the pointer
+    setDirty();
     return mRootNode;
   }
 
@@ -33,6 +33,7 @@ THE SOFTWARE.
 namespace Gsage {
 
   const Event::Type OgreObjectManagerEvent::FACTORY_UNREGISTERED = "factoryUnregistered";
+  const Event::TypeId OgreObjectManagerEvent::FACTORY_UNREGISTERED_ID = Event::intern(OgreObjectManagerEvent::FACTORY_UNREGISTERED);
 
   OgreObjectManager::OgreObjectManager()
   {
@@ -106,6 +106,9 @@ namespace Gsage {
     mSceneManager(0)
   {
     mSystemInfo.put("type", OgreRenderSystem::ID);
+    // rendering is bound to the thread, which owns the GL context
+    declareWrite(RenderComponent::SYSTEM);
+    setMainThreadOnly(true);
     mLogManager = new Ogre::LogManager();
   }
 
@@ -304,7 +307,7 @@ namespace Gsage {
     ComponentStorage<RenderComponent>::update(time);
     Ogre::WindowEventUtilities::messagePump();
 
-    mEngine->fireEvent(RenderEvent(RenderEvent::UPDATE, this));
+    mEngine->fireEvent(RenderEvent(RenderEvent::UPDATE_ID, this));
 
     for(auto pair : mRenderTargets) {
       if(!pair.second->isAutoUpdated()) {
@@ -318,7 +321,7 @@ namespace Gsage {
     }
 
     if(!continueRendering)
-      mEngine->fireEvent(EngineEvent(EngineEvent::SHUTDOWN));
+      mEngine->fireEvent(EngineEvent(EngineEvent::SHUTDOWN_ID));
   }
 
   void OgreRenderSystem::updateComponent(RenderComponent* component, Entity* entity, const double& time)
@@ -372,7 +375,7 @@ namespace Gsage {
       } else {
         target = mWindow;
       }
-      mEngine->fireEvent(RenderEvent(RenderEvent::RENDER_QUEUE_STARTED, this, queueGroupId, target));
+      mEngine->fireEvent(RenderEvent(RenderEvent::RENDER_QUEUE_STARTED_ID, this, queueGroupId, target));
     }
   }
 
@@ -385,7 +388,7 @@ namespace Gsage {
       } else {
         target = mWindow;
       }
-      mEngine->fireEvent(RenderEvent(RenderEvent::RENDER_QUEUE_ENDED, this, queueGroupId, target));
+      mEngine->fireEvent(RenderEvent(RenderEvent::RENDER_QUEUE_ENDED_ID, this, queueGroupId, target));
     }
   }
 
@@ -46,6 +46,10 @@ namespace Gsage {
     mAgentCounter(0)
   {
     mSystemInfo.put("type", RecastMovementSystem::ID);
+    // moves scene nodes, position change events are fired synchronously
+    declareWrite(MovementComponent::SYSTEM);
+    declareWrite(RenderComponent::SYSTEM);
+    setMainThreadOnly(true);
   }
 
   RecastMovementSystem::~RecastMovementSystem()
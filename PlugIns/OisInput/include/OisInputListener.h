@@ -115,8 +115,8 @@ namespace Gsage {
       size_t mHandle;
 
 
-      void fireMouseEvent(Event::ConstType type, const OIS::MouseEvent& event);
-      void fireMouseEvent(Event::ConstType type, const OIS::MouseEvent& event, const MouseEvent::ButtonType& button);
+      void fireMouseEvent(Event::TypeId type, const OIS::MouseEvent& event);
+      void fireMouseEvent(Event::TypeId type, const OIS::MouseEvent& event, const MouseEvent::ButtonType& button);
 
       MouseEvent::ButtonType mapButtonType(const OIS::MouseButtonID& oisButtonID);
 
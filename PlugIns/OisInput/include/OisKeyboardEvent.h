@@ -36,8 +36,11 @@ namespace Gsage {
   {
     public:
       static const Event::Type KEY_DOWN;
+      static const Event::TypeId KEY_DOWN_ID;
       static const Event::Type KEY_UP;
+      static const Event::TypeId KEY_UP_ID;
 
+      OisKeyboardEvent(Event::TypeId type, const OIS::KeyCode& key, const unsigned int text, const unsigned int modifierState);
       OisKeyboardEvent(Event::ConstType type, const OIS::KeyCode& key, const unsigned int text, const unsigned int modifierState);
       virtual ~OisKeyboardEvent();
 
@@ -301,23 +301,23 @@ namespace Gsage {
 
   bool OisInputListener::mousePressed(const OIS::MouseEvent& arg, OIS::MouseButtonID id)
   {
-    fireMouseEvent(MouseEvent::MOUSE_DOWN, arg, mapButtonType(id));
+    fireMouseEvent(MouseEvent::MOUSE_DOWN_ID, arg, mapButtonType(id));
     return true;
   }
 
   bool OisInputListener::mouseReleased(const OIS::MouseEvent& arg, OIS::MouseButtonID id)
   {
-    fireMouseEvent(MouseEvent::MOUSE_UP, arg, mapButtonType(id));
+    fireMouseEvent(MouseEvent::MOUSE_UP_ID, arg, mapButtonType(id));
     return true;
   }
 
   bool OisInputListener::mouseMoved(const OIS::MouseEvent& arg)
   {
-    fireMouseEvent(MouseEvent::MOUSE_MOVE, arg);
+    fireMouseEvent(MouseEvent::MOUSE_MOVE_ID, arg);
     return true;
   }
 
-  void OisInputListener::fireMouseEvent(Event::ConstType type, const OIS::MouseEvent& event, const MouseEvent::ButtonType& button)
+  void OisInputListener::fireMouseEvent(Event::TypeId type, const OIS::MouseEvent& event, const MouseEvent::ButtonType& button)
   {
     MouseEvent e(type, event.state.width, event.state.height, button);
     e.setAbsolutePosition(event.state.X.abs, event.state.Y.abs, event.state.Z.abs);
@@ -328,7 +328,7 @@ namespace Gsage {
       fireEvent(e);
   }
 
-  void OisInputListener::fireMouseEvent(Event::ConstType type, const OIS::MouseEvent& event)
+  void OisInputListener::fireMouseEvent(Event::TypeId type, const OIS::MouseEvent& event)
   {
     MouseEvent e(type, event.state.width, event.state.height);
     e.setAbsolutePosition(event.state.X.abs, event.state.Y.abs, event.state.Z.abs);
@@ -375,7 +375,7 @@ namespace Gsage {
   bool OisInputListener::keyPressed(const OIS::KeyEvent& e)
   {
     KeyboardEvent::Key key = mKeyMap[e.key];
-    KeyboardEvent event(KeyboardEvent::KEY_DOWN, key, e.text, getModifiersState());
+    KeyboardEvent event(KeyboardEvent::KEY_DOWN_ID, key, e.text, getModifiersState());
     mEventRedirect->fireEvent(event);
     begin(event);
     return true;
@@ -384,7 +384,7 @@ namespace Gsage {
   bool OisInputListener::keyReleased(const OIS::KeyEvent& e)
   {
     KeyboardEvent::Key key = mKeyMap[e.key];
-    KeyboardEvent event(KeyboardEvent::KEY_UP, key, e.text, getModifiersState());
+    KeyboardEvent event(KeyboardEvent::KEY_UP_ID, key, e.text, getModifiersState());
     mEventRedirect->fireEvent(event);
     end(event);
     return true;
@@ -392,7 +392,7 @@ namespace Gsage {
 
   void OisInputListener::repeatKey(KeyboardEvent::Key key, unsigned int character)
   {
-    mEventRedirect->fireEvent(KeyboardEvent(KeyboardEvent::KEY_DOWN, key, character, getModifiersState()));
+    mEventRedirect->fireEvent(KeyboardEvent(KeyboardEvent::KEY_DOWN_ID, key, character, getModifiersState()));
   }
 
   unsigned int OisInputListener::getModifiersState()
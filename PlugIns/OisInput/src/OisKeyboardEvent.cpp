@@ -29,9 +29,16 @@ THE SOFTWARE.
 namespace Gsage {
 
   const Event::Type OisKeyboardEvent::KEY_DOWN = "keyDown";
+  const Event::TypeId OisKeyboardEvent::KEY_DOWN_ID = Event::intern(OisKeyboardEvent::KEY_DOWN);
   const Event::Type OisKeyboardEvent::KEY_UP = "keyUp";
+  const Event::TypeId OisKeyboardEvent::KEY_UP_ID = Event::intern(OisKeyboardEvent::KEY_UP);
 
   OisKeyboardEvent::OisKeyboardEvent(Event::ConstType type, const OIS::KeyCode& code, const unsigned int t, const unsigned int modState)
+    : OisKeyboardEvent(Event::intern(type), code, t, modState)
+  {
+  }
+
+  OisKeyboardEvent::OisKeyboardEvent(Event::TypeId type, const OIS::KeyCode& code, const unsigned int t, const unsigned int modState)
     : Event(type)
     , key(code)
     , text(t)
@@ -34,7 +34,9 @@ namespace Gsage {
   {
     public:
       static const Event::Type CREATE;
+      static const Event::TypeId CREATE_ID;
 
+      RocketContextEvent(Event::TypeId type, const std::string& name);
       RocketContextEvent(Event::ConstType type, const std::string& name);
       virtual ~RocketContextEvent();
 
@@ -28,8 +28,14 @@ THE SOFTWARE.
 
 namespace Gsage {
   const Event::Type RocketContextEvent::CREATE = "RocketContextEvent::CREATE";
+  const Event::TypeId RocketContextEvent::CREATE_ID = Event::intern(RocketContextEvent::CREATE);
 
   RocketContextEvent::RocketContextEvent(Event::ConstType type, const std::string& name)
+    : RocketContextEvent(Event::intern(type), name)
+  {
+  }
+
+  RocketContextEvent::RocketContextEvent(Event::TypeId type, const std::string& name)
     : Event(type)
     , name(name)
   {
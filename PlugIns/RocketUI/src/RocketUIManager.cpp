@@ -88,7 +88,7 @@ namespace Gsage {
       }
     }
     mContexts[name] = Rocket::Core::CreateContext(name.c_str(), Rocket::Core::Vector2i(width, height));
-    mEngine->fireEvent(RocketContextEvent(RocketContextEvent::CREATE, name));
+    mEngine->fireEvent(RocketContextEvent(RocketContextEvent::CREATE_ID, name));
     LOG(INFO) << "Created context " << name << ", initial size: " << width << "x" << height;
     return mContexts[name];
   }
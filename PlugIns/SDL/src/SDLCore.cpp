@@ -62,7 +62,7 @@ namespace Gsage {
       }
 
       if(event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
-        mFacade->getEngine()->fireEvent(WindowEvent(WindowEvent::RESIZE, event.window.windowID, event.window.data1, event.window.data2));
+        mFacade->getEngine()->fireEvent(WindowEvent(WindowEvent::RESIZE_ID, event.window.windowID, event.window.data1, event.window.data2));
       }
 
       for(auto listener : mEventListeners) {
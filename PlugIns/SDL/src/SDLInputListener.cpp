@@ -201,7 +201,7 @@ namespace Gsage {
         handleKeyboardEvent(event);
         break;
       case SDL_TEXTINPUT:
-        mEngine->fireEvent(TextInputEvent(TextInputEvent::INPUT, event->text.text));
+        mEngine->queueEvent(TextInputEvent(TextInputEvent::INPUT_ID, event->text.text));
         break;
     }
   }
@@ -213,16 +213,16 @@ namespace Gsage {
 
     switch(event->type) {
       case SDL_MOUSEWHEEL:
-        fireMouseEvent(MouseEvent::MOUSE_MOVE, x, y, mPreviousZ + event->wheel.y * 20);
+        fireMouseEvent(MouseEvent::MOUSE_MOVE_ID, x, y, mPreviousZ + event->wheel.y * 20);
         break;
       case SDL_MOUSEMOTION:
-        fireMouseEvent(MouseEvent::MOUSE_MOVE, x, y, mPreviousZ);
+        fireMouseEvent(MouseEvent::MOUSE_MOVE_ID, x, y, mPreviousZ);
         break;
       case SDL_MOUSEBUTTONDOWN:
-        fireMouseEvent(MouseEvent::MOUSE_DOWN, x, y, mPreviousZ, mapButtonType(event->button.button));
+        fireMouseEvent(MouseEvent::MOUSE_DOWN_ID, x, y, mPreviousZ, mapButtonType(event->button.button));
         break;
       case SDL_MOUSEBUTTONUP:
-        fireMouseEvent(MouseEvent::MOUSE_UP, x, y, mPreviousZ, mapButtonType(event->button.button));
+        fireMouseEvent(MouseEvent::MOUSE_UP_ID, x, y, mPreviousZ, mapButtonType(event->button.button));
         break;
     }
   }
@@ -234,8 +234,8 @@ namespace Gsage {
     }
 
     KeyboardEvent::Key key = mKeyMap[event->key.keysym.sym];
-    KeyboardEvent e(event->type == SDL_KEYDOWN ? KeyboardEvent::KEY_DOWN : KeyboardEvent::KEY_UP, key, 0, SDL_GetModState());
-    mEngine->fireEvent(e);
+    KeyboardEvent e(event->type == SDL_KEYDOWN ? KeyboardEvent::KEY_DOWN_ID : KeyboardEvent::KEY_UP_ID, key, 0, SDL_GetModState());
+    mEngine->queueEvent(e);
   }
 
   const MouseEvent::ButtonType SDLInputListener::mapButtonType(Uint8 sdlButtonID)
@@ -157,7 +157,7 @@ namespace Gsage {
       wrapper->mGLContext = sdlContext;
     }
 
-    fireWindowEvent(WindowEvent::CREATE, wrapper->getWindowHandle(), width, height);
+    fireWindowEvent(WindowEvent::CREATE_ID, wrapper->getWindowHandle(), width, height);
     mWindows.push_back(WindowPtr(static_cast<Window*>(wrapper)));
     return mWindows[mWindows.size()-1];
   }
@@ -168,7 +168,7 @@ namespace Gsage {
     if(result == mWindows.end()) {
       return false;
     }
-    fireWindowEvent(WindowEvent::CLOSE, window->getWindowHandle());
+    fireWindowEvent(WindowEvent::CLOSE_ID, window->getWindowHandle());
     mWindows.erase(result);
     return true;
   }
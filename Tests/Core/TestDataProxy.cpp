@@ -1,7 +1,14 @@
 #include "GsageDefinitions.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <set>
 #include <sstream>
 #include "DataProxy.h"
 #include "lua/LuaInterface.h"
+#include "serialization/MsgpackWrapper.h"
+#include "TestDefinitions.h"
 
 #include <json/json.h>
 #include <gtest/gtest.h>
@@ -9,12 +16,42 @@
 
 using namespace Gsage;
 
+namespace {
+  std::atomic<bool> countAllocations(false);
+  std::atomic<size_t> allocations(0);
+}
+
+// counts heap allocations made while countAllocations is set
+void* operator new(std::size_t size)
+{
+  if(countAllocations) {
+    allocations++;
+  }
+
+  void* res = std::malloc(size ? size : 1);
+  if(!res) {
+    throw std::bad_alloc();
+  }
+  return res;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
 class CustomObject
 {
   public:
     std::string variable;
 };
 
+struct Point
+{
+  double x;
+  double y;
+};
+
 class TestDataProxy : public ::testing::Test
 {
 
@@ -49,6 +86,59 @@ namespace Gsage {
   {
     typedef CustomObjectCaster type;
   };
+
+  // legacy string caster
+  struct PointStringCaster
+  {
+    bool to(const std::string& str, Point& dst) const
+    {
+      std::vector<std::string> values = split(str, ',');
+      if(values.size() != 2) {
+        return false;
+      }
+      dst.x = std::stod(values[0]);
+      dst.y = std::stod(values[1]);
+      return true;
+    }
+
+    const std::string from(const Point& value) const
+    {
+      return std::to_string(value.x) + "," + std::to_string(value.y);
+    }
+  };
+
+  struct PointArrayCaster
+  {
+    bool to(const NumericArray& src, Point& dst) const
+    {
+      if(src.size != 2) {
+        return false;
+      }
+      dst.x = src[0];
+      dst.y = src[1];
+      return true;
+    }
+
+    const NumericArray from(const Point& value) const
+    {
+      NumericArray res;
+      res.push(value.x);
+      res.push(value.y);
+      return res;
+    }
+  };
+
+  template<>
+  struct TranslatorBetween<std::string, Point>
+  {
+    typedef PointStringCaster type;
+  };
+
+  template<>
+  struct TranslatorBetween<NumericArray, Point>
+  {
+    typedef PointArrayCaster type;
+  };
 }
 
 TEST_F(TestDataProxy, TestLuaObject)
@@ -434,6 +524,7 @@ TEST_P(TestMerge, TestMergeOperations)
         return DataProxy::create(lua.create_table());
         break;
       case DataWrapper::JSON_OBJECT:
+      case DataWrapper::MSGPACK_OBJECT:
         return DataProxy::create(value);
         break;
       default:
@@ -508,5 +599,248 @@ INSTANTIATE_TEST_CASE_P(TestMergeOperations,
                           std::make_tuple(DataWrapper::JSON_OBJECT, DataWrapper::JSON_OBJECT),
                           std::make_tuple(DataWrapper::LUA_TABLE, DataWrapper::LUA_TABLE),
                           std::make_tuple(DataWrapper::JSON_OBJECT, DataWrapper::LUA_TABLE),
-                          std::make_tuple(DataWrapper::LUA_TABLE, DataWrapper::JSON_OBJECT)
+                          std::make_tuple(DataWrapper::LUA_TABLE, DataWrapper::JSON_OBJECT),
+                          std::make_tuple(DataWrapper::MSGPACK_OBJECT, DataWrapper::MSGPACK_OBJECT),
+                          std::make_tuple(DataWrapper::JSON_OBJECT, DataWrapper::MSGPACK_OBJECT),
+                          std::make_tuple(DataWrapper::MSGPACK_OBJECT, DataWrapper::LUA_TABLE)
                         ));
+
+TEST_F(TestDataProxy, TestNumericArrays)
+{
+  Point point = {1.5, -2.0};
+  for(auto type : {DataWrapper::JSON_OBJECT, DataWrapper::MSGPACK_OBJECT}) {
+    DataProxy dp = DataProxy::create(type);
+    dp.put("point", point);
+
+    // stored as array of numbers, not as a string
+    ASSERT_EQ(dp["point"].getStoredType(), DataWrapper::Array);
+    ASSERT_EQ(dp["point"].size(), 2);
+    ASSERT_FALSE(dp.get<std::string>("point").second);
+
+    Point res = {0, 0};
+    ASSERT_TRUE(dp.read("point", res));
+    ASSERT_DOUBLE_EQ(res.x, 1.5);
+    ASSERT_DOUBLE_EQ(res.y, -2.0);
+
+    // legacy strings are still parsed
+    dp.put("legacy", "3,4");
+    ASSERT_TRUE(dp.read("legacy", res));
+    ASSERT_DOUBLE_EQ(res.x, 3.0);
+    ASSERT_DOUBLE_EQ(res.y, 4.0);
+
+    DataProxy reloaded = loads(dumps(dp, type), type);
+    ASSERT_TRUE(reloaded.read("point", res));
+    ASSERT_DOUBLE_EQ(res.x, 1.5);
+  }
+
+  sol::table t = lua.create_table();
+  t["point"] = lua.create_table_with(1, 5, 2, 6);
+  DataProxy dp = DataProxy::wrap(t);
+  Point res = {0, 0};
+  ASSERT_TRUE(dp.read("point", res));
+  ASSERT_DOUBLE_EQ(res.x, 5.0);
+  ASSERT_DOUBLE_EQ(res.y, 6.0);
+}
+
+TEST_F(TestDataProxy, TestMsgpackObject)
+{
+  auto loaded = load(std::string(TEST_RESOURCES) + GSAGE_PATH_SEPARATOR + "test.msgpack", DataWrapper::MSGPACK_OBJECT);
+  ASSERT_TRUE(std::get<1>(loaded));
+  DataProxy dp = std::get<0>(loaded);
+  ASSERT_EQ(dp.getWrappedType(), DataWrapper::MSGPACK_OBJECT);
+
+  // values are read directly from the unpacked data
+  ASSERT_EQ(dp["nested"]["str"].as<std::string>(), "abcd");
+  ASSERT_EQ(dp.get<int>("int", 0), 1);
+  ASSERT_EQ(dp.get<bool>("bool", false), true);
+  ASSERT_EQ(dp.get<int>("nested.c", 0), 100);
+  ASSERT_EQ(dp["array"].size(), 3);
+  ASSERT_EQ(dp["array"][2]["a"].as<std::string>(), "123");
+  ASSERT_EQ(dp.count("missing"), 0);
+
+  // modifications are visible to the children, created before them
+  DataProxy nested = dp.get<DataProxy>("nested").first;
+  dp.put("added", 1.5);
+  dp.put("string", "value");
+  nested.put("child", 2);
+  ASSERT_EQ(dp.get<int>("nested.child", 0), 2);
+  ASSERT_FLOAT_EQ(dp.get<double>("added", 0), 1.5);
+
+  DataProxy reloaded = loads(dumps(dp, DataWrapper::MSGPACK_OBJECT), DataWrapper::MSGPACK_OBJECT);
+  ASSERT_EQ(reloaded.get<std::string>("string", ""), "value");
+  ASSERT_EQ(reloaded.get<int>("nested.child", 0), 2);
+  ASSERT_EQ(reloaded["array"].size(), 3);
+
+  DataProxy json = DataProxy::create(DataWrapper::JSON_OBJECT);
+  reloaded.dump(json);
+  ASSERT_EQ(json.getWrappedType(), DataWrapper::JSON_OBJECT);
+  ASSERT_EQ(json["nested"]["str"].as<std::string>(), "abcd");
+
+  DataProxy invalid;
+  ASSERT_FALSE(loads(invalid, "\xc1", DataWrapper::MSGPACK_OBJECT));
+}
+
+TEST_F(TestDataProxy, TestMsgpackStorageReuse)
+{
+  MsgpackWrapper::DocumentPtr document = std::make_shared<MsgpackWrapper::Document>();
+  MsgpackWrapper wrapper(document, MsgpackWrapper::Path(), document->root);
+
+  NumericArray position;
+  position.push(1);
+  position.push(2);
+  position.push(3);
+  std::set<const void*> blocks;
+  for(int i = 0; i < 100; i++) {
+    wrapper.putArray("position", position);
+    blocks.insert(wrapper.getObject()->via.map.ptr[0].val.via.array.ptr);
+
+    // replaced map is released with all the arrays it had
+    DataWrapper* child = wrapper.createChildAt("child");
+    for(int j = 0; j < 10; j++) {
+      static_cast<MsgpackWrapper*>(child)->putArray(std::to_string(j), position);
+    }
+    delete child;
+  }
+
+  // new array is created before the old one is released
+  ASSERT_LE(blocks.size(), 2u);
+  // root map, position and child map with its 10 arrays
+  ASSERT_EQ(document->blockSizes.size(), 13u);
+
+  NumericArray res;
+  ASSERT_TRUE(wrapper.readArray("position", res));
+  ASSERT_EQ(res.size, 3u);
+  ASSERT_EQ(wrapper.size(), 2);
+}
+
+/**
+ * Compares msgpack loading into the native wrapper with converting it into Json::Value tree.
+ * Disabled by default, run with --gtest_also_run_disabled_tests
+ */
+TEST_F(TestDataProxy, DISABLED_BenchmarkMsgpackLoad)
+{
+  auto loaded = load(std::string(TEST_RESOURCES) + GSAGE_PATH_SEPARATOR + "test.msgpack", DataWrapper::MSGPACK_OBJECT);
+  ASSERT_TRUE(std::get<1>(loaded));
+  std::string data = dumps(std::get<0>(loaded), DataWrapper::MSGPACK_OBJECT);
+
+  const int iterations = 20000;
+  int total = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for(int i = 0; i < iterations; i++) {
+    DataProxy dp = loads(data, DataWrapper::MSGPACK_OBJECT);
+    total += dp.get<int>("nested.c", 0);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double native = std::chrono::duration<double>(end - start).count();
+
+  start = std::chrono::high_resolution_clock::now();
+  for(int i = 0; i < iterations; i++) {
+    DataProxy json = DataProxy::create(DataWrapper::JSON_OBJECT);
+    loads(data, DataWrapper::MSGPACK_OBJECT).dump(json);
+    total += json.get<int>("nested.c", 0);
+  }
+  end = std::chrono::high_resolution_clock::now();
+  double converted = std::chrono::duration<double>(end - start).count();
+
+  ASSERT_EQ(total, iterations * 200);
+  LOG(INFO) << "Msgpack load: native " << (iterations / native) << " loads per second, "
+            << "with Json::Value tree " << (iterations / converted) << " loads per second";
+}
+
+TEST_F(TestDataProxy, TestCompiledPath)
+{
+  DataProxy::Path position("render.root.position");
+  ASSERT_EQ(position, DataProxy::Path("render.root.position"));
+  ASSERT_NE(position, DataProxy::Path("render.root"));
+  ASSERT_EQ(position.str(), "render.root.position");
+  ASSERT_EQ(position.getKey(), "position");
+  ASSERT_EQ(position.getParents().size(), 2);
+
+  DataWrapper::WrappedType types[] = {DataWrapper::JSON_OBJECT, DataWrapper::MSGPACK_OBJECT};
+  for(auto type : types) {
+    DataProxy dp = DataProxy::create(type);
+    dp.put(position, "1,2,3");
+    ASSERT_EQ(dp.get<std::string>("render.root.position").first, "1,2,3");
+    ASSERT_EQ(dp.get(position, "none"), "1,2,3");
+
+    DataProxy::Path id("id");
+    dp.put(id, 5);
+    ASSERT_EQ(dp.get(id, 0), 5);
+    ASSERT_EQ(dp.get<int>("id").first, 5);
+
+    ASSERT_FALSE(dp.get<int>(DataProxy::Path("render.missing")).second);
+    ASSERT_FALSE(dp.get<int>(DataProxy::Path("id.value")).second);
+  }
+}
+
+/**
+ * Path is resolved against the wrapped data, only the parent of the value gets a wrapper
+ */
+TEST_F(TestDataProxy, TestPathAllocations)
+{
+  const DataProxy::Path shallow("shallow.value");
+  const DataProxy::Path deep("a.b.c.d.e.f.value");
+
+  sol::table table = lua.create_table();
+  DataProxy proxies[] = {
+    DataProxy::create(DataWrapper::JSON_OBJECT),
+    DataProxy::create(DataWrapper::MSGPACK_OBJECT),
+    DataProxy::wrap(table)
+  };
+  for(auto& dp : proxies) {
+    dp.put(shallow, 1);
+    dp.put(deep, 2);
+
+    int value = 0;
+    auto count = [&](const DataProxy::Path& path) {
+      allocations = 0;
+      countAllocations = true;
+      bool res = dp.read(path, value);
+      countAllocations = false;
+      EXPECT_TRUE(res);
+      return allocations.load();
+    };
+
+    size_t shallowCount = count(shallow);
+    EXPECT_EQ(value, 1);
+    size_t deepCount = count(deep);
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(deepCount, shallowCount) << "wrapped type " << dp.getWrappedType();
+    // wrapper, shared pointer control block and msgpack path
+    EXPECT_LE(deepCount, 3u) << "wrapped type " << dp.getWrappedType();
+
+    EXPECT_FALSE(dp.get<int>(DataProxy::Path("a.b.missing.value")).second);
+    EXPECT_EQ(dp.get<int>("a.b.c.d.e.f.value", 0), 2);
+  }
+}
+
+/**
+ * Compares lookups by string key with lookups by compiled path.
+ * Disabled by default, run with --gtest_also_run_disabled_tests
+ */
+TEST_F(TestDataProxy, DISABLED_BenchmarkCompiledPath)
+{
+  DataProxy dp = DataProxy::create(DataWrapper::JSON_OBJECT);
+  dp.put("render.root.position", 1);
+
+  const int iterations = 200000;
+  int total = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for(int i = 0; i < iterations; i++) {
+    total += dp.get("render.root.position", 0);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double stringKey = std::chrono::duration<double>(end - start).count();
+
+  DataProxy::Path path("render.root.position");
+  start = std::chrono::high_resolution_clock::now();
+  for(int i = 0; i < iterations; i++) {
+    total += dp.get(path, 0);
+  }
+  end = std::chrono::high_resolution_clock::now();
+  double compiledKey = std::chrono::duration<double>(end - start).count();
+
+  ASSERT_EQ(total, iterations * 2);
+  LOG(INFO) << "DataProxy get: string key " << (iterations / stringKey) << " reads per second, "
+            << "compiled path " << (iterations / compiledKey) << " reads per second";
+}
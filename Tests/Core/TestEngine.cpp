@@ -3,8 +3,15 @@
 #include "EngineSystem.h"
 #include "Component.h"
 #include "ComponentStorage.h"
+#include "PackedComponentStorage.h"
+#include "ScratchAllocator.h"
 #include "Entity.h"
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
 using namespace Gsage;
 
 class SpeedComponent : public EntityComponent
@@ -70,6 +77,40 @@ class TestSystem : public ComponentStorage<SpeedComponent>
     }
 };
 
+struct MovementData
+{
+  double position;
+  double velocity;
+};
+
+class MovementSystem : public PackedComponentStorage<SpeedComponent, MovementData>
+{
+  public:
+    MovementSystem() : removeOnUpdate(0) {}
+
+    void updateComponent(MovementData& data, SpeedComponent* component, Entity* entity, const double& time)
+    {
+      data.position += data.velocity * time;
+      updated.push_back(entity->getId());
+      if(removeOnUpdate) {
+        Entity* e = removeOnUpdate;
+        removeOnUpdate = 0;
+        mEngine->removeEntity(e);
+      }
+    }
+
+    bool fillComponentData(SpeedComponent* c, const DataProxy& data)
+    {
+      c->value = data.get<double>("speed").first;
+      getHotData(c).position = 0;
+      getHotData(c).velocity = c->value;
+      return true;
+    }
+
+    std::vector<std::string> updated;
+    Entity* removeOnUpdate;
+};
+
 class TestEngine : public ::testing::Test
 {
   public:
@@ -129,6 +170,121 @@ TEST_F(TestEngine, TestAddSystem)
   ASSERT_EQ(0, system.getComponentCount());
 }
 
+class MassComponent : public EntityComponent
+{
+  public:
+    MassComponent()
+      : mass(0)
+    {
+      BIND_PROPERTY("mass", &mass);
+      setReadsResolvedProperties(true);
+    }
+
+    double mass;
+};
+
+class ScaledMassComponent : public MassComponent
+{
+  public:
+    ScaledMassComponent()
+      : reads(0)
+    {
+      setReadsResolvedProperties(false);
+    }
+
+    bool read(const DataProxy& dict)
+    {
+      reads++;
+      bool res = MassComponent::read(dict);
+      mass *= dict.get("scale", 1.0);
+      return res;
+    }
+
+    int reads;
+};
+
+class ScaledMassSystem : public ComponentStorage<ScaledMassComponent>
+{
+  public:
+    void updateComponent(ScaledMassComponent* component, Entity* entity, const double& time)
+    {
+    }
+};
+
+class MassSystem : public ComponentStorage<MassComponent>
+{
+  public:
+    MassSystem() : filled(0) {}
+
+    void updateComponent(MassComponent* component, Entity* entity, const double& time)
+    {
+    }
+
+    bool fillComponentData(MassComponent* c, const DataProxy& data)
+    {
+      filled++;
+      return true;
+    }
+
+    int filled;
+};
+
+TEST_F(TestEngine, TestCreateEntityFromTemplate)
+{
+  MassSystem* system = new MassSystem();
+  mInstance->addSystem("mass", system);
+  DataProxy data;
+  data.put("class", "rock");
+  data.put("flags.0", "dynamic");
+  data.put("mass.mass", 2.5);
+
+  Engine::EntityTemplate entityTemplate(data);
+  Entity* first = mInstance->createEntity(entityTemplate);
+  ASSERT_NE(first, nullptr);
+  ASSERT_TRUE(entityTemplate.resolved);
+  ASSERT_EQ(entityTemplate.components.size(), 1u);
+  EXPECT_EQ(entityTemplate.components[0].id, ComponentRegistry::find("mass"));
+  ASSERT_NE(entityTemplate.components[0].properties.table, nullptr);
+
+  // entity with no id gets a new id each time
+  Entity* second = mInstance->createEntity(entityTemplate);
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(first->getId(), second->getId());
+  EXPECT_EQ(system->filled, 2);
+
+  for(Entity* entity : {first, second})
+  {
+    EXPECT_EQ(entity->getClass(), "rock");
+    EXPECT_TRUE(entity->hasFlag("dynamic"));
+    MassComponent* c = mInstance->getComponent<MassComponent>(*entity, "mass");
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(c->mass, 2.5);
+  }
+
+  // template data is not modified
+  EXPECT_EQ(data.count("id"), 0);
+  EXPECT_EQ(mInstance->view({"mass"}).size(), 2u);
+
+  // component with custom reading is created by its own read
+  mInstance->addSystem("scaledMass", new ScaledMassSystem());
+  DataProxy scaled;
+  scaled.put("mass", 2.5);
+  scaled.put("scale", 2.0);
+  DataProxy scaledData;
+  scaledData.put("scaledMass", scaled);
+  Engine::EntityTemplate scaledTemplate(scaledData);
+  for(int i = 0; i < 2; i++)
+  {
+    Entity* entity = mInstance->createEntity(scaledTemplate);
+    ASSERT_NE(entity, nullptr);
+    ScaledMassComponent* c = mInstance->getComponent<ScaledMassComponent>(*entity, "scaledMass");
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(c->reads, 1);
+    EXPECT_EQ(c->mass, 5.0);
+  }
+  EXPECT_EQ(scaledTemplate.components[0].properties.table, nullptr);
+}
+
 TEST_F(TestEngine, TestEntityAddFailure)
 {
   TestSystem system;
@@ -154,3 +310,482 @@ TEST_F(TestEngine, TestEntityAddFailure)
   ASSERT_FALSE(mInstance->removeEntity("test"));
   ASSERT_FALSE(mInstance->removeEntity("not_exists"));
 }
+
+TEST_F(TestEngine, TestEntityHandles)
+{
+  DataProxy entityData;
+  entityData.put("id", "test");
+  Entity* e = mInstance->createEntity(entityData);
+  Entity::Handle handle = e->getHandle();
+
+  ASSERT_NE(handle, Entity::INVALID_HANDLE);
+  ASSERT_EQ(mInstance->getEntity(handle), e);
+  ASSERT_EQ(mInstance->getEntity(Entity::Handle(Entity::INVALID_HANDLE)), (Entity*)NULL);
+  // handle fits into the double without precision loss, so it can be passed to Lua
+  ASSERT_EQ((Entity::Handle)(double)handle, handle);
+
+  ASSERT_TRUE(mInstance->removeEntity(handle));
+  ASSERT_EQ(mInstance->getEntity(handle), (Entity*)NULL);
+  ASSERT_FALSE(mInstance->removeEntity(handle));
+
+  // the slot is reused, but the old handle stays stale
+  DataProxy entityData2;
+  entityData2.put("id", "test2");
+  Entity* e2 = mInstance->createEntity(entityData2);
+  ASSERT_EQ(e, e2);
+  ASSERT_NE(e2->getHandle(), handle);
+  ASSERT_EQ(mInstance->getEntity(handle), (Entity*)NULL);
+  ASSERT_EQ(mInstance->getEntity(e2->getHandle()), e2);
+  ASSERT_EQ(mInstance->getEntity("test2"), e2);
+}
+
+class TaggedComponent : public EntityComponent
+{
+  public:
+    static const std::string SYSTEM;
+};
+
+const std::string TaggedComponent::SYSTEM = "tagged";
+
+TEST_F(TestEngine, TestComponentMask)
+{
+  Entity entity;
+  SpeedComponent speed;
+  AccelerationComponent acceleration;
+  TaggedComponent tagged;
+
+  ASSERT_TRUE(entity.addComponent("speed", &speed));
+  ASSERT_TRUE(entity.addComponent("accelerator", &acceleration));
+  ASSERT_TRUE(entity.hasComponent("speed"));
+  ASSERT_FALSE(entity.hasComponent(TaggedComponent::SYSTEM));
+  ASSERT_TRUE(entity.hasComponents({"speed", "accelerator"}));
+  ASSERT_FALSE(entity.hasComponents({"speed", "notRegistered"}));
+  ASSERT_EQ(entity.getComponent<TaggedComponent>(), (TaggedComponent*)NULL);
+
+  ASSERT_TRUE(entity.addComponent(TaggedComponent::SYSTEM, &tagged));
+  ASSERT_EQ(entity.getComponent<TaggedComponent>(), &tagged);
+  ASSERT_EQ(entity.getComponent("speed"), &speed);
+  ASSERT_EQ(entity.getComponent("accelerator"), &acceleration);
+
+  ComponentMask mask = ComponentRegistry::getMask<TaggedComponent>() | ComponentRegistry::getBit(ComponentRegistry::find("speed"));
+  ASSERT_TRUE(entity.hasComponents(mask));
+  ASSERT_EQ(ComponentRegistry::count(entity.getComponentMask()), 3);
+
+  ASSERT_TRUE(entity.removeComponent("speed"));
+  ASSERT_FALSE(entity.removeComponent("speed"));
+  ASSERT_FALSE(entity.hasComponents(mask));
+  ASSERT_EQ(entity.getComponent("speed"), (EntityComponent*)NULL);
+  ASSERT_EQ(entity.getComponent("accelerator"), &acceleration);
+  ASSERT_EQ(entity.getComponent<TaggedComponent>(), &tagged);
+  ASSERT_EQ(entity.getComponentNames().size(), 2);
+}
+
+class TrackedComponent : public EntityComponent
+{
+  public:
+    TrackedComponent()
+    {
+      setTracksChanges(true);
+    }
+};
+
+TEST_F(TestEngine, TestEntityDirtyTracking)
+{
+  Entity entity;
+  TrackedComponent tracked;
+  SpeedComponent untracked;
+  tracked.setOwner(&entity);
+  untracked.setOwner(&entity);
+
+  ASSERT_TRUE(entity.addComponent("tracked", &tracked));
+  EXPECT_TRUE(entity.isDirty());
+  entity.setDirty(false);
+  tracked.setDirty(false);
+  EXPECT_FALSE(entity.isDirty());
+
+  // component change marks the owner
+  tracked.setDirty();
+  EXPECT_TRUE(entity.isDirty());
+  entity.setDirty(false);
+
+  entity.setFlag("dynamic");
+  EXPECT_TRUE(entity.isDirty());
+  entity.setDirty(false);
+
+  // components without change tracking keep the entity dirty
+  ASSERT_TRUE(entity.addComponent("speed", &untracked));
+  entity.setDirty(false);
+  EXPECT_TRUE(entity.isDirty());
+
+  ASSERT_TRUE(entity.removeComponent("speed"));
+  entity.setDirty(false);
+  EXPECT_FALSE(entity.isDirty());
+}
+
+TEST_F(TestEngine, TestConcurrentComponentRegistry)
+{
+  const int threadCount = 4;
+  const int typeCount = 8;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<ComponentId>> ids(threadCount, std::vector<ComponentId>(typeCount));
+  std::atomic<bool> failed(false);
+  for(int t = 0; t < threadCount; t++) {
+    threads.emplace_back([&, t] {
+      for(int i = 0; i < typeCount; i++) {
+        std::string name = "concurrent" + std::to_string((i + t) % typeCount);
+        ComponentId id = ComponentRegistry::getId(name);
+        if(ComponentRegistry::find(name) != id || ComponentRegistry::getName(id) != name)
+          failed = true;
+        ids[t][(i + t) % typeCount] = id;
+      }
+    });
+  }
+  for(auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_FALSE(failed);
+  for(int t = 1; t < threadCount; t++) {
+    ASSERT_EQ(ids[t], ids[0]);
+  }
+  ASSERT_EQ(ComponentRegistry::find("notRegistered"), (ComponentId)ComponentRegistry::INVALID_ID);
+  ASSERT_EQ(ComponentRegistry::getName(MAX_COMPONENT_TYPES - 1), "");
+}
+
+TEST_F(TestEngine, TestEntityView)
+{
+  TestSystem system;
+  mInstance->addSystem("speed", &system);
+  mInstance->addSystem("accelerator", new AccelerationSystem());
+
+  DataProxy speed;
+  DataProxy accelerator;
+  speed.put("speed", 2.0);
+  accelerator.put("acceleration", 1.5);
+
+  DataProxy entityData;
+  entityData.put("id", "both");
+  entityData.put("speed", speed);
+  entityData.put("accelerator", accelerator);
+  mInstance->createEntity(entityData);
+
+  DataProxy speedOnly;
+  speedOnly.put("id", "speedOnly");
+  speedOnly.put("speed", speed);
+  mInstance->createEntity(speedOnly);
+
+  // view is populated on creation and cached
+  EntityView& view = mInstance->view({"speed", "accelerator"});
+  ASSERT_EQ(&view, &mInstance->view({"accelerator", "speed"}));
+  ASSERT_EQ(view.size(), 1);
+  ASSERT_EQ(view.getEntities()[0]->getId(), "both");
+  ASSERT_EQ(mInstance->view({"speed"}).size(), 2);
+
+  // adding a component to existing entity updates the view
+  speedOnly.put("accelerator", accelerator);
+  mInstance->createEntity(speedOnly);
+  ASSERT_EQ(view.size(), 2);
+  ASSERT_TRUE(view.contains(mInstance->getEntity("speedOnly")));
+
+  // new entities are added incrementally
+  entityData.put("id", "third");
+  mInstance->createEntity(entityData);
+  ASSERT_EQ(view.size(), 3);
+
+  ASSERT_TRUE(mInstance->removeEntity("both"));
+  ASSERT_EQ(view.size(), 2);
+  ASSERT_FALSE(view.contains(mInstance->getEntity("both")));
+  for(Entity* entity : view) {
+    ASSERT_TRUE(entity->getId() == "speedOnly" || entity->getId() == "third");
+  }
+
+  mInstance->unloadAll();
+  ASSERT_TRUE(view.empty());
+  ASSERT_TRUE(mInstance->view({"speed"}).empty());
+}
+
+TEST_F(TestEngine, TestEntityViewEach)
+{
+  Engine engine;
+  EntityView& view = engine.view<TaggedComponent>();
+  ASSERT_EQ(view.getMask(), ComponentRegistry::getMask<TaggedComponent>());
+
+  Entity entity;
+  TaggedComponent tagged;
+  view.update(&entity);
+  ASSERT_TRUE(view.empty());
+
+  ASSERT_TRUE(entity.addComponent(TaggedComponent::SYSTEM, &tagged));
+  view.update(&entity);
+  ASSERT_EQ(view.size(), 1);
+
+  int calls = 0;
+  view.each<TaggedComponent>([&](Entity* e, TaggedComponent* c) {
+    ASSERT_EQ(e, &entity);
+    ASSERT_EQ(c, &tagged);
+    calls++;
+  });
+  ASSERT_EQ(calls, 1);
+
+  // entity that lost the component is dropped on update
+  ASSERT_TRUE(entity.removeComponent(TaggedComponent::SYSTEM));
+  view.update(&entity);
+  ASSERT_TRUE(view.empty());
+}
+
+TEST_F(TestEngine, TestPackedComponentStorage)
+{
+  MovementSystem system;
+  mInstance->addSystem("movement", &system);
+
+  std::vector<Entity*> entities;
+  for(int i = 0; i < 4; i++) {
+    DataProxy entityData;
+    DataProxy movement;
+    movement.put("speed", (double)(i + 1));
+    entityData.put("id", std::string("e") + std::to_string(i));
+    entityData.put("movement", movement);
+    entities.push_back(mInstance->createEntity(entityData));
+  }
+
+  ASSERT_EQ(4, system.getComponentCount());
+  mInstance->update(2);
+  ASSERT_EQ(4, system.updated.size());
+  for(int i = 0; i < 4; i++) {
+    SpeedComponent* c = mInstance->getComponent<SpeedComponent>(*entities[i], "movement");
+    ASSERT_DOUBLE_EQ(system.getHotData(c).position, (i + 1) * 2.0);
+  }
+
+  // remove from the middle, packed arrays keep the mapping
+  ASSERT_TRUE(mInstance->removeEntity("e1"));
+  ASSERT_EQ(3, system.getComponentCount());
+  SpeedComponent* last = mInstance->getComponent<SpeedComponent>(*entities[3], "movement");
+  ASSERT_DOUBLE_EQ(system.getHotData(last).position, 8.0);
+
+  // removal during the update skips removed component and compacts after the loop
+  system.updated.clear();
+  system.removeOnUpdate = entities[3];
+  mInstance->update(1);
+  ASSERT_EQ(2, system.getComponentCount());
+  ASSERT_EQ(1, std::count(system.updated.begin(), system.updated.end(), "e0"));
+  ASSERT_EQ(1, std::count(system.updated.begin(), system.updated.end(), "e2"));
+
+  SpeedComponent* c = mInstance->getComponent<SpeedComponent>(*entities[2], "movement");
+  ASSERT_DOUBLE_EQ(system.getHotData(c).position, 9.0);
+
+  mInstance->unloadAll();
+  ASSERT_EQ(0, system.getComponentCount());
+}
+
+class ScheduledSystem : public EngineSystem
+{
+  public:
+    ScheduledSystem(std::vector<std::string>& log, std::mutex& mutex, std::atomic<int>& active, std::atomic<int>& maxActive)
+      : mLog(log)
+      , mMutex(mutex)
+      , mActive(active)
+      , mMaxActive(maxActive)
+    {
+    }
+
+    void reads(const std::string& type) { declareRead(type); }
+    void writes(const std::string& type) { declareWrite(type); }
+    void exclusive() { setExclusive(true); }
+
+    void update(const double& time)
+    {
+      int active = ++mActive;
+      int max = mMaxActive;
+      while(active > max && !mMaxActive.compare_exchange_weak(max, active)) {}
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLog.push_back(getName());
+      }
+      thread = std::this_thread::get_id();
+      --mActive;
+    }
+
+    std::thread::id thread;
+
+    EntityComponent* createComponent(const DataProxy& data, Entity* owner) { return 0; }
+    bool removeComponent(EntityComponent* component) { return true; }
+    void unloadComponents() {}
+  private:
+    std::vector<std::string>& mLog;
+    std::mutex& mMutex;
+    std::atomic<int>& mActive;
+    std::atomic<int>& mMaxActive;
+};
+
+TEST_F(TestEngine, TestSerialScheduler)
+{
+  std::vector<std::string> log;
+  std::mutex mutex;
+  std::atomic<int> active(0);
+  std::atomic<int> maxActive(0);
+
+  ScheduledSystem b(log, mutex, active, maxActive);
+  ScheduledSystem a(log, mutex, active, maxActive);
+  b.writes("b");
+  a.writes("a");
+  mInstance->addSystem("b", &b);
+  mInstance->addSystem("a", &a);
+
+  ASSERT_FALSE(mInstance->getScheduler().isParallel());
+  mInstance->update(1);
+  ASSERT_EQ(log.size(), 2);
+  ASSERT_EQ(log[0], "a");
+  ASSERT_EQ(log[1], "b");
+  ASSERT_EQ(maxActive, 1);
+}
+
+TEST_F(TestEngine, TestParallelScheduler)
+{
+  std::vector<std::string> log;
+  std::mutex mutex;
+  std::atomic<int> active(0);
+  std::atomic<int> maxActive(0);
+
+  // movement writes render, so they must not overlap
+  // stats is independent, it can be updated along with any of them
+  ScheduledSystem movement(log, mutex, active, maxActive);
+  movement.writes("movement");
+  movement.writes("render");
+  ScheduledSystem render(log, mutex, active, maxActive);
+  render.reads("render");
+  ScheduledSystem stats(log, mutex, active, maxActive);
+  stats.writes("stats");
+  // undeclared system is exclusive
+  ScheduledSystem exclusive(log, mutex, active, maxActive);
+
+  mInstance->addSystem("movement", &movement);
+  mInstance->addSystem("render", &render);
+  mInstance->addSystem("stats", &stats);
+  mInstance->addSystem("exclusive", &exclusive);
+  mInstance->getScheduler().setParallel(true, 4);
+
+  for(int i = 0; i < 3; i++) {
+    log.clear();
+    mInstance->update(1);
+    ASSERT_EQ(log.size(), 4);
+    // exclusive goes first in the engine order, movement must finish before render
+    ASSERT_EQ(log[0], "exclusive");
+    ASSERT_LT(std::find(log.begin(), log.end(), "movement"), std::find(log.begin(), log.end(), "render"));
+    ASSERT_LE(maxActive, 2);
+  }
+  // movement and stats should overlap at least once
+  ASSERT_EQ(maxActive, 2);
+
+  // disabled system is skipped
+  log.clear();
+  stats.setEnabled(false);
+  mInstance->update(1);
+  ASSERT_EQ(log.size(), 3);
+  ASSERT_EQ(std::count(log.begin(), log.end(), "stats"), 0);
+
+  mInstance->getScheduler().setParallel(false);
+}
+
+TEST_F(TestEngine, TestSchedulerExclusiveSystem)
+{
+  std::vector<std::string> log;
+  std::mutex mutex;
+  std::atomic<int> active(0);
+  std::atomic<int> maxActive(0);
+
+  // conflicting chain is updated by a single thread
+  ScheduledSystem a(log, mutex, active, maxActive);
+  a.writes("a");
+  ScheduledSystem b(log, mutex, active, maxActive);
+  b.reads("a");
+  b.writes("b");
+  ScheduledSystem c(log, mutex, active, maxActive);
+  c.reads("b");
+  // declared, but exclusive system conflicts with everything and runs on the main thread
+  ScheduledSystem script(log, mutex, active, maxActive);
+  script.writes("script");
+  script.exclusive();
+  ScheduledSystem stats(log, mutex, active, maxActive);
+  stats.writes("stats");
+
+  mInstance->addSystem("a", &a);
+  mInstance->addSystem("b", &b);
+  mInstance->addSystem("c", &c);
+  mInstance->addSystem("script", &script);
+  mInstance->addSystem("stats", &stats);
+  mInstance->getScheduler().setParallel(true, 4);
+
+  ASSERT_TRUE(script.isMainThreadOnly());
+  ASSERT_FALSE(stats.isMainThreadOnly());
+  for(int i = 0; i < 3; i++) {
+    log.clear();
+    mInstance->update(1);
+    ASSERT_EQ(log, std::vector<std::string>({"a", "b", "c", "script", "stats"}));
+    ASSERT_EQ(a.thread, b.thread);
+    ASSERT_EQ(b.thread, c.thread);
+    ASSERT_EQ(script.thread, std::this_thread::get_id());
+  }
+  ASSERT_EQ(maxActive, 1);
+
+  mInstance->getScheduler().setParallel(false);
+}
+
+class ParallelSpeedSystem : public ComponentStorage<SpeedComponent>
+{
+  public:
+    ParallelSpeedSystem() : chunks(0) {}
+
+    void updateChunk(SpeedComponent** components, size_t count, const double& time, ScratchAllocator& scratch)
+    {
+      chunks++;
+      // stage values in chunk scratch memory
+      double* values = scratch.allocate<double>(count);
+      for(size_t i = 0; i < count; ++i) {
+        values[i] = components[i]->value + time;
+      }
+      for(size_t i = 0; i < count; ++i) {
+        components[i]->value = values[i];
+      }
+    }
+
+    void updateComponent(SpeedComponent* component, Entity* entity, const double& time)
+    {
+    }
+
+    std::atomic<int> chunks;
+};
+
+TEST_F(TestEngine, TestParallelComponentUpdate)
+{
+  ParallelSpeedSystem system;
+  mInstance->addSystem("speed", &system);
+  system.setParallelUpdate(true, 1000);
+
+  const int count = 20000;
+  DataProxy speed;
+  speed.put("speed", 0.0);
+  for(int i = 0; i < count; i++) {
+    DataProxy entityData;
+    entityData.put("speed", speed);
+    mInstance->createEntity(entityData);
+  }
+
+  for(Entity* e : mInstance->getEntities()) {
+    mInstance->getComponent<SpeedComponent>(*e, "speed")->value = 0;
+  }
+
+  mInstance->update(1);
+  mInstance->update(1);
+  ASSERT_EQ(system.chunks, 2 * count / 1000);
+  for(Entity* e : mInstance->getEntities()) {
+    ASSERT_DOUBLE_EQ(mInstance->getComponent<SpeedComponent>(*e, "speed")->value, 2.0);
+  }
+
+  // falls back to the serial update when there are less components than in one chunk
+  system.chunks = 0;
+  system.setParallelUpdate(true, count);
+  mInstance->update(1);
+  ASSERT_EQ(system.chunks, 1);
+  mInstance->unloadAll();
+}
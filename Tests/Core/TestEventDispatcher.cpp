@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
+#include <chrono>
 #include "EventDispatcher.h"
 #include "EventSubscriber.h"
+#include "EventQueue.h"
+#include "EventInbox.h"
+#include <atomic>
+#include <thread>
 
 using namespace Gsage;
 
@@ -9,8 +14,10 @@ class TestEvent : public Event
   public:
     static const std::string PING;
     static const std::string ECHO;
+    static const Event::TypeId PING_ID;
 
     TestEvent(const std::string& type, int value) : Event(type), mValue(value) {};
+    TestEvent(Event::TypeId type, int value) : Event(type), mValue(value) {};
     int getValue() { return mValue; };
 
     void setHandled(const std::string& name) { mHandlerName = name; };
@@ -22,6 +29,7 @@ class TestEvent : public Event
 
 const std::string TestEvent::PING = "ping";
 const std::string TestEvent::ECHO = "echo";
+const Event::TypeId TestEvent::PING_ID = Event::intern(TestEvent::PING);
 
 class TestEventDispatcher : public ::testing::Test
 {
@@ -361,3 +369,297 @@ TEST(TestRemoveEventListener, TestRemoveInHandler)
   delete handler;
   delete dispatcher;
 }
+
+/**
+ * Test event types interning
+ * 1. Same type strings get the same id, different strings get different ids.
+ * 2. Event created from id has the same type string.
+ */
+TEST(TestEventTypes, TestInterning)
+{
+  Event::TypeId ping = Event::intern(TestEvent::PING);
+  Event::TypeId echo = Event::intern(TestEvent::ECHO);
+
+  ASSERT_NE(ping, echo);
+  ASSERT_EQ(ping, Event::intern("ping"));
+  ASSERT_EQ(TestEvent(TestEvent::PING, 1).getTypeId(), ping);
+  ASSERT_EQ(Event::getTypeName(echo), TestEvent::ECHO);
+
+  Event event(ping);
+  ASSERT_EQ(event.getType(), TestEvent::PING);
+}
+
+/**
+ * Test that callbacks with the same priority are called in the order of subscription,
+ * even after some of them were removed and added back
+ */
+TEST(TestEventSignal, TestConnectionOrder)
+{
+  EventSignal signal;
+  std::vector<int> calls;
+  EventConnection first = signal.connect(1, [&calls](EventDispatcher*, const Event&) { calls.push_back(1); return true; });
+  EventConnection second = signal.connect(1, [&calls](EventDispatcher*, const Event&) { calls.push_back(2); return true; });
+  signal.connect(0, [&calls](EventDispatcher*, const Event&) { calls.push_back(0); return true; });
+
+  first.disconnect();
+  EventConnection third = signal.connect(1, [&calls](EventDispatcher*, const Event&) { calls.push_back(3); return true; });
+  // removing second connection must not affect the third one
+  second.disconnect();
+
+  signal(0, TestEvent(TestEvent::PING, 1));
+  ASSERT_EQ(calls, std::vector<int>({0, 3}));
+  ASSERT_FALSE(signal.empty());
+}
+
+/**
+ * Test queued events flow:
+ * 1. Without the queue, queueEvent fires immediately.
+ * 2. With the queue, events are dispatched on flush in the order of posting.
+ * 3. Events with the same key are coalesced, the last one is dispatched.
+ **/
+TEST(TestEventQueue, TestQueueAndCoalesce)
+{
+  TestEvents receivedEvents;
+  EventDispatcher dispatcher;
+  TestEventHandler handler(receivedEvents);
+  handler.addEventListener(&dispatcher, TestEvent::PING, &TestEventHandler::onTestEvent);
+  handler.addEventListener(&dispatcher, TestEvent::ECHO, &TestEventHandler::onTestEvent);
+
+  dispatcher.queueEvent(TestEvent(TestEvent::PING, 1));
+  ASSERT_EQ(receivedEvents.size(), 1);
+  receivedEvents.clear();
+
+  EventQueue queue;
+  dispatcher.setEventQueue(&queue);
+  dispatcher.queueEvent(TestEvent(TestEvent::PING, 1), 1);
+  dispatcher.queueEvent(TestEvent(TestEvent::ECHO, 2), 1);
+  dispatcher.queueEvent(TestEvent(TestEvent::PING, 3));
+  dispatcher.queueEvent(TestEvent(TestEvent::PING, 4), 1);
+  ASSERT_EQ(receivedEvents.size(), 0);
+  ASSERT_EQ(queue.size(), 3);
+
+  ASSERT_EQ(queue.flush(), 3);
+  ASSERT_EQ(receivedEvents.size(), 3);
+  // coalesced event takes the place of the last posted one
+  ASSERT_EQ(receivedEvents[0].getValue(), 2);
+  ASSERT_EQ(receivedEvents[1].getValue(), 3);
+  ASSERT_EQ(receivedEvents[2].getValue(), 4);
+  ASSERT_EQ(queue.size(), 0);
+  ASSERT_EQ(queue.flush(), 0);
+}
+
+/**
+ * Test custom merge function for the coalesced events
+ */
+TEST(TestEventQueue, TestMerge)
+{
+  TestEvents receivedEvents;
+  EventDispatcher dispatcher;
+  EventQueue queue;
+  dispatcher.setEventQueue(&queue);
+  TestEventHandler handler(receivedEvents);
+  handler.addEventListener(&dispatcher, TestEvent::PING, &TestEventHandler::onTestEvent);
+
+  auto sum = [](TestEvent& queued, const TestEvent& event) {
+    queued = TestEvent(event.getType(), queued.getValue() + const_cast<TestEvent&>(event).getValue());
+  };
+  for(int i = 1; i <= 10; i++) {
+    dispatcher.queueEvent(TestEvent(TestEvent::PING, i), 0, sum);
+  }
+
+  queue.flush();
+  ASSERT_EQ(receivedEvents.size(), 1);
+  ASSERT_EQ(receivedEvents[0].getValue(), 55);
+}
+
+class TestQueueingHandler : public EventSubscriber<TestQueueingHandler>
+{
+  public:
+    TestQueueingHandler() : count(0) {}
+
+    bool onEvent(EventDispatcher* sender, const Event& event)
+    {
+      count++;
+      sender->queueEvent(TestEvent(TestEvent::PING, count));
+      return true;
+    }
+
+    int count;
+};
+
+/**
+ * Test that events posted during the flush are dispatched on the next flush
+ * and that events of deleted dispatcher are dropped
+ **/
+TEST(TestEventQueue, TestPostDuringFlush)
+{
+  EventQueue queue;
+  EventDispatcher* dispatcher = new EventDispatcher();
+  dispatcher->setEventQueue(&queue);
+  TestQueueingHandler handler;
+  handler.addEventListener(dispatcher, TestEvent::PING, &TestQueueingHandler::onEvent);
+
+  dispatcher->queueEvent(TestEvent(TestEvent::PING, 0));
+  ASSERT_EQ(queue.flush(), 1);
+  ASSERT_EQ(handler.count, 1);
+  ASSERT_EQ(queue.size(), 1);
+
+  ASSERT_EQ(queue.flush(), 1);
+  ASSERT_EQ(handler.count, 2);
+
+  delete dispatcher;
+  ASSERT_EQ(queue.size(), 0);
+  ASSERT_EQ(queue.flush(), 0);
+  ASSERT_EQ(handler.count, 2);
+}
+
+class TestInboxHandler : public EventSubscriber<TestInboxHandler>
+{
+  public:
+    TestInboxHandler(int producers) : received(0), ordered(true), mLastValues(producers, -1) {}
+
+    bool onEvent(EventDispatcher* sender, const Event& event)
+    {
+      // value encodes producer index and sequence number
+      int value = const_cast<TestEvent&>(static_cast<const TestEvent&>(event)).getValue();
+      int producer = value % mLastValues.size();
+      int sequence = value / mLastValues.size();
+      ordered = ordered && sequence > mLastValues[producer];
+      mLastValues[producer] = sequence;
+      received++;
+      return true;
+    }
+
+    long received;
+    bool ordered;
+  private:
+    std::vector<int> mLastValues;
+};
+
+/**
+ * Test that full inbox rejects events and that the memory is reused after drain
+ */
+TEST(TestEventInbox, TestBounded)
+{
+  TestEvents receivedEvents;
+  EventDispatcher dispatcher;
+  EventInbox inbox(4);
+  TestEventHandler handler(receivedEvents);
+  handler.addEventListener(&dispatcher, TestEvent::PING, &TestEventHandler::onTestEvent);
+
+  ASSERT_EQ(inbox.getCapacity(), 4);
+  for(int i = 0; i < 4; i++) {
+    ASSERT_TRUE(inbox.post(&dispatcher, TestEvent(TestEvent::PING, i)));
+  }
+  ASSERT_FALSE(inbox.post(&dispatcher, TestEvent(TestEvent::PING, 4)));
+  ASSERT_EQ(inbox.getDroppedCount(), 1);
+
+  ASSERT_EQ(inbox.drain(), 4);
+  ASSERT_EQ(receivedEvents.size(), 4);
+  ASSERT_EQ(receivedEvents[3].getValue(), 3);
+
+  ASSERT_TRUE(inbox.post(&dispatcher, TestEvent(TestEvent::PING, 5)));
+  ASSERT_EQ(inbox.drain(), 1);
+  ASSERT_EQ(inbox.drain(), 0);
+}
+
+/**
+ * Stress test: several producer threads post events while the main thread drains the inbox.
+ * All accepted events should be dispatched once, keeping the order of each producer
+ */
+TEST(TestEventInbox, TestMultipleProducers)
+{
+  const int producers = 8;
+  const int eventsPerProducer = 20000;
+  EventDispatcher dispatcher;
+  EventInbox inbox(256);
+  TestInboxHandler handler(producers);
+  handler.addEventListener(&dispatcher, TestEvent::PING, &TestInboxHandler::onEvent);
+
+  std::atomic<long> posted(0);
+  std::atomic<int> running(producers);
+  std::vector<std::thread> threads;
+  Event::TypeId ping = Event::intern(TestEvent::PING);
+  for(int p = 0; p < producers; p++) {
+    threads.emplace_back([&, p]() {
+      for(int i = 0; i < eventsPerProducer; i++) {
+        // retry when the inbox is full, so that all events are delivered
+        while(!inbox.post(&dispatcher, TestEvent(ping, i * producers + p))) {
+          std::this_thread::yield();
+        }
+        posted++;
+      }
+      running--;
+    });
+  }
+
+  while(running > 0) {
+    if(inbox.drain() == 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  for(auto& thread : threads) {
+    thread.join();
+  }
+  inbox.drain();
+
+  ASSERT_EQ(posted, producers * eventsPerProducer);
+  ASSERT_EQ(handler.received, producers * eventsPerProducer);
+  ASSERT_TRUE(handler.ordered);
+  LOG(INFO) << "EventInbox dropped " << inbox.getDroppedCount() << " posts while full";
+}
+
+class BenchmarkHandler : public EventSubscriber<BenchmarkHandler>
+{
+  public:
+    BenchmarkHandler() : count(0) {}
+
+    bool onEvent(EventDispatcher* sender, const Event& event)
+    {
+      count++;
+      return true;
+    }
+
+    long count;
+};
+
+/**
+ * Measures event construction and fireEvent throughput for the event type without listeners,
+ * with one listener and with 10 listeners of different priorities.
+ * Events are created inside the loop, the same way engine code fires them.
+ * Disabled by default, run with --gtest_also_run_disabled_tests
+ */
+TEST(TestEventDispatcherBenchmark, DISABLED_BenchmarkFireEvent)
+{
+  const int iterations = 1000000;
+  for(int listeners : {0, 1, 10}) {
+    EventDispatcher dispatcher;
+    std::vector<BenchmarkHandler> handlers(listeners);
+    for(int i = 0; i < listeners; i++) {
+      handlers[i].addEventListener(&dispatcher, TestEvent::PING, &BenchmarkHandler::onEvent, i % 3);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < iterations; i++) {
+      dispatcher.fireEvent(TestEvent(TestEvent::PING_ID, i));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    // type name is interned on each construction
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < iterations; i++) {
+      dispatcher.fireEvent(TestEvent(TestEvent::PING, i));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double byName = std::chrono::duration<double>(end - start).count();
+
+    for(BenchmarkHandler& handler : handlers) {
+      ASSERT_EQ(handler.count, iterations * 2);
+    }
+
+    LOG(INFO) << "EventDispatcher " << listeners << " listeners: " << (iterations / seconds) << " events per second, "
+      << (iterations / byName) << " when created by type name";
+  }
+}
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include "FileLoader.h"
+#include "MappedFile.h"
+#include "Prefab.h"
 #include "TestDefinitions.h"
+#include <cstdio>
+#include <fstream>
+#include <chrono>
+#include <thread>
 
 using namespace Gsage;
 
@@ -32,3 +38,187 @@ TEST(FileLoader, FileLoaderLoadAndDump)
     EXPECT_EQ(pair.first.get<std::string>("some", ""), "hello");
   }
 }
+
+namespace {
+  void writeFile(const std::string& path, const std::string& contents)
+  {
+    std::ofstream stream(path);
+    stream << contents;
+  }
+}
+
+TEST(FileLoader, ParsedFileCache)
+{
+  std::string path = "testFileLoaderCache.json";
+  writeFile(path, "{\"value\": 1, \"nested\": {\"a\": \"b\"}}");
+
+  FileLoader instance(FileLoader::Json, DataProxy());
+  auto pair = instance.load(path);
+  ASSERT_TRUE(pair.second);
+  EXPECT_EQ(pair.first.get("value", 0), 1);
+
+  FileLoader::CacheStats stats = instance.getCacheStats();
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.entries, 1);
+
+  // modifying loaded data should not affect the cached copy
+  pair.first.put("value", 100);
+  pair.first.put("nested.a", "changed");
+
+  DataProxy params;
+  params.put("param", 5);
+  pair = instance.load(path, params);
+  ASSERT_TRUE(pair.second);
+  EXPECT_EQ(pair.first.get("value", 0), 1);
+  EXPECT_EQ(pair.first.get<std::string>("nested.a", ""), "b");
+  EXPECT_EQ(pair.first.get("param", 0), 5);
+
+  pair = instance.load(path);
+  EXPECT_EQ(pair.first.count("param"), 0);
+
+  stats = instance.getCacheStats();
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 2);
+
+  // changed file is reloaded
+  writeFile(path, "{\"value\": 22}");
+  pair = instance.load(path);
+  ASSERT_TRUE(pair.second);
+  EXPECT_EQ(pair.first.get("value", 0), 22);
+  EXPECT_EQ(instance.getCacheStats().misses, 2);
+
+  // same size rewrite within one second is detected by the nanosecond mtime
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  writeFile(path, "{\"value\": 33}");
+  pair = instance.load(path);
+  ASSERT_TRUE(pair.second);
+  EXPECT_EQ(pair.first.get("value", 0), 33);
+  EXPECT_EQ(instance.getCacheStats().misses, 3);
+
+  // explicit flush
+  instance.flushCache(path);
+  EXPECT_EQ(instance.getCacheStats().entries, 0);
+  pair = instance.load(path);
+  EXPECT_EQ(pair.first.get("value", 0), 33);
+  EXPECT_EQ(instance.getCacheStats().misses, 4);
+
+  instance.flushCache();
+  stats = instance.getCacheStats();
+  EXPECT_EQ(stats.entries, 0);
+  EXPECT_EQ(stats.size, 0);
+
+  std::remove(path.c_str());
+  EXPECT_FALSE(instance.load(path).second);
+}
+
+TEST(FileLoader, ParsedFileCacheCapacity)
+{
+  std::vector<std::string> paths = {
+    "testFileLoaderCache1.json",
+    "testFileLoaderCache2.json",
+    "testFileLoaderCache3.json"
+  };
+
+  for(auto& path : paths) {
+    writeFile(path, "{\"value\": \"0123456789\"}");
+  }
+
+  FileLoader instance(FileLoader::Json, DataProxy());
+  instance.setCacheCapacity(50);
+  for(auto& path : paths) {
+    ASSERT_TRUE(instance.load(path).second);
+  }
+
+  FileLoader::CacheStats stats = instance.getCacheStats();
+  EXPECT_EQ(stats.entries, 2);
+  EXPECT_LE(stats.size, 50);
+
+  // the first file was evicted as least recently used
+  instance.load(paths[2]);
+  instance.load(paths[0]);
+  stats = instance.getCacheStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 4);
+
+  instance.setCacheCapacity(0);
+  EXPECT_EQ(instance.getCacheStats().entries, 0);
+  ASSERT_TRUE(instance.load(paths[1]).second);
+  EXPECT_EQ(instance.getCacheStats().entries, 0);
+
+  for(auto& path : paths) {
+    std::remove(path.c_str());
+  }
+}
+
+TEST(FileLoader, MappedFile)
+{
+  std::string path = "testMappedFile.json";
+  std::string contents = "{\"value\": 1}";
+  writeFile(path, contents);
+
+  MappedFile file(path);
+  ASSERT_TRUE(file.isOpen());
+  EXPECT_EQ(file.size(), contents.size());
+  EXPECT_EQ(file.str(), contents);
+
+  DataProxy dp;
+  ASSERT_TRUE(loads(dp, file.data(), file.size(), DataWrapper::JSON_OBJECT));
+  EXPECT_EQ(dp.get("value", 0), 1);
+
+  MappedFile moved(std::move(file));
+  EXPECT_FALSE(file.isOpen());
+  EXPECT_EQ(moved.str(), contents);
+
+  moved.close();
+  EXPECT_FALSE(moved.isOpen());
+  EXPECT_EQ(moved.size(), 0);
+
+  // empty files can't be mapped, but are still readable
+  writeFile(path, "");
+  ASSERT_TRUE(moved.open(path));
+  EXPECT_FALSE(moved.isMapped());
+  EXPECT_EQ(moved.size(), 0);
+  EXPECT_NE(moved.data(), nullptr);
+
+  std::remove(path.c_str());
+  EXPECT_FALSE(moved.open(path));
+}
+
+TEST(FileLoader, Prefab)
+{
+  DataProxy data;
+  data.put("id", "prefab");
+  data.put("stats.hp", 100);
+  data.put("render.root.position", "1,2,3");
+
+  std::string blob;
+  ASSERT_TRUE(Prefab::compile(data, blob));
+  ASSERT_TRUE(Prefab::isPrefab(blob.data(), blob.size()));
+
+  Prefab prefab;
+  ASSERT_FALSE(prefab.read(blob.data(), blob.size() - 1));
+  ASSERT_TRUE(prefab.read(blob.data(), blob.size()));
+  DataProxy instance;
+  ASSERT_TRUE(prefab.instantiate(instance));
+  EXPECT_EQ(instance.getWrappedType(), DataWrapper::MSGPACK_OBJECT);
+  EXPECT_EQ(instance.get("stats.hp", 0), 100);
+
+  // prefabs are loaded regardless of the loader encoding
+  std::string path = "testPrefab.prefab";
+  writeFile(path, blob);
+  FileLoader loader(FileLoader::Json, DataProxy());
+  for(int i = 0; i < 2; i++) {
+    DataProxy params;
+    params.put("stats.mp", i);
+    auto pair = loader.load(path, params);
+    ASSERT_TRUE(pair.second);
+    EXPECT_EQ(pair.first.get<std::string>("id", ""), "prefab");
+    EXPECT_EQ(pair.first.get<std::string>("render.root.position", ""), "1,2,3");
+    EXPECT_EQ(pair.first.get("stats.hp", 0), 100);
+    EXPECT_EQ(pair.first.get("stats.mp", -1), i);
+  }
+  EXPECT_EQ(loader.getCacheStats().hits, 1);
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,381 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Engine.h"
+#include "ComponentStorage.h"
+#include "FileLoader.h"
+#include "GameDataManager.h"
+#include "Prefab.h"
+#include "EventSubscriber.h"
+
+using namespace Gsage;
+
+class AreaLoadListener : public EventSubscriber<AreaLoadListener>
+{
+  public:
+    AreaLoadListener()
+      : progress(0)
+      , complete(0)
+      , failed(0)
+    {
+    }
+
+    bool onAreaLoad(EventDispatcher* sender, const Event& event)
+    {
+      const AreaLoadEvent& e = static_cast<const AreaLoadEvent&>(event);
+      if(e.getType() == AreaLoadEvent::PROGRESS) {
+        progress++;
+        EXPECT_LT(e.getLoaded(), e.getTotal());
+      } else if(e.getType() == AreaLoadEvent::COMPLETE) {
+        complete++;
+        EXPECT_EQ(e.getProgress(), 1.0f);
+      } else {
+        failed++;
+      }
+      return true;
+    }
+
+    int progress;
+    int complete;
+    int failed;
+};
+
+class PositionComponent : public EntityComponent
+{
+  public:
+    static const std::string SYSTEM;
+
+    PositionComponent()
+      : dumps(0)
+    {
+      setTracksChanges(true);
+    }
+
+    virtual ~PositionComponent()
+    {
+    }
+
+    bool dump(DataProxy& dict)
+    {
+      dumps++;
+      dict.put("root.position", position);
+      return true;
+    }
+
+    void setPosition(const std::string& value)
+    {
+      position = value;
+      setDirty();
+    }
+
+    std::string position;
+    int dumps;
+};
+
+const std::string PositionComponent::SYSTEM = "render";
+
+class PositionSystem : public ComponentStorage<PositionComponent>
+{
+  public:
+    void updateComponent(PositionComponent* component, Entity* entity, const double& time)
+    {
+    }
+
+    bool fillComponentData(PositionComponent* c, const DataProxy& data)
+    {
+      c->position = data.get("root.position", "0,0,0");
+      return true;
+    }
+};
+
+std::string readFile(const std::string& path)
+{
+  std::ifstream stream(path);
+  return std::string((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+}
+
+size_t countLines(const std::string& path)
+{
+  std::string contents = readFile(path);
+  return std::count(contents.begin(), contents.end(), '\n');
+}
+
+class TestGameDataManager : public ::testing::Test
+{
+  public:
+    static void SetUpTestCase()
+    {
+      FileLoader::init(FileLoader::Json, DataProxy());
+    }
+
+    void SetUp()
+    {
+      std::ofstream area("testAsyncArea.json");
+      area << "{\"entities\": [";
+      for(int i = 0; i < ENTITY_COUNT; i++) {
+        area << (i == 0 ? "" : ",") << "{\"id\": \"entity" << i << "\"}";
+      }
+      area << "]}";
+      area.close();
+
+      DataProxy config;
+      config.put("dataManager.levelsFolder", ".");
+      mEngine = new Engine();
+      mInstance = new GameDataManager(mEngine, config);
+      mListener.addEventListener(mEngine, AreaLoadEvent::PROGRESS, &AreaLoadListener::onAreaLoad);
+      mListener.addEventListener(mEngine, AreaLoadEvent::COMPLETE, &AreaLoadListener::onAreaLoad);
+      mListener.addEventListener(mEngine, AreaLoadEvent::FAILED, &AreaLoadListener::onAreaLoad);
+    }
+
+    void TearDown()
+    {
+      delete mInstance;
+      mEngine->unloadAll();
+      delete mEngine;
+      std::remove("testAsyncArea.json");
+    }
+
+    /**
+     * Update data manager until the load is finished
+     */
+    int waitForLoad()
+    {
+      int frames = 0;
+      auto start = std::chrono::high_resolution_clock::now();
+      while(mInstance->isLoading() && std::chrono::high_resolution_clock::now() - start < std::chrono::seconds(10)) {
+        mInstance->update(0.1f);
+        frames++;
+      }
+      return frames;
+    }
+
+    enum { ENTITY_COUNT = 20 };
+
+    Engine* mEngine;
+    GameDataManager* mInstance;
+    AreaLoadListener mListener;
+};
+
+TEST_F(TestGameDataManager, TestLoadArea)
+{
+  ASSERT_TRUE(mInstance->loadArea("testAsyncArea"));
+  ASSERT_FALSE(mInstance->isLoading());
+  ASSERT_EQ(mEngine->getEntities().size(), ENTITY_COUNT);
+  ASSERT_EQ(mListener.complete, 1);
+  ASSERT_EQ(mListener.progress, 0);
+
+  ASSERT_FALSE(mInstance->loadArea("missingArea"));
+  ASSERT_FALSE(mInstance->isLoading());
+  ASSERT_EQ(mListener.failed, 1);
+}
+
+TEST_F(TestGameDataManager, TestLoadAreaAsync)
+{
+  // zero budget: one entity per frame
+  mInstance->setFrameBudget(0);
+  ASSERT_TRUE(mInstance->loadAreaAsync("testAsyncArea"));
+  ASSERT_TRUE(mInstance->isLoading());
+  ASSERT_FALSE(mInstance->loadAreaAsync("testAsyncArea"));
+
+  waitForLoad();
+  ASSERT_FALSE(mInstance->isLoading());
+  ASSERT_EQ(mEngine->getEntities().size(), ENTITY_COUNT);
+  ASSERT_EQ(mListener.progress, ENTITY_COUNT - 1);
+  ASSERT_EQ(mListener.complete, 1);
+
+  ASSERT_TRUE(mInstance->loadAreaAsync("missingArea"));
+  waitForLoad();
+  ASSERT_EQ(mListener.failed, 1);
+}
+
+TEST_F(TestGameDataManager, TestCancelLoad)
+{
+  mInstance->setFrameBudget(0);
+  ASSERT_TRUE(mInstance->loadAreaAsync("testAsyncArea"));
+  while(mEngine->getEntities().size() == 0) {
+    mInstance->update(0.1f);
+  }
+  mInstance->cancelLoad();
+  ASSERT_FALSE(mInstance->isLoading());
+  mInstance->update(0.1f);
+  ASSERT_EQ(mEngine->getEntities().size(), 1);
+  ASSERT_EQ(mListener.complete, 0);
+}
+
+TEST_F(TestGameDataManager, TestIncrementalSave)
+{
+  mEngine->addSystem<PositionSystem>();
+  {
+    std::ofstream save("testSave.json");
+    save << "{\"area\": \"testAsyncArea\", \"characters\": {"
+         << "\"a\": {\"id\": \"a\", \"render\": {\"root\": {\"position\": \"1,0,0\"}}},"
+         << "\"b\": {\"id\": \"b\", \"render\": {\"root\": {\"position\": \"2,0,0\"}}}"
+         << "}, \"placement\": {\"testAsyncArea\": {\"a\": {\"position\": \"1,0,0\"}, \"b\": {\"position\": \"2,0,0\"}}}}";
+  }
+  std::remove("testSave.json.delta");
+
+  ASSERT_TRUE(mInstance->loadSave("testSave"));
+  ASSERT_EQ(mEngine->getEntities().size(), ENTITY_COUNT + 2);
+
+  // first save after load rewrites the file
+  ASSERT_TRUE(mInstance->dumpSave("testSave"));
+  mInstance->waitForSaves();
+  EXPECT_EQ(countLines("testSave.json.delta"), 1);
+  std::string base = readFile("testSave.json");
+
+  PositionComponent* a = mEngine->getComponent<PositionComponent>(mEngine->getEntity("a"), PositionComponent::SYSTEM);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(a->dumps, 1);
+  a->setPosition("5,0,0");
+  mEngine->removeEntity("b");
+  Entity* c = mInstance->createEntity(std::string("{\"id\": \"c\", \"render\": {\"root\": {\"position\": \"3,0,0\"}}}"));
+  ASSERT_NE(c, nullptr);
+  c->setFlag("dynamic");
+
+  ASSERT_TRUE(mInstance->dumpSave("testSave"));
+  // nothing changed, nothing is written
+  ASSERT_TRUE(mInstance->dumpSave("testSave"));
+  mInstance->waitForSaves();
+
+  EXPECT_EQ(readFile("testSave.json"), base);
+  // header, a update, b removal, c
+  EXPECT_EQ(countLines("testSave.json.delta"), 4);
+  EXPECT_EQ(a->dumps, 2);
+
+  // saved entities are clean, props change is detected without dumping the components
+  Entity* entity = mEngine->getEntity("a");
+  EXPECT_FALSE(entity->isDirty());
+  EXPECT_FALSE(c->isDirty());
+  DataProxy props;
+  props.put("level", 2);
+  entity->setProps(props);
+  EXPECT_TRUE(entity->isDirty());
+  ASSERT_TRUE(mInstance->dumpSave("testSave"));
+  mInstance->waitForSaves();
+  EXPECT_EQ(countLines("testSave.json.delta"), 5);
+  EXPECT_EQ(a->dumps, 2);
+  EXPECT_FALSE(entity->isDirty());
+
+  mEngine->unloadAll();
+  ASSERT_TRUE(mInstance->loadSave("testSave"));
+  ASSERT_EQ(mEngine->getEntities().size(), ENTITY_COUNT + 2);
+  ASSERT_EQ(mEngine->getEntity("b"), nullptr);
+  a = mEngine->getComponent<PositionComponent>(mEngine->getEntity("a"), PositionComponent::SYSTEM);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(a->position, "5,0,0");
+  EXPECT_EQ(mEngine->getEntity("a")->getProps().get("level", 0), 2);
+  PositionComponent* loaded = mEngine->getComponent<PositionComponent>(mEngine->getEntity("c"), PositionComponent::SYSTEM);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->position, "3,0,0");
+
+  // delta log of the other revision is ignored
+  std::string delta = readFile("testSave.json.delta");
+  ASSERT_TRUE(mInstance->dumpSave("testSave"));
+  mInstance->waitForSaves();
+  EXPECT_NE(readFile("testSave.json"), base);
+  EXPECT_EQ(countLines("testSave.json.delta"), 1);
+  {
+    std::ofstream stream("testSave.json.delta");
+    stream << delta;
+  }
+
+  mEngine->unloadAll();
+  ASSERT_TRUE(mInstance->loadSave("testSave"));
+  a = mEngine->getComponent<PositionComponent>(mEngine->getEntity("a"), PositionComponent::SYSTEM);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(a->position, "5,0,0");
+  EXPECT_NE(mEngine->getEntity("c"), nullptr);
+
+  std::remove("testSave.json");
+  std::remove("testSave.json.delta");
+}
+
+TEST_F(TestGameDataManager, TestFailedSave)
+{
+  mEngine->addSystem<PositionSystem>();
+  {
+    std::ofstream save("testSave.json");
+    save << "{\"area\": \"testAsyncArea\", \"characters\": {"
+         << "\"a\": {\"id\": \"a\", \"render\": {\"root\": {\"position\": \"1,0,0\"}}}"
+         << "}, \"placement\": {\"testAsyncArea\": {\"a\": {\"position\": \"1,0,0\"}}}}";
+  }
+  std::remove("testSave.json.delta");
+  ASSERT_TRUE(mInstance->loadSave("testSave"));
+  std::string base = readFile("testSave.json");
+
+  // temporary file can't be created, so the save is not replaced
+  ASSERT_EQ(mkdir("testSave.json.tmp", 0755), 0);
+  std::ofstream("testSave.json.tmp/keep") << "keep";
+  PositionComponent* a = mEngine->getComponent<PositionComponent>(mEngine->getEntity("a"), PositionComponent::SYSTEM);
+  ASSERT_NE(a, nullptr);
+  a->setPosition("5,0,0");
+  ASSERT_TRUE(mInstance->dumpSave("testSave"));
+  // delta of the failed revision is not written
+  a->setPosition("6,0,0");
+  ASSERT_TRUE(mInstance->dumpSave("testSave"));
+  mInstance->waitForSaves();
+  EXPECT_EQ(readFile("testSave.json"), base);
+  std::remove("testSave.json.tmp/keep");
+  ASSERT_EQ(rmdir("testSave.json.tmp"), 0);
+
+  // the next save rewrites the whole file
+  Entity* entity = mEngine->getEntity("a");
+  DataProxy props;
+  props.put("level", 2);
+  entity->setProps(props);
+  ASSERT_TRUE(mInstance->dumpSave("testSave"));
+  mInstance->waitForSaves();
+  EXPECT_NE(readFile("testSave.json"), base);
+  EXPECT_EQ(countLines("testSave.json.delta"), 1);
+
+  mEngine->unloadAll();
+  ASSERT_TRUE(mInstance->loadSave("testSave"));
+  a = mEngine->getComponent<PositionComponent>(mEngine->getEntity("a"), PositionComponent::SYSTEM);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(a->position, "6,0,0");
+  EXPECT_EQ(mEngine->getEntity("a")->getProps().get("level", 0), 2);
+
+  std::remove("testSave.json");
+  std::remove("testSave.json.delta");
+}
+
+TEST_F(TestGameDataManager, TestLoadPrefabArea)
+{
+  DataProxy area;
+  area.put("entities.0.id", "prefabEntity");
+
+  std::string blob;
+  ASSERT_TRUE(Prefab::compile(area, blob));
+  {
+    std::ofstream stream("testAsyncArea.prefab", std::ios::binary);
+    stream << blob;
+  }
+
+  // compiled area is preferred over json
+  ASSERT_TRUE(mInstance->loadArea("testAsyncArea"));
+  ASSERT_EQ(mEngine->getEntities().size(), 1);
+  ASSERT_NE(mEngine->getEntity("prefabEntity"), nullptr);
+
+  // the next load creates entities from the resolved templates
+  mEngine->unloadAll();
+  ASSERT_TRUE(mInstance->loadArea("testAsyncArea"));
+  ASSERT_EQ(mEngine->getEntities().size(), 1);
+  ASSERT_NE(mEngine->getEntity("prefabEntity"), nullptr);
+
+  // prefab is ignored when the json is edited after the compilation
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  {
+    std::ofstream stream("testAsyncArea.json");
+    stream << "{\"entities\": [{\"id\": \"jsonEntity\"}]}";
+  }
+  mEngine->unloadAll();
+  ASSERT_TRUE(mInstance->loadArea("testAsyncArea"));
+  ASSERT_EQ(mEngine->getEntities().size(), 1);
+  ASSERT_NE(mEngine->getEntity("jsonEntity"), nullptr);
+  std::remove("testAsyncArea.prefab");
+}
@@ -0,0 +1,159 @@
+#include "sol.hpp"
+#include "lua/LuaEventProxy.h"
+
+#include <gtest/gtest.h>
+
+using namespace Gsage;
+
+class PointEvent : public Event
+{
+  public:
+    static const Event::Type MOVE;
+
+    PointEvent(Event::ConstType type, int x, int y) : Event(type), x(x), y(y) {}
+    virtual ~PointEvent() {}
+
+    int x;
+    int y;
+};
+
+const Event::Type PointEvent::MOVE = "pointMove";
+
+class TestLuaEventProxy : public ::testing::Test
+{
+  public:
+    TestLuaEventProxy()
+    {
+      lua.open_libraries(sol::lib::base, sol::lib::table);
+      lua.new_usertype<Event>("BaseEvent",
+          "type", sol::property(&Event::getType)
+      );
+      lua.new_usertype<PointEvent>("PointEvent",
+          sol::base_classes, sol::bases<Event>(),
+          "x", sol::readonly(&PointEvent::x),
+          "y", sol::readonly(&PointEvent::y)
+      );
+      lua.new_usertype<LuaEventProxy>("LuaEventProxy",
+          "new", sol::constructors<void()>()
+      );
+      lua["LuaEventProxy"]["onPoint"] = sol::overload(
+          &LuaEventProxy::addEventListener<PointEvent>,
+          &LuaEventProxy::addUnpackedEventListener<PointEvent>
+      );
+      lua["LuaEventProxy"]["unbind"] = &LuaEventProxy::removeEventListener;
+      lua["dispatcher"] = &dispatcher;
+      lua["fire"] = [this] (int x, int y) {
+        dispatcher.fireEvent(PointEvent(PointEvent::MOVE, x, y));
+      };
+      lua.script("proxy = LuaEventProxy.new()");
+    }
+
+    virtual ~TestLuaEventProxy()
+    {
+      lua.script("proxy = nil; collectgarbage()");
+    }
+
+    EventDispatcher dispatcher;
+    sol::state lua;
+};
+
+TEST_F(TestLuaEventProxy, TestDispatch)
+{
+  lua.script(R"(
+    events = {}
+    values = {}
+    handler = function(e)
+      table.insert(events, e)
+      table.insert(values, e.x + e.y)
+    end
+    proxy:onPoint(dispatcher, "pointMove", handler)
+  )");
+
+  dispatcher.fireEvent(PointEvent(PointEvent::MOVE, 1, 2));
+  dispatcher.fireEvent(PointEvent(PointEvent::MOVE, 3, 4));
+
+  EXPECT_EQ(lua["values"][1].get<int>(), 3);
+  EXPECT_EQ(lua["values"][2].get<int>(), 7);
+  // the same lua object is used for each event
+  EXPECT_TRUE(lua.script("return rawequal(events[1], events[2])").get<bool>());
+
+  EXPECT_TRUE(lua.script("return proxy:unbind(dispatcher, 'pointMove', handler)").get<bool>());
+  LuaEventProxy* proxy = lua["proxy"];
+  EXPECT_EQ(proxy->getCallbacks(&dispatcher, PointEvent::MOVE), nullptr);
+}
+
+TEST_F(TestLuaEventProxy, TestUnpacked)
+{
+  lua.script(R"(
+    sum = 0
+    proxy:onPoint(dispatcher, "pointMove", function(x, y, t)
+      sum = sum + x * y
+      eventType = t
+    end, {"x", "y", "type"})
+  )");
+
+  for(int i = 0; i < 10; ++i) {
+    dispatcher.fireEvent(PointEvent(PointEvent::MOVE, i, 2));
+  }
+
+  EXPECT_EQ(lua["sum"].get<int>(), 90);
+  EXPECT_EQ(lua["eventType"].get<std::string>(), PointEvent::MOVE);
+
+  // dispatch does not create lua objects, a userdata per event would take more than 10 bytes
+  int before = lua.script("collectgarbage(); collectgarbage('stop'); return collectgarbage('count') * 1024");
+  for(int i = 0; i < 1000; ++i) {
+    dispatcher.fireEvent(PointEvent(PointEvent::MOVE, i, 2));
+  }
+  int after = lua.script("local res = collectgarbage('count') * 1024; collectgarbage('restart'); return res");
+  EXPECT_LT(after - before, 10000);
+}
+
+TEST_F(TestLuaEventProxy, TestNestedDispatch)
+{
+  lua.script(R"(
+    values = {}
+    proxy:onPoint(dispatcher, "pointMove", function(e)
+      if e.x == 0 then
+        fire(1, 1)
+      end
+      table.insert(values, e.x)
+    end)
+  )");
+
+  dispatcher.fireEvent(PointEvent(PointEvent::MOVE, 0, 0));
+  EXPECT_EQ(lua["values"][1].get<int>(), 1);
+  EXPECT_EQ(lua["values"][2].get<int>(), 0);
+}
+
+TEST_F(TestLuaEventProxy, TestUnbindInHandler)
+{
+  lua.script(R"(
+    count = 0
+    for i = 1, 10 do
+      local handler
+      handler = function(e)
+        count = count + 1
+        proxy:unbind(dispatcher, "pointMove", handler)
+      end
+      proxy:onPoint(dispatcher, "pointMove", handler)
+    end
+  )");
+
+  dispatcher.fireEvent(PointEvent(PointEvent::MOVE, 0, 0));
+  dispatcher.fireEvent(PointEvent(PointEvent::MOVE, 0, 0));
+  EXPECT_EQ(lua["count"].get<int>(), 10);
+  LuaEventProxy* proxy = lua["proxy"];
+  EXPECT_EQ(proxy->getCallbacks(&dispatcher, PointEvent::MOVE), nullptr);
+}
+
+TEST_F(TestLuaEventProxy, TestError)
+{
+  lua.script(R"(
+    count = 0
+    proxy:onPoint(dispatcher, "pointMove", function(e) error("failed") end)
+    proxy:onPoint(dispatcher, "pointMove", function(e) count = count + 1 end)
+  )");
+
+  dispatcher.fireEvent(PointEvent(PointEvent::MOVE, 0, 0));
+  EXPECT_EQ(lua["count"].get<int>(), 1);
+}
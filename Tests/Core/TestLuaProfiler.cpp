@@ -0,0 +1,165 @@
+#include "sol.hpp"
+#include "lua/LuaProfiler.h"
+#include "lua/LuaEventProxy.h"
+
+#include <fstream>
+#include <sstream>
+#include <gtest/gtest.h>
+
+using namespace Gsage;
+
+class TestLuaProfiler : public ::testing::Test
+{
+  public:
+    TestLuaProfiler()
+    {
+      lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::jit);
+      // traces do not call hooks
+      lua.script("if jit then jit.off() end");
+      lua.script(R"(
+        function busy(n)
+          local res = 0
+          for i = 1, n do
+            res = res + math.sin(i)
+          end
+          return res
+        end
+
+        function outer(n)
+          local res = busy(n)
+          return res
+        end
+      )");
+      profiler.setState(lua.lua_state());
+    }
+
+    virtual ~TestLuaProfiler()
+    {
+      profiler.stop();
+    }
+
+    sol::state lua;
+    LuaProfiler profiler;
+};
+
+TEST_F(TestLuaProfiler, TestSampling)
+{
+  ASSERT_TRUE(profiler.start(0.0001, 100));
+  EXPECT_TRUE(profiler.isRunning());
+  // the second profiler can't run at the same time
+  LuaProfiler other;
+  other.setState(lua.lua_state());
+  EXPECT_FALSE(other.start());
+
+  sol::protected_function outer = lua["outer"];
+  outer(2000000);
+  profiler.stop();
+  EXPECT_FALSE(profiler.isRunning());
+
+  ASSERT_GT(profiler.getSampleCount(), 0u);
+  const LuaProfiler::FunctionStats* busy = 0;
+  const LuaProfiler::FunctionStats* outerStats = 0;
+  for(auto& stats : profiler.getFunctions()) {
+    if(stats.line == 2)
+      busy = &stats;
+    else if(stats.line == 10)
+      outerStats = &stats;
+  }
+
+  ASSERT_NE(busy, nullptr);
+  EXPECT_EQ(busy->name, "busy");
+  ASSERT_NE(outerStats, nullptr);
+  EXPECT_GT(busy->selfSamples, profiler.getSampleCount() / 2);
+  EXPECT_EQ(outerStats->totalSamples, profiler.getSampleCount());
+  EXPECT_EQ(outerStats->selfSamples, 0u);
+
+  // the hottest lines are in the loop
+  std::vector<LuaProfiler::LineStats> lines = profiler.getLines();
+  ASSERT_FALSE(lines.empty());
+  EXPECT_GE(lines[0].line, 4);
+  EXPECT_LE(lines[0].line, 6);
+
+  std::string folded = profiler.getFoldedStacks();
+  // outer is called from C++, so it has no name
+  EXPECT_EQ(folded.find("lua;[string"), 0u);
+  EXPECT_NE(folded.find(";busy "), std::string::npos);
+
+  // no samples are taken when the profiler is stopped
+  size_t count = profiler.getSampleCount();
+  outer(100000);
+  EXPECT_EQ(profiler.getSampleCount(), count);
+
+  profiler.reset();
+  EXPECT_EQ(profiler.getSampleCount(), 0u);
+  EXPECT_TRUE(profiler.getFunctions().empty());
+  EXPECT_TRUE(profiler.getFoldedStacks().empty());
+}
+
+TEST_F(TestLuaProfiler, TestScopes)
+{
+  uint32_t scope = profiler.getScope("update");
+  EXPECT_EQ(profiler.getScope("update"), scope);
+
+  profiler.setCountNativeCalls(true);
+  ASSERT_TRUE(profiler.start(0.0001, 100));
+  sol::protected_function outer = lua["outer"];
+  for(int i = 0; i < 3; ++i) {
+    profiler.enterScope(scope);
+    outer(100000);
+    profiler.leaveScope();
+  }
+  profiler.stop();
+
+  const LuaProfiler::ScopeStats& stats = profiler.getScopes()[scope];
+  EXPECT_EQ(stats.name, "update");
+  EXPECT_EQ(stats.calls, 3u);
+  // math.sin call
+  EXPECT_EQ(stats.nativeCalls, 300000u);
+  EXPECT_GT(stats.time, 0);
+  EXPECT_EQ(stats.samples, profiler.getSampleCount());
+
+  std::string path = "testLuaProfiler.folded";
+  ASSERT_TRUE(profiler.saveFoldedStacks(path));
+  std::ifstream stream(path);
+  std::stringstream contents;
+  contents << stream.rdbuf();
+  EXPECT_EQ(contents.str(), profiler.getFoldedStacks());
+  EXPECT_EQ(contents.str().find("update;"), 0u);
+  EXPECT_NE(contents.str().find(";busy "), std::string::npos);
+  std::remove(path.c_str());
+}
+
+TEST_F(TestLuaProfiler, TestEventScopes)
+{
+  EventDispatcher dispatcher;
+  LuaEventProxy proxy;
+  lua.new_usertype<LuaEventProxy>("LuaEventProxy",
+      "bind", &LuaEventProxy::addEventListener<Event>
+  );
+  lua["dispatcher"] = &dispatcher;
+  lua["proxy"] = &proxy;
+  lua.script(R"(
+    proxy:bind(dispatcher, "tick", function(e) busy(100000) end)
+    proxy:bind(dispatcher, "tick", function(e) busy(100000) end)
+  )");
+
+  // handlers are not wrapped with scopes when the profiler is stopped
+  dispatcher.fireEvent(Event("tick"));
+  EXPECT_TRUE(profiler.getScopes().empty());
+
+  ASSERT_TRUE(profiler.start(0.0001, 100));
+  for(int i = 0; i < 3; ++i) {
+    dispatcher.fireEvent(Event("tick"));
+  }
+  profiler.stop();
+
+  uint32_t scope = profiler.getScope("event tick");
+  const LuaProfiler::ScopeStats& stats = profiler.getScopes()[scope];
+  // each handler call is a separate scope call
+  EXPECT_EQ(stats.calls, 6u);
+  EXPECT_GT(stats.time, 0);
+  ASSERT_GT(profiler.getSampleCount(), 0u);
+  EXPECT_EQ(stats.samples, profiler.getSampleCount());
+  EXPECT_EQ(profiler.getFoldedStacks().find("event tick;"), 0u);
+  EXPECT_NE(profiler.getFoldedStacks().find(";busy "), std::string::npos);
+}
@@ -0,0 +1,146 @@
+#include "sol.hpp"
+#include "lua/LuaScriptCache.h"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <sys/stat.h>
+#ifdef _MSC_VER
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+#include <gtest/gtest.h>
+
+using namespace Gsage;
+
+namespace {
+  void writeFile(const std::string& path, const std::string& contents)
+  {
+    std::ofstream stream(path, std::ios::binary);
+    stream << contents;
+  }
+
+  void setModificationTime(const std::string& path, time_t mtime)
+  {
+    struct utimbuf times;
+    times.actime = mtime;
+    times.modtime = mtime;
+    utime(path.c_str(), &times);
+  }
+
+  std::string compile(sol::state& lua, const std::string& code)
+  {
+    sol::protected_function dump = lua["string"]["dump"];
+    return dump(lua.load(code).get<sol::protected_function>()).get<std::string>();
+  }
+}
+
+class TestLuaScriptCache : public ::testing::Test
+{
+  public:
+    TestLuaScriptCache()
+    {
+      lua.open_libraries(sol::lib::base, sol::lib::package, sol::lib::string);
+      cache.setState(lua.lua_state());
+    }
+
+    virtual ~TestLuaScriptCache()
+    {
+      cache.uninstallLoader();
+      cache.clear();
+      for(auto& path : files) {
+        std::remove(path.c_str());
+      }
+    }
+
+    std::string createFile(const std::string& path, const std::string& contents)
+    {
+      writeFile(path, contents);
+      files.push_back(path);
+      return path;
+    }
+
+    sol::state lua;
+    LuaScriptCache cache;
+    std::vector<std::string> files;
+};
+
+TEST_F(TestLuaScriptCache, TestLoad)
+{
+  std::string path = createFile("testScriptCache.lua", "count = (count or 0) + 1; return count");
+  sol::protected_function first = cache.load(path);
+  sol::protected_function second = cache.load(path);
+  ASSERT_TRUE(first.valid());
+  ASSERT_TRUE(second.valid());
+  EXPECT_EQ(cache.getCompileCount(), 1u);
+  EXPECT_EQ(first().get<int>(), 1);
+  EXPECT_EQ(second().get<int>(), 2);
+
+  // changed file is compiled again
+  writeFile(path, "return 'changed'");
+  EXPECT_EQ(cache.load(path)().get<std::string>(), "changed");
+  EXPECT_EQ(cache.getCompileCount(), 2u);
+  EXPECT_EQ(cache.size(), 1u);
+
+  // syntax errors are not cached
+  writeFile(path, "return (");
+  EXPECT_FALSE(cache.load(path).valid());
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_FALSE(cache.load("testScriptCacheMissing.lua").valid());
+}
+
+TEST_F(TestLuaScriptCache, TestPrecompiled)
+{
+  std::string path = createFile("testScriptCache.lua", "return 'source'");
+  std::string compiled = createFile(LuaScriptCache::getCompiledPath(path), compile(lua, "return 'compiled'"));
+  EXPECT_EQ(compiled, "testScriptCache.luac");
+
+  time_t now = time(0);
+  setModificationTime(path, now - 10);
+  setModificationTime(compiled, now);
+  EXPECT_EQ(cache.load(path)().get<std::string>(), "compiled");
+
+  // precompiled file is older than the source
+  setModificationTime(path, now + 10);
+  EXPECT_EQ(cache.load(path)().get<std::string>(), "source");
+
+  // source is edited in the same second the precompiled file was written
+  writeFile(compiled, compile(lua, "return 'compiled'"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  writeFile(path, "return 'edited'");
+  EXPECT_EQ(cache.load(path)().get<std::string>(), "edited");
+}
+
+TEST_F(TestLuaScriptCache, TestStateChange)
+{
+  std::string path = createFile("testScriptCache.lua", "return 'value'");
+  EXPECT_EQ(cache.load(path)().get<std::string>(), "value");
+
+  sol::state other;
+  other.open_libraries(sol::lib::base);
+  cache.setState(other.lua_state());
+  // chunk is restored from the bytecode
+  EXPECT_EQ(cache.load(path)().get<std::string>(), "value");
+  EXPECT_EQ(cache.getCompileCount(), 1u);
+  cache.clear();
+  cache.setState(lua.lua_state());
+}
+
+TEST_F(TestLuaScriptCache, TestRequire)
+{
+  std::string path = createFile("testScriptCacheModule.lua", "return 'source'");
+  std::string compiled = createFile(LuaScriptCache::getCompiledPath(path), compile(lua, "return 'compiled'"));
+  time_t now = time(0);
+  setModificationTime(path, now - 10);
+  setModificationTime(compiled, now);
+
+  cache.installLoader();
+  lua.script("package.path = './?.lua'");
+  EXPECT_EQ(lua.script("return require 'testScriptCacheModule'").get<std::string>(), "compiled");
+  EXPECT_EQ(cache.size(), 1u);
+
+  cache.uninstallLoader();
+  lua.script("package.loaded.testScriptCacheModule = nil");
+  EXPECT_EQ(lua.script("return require 'testScriptCacheModule'").get<std::string>(), "source");
+}
@@ -0,0 +1,143 @@
+#include "sol.hpp"
+#include "Engine.h"
+#include "systems/LuaScriptSystem.h"
+#include "components/ScriptComponent.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace Gsage;
+
+class TestLuaScriptSystem : public ::testing::Test
+{
+  public:
+    TestLuaScriptSystem()
+    {
+      lua.open_libraries(sol::lib::base, sol::lib::coroutine);
+      system = engine.addSystem<LuaScriptSystem>();
+      system->setLuaState(lua.lua_state());
+
+      lua.new_usertype<LuaScriptSystem>("ScriptSystem",
+        "waitSeconds", &LuaScriptSystem::waitSeconds,
+        "isSleeping", &LuaScriptSystem::isSleeping,
+        "getSleepTime", &LuaScriptSystem::getSleepTime
+      );
+      lua["timers"] = system;
+    }
+
+    // state should outlive the script system
+    sol::state lua;
+    Engine engine;
+    LuaScriptSystem* system;
+};
+
+TEST_F(TestLuaScriptSystem, TestWaitSeconds)
+{
+  lua.script(R"(
+    wakes = {}
+    coroutines = {}
+    for i = 1, 10000 do
+      local co = coroutine.create(function()
+        timers:waitSeconds(0.5 + (i % 10) * 0.1)
+        coroutine.yield()
+        wakes[i] = (wakes[i] or 0) + 1
+      end)
+      coroutine.resume(co)
+      coroutines[i] = co
+    end
+  )");
+
+  ASSERT_EQ(system->getSleepingCount(), 10000u);
+  sol::table coroutines = lua["coroutines"];
+  EXPECT_TRUE(system->isSleeping(coroutines[1]));
+  EXPECT_NEAR(system->getSleepTime(coroutines[1]), 0.6, 0.002);
+
+  engine.update(0.4);
+  EXPECT_EQ(system->getSleepingCount(), 10000u);
+
+  for(int i = 0; i < 20; ++i) {
+    engine.update(0.05);
+  }
+
+  EXPECT_EQ(system->getSleepingCount(), 0u);
+  EXPECT_FALSE(system->isSleeping(coroutines[1]));
+  EXPECT_EQ(system->getSleepTime(coroutines[1]), 0);
+
+  sol::table wakes = lua["wakes"];
+  for(int i = 1; i <= 10000; ++i) {
+    ASSERT_EQ(wakes.get_or(i, 0), 1) << "coroutine " << i;
+  }
+}
+
+TEST_F(TestLuaScriptSystem, TestWaitAgain)
+{
+  lua.script(R"(
+    wakes = 0
+    co = coroutine.create(function()
+      for i = 1, 3 do
+        timers:waitSeconds(1)
+        coroutine.yield()
+        wakes = wakes + 1
+      end
+    end)
+    coroutine.resume(co)
+  )");
+
+  for(int i = 0; i < 25; ++i) {
+    engine.update(0.1);
+    EXPECT_EQ(lua["wakes"].get<int>(), (i + 1) / 10);
+  }
+
+  // main thread can not wait
+  lua.script("ok = timers:waitSeconds(10)");
+  EXPECT_FALSE(lua["ok"].get<bool>());
+  EXPECT_EQ(system->getSleepingCount(), 1u);
+
+  engine.update(1.0);
+  EXPECT_EQ(lua["wakes"].get<int>(), 3);
+  EXPECT_EQ(system->getSleepingCount(), 0u);
+}
+
+TEST_F(TestLuaScriptSystem, TestRunScriptFile)
+{
+  std::string path = "testLuaScriptSystem.lua";
+  {
+    std::ofstream stream(path);
+    stream << "runs = (runs or 0) + 1";
+  }
+
+  for(int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(system->runScript("@File:" + path));
+  }
+  EXPECT_EQ(lua["runs"].get<int>(), 10);
+
+  EXPECT_TRUE(system->runScript("runs = runs * 2"));
+  EXPECT_EQ(lua["runs"].get<int>(), 20);
+  EXPECT_FALSE(system->runScript("runs = "));
+  EXPECT_FALSE(system->runScript("@File:testLuaScriptSystemMissing.lua"));
+  std::remove(path.c_str());
+}
+
+TEST_F(TestLuaScriptSystem, TestProfilerScopes)
+{
+  lua.script("function listener(time) updates = (updates or 0) + 1 end");
+  system->addUpdateListener(lua["listener"]);
+  LuaProfiler* profiler = system->getProfiler();
+  ASSERT_TRUE(profiler->start());
+  for(int i = 0; i < 5; ++i) {
+    engine.update(0.1);
+  }
+  profiler->stop();
+  engine.update(0.1);
+
+  EXPECT_EQ(lua["updates"].get<int>(), 6);
+  bool found = false;
+  for(auto& scope : profiler->getScopes()) {
+    if(scope.name.find("listener ") == 0) {
+      found = true;
+      EXPECT_EQ(scope.calls, 5u);
+    }
+  }
+  EXPECT_TRUE(found);
+  EXPECT_EQ(profiler->getScopes()[profiler->getScope("timers")].calls, 5u);
+}
@@ -0,0 +1,125 @@
+#include "ObjectPool.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+
+#include "Logger.h"
+
+using namespace Gsage;
+
+struct PooledObject
+{
+  PooledObject() : value(0) {}
+  PooledObject(int v) : value(v) {}
+
+  int value;
+};
+
+TEST(TestObjectPool, TestCreateErase)
+{
+  ObjectPool<PooledObject> pool(4);
+  std::vector<PooledObject*> objects;
+  for(int i = 0; i < 100; i++) {
+    objects.push_back(pool.create(i));
+  }
+
+  ASSERT_EQ(pool.size(), 100);
+  for(int i = 0; i < 100; i++) {
+    ASSERT_EQ(objects[i]->value, i);
+  }
+
+  // erase from the middle, swap-and-pop keeps the dense array consistent
+  pool.erase(objects[10]);
+  pool.erase(objects[0]);
+  pool.erase(objects[99]);
+  ASSERT_EQ(pool.size(), 97);
+
+  for(PooledObject* object : pool.getElements()) {
+    ASSERT_TRUE(object->value != 10 && object->value != 0 && object->value != 99);
+    ASSERT_TRUE(pool.valid(pool.getHandle(object)));
+  }
+
+  // removing the same element twice does nothing
+  pool.remove(objects[10]);
+  ASSERT_EQ(pool.size(), 97);
+}
+
+TEST(TestObjectPool, TestFreeListReuse)
+{
+  ObjectPool<PooledObject> pool(4);
+  PooledObject* a = pool.create(1);
+  PooledObject* b = pool.create(2);
+  PooledObject* c = pool.create(3);
+
+  pool.erase(a);
+  pool.erase(b);
+  pool.erase(c);
+  ASSERT_EQ(pool.size(), 0);
+
+  // all freed slots are chained, not only the last one
+  PooledObject* d = pool.create(4);
+  PooledObject* e = pool.create(5);
+  PooledObject* f = pool.create(6);
+  ASSERT_EQ(d, c);
+  ASSERT_EQ(e, b);
+  ASSERT_EQ(f, a);
+}
+
+TEST(TestObjectPool, TestHandles)
+{
+  ObjectPool<PooledObject> pool(4);
+  PooledObject* a = pool.create(1);
+  ObjectPool<PooledObject>::Handle handle = pool.getHandle(a);
+
+  ASSERT_TRUE(handle.isValid());
+  ASSERT_EQ(pool.get(handle), a);
+
+  ASSERT_TRUE(pool.erase(handle));
+  ASSERT_FALSE(pool.valid(handle));
+  ASSERT_EQ(pool.get(handle), (PooledObject*)NULL);
+  ASSERT_FALSE(pool.erase(handle));
+
+  // slot is reused, but the old handle remains stale
+  PooledObject* b = pool.create(2);
+  ASSERT_EQ(a, b);
+  ASSERT_EQ(pool.get(handle), (PooledObject*)NULL);
+  ASSERT_NE(pool.getHandle(b), handle);
+  ASSERT_EQ(pool.get(pool.getHandle(b))->value, 2);
+
+  pool.clear();
+  ASSERT_EQ(pool.size(), 0);
+  ASSERT_FALSE(pool.valid(pool.getHandle(b)));
+  ASSERT_FALSE(pool.valid(ObjectPool<PooledObject>::Handle()));
+}
+
+/**
+ * Measures create/erase throughput with 1k, 10k and 100k live objects:
+ * erases random elements and creates new ones in place of them.
+ * Disabled by default, run with --gtest_also_run_disabled_tests
+ */
+TEST(TestObjectPool, DISABLED_BenchmarkCreateErase)
+{
+  const int iterations = 200000;
+  std::mt19937 random(42);
+  for(int live : {1000, 10000, 100000}) {
+    ObjectPool<PooledObject> pool;
+    std::vector<ObjectPool<PooledObject>::Handle> handles;
+    handles.reserve(live);
+    for(int i = 0; i < live; i++) {
+      handles.push_back(pool.getHandle(pool.create(i)));
+    }
+
+    std::uniform_int_distribution<int> distribution(0, live - 1);
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < iterations; i++) {
+      int index = distribution(random);
+      ASSERT_TRUE(pool.erase(handles[index]));
+      handles[index] = pool.getHandle(pool.create(i));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    ASSERT_EQ(pool.size(), live);
+    double seconds = std::chrono::duration<double>(end - start).count();
+    LOG(INFO) << "ObjectPool " << live << " live objects: " << (iterations / seconds) << " create/erase pairs per second";
+  }
+}
@@ -144,3 +144,76 @@ TEST_F(TestSerializable, TestReadErrors)
   ASSERT_TRUE(loads(node, s, DataWrapper::JSON_OBJECT));
   ASSERT_TRUE(mInstance->read(node));
 }
+
+TEST_F(TestSerializable, TestSharedPropertyTable)
+{
+  StubSerializable first;
+  StubSerializable second;
+  // instances of the same class reuse the property table built by the first one
+  ASSERT_EQ(first.getPropertyTable(), second.getPropertyTable());
+  ASSERT_EQ(first.getPropertyTable()->getBindings().size(), 7u);
+
+  DataProxy node;
+  std::string s = "{\"boolValue\": true, \"floatValue\": 2.5, \"intAccessor\": 10, \"node\": {\"test\": 1}, \"forNested\": 5}";
+  ASSERT_TRUE(loads(node, s, DataWrapper::JSON_OBJECT));
+  first.read(node);
+
+  ASSERT_TRUE(first.boolValue);
+  ASSERT_FLOAT_EQ(first.floatValue, 2.5);
+  ASSERT_EQ(first.intValue, 10);
+  ASSERT_EQ(first.nested->value, 6);
+
+  // the second instance is not affected
+  ASSERT_FALSE(second.boolValue);
+  ASSERT_FLOAT_EQ(second.floatValue, -1);
+  ASSERT_EQ(second.intValue, -1);
+  ASSERT_EQ(second.nested->value, -1);
+
+  ASSERT_TRUE(second.read(node, "forNested"));
+  ASSERT_EQ(second.nested->value, 6);
+  ASSERT_FALSE(second.read(node, "unknown"));
+
+  DataProxy dumped;
+  second.dump(dumped);
+  ASSERT_EQ(dumped.get<int>("forNested", -1), 6);
+  ASSERT_FLOAT_EQ(dumped.get<float>("floatValue", 0), -1);
+}
+
+TEST_F(TestSerializable, TestResolvedProperties)
+{
+  StubSerializable first;
+  StubSerializable second;
+
+  DataProxy node;
+  std::string s = "{\"boolValue\": true, \"notFound\": 404, \"floatValue\": 2.5, \"intAccessor\": 10, \"node\": {\"test\": 1}, \"forNested\": 5}";
+  ASSERT_TRUE(loads(node, s, DataWrapper::JSON_OBJECT));
+
+  ResolvedProperties properties;
+  first.resolve(node, properties);
+  ASSERT_EQ(properties.table, first.getPropertyTable());
+  ASSERT_EQ(properties.values.size(), 7u);
+
+  // properties resolved by one instance are read by another one
+  ASSERT_TRUE(second.read(properties, node));
+  ASSERT_TRUE(second.boolValue);
+  ASSERT_EQ(second.notFound, 404);
+  ASSERT_FLOAT_EQ(second.floatValue, 2.5);
+  ASSERT_EQ(second.intValue, 10);
+  ASSERT_EQ(second.nested->value, 6);
+  ASSERT_EQ(second.node.get<int>("test", -1), 1);
+
+  // node values are copied
+  second.node.put("test", 2);
+  ASSERT_EQ(node.get<int>("node.test", -1), 1);
+
+  // missing required value fails the read, same as reading the node
+  s = "{\"boolValue\": true, \"floatValue\": 0.0001, \"intAccessor\": 1000}";
+  ASSERT_TRUE(loads(node, s, DataWrapper::JSON_OBJECT));
+  first.resolve(node, properties);
+  ASSERT_FALSE(second.read(properties, node));
+  ASSERT_FLOAT_EQ(second.floatValue, 0.0001);
+
+  // properties resolved for another table are ignored
+  properties.table = 0;
+  ASSERT_FALSE(second.read(properties, node));
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "components/StatsComponent.h"
+#include "EventSubscriber.h"
+#include "EventQueue.h"
+
+using namespace Gsage;
+
+class StatsListener : public EventSubscriber<StatsListener>
+{
+  public:
+    bool onStatChange(EventDispatcher* sender, const Event& event)
+    {
+      changes.push_back(static_cast<const StatEvent&>(event).getId());
+      return true;
+    }
+
+    std::vector<std::string> changes;
+};
+
+TEST(TestStatsComponent, TestReadDump)
+{
+  DataProxy dict = loads("{\"hp\": 100, \"speed\": 1.5, \"alive\": true, \"enemy\": \"ninja\", \"items\": [1, 2]}", DataWrapper::JSON_OBJECT);
+  StatsComponent stats;
+  ASSERT_TRUE(stats.read(dict));
+
+  ASSERT_TRUE(stats.hasStat("hp"));
+  ASSERT_FALSE(stats.hasStat("mp"));
+  ASSERT_EQ(stats.getStat<int>("hp"), 100);
+  ASSERT_EQ(stats.getStat<float>("speed"), 1.5f);
+  ASSERT_TRUE(stats.getStat<bool>("alive"));
+  ASSERT_EQ(stats.getStat<std::string>("enemy"), "ninja");
+  ASSERT_EQ(stats.getStat<float>("enemy", 2.0f), 2.0f);
+  ASSERT_EQ(stats.getStat<float>("mp", 3.0f), 3.0f);
+
+  StatId hp = StatsComponent::getStatId("hp");
+  ASSERT_EQ(hp, StatsComponent::findStatId("hp"));
+  ASSERT_EQ(StatsComponent::getStatName(hp), "hp");
+  ASSERT_EQ(stats.increase("hp", -10), 90);
+  ASSERT_EQ(stats.getStat<float>(hp), 90);
+
+  DataProxy res = DataProxy::create(DataWrapper::JSON_OBJECT);
+  ASSERT_TRUE(stats.dump(res));
+  ASSERT_EQ(res.get<float>("hp", 0), 90);
+  ASSERT_EQ(res.get<float>("speed", 0), 1.5f);
+  ASSERT_EQ(res.get<bool>("alive", false), true);
+  ASSERT_EQ(res.get("enemy", ""), "ninja");
+  auto items = res.get<DataProxy>("items");
+  ASSERT_TRUE(items.second);
+  ASSERT_EQ(items.first.size(), 2);
+  ASSERT_EQ(items.first[1].getValueOptional<int>(0), 2);
+}
+
+TEST(TestStatsComponent, TestChangeEvents)
+{
+  StatsComponent stats;
+  StatsListener listener;
+  listener.addEventListener(&stats, StatEvent::STAT_CHANGE, &StatsListener::onStatChange);
+
+  // no queue, events are fired immediately
+  stats.setStat("hp", 100.0f);
+  stats.setStat("hp", 100.0f);
+  stats.setStat("hp", 90.0f);
+  ASSERT_EQ(listener.changes.size(), 2);
+  listener.changes.clear();
+
+  // queued events are collected by dirty flags and posted on flush
+  EventQueue queue;
+  stats.setEventQueue(&queue);
+  for(int i = 0; i < 10; i++) {
+    stats.increase("hp", -1);
+    stats.setStat("name", std::string("ninja"));
+  }
+  stats.setStat("alive", true);
+  ASSERT_EQ(queue.size(), 0);
+  ASSERT_EQ(stats.flushChanges(), 3);
+  ASSERT_EQ(stats.flushChanges(), 0);
+  ASSERT_EQ(listener.changes.size(), 0);
+  ASSERT_EQ(queue.flush(), 3);
+  ASSERT_EQ(listener.changes.size(), 3);
+  ASSERT_EQ(listener.changes[0], "hp");
+  ASSERT_EQ(listener.changes[1], "name");
+  ASSERT_EQ(listener.changes[2], "alive");
+  ASSERT_EQ(stats.getStat<float>("hp"), 80.0f);
+  stats.setEventQueue(0);
+}
@@ -0,0 +1,166 @@
+#include "TimerWheel.h"
+#include <gtest/gtest.h>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace Gsage;
+
+TEST(TestTimerWheel, TestFire)
+{
+  TimerWheel wheel(0.01);
+  std::vector<int> fired;
+  int values[] = {0, 1, 2};
+  wheel.schedule(0.5, &values[1]);
+  wheel.schedule(0.1, &values[0]);
+  TimerWheel::Handle last = wheel.schedule(1.0, &values[2]);
+  ASSERT_EQ(wheel.size(), 3u);
+  ASSERT_NEAR(wheel.getTimeLeft(last), 1.0, 0.01);
+
+  auto callback = [&] (const TimerWheel::Handle& handle, void* data) {
+    fired.push_back(*static_cast<int*>(data));
+  };
+
+  ASSERT_EQ(wheel.advance(0.05, callback), 0u);
+  ASSERT_EQ(wheel.advance(0.06, callback), 1u);
+  ASSERT_EQ(fired, std::vector<int>({0}));
+  ASSERT_NEAR(wheel.getTimeLeft(last), 0.89, 0.01);
+
+  wheel.advance(0.9, callback);
+  ASSERT_EQ(fired, std::vector<int>({0, 1, 2}));
+  ASSERT_EQ(wheel.size(), 0u);
+  ASSERT_FALSE(wheel.isScheduled(last));
+  ASSERT_EQ(wheel.getTimeLeft(last), 0);
+}
+
+TEST(TestTimerWheel, TestCancel)
+{
+  TimerWheel wheel;
+  int count = 0;
+  auto callback = [&] (const TimerWheel::Handle& handle, void* data) { count++; };
+
+  TimerWheel::Handle first = wheel.schedule(1.0, 0);
+  TimerWheel::Handle second = wheel.schedule(1.0, 0);
+  ASSERT_TRUE(wheel.cancel(first));
+  ASSERT_FALSE(wheel.cancel(first));
+  ASSERT_FALSE(wheel.isScheduled(first));
+
+  // freed entry is reused, but the old handle stays stale
+  TimerWheel::Handle third = wheel.schedule(2.0, 0);
+  ASSERT_EQ(third.index, first.index);
+  ASSERT_FALSE(wheel.cancel(first));
+  ASSERT_TRUE(wheel.isScheduled(third));
+
+  wheel.advance(1.5, callback);
+  ASSERT_EQ(count, 1);
+  ASSERT_FALSE(wheel.isScheduled(second));
+  wheel.clear();
+  ASSERT_EQ(wheel.size(), 0u);
+  wheel.advance(1.0, callback);
+  ASSERT_EQ(count, 1);
+}
+
+TEST(TestTimerWheel, TestReschedule)
+{
+  TimerWheel wheel(0.01);
+  int count = 0;
+  // each timer schedules itself again, it should not fire twice in one advance call
+  std::function<void(const TimerWheel::Handle&, void*)> callback = [&] (const TimerWheel::Handle& handle, void* data) {
+    count++;
+    wheel.schedule(0, data);
+  };
+
+  wheel.schedule(0, 0);
+  wheel.advance(0.01, callback);
+  ASSERT_EQ(count, 1);
+  wheel.advance(0.01, callback);
+  ASSERT_EQ(count, 2);
+  ASSERT_EQ(wheel.size(), 1u);
+
+  // cancelling other timer, expiring in the same tick
+  wheel.clear();
+  TimerWheel::Handle handles[2];
+  handles[0] = wheel.schedule(0.5, &handles[1]);
+  handles[1] = wheel.schedule(0.5, &handles[0]);
+  size_t fired = wheel.advance(0.5, [&] (const TimerWheel::Handle& handle, void* data) {
+    wheel.cancel(*static_cast<TimerWheel::Handle*>(data));
+  });
+  ASSERT_EQ(fired, 1u);
+}
+
+TEST(TestTimerWheel, TestRescheduleMultiTick)
+{
+  TimerWheel wheel(0.01);
+  int count = 0;
+  TimerWheel::Handle handle;
+  // advance spans 100 ticks, rescheduled timers would expire in the same call
+  std::function<void(const TimerWheel::Handle&, void*)> callback = [&] (const TimerWheel::Handle& h, void* data) {
+    count++;
+    handle = wheel.schedule(0.01, data);
+    EXPECT_TRUE(wheel.isScheduled(handle));
+  };
+
+  wheel.schedule(0.01, 0);
+  ASSERT_EQ(wheel.advance(1.0, callback), 1u);
+  ASSERT_EQ(count, 1);
+  ASSERT_EQ(wheel.size(), 1u);
+
+  // overdue timer fires in the next call
+  ASSERT_EQ(wheel.advance(0.01, callback), 1u);
+  ASSERT_EQ(count, 2);
+
+  // timer can be cancelled before it is added to the wheel
+  size_t fired = wheel.advance(1.0, [&] (const TimerWheel::Handle& h, void* data) {
+    count++;
+    TimerWheel::Handle scheduled = wheel.schedule(0.01, data);
+    EXPECT_TRUE(wheel.cancel(scheduled));
+    EXPECT_FALSE(wheel.isScheduled(scheduled));
+  });
+  ASSERT_EQ(fired, 1u);
+  ASSERT_EQ(count, 3);
+  ASSERT_EQ(wheel.size(), 0u);
+  ASSERT_EQ(wheel.advance(1.0, callback), 0u);
+}
+
+TEST(TestTimerWheel, TestManyTimers)
+{
+  // 10k timers with delays up to several hours, so all wheel levels are used
+  const int count = 10000;
+  const double frame = 1.0 / 60;
+  TimerWheel wheel;
+  wheel.reserve(count);
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<double> shortDelay(0, 10.0);
+  std::uniform_real_distribution<double> longDelay(10.0, 6 * 3600);
+  std::vector<double> delays(count);
+  std::vector<double> firedAt(count, -1);
+  for(int i = 0; i < count; ++i) {
+    delays[i] = i % 10 == 0 ? longDelay(random) : shortDelay(random);
+    wheel.schedule(delays[i], &delays[i]);
+  }
+
+  double now = 0;
+  auto callback = [&] (const TimerWheel::Handle& handle, void* data) {
+    size_t index = static_cast<double*>(data) - delays.data();
+    ASSERT_EQ(firedAt[index], -1);
+    firedAt[index] = now;
+  };
+
+  while(now < 10.0 + frame) {
+    now += frame;
+    wheel.advance(frame, callback);
+  }
+  // bigger steps for the long timers
+  while(wheel.size() > 0 && now < 7 * 3600) {
+    now += 1.0;
+    wheel.advance(1.0, callback);
+  }
+
+  ASSERT_EQ(wheel.size(), 0u);
+  for(int i = 0; i < count; ++i) {
+    double step = delays[i] < 10.0 ? frame : 1.0;
+    ASSERT_GE(firedAt[i], delays[i] - 1e-6) << i;
+    ASSERT_LT(firedAt[i], delays[i] + step + 0.002) << i;
+  }
+}
@@ -0,0 +1,69 @@
+require 'lib.behaviors'
+local async = require 'lib.async'
+
+describe("test behavior trees #core", function()
+  local function createNode(run)
+    return {run = run}
+  end
+
+  local function createTree(node)
+    local tree = BehaviorTree(RunContext("btreeSpec"))
+    tree:start(node)
+    return tree
+  end
+
+  describe("updateAll", function()
+    it("should update each tree once", function()
+      local counts = {0, 0, 0}
+      local trees = {}
+      for i = 1, 3 do
+        trees[i] = createTree(createNode(function(self, context)
+          while true do
+            counts[i] = counts[i] + 1
+            coroutine.yield()
+          end
+        end))
+      end
+
+      btree.updateAll(trees, 3, 0.1)
+      assert.are.same({1, 1, 1}, counts)
+
+      -- trees after count are ignored
+      btree.updateAll(trees, 2, 0.1)
+      assert.are.same({2, 2, 1}, counts)
+
+      for _, tree in ipairs(trees) do
+        tree:stop()
+      end
+    end)
+
+    it("should report sleep time", function()
+      local count = 0
+      local trees = {
+        createTree(createNode(function(self, context)
+          while true do
+            count = count + 1
+            async.waitSeconds(10)
+          end
+        end)),
+        createTree(createNode(function(self, context)
+          coroutine.yield()
+        end)),
+      }
+
+      local sleep = {}
+      btree.updateAll(trees, 2, 0.1, sleep)
+      assert.equals(1, count)
+      assert.is_true(sleep[1] > 9 and sleep[1] <= 10)
+      assert.equals(0, sleep[2])
+
+      -- suspended tree is not resumed, finished tree does not sleep
+      btree.updateAll(trees, 2, 0.1, sleep)
+      assert.equals(1, count)
+      assert.is_nil(trees[2].mainCoroutine)
+      assert.equals(0, sleep[2])
+
+      trees[1]:stop()
+    end)
+  end)
+end)
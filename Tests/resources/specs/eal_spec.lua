@@ -120,6 +120,35 @@ describe("test engine abstraction layer #eal", function()
     assert.equals(wrapper:ping(), "pong")
   end)
 
+  it("view should return wrapped entities with all components", function()
+    local both = data:createEntity({
+      test = {
+        prop = "view"
+      },
+      stats = {
+      }
+    })
+    local testOnly = data:createEntity({
+      test = {
+        prop = "view"
+      }
+    })
+
+    local found = {}
+    for _, wrapper in ipairs(eal:view({"test", "stats"})) do
+      found[wrapper.id] = wrapper
+    end
+    assert.is_not.is_nil(found[both.id])
+    assert.is_nil(found[testOnly.id])
+    assert.equals(found[both.id]:ping(), "view")
+
+    assert.truthy(core:removeEntity(both.id))
+    for _, wrapper in ipairs(eal:view({"test", "stats"})) do
+      assert.is_not.equals(wrapper.id, both.id)
+    end
+    assert.truthy(core:removeEntity(testOnly.id))
+  end)
+
   describe("mixins", function()
     local composition = data:createEntity({
       props = {
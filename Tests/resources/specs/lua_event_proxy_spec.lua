@@ -38,6 +38,37 @@ describe("test event proxy #core", function()
     assert.is_not.is_nil(entityID)
   end)
 
+  it("should pass event fields as arguments", function()
+    local eventType = nil
+    local entityID = nil
+    local function handler(t, id)
+      eventType = t
+      entityID = id
+    end
+    local proxy = LuaEventProxy.new()
+    assert.truthy(proxy:onEntity(core, EntityEvent.CREATE, handler, {"type", "id"}))
+    local entity = createTestEntity()
+
+    assert.equals(eventType, EntityEvent.CREATE)
+    assert.equals(entityID, entity.id)
+    assert.truthy(proxy:unbind(core, EntityEvent.CREATE, handler))
+  end)
+
+  it("should reuse event object", function()
+    local events = {}
+    local function handler(e)
+      table.insert(events, e)
+    end
+    local proxy = LuaEventProxy.new()
+    assert.truthy(proxy:onEntity(core, EntityEvent.CREATE, handler))
+    createTestEntity()
+    createTestEntity()
+
+    assert.equals(#events, 2)
+    assert.equals(events[1], events[2])
+    assert.truthy(proxy:unbind(core, EntityEvent.CREATE, handler))
+  end)
+
   describe("unbind", function()
     local eventType = nil
     it("should work", function()
@@ -20,6 +20,7 @@ if imguiInterface:available() then
   require 'imgui.stats'
   require 'imgui.transform'
   require 'imgui.sceneExplorer'
+  require 'imgui.profiler'
 end
 
 local rocketInitialized = false
@@ -117,6 +118,10 @@ if imguiInterface:available() then
 
   imguiInterface:addView("stats", stats)
 
+  profiler = Profiler("lua profiler", true)
+
+  imguiInterface:addView("profiler", profiler)
+
   imguiInterface:addView("assets", function()
     imgui.TextWrapped("coming soon")
   end, true)
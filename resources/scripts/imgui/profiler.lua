@@ -1,32 +1,136 @@
 require 'lib.class'
-local time = require 'lib.time'
-
--- imgui engine stats view
-Stats = class(function(self)
-  self.fps = 0
-  self.frames = 0
-  self.elapsedTime = 0
-  -- update each second
-  self.monitor = ResourceMonitor.new(0.1)
-  self.stats = self.monitor.stats
-
-  self.handleTime = function(delta)
-    self.frames = self.frames + 1
-    self.elapsedTime = self.elapsedTime + delta
-    if self.elapsedTime >= 1 then
-      self.fps = self.frames
-      self.frames = 0
-      self.elapsedTime = 0
+require 'imgui.base'
+
+-- lua sampling profiler view
+Profiler = class(ImguiWindow, function(self, title, docked, open)
+  ImguiWindow.init(self, title, docked, open)
+  self.limit = 20
+  self.foldedPath = "lua.folded"
+end)
+
+local function sortBy(items, field)
+  local res = {}
+  for i = 1, #items do
+    res[i] = items[i]
+  end
+  table.sort(res, function(a, b) return a[field] > b[field] end)
+  return res
+end
+
+local function percent(value, total)
+  if total == 0 then
+    return "0%"
+  end
+  return string.format("%.1f%%", value * 100 / total)
+end
+
+-- render profiler controls and collected stats
+function Profiler:__call()
+  if self:imguiBegin() then
+    local profiler = core:script().profiler
+    self:renderControls(profiler)
+    imgui.Separator()
+    self:renderScopes(profiler)
+    imgui.Separator()
+    self:renderFunctions(profiler)
+    imgui.Separator()
+    self:renderLines(profiler)
+    self:imguiEnd()
+  end
+end
+
+function Profiler:renderControls(profiler)
+  if profiler.running then
+    if imgui.Button("stop") then
+      profiler:stop()
+    end
+  elseif imgui.Button("start") then
+    profiler:start()
+  end
+  imgui.SameLine()
+  if imgui.Button("reset") then
+    profiler:reset()
+  end
+  imgui.SameLine()
+  if imgui.Button("save folded") then
+    if profiler:saveFolded(self.foldedPath) then
+      log.info("Saved lua profiler stacks to " .. self.foldedPath)
     end
   end
-  game:addUpdateListener(self.monitor)
-  time.addHandler("stats", self.handleTime, true)
-end)
 
--- render stats
-function Stats:__call()
-  imgui.Begin("Stats", true, ImGuiWindowFlags_NoResize + ImGuiWindowFlags_NoTitleBar)
-  imgui.Text("FPS:" .. self.fps)
-  imgui.Text("CPU:" .. math.floor(self.stats.lastCPU * 100))
-  imgui.End()
+  if not profiler.running then
+    local _, countNativeCalls = imgui.Checkbox("count native calls", profiler.countNativeCalls)
+    profiler.countNativeCalls = countNativeCalls
+  end
+  imgui.Text("samples: " .. profiler.sampleCount)
+end
+
+function Profiler:renderScopes(profiler)
+  local scopes = sortBy(profiler.scopes, "time")
+  imgui.Columns(5, "scopes", true)
+  imgui.Text("scope")
+  imgui.NextColumn()
+  imgui.Text("calls")
+  imgui.NextColumn()
+  imgui.Text("native calls")
+  imgui.NextColumn()
+  imgui.Text("time, ms")
+  imgui.NextColumn()
+  imgui.Text("samples")
+  imgui.NextColumn()
+  for i = 1, math.min(#scopes, self.limit) do
+    local scope = scopes[i]
+    imgui.Text(scope.name)
+    imgui.NextColumn()
+    imgui.Text(tostring(scope.calls))
+    imgui.NextColumn()
+    imgui.Text(tostring(scope.nativeCalls))
+    imgui.NextColumn()
+    imgui.Text(string.format("%.2f", scope.time * 1000))
+    imgui.NextColumn()
+    imgui.Text(tostring(scope.samples))
+    imgui.NextColumn()
+  end
+  imgui.Columns(1)
+end
+
+function Profiler:renderFunctions(profiler)
+  local total = profiler.sampleCount
+  local functions = sortBy(profiler.functions, "selfSamples")
+  imgui.Columns(3, "functions", true)
+  imgui.Text("function")
+  imgui.NextColumn()
+  imgui.Text("self")
+  imgui.NextColumn()
+  imgui.Text("total")
+  imgui.NextColumn()
+  for i = 1, math.min(#functions, self.limit) do
+    local f = functions[i]
+    imgui.Text((f.name ~= "" and f.name .. " " or "") .. f.source .. ":" .. f.line)
+    imgui.NextColumn()
+    imgui.Text(percent(f.selfSamples, total))
+    imgui.NextColumn()
+    imgui.Text(percent(f.totalSamples, total))
+    imgui.NextColumn()
+  end
+  imgui.Columns(1)
+end
+
+function Profiler:renderLines(profiler)
+  local total = profiler.sampleCount
+  -- lines are sorted by sample count already
+  local lines = profiler.lines
+  imgui.Columns(2, "lines", true)
+  imgui.Text("line")
+  imgui.NextColumn()
+  imgui.Text("samples")
+  imgui.NextColumn()
+  for i = 1, math.min(#lines, self.limit) do
+    local l = lines[i]
+    imgui.Text(profiler:getFunctionName(l.functionId) .. " line " .. l.line)
+    imgui.NextColumn()
+    imgui.Text(percent(l.samples, total))
+    imgui.NextColumn()
+  end
+  imgui.Columns(1)
 end
@@ -18,10 +18,30 @@ local WAITING_ON_SIGNAL = {}
 -- Keep track of how long the game has been running.
 local CURRENT_TIME = 0
 
+-- Script system keeps sleeping coroutines in the native timer wheel and resumes them itself.
+-- Lua tables are used only when there is no script system
+local timers = core and core:script()
+
 function async.isSuspended(co)
+  if timers then
+    return WAITING_ON_SIGNAL_ALL[co] ~= nil or timers:isSleeping(co)
+  end
   return WAITING_ON_TIME[co] ~= nil or WAITING_ON_SIGNAL_ALL[co] ~= nil
 end
 
+-- Get the time left until the coroutine is woken up, 0 if it is not waiting on time
+function async.getSleepTime(co)
+  if timers then
+    return timers:getSleepTime(co)
+  end
+
+  local wakeupTime = WAITING_ON_TIME[co]
+  if wakeupTime == nil then
+    return 0
+  end
+  return wakeupTime - CURRENT_TIME
+end
+
 function async.waitSeconds(seconds)
     -- Grab a reference to the current running coroutine.
     local co = coroutine.running()
@@ -29,9 +49,13 @@ function async.waitSeconds(seconds)
     -- If co is nil, that means we're on the main process, which isn't a coroutine and can't yield
     assert(co ~= nil, "The main thread cannot wait!")
 
-    -- Store the coroutine and its wakeup time in the WAITING_ON_TIME table
-    local wakeupTime = CURRENT_TIME + seconds
-    WAITING_ON_TIME[co] = wakeupTime
+    if timers then
+      timers:waitSeconds(seconds)
+    else
+      -- Store the coroutine and its wakeup time in the WAITING_ON_TIME table
+      local wakeupTime = CURRENT_TIME + seconds
+      WAITING_ON_TIME[co] = wakeupTime
+    end
 
     -- And suspend the process
     return coroutine.yield(co)
@@ -97,6 +121,8 @@ function async.signal(signalName)
     end
 end
 
-time.addHandler("async", async.addTime, true)
+if not timers then
+  time.addHandler("async", async.addTime, true)
+end
 
 return async
@@ -32,6 +32,23 @@ function btree.deinitialize(id)
   btree[id] = nil
 end
 
+-- Update count trees from the trees array in a single call.
+-- If sleep table is passed, it gets the time each tree is going to wait,
+-- so the caller can skip the tree until then
+function btree.updateAll(trees, count, time, sleep)
+  for i = 1, count do
+    local co = trees[i].mainCoroutine
+    if co ~= nil and not async.isSuspended(co) then
+      coroutine.resume(co)
+    end
+
+    if sleep ~= nil then
+      co = trees[i].mainCoroutine
+      sleep[i] = co and async.getSleepTime(co) or 0
+    end
+  end
+end
+
 function btree.getBehavior(behaviorId)
   if not btree.factories[behaviorId] then
     local succeed, err = pcall(function() require(behaviorId) end)
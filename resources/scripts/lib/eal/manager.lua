@@ -83,6 +83,20 @@ function EALManager:getEntity(name)
   return self.entities[name]
 end
 
+-- get all entities that have all the listed components
+-- uses engine cached view, so it does not scan all entities each call
+function EALManager:view(components)
+  local result = {}
+  local entities = core:view(components)
+  for i = 1, #entities do
+    local e = self:getEntity(entities[i].id)
+    if e then
+      table.insert(result, e)
+    end
+  end
+  return result
+end
+
 -- assemble entity wrapper
 function EALManager:assemble(name)
   local e = core:getEntity(name)
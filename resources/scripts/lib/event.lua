@@ -18,7 +18,10 @@ end)
 -- @param target event dispatcher
 -- @param type event type
 -- @param callback event listener
-function EventProxy:bind(target, type, callback, global, handlerName)
+-- @param global unused
+-- @param handlerName name of the typed handler
+-- @param fields list of event fields, that are passed to the callback instead of the event object
+function EventProxy:bind(target, type, callback, global, handlerName, fields)
   if type == nil or type == "" then
     error("Tried to bind nil event type")
   end
@@ -31,6 +34,11 @@ function EventProxy:bind(target, type, callback, global, handlerName)
   -- if called from root coroutine, then we can register the handler
   -- directly in the script system
   if not co or isRoot then
+    if fields then
+      self.direct[handlerName or "bind"](self.direct, target, type, callback, fields)
+      return
+    end
+
     if handlerName == "onOgreSelect" then
       self.direct:onOgreSelect(target, type, callback)
       return
@@ -39,9 +47,28 @@ function EventProxy:bind(target, type, callback, global, handlerName)
     return
   end
 
+  local listener = callback
+  if fields then
+    local count = #fields
+    -- connection passes the event object, so fields are read here
+    listener = function(event, target)
+      if count == 1 then
+        return callback(event[fields[1]])
+      elseif count == 2 then
+        return callback(event[fields[1]], event[fields[2]])
+      end
+
+      local values = {}
+      for i = 1, count do
+        values[i] = event[fields[i]]
+      end
+      return callback(unpack(values, 1, count))
+    end
+  end
+
   local id = self.connection[handlerName or "bind"](self.connection, target, type)
   self:traverseSet(target, type, callback, id)
-  self.handlers[id] = callback
+  self.handlers[id] = listener
 end
 
 -- unbind callback
@@ -71,8 +98,8 @@ local __index = EventProxy.__index
 
 function EventProxy:__index(key)
   if __index[key] == nil and self.connection[key] then
-    return function(self, target, type, callback, global)
-      return self:bind(target, type, callback, global, key)
+    return function(self, target, type, callback, global, fields)
+      return self:bind(target, type, callback, global, key, fields)
     end
   end
 
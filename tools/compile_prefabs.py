@@ -0,0 +1,162 @@
+"""
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+"""
+
+#!/usr/bin/python
+"""
+Compile json characters and levels into binary prefabs, that can be loaded by the engine without parsing json.
+
+Prefab layout: "GSPF" magic, uint32 format version, uint32 payload size (little endian), msgpack payload.
+GameDataManager picks <name>.prefab instead of <name>.json if it exists in the same folder.
+"""
+import argparse
+import collections
+import json
+import os
+import struct
+import sys
+
+MAGIC = b"GSPF"
+VERSION = 1
+EXTENSION = ".prefab"
+
+try:
+    text_type = unicode
+except NameError:
+    text_type = str
+
+def create_arg_parser():
+    parser = argparse.ArgumentParser(description="Compile json data files to binary prefabs")
+    parser.add_argument("inputs", nargs="+", help="Json files or folders to compile")
+    parser.add_argument("-o", "--output-dir", dest="output_dir", default=None,
+            help="Folder to write prefabs to, prefabs are written next to the source files by default")
+    parser.add_argument("-v", "--verbose", dest="verbose", action="store_true", help="Verbose output")
+    return parser
+
+def pack(value, out):
+    if value is None:
+        out.append(b"\xc0")
+    elif value is True:
+        out.append(b"\xc3")
+    elif value is False:
+        out.append(b"\xc2")
+    elif isinstance(value, float):
+        out.append(struct.pack(">Bd", 0xcb, value))
+    elif isinstance(value, int) or type(value).__name__ == "long":
+        pack_int(value, out)
+    elif isinstance(value, (text_type, str)):
+        data = value.encode("utf-8") if isinstance(value, text_type) else value
+        size = len(data)
+        if size < 32:
+            out.append(struct.pack(">B", 0xa0 | size))
+        elif size < 0x100:
+            out.append(struct.pack(">BB", 0xd9, size))
+        elif size < 0x10000:
+            out.append(struct.pack(">BH", 0xda, size))
+        else:
+            out.append(struct.pack(">BI", 0xdb, size))
+        out.append(data)
+    elif isinstance(value, (list, tuple)):
+        pack_header(len(value), 0x90, 0xdc, out)
+        for item in value:
+            pack(item, out)
+    elif isinstance(value, dict):
+        pack_header(len(value), 0x80, 0xde, out)
+        for key, item in value.items():
+            pack(key, out)
+            pack(item, out)
+    else:
+        raise TypeError("Can't pack value of type %s" % type(value))
+
+def pack_header(size, fix, base, out):
+    if size < 16:
+        out.append(struct.pack(">B", fix | size))
+    elif size < 0x10000:
+        out.append(struct.pack(">BH", base, size))
+    else:
+        out.append(struct.pack(">BI", base + 1, size))
+
+def pack_int(value, out):
+    if 0 <= value < 0x80:
+        out.append(struct.pack(">B", value))
+    elif -32 <= value < 0:
+        out.append(struct.pack(">b", value))
+    elif value >= 0:
+        for code, fmt, limit in ((0xcc, ">BB", 0x100), (0xcd, ">BH", 0x10000), (0xce, ">BI", 0x100000000)):
+            if value < limit:
+                out.append(struct.pack(fmt, code, value))
+                return
+        out.append(struct.pack(">BQ", 0xcf, value))
+    else:
+        for code, fmt, limit in ((0xd0, ">Bb", 0x80), (0xd1, ">Bh", 0x8000), (0xd2, ">Bi", 0x80000000)):
+            if value >= -limit:
+                out.append(struct.pack(fmt, code, value))
+                return
+        out.append(struct.pack(">Bq", 0xd3, value))
+
+def compile_prefab(data):
+    out = []
+    pack(data, out)
+    payload = b"".join(out)
+    return MAGIC + struct.pack("<II", VERSION, len(payload)) + payload
+
+def collect_inputs(inputs):
+    for path in inputs:
+        if not os.path.isdir(path):
+            yield path, ""
+            continue
+
+        for root, dirs, files in os.walk(path):
+            for name in sorted(files):
+                if name.endswith(".json"):
+                    yield os.path.join(root, name), os.path.relpath(root, path)
+
+if __name__ == "__main__":
+    arg_parser = create_arg_parser()
+    options = arg_parser.parse_args()
+    failed = False
+    for path, folder in collect_inputs(options.inputs):
+        try:
+            with open(path, "r") as f:
+                data = json.load(f, object_pairs_hook=collections.OrderedDict)
+        except ValueError as e:
+            sys.stderr.write("Failed to read %s: %s\n" % (path, e))
+            failed = True
+            continue
+
+        output_dir = os.path.dirname(path)
+        if options.output_dir:
+            output_dir = os.path.join(options.output_dir, folder)
+            if not os.path.exists(output_dir):
+                os.makedirs(output_dir)
+
+        output = os.path.normpath(os.path.join(output_dir, os.path.splitext(os.path.basename(path))[0] + EXTENSION))
+        with open(output, "wb") as f:
+            f.write(compile_prefab(data))
+
+        if options.verbose:
+            print("%s -> %s" % (path, output))
+
+    sys.exit(1 if failed else 0)
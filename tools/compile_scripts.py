@@ -0,0 +1,106 @@
+"""
+-----------------------------------------------------------------------------
+This file is a part of Gsage engine
+
+Copyright (c) 2014-2016 Artem Chernyshev
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+"""
+
+#!/usr/bin/python
+"""
+Precompile lua scripts into bytecode, that can be loaded by the engine without parsing the source.
+
+Each script.lua is compiled into script.luac in the same folder.
+LuaScriptCache picks the precompiled file for @File scripts and required modules,
+if it is not older than the source.
+
+Bytecode is specific to the lua VM, so the compiler should be the same version the engine is built with:
+luajit for LuaJIT builds (resources/luarocks/bin/luajit), luac for lua-5.1.
+"""
+import argparse
+import os
+import subprocess
+import sys
+
+SOURCE_EXTENSION = ".lua"
+EXTENSION = ".luac"
+
+def create_arg_parser():
+    parser = argparse.ArgumentParser(description="Precompile lua scripts to bytecode")
+    parser.add_argument("inputs", nargs="+",
+            help="Lua files or folders to compile, e.g. resources/scripts resources/behaviors")
+    parser.add_argument("-c", "--compiler", dest="compiler", default="luajit",
+            help="Path to luajit or luac executable")
+    parser.add_argument("-s", "--strip", dest="strip", action="store_true",
+            help="Strip debug information, errors won't have line numbers")
+    parser.add_argument("-f", "--force", dest="force", action="store_true",
+            help="Compile scripts, that have up to date bytecode")
+    parser.add_argument("-v", "--verbose", dest="verbose", action="store_true", help="Verbose output")
+    return parser
+
+def get_command(compiler, source, output, strip):
+    if os.path.basename(compiler).startswith("luajit"):
+        return [compiler, "-b" if strip else "-bg", source, output]
+
+    command = [compiler, "-o", output]
+    if strip:
+        command.append("-s")
+    command.append(source)
+    return command
+
+def collect_inputs(inputs):
+    for path in inputs:
+        if not os.path.isdir(path):
+            yield path
+            continue
+
+        for root, dirs, files in os.walk(path):
+            for name in sorted(files):
+                if name.endswith(SOURCE_EXTENSION):
+                    yield os.path.join(root, name)
+
+if __name__ == "__main__":
+    arg_parser = create_arg_parser()
+    options = arg_parser.parse_args()
+    failed = False
+    compiled = 0
+    for path in collect_inputs(options.inputs):
+        output = os.path.splitext(path)[0] + EXTENSION
+        if not options.force and os.path.exists(output) and os.path.getmtime(output) >= os.path.getmtime(path):
+            continue
+
+        try:
+            subprocess.check_call(get_command(options.compiler, path, output, options.strip))
+        except OSError as e:
+            sys.stderr.write("Failed to run %s: %s\n" % (options.compiler, e))
+            sys.exit(1)
+        except subprocess.CalledProcessError:
+            sys.stderr.write("Failed to compile %s\n" % path)
+            failed = True
+            continue
+
+        compiled += 1
+        if options.verbose:
+            print("%s -> %s" % (path, output))
+
+    if options.verbose:
+        print("compiled %d scripts" % compiled)
+    sys.exit(1 if failed else 0)